@@ -0,0 +1,177 @@
+#ifndef LIB_MART_COMMON_GUARD_BENCHMARKS_BENCH_COMMON_H
+#define LIB_MART_COMMON_GUARD_BENCHMARKS_BENCH_COMMON_H
+/**
+ * bench_common.hpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Small helpers shared by the benchmark executables (statistics, command line, json output)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace bench {
+
+using bench_clock = std::chrono::steady_clock;
+
+inline std::int64_t ns_between( bench_clock::time_point start, bench_clock::time_point end ) noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( end - start ).count();
+}
+
+struct Stats {
+	std::size_t  ops         = 0;
+	double       ns_per_op   = 0;
+	double       ops_per_s   = 0;
+	double       bytes_per_s = 0; // only set by benchmarks that move payload
+	std::int64_t p50_ns      = 0;
+	std::int64_t p99_ns      = 0;
+	std::int64_t p999_ns     = 0;
+	std::int64_t max_ns      = 0;
+};
+
+/**
+ * Computes throughput from the wall clock time and percentiles from the per operation samples
+ * NOTE: sorts samples in place
+ */
+inline Stats summarize( std::vector<std::int64_t>& samples_ns, std::size_t ops, std::chrono::nanoseconds wall_time )
+{
+	Stats s;
+	s.ops = ops;
+	if( ops != 0 && wall_time.count() > 0 ) {
+		s.ns_per_op = static_cast<double>( wall_time.count() ) / static_cast<double>( ops );
+		s.ops_per_s = 1e9 / s.ns_per_op;
+	}
+	if( samples_ns.empty() ) { return s; }
+
+	std::sort( samples_ns.begin(), samples_ns.end() );
+	const auto percentile = [&]( double p ) {
+		const auto idx = static_cast<std::size_t>( p * static_cast<double>( samples_ns.size() - 1 ) );
+		return samples_ns[idx];
+	};
+	s.p50_ns  = percentile( 0.5 );
+	s.p99_ns  = percentile( 0.99 );
+	s.p999_ns = percentile( 0.999 );
+	s.max_ns  = samples_ns.back();
+	return s;
+}
+
+/**
+ * One row in the result table: a set of parameters (e.g. "sink":"file") and the measured statistics
+ */
+struct Result {
+	std::vector<std::pair<std::string, std::string>> params;
+	Stats                                             stats;
+};
+
+inline void write_json_string( std::ostream& out, std::string_view str )
+{
+	out << '"';
+	for( char c : str ) {
+		switch( c ) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			default: out << c;
+		}
+	}
+	out << '"';
+}
+
+inline void write_json( std::ostream& out, std::string_view benchmark_name, const std::vector<Result>& results )
+{
+	out << "{\n  \"benchmark\": ";
+	write_json_string( out, benchmark_name );
+	out << ",\n  \"results\": [";
+	for( std::size_t i = 0; i < results.size(); ++i ) {
+		const auto& r = results[i];
+		out << ( i == 0 ? "\n    {" : ",\n    {" );
+		for( const auto& p : r.params ) {
+			write_json_string( out, p.first );
+			out << ": ";
+			write_json_string( out, p.second );
+			out << ", ";
+		}
+		out << "\"ops\": " << r.stats.ops                        //
+			<< ", \"ns_per_op\": " << r.stats.ns_per_op          //
+			<< ", \"ops_per_s\": " << r.stats.ops_per_s          //
+			<< ", \"mb_per_s\": " << r.stats.bytes_per_s / 1e6   //
+			<< ", \"p50_ns\": " << r.stats.p50_ns                //
+			<< ", \"p99_ns\": " << r.stats.p99_ns                //
+			<< ", \"p999_ns\": " << r.stats.p999_ns              //
+			<< ", \"max_ns\": " << r.stats.max_ns << "}";
+	}
+	out << "\n  ]\n}\n";
+}
+
+/**
+ * Writes the results to the given file or - if path is empty - to stdout
+ */
+inline bool write_json( const std::string& path, std::string_view benchmark_name, const std::vector<Result>& results )
+{
+	if( path.empty() ) {
+		write_json( std::cout, benchmark_name, results );
+		return true;
+	}
+	std::ofstream file( path );
+	if( !file ) {
+		std::cerr << "Could not open " << path << " for writing\n";
+		return false;
+	}
+	write_json( file, benchmark_name, results );
+	return static_cast<bool>( file );
+}
+
+/**
+ * Minimal command line parsing: options have the form "--name value"
+ */
+class CmdLine {
+public:
+	CmdLine( int argc, char** argv )
+		: _args( argv + 1, argv + argc )
+	{
+	}
+
+	bool has( std::string_view name ) const { return std::find( _args.begin(), _args.end(), name ) != _args.end(); }
+
+	std::string get( std::string_view name, std::string default_value ) const
+	{
+		const auto it = std::find( _args.begin(), _args.end(), name );
+		if( it == _args.end() || it + 1 == _args.end() ) { return default_value; }
+		return *( it + 1 );
+	}
+
+	std::size_t get( std::string_view name, std::size_t default_value ) const
+	{
+		const auto str = get( name, std::string{} );
+		return str.empty() ? default_value : static_cast<std::size_t>( std::strtoull( str.c_str(), nullptr, 10 ) );
+	}
+
+private:
+	std::vector<std::string> _args;
+};
+
+} // namespace bench
+} // namespace mart
+
+#endif
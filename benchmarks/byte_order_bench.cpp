@@ -0,0 +1,113 @@
+/**
+ * byte_order_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Compares the array byte order conversion (byte_order.hpp) with a loop over the scalar to_host_order
+ *
+ * Usage: mart-netlib-byte-order-bench [--elements <count>] [--out <json file>]
+ *
+ * For 16, 32 and 64 bit integers and different array sizes, an array in network byte order is repeatedly converted
+ * into a second array in host byte order, until <elements> integers have been converted. Throughput (ops_per_s) is
+ * in converted arrays per second, mb_per_s in converted bytes per second.
+ * - loop: to_host_order called for each element
+ * - scalar / ssse3 / avx2: mart::nw::to_host_order on the whole array with the respective kernel
+ *   (kernels the cpu doesn't support are skipped)
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/byte_order.hpp>
+
+#include <cstring>
+
+namespace {
+
+using mart::bench::bench_clock;
+using mart::nw::ByteSwapKernel;
+
+// prevents the compiler from dropping conversions, whose results are never read
+volatile std::uint64_t sink = 0;
+
+template<class Net, class Host>
+mart::bench::Stats run( const char* mode, std::size_t count, std::size_t total_elements )
+{
+	std::vector<Net>  src( count );
+	std::vector<Host> dst( count );
+	for( std::size_t i = 0; i < count; ++i ) {
+		src[i] = mart::nw::to_net_order( static_cast<Host>( i * 0x0101010101010101u ) );
+	}
+
+	const bool        loop = std::strcmp( mode, "loop" ) == 0;
+	const std::size_t reps = std::max( total_elements / count, std::size_t{ 1 } );
+
+	const auto start = bench_clock::now();
+	for( std::size_t r = 0; r < reps; ++r ) {
+		if( loop ) {
+			for( std::size_t i = 0; i < count; ++i ) {
+				dst[i] = mart::nw::to_host_order( src[i] );
+			}
+		} else {
+			mart::nw::to_host_order( src, dst );
+		}
+		sink = sink + dst[r % count];
+	}
+	const auto wall = bench_clock::now() - start;
+
+	std::vector<std::int64_t> no_samples;
+	auto stats        = mart::bench::summarize( no_samples, reps, wall );
+	stats.bytes_per_s = stats.ops_per_s * static_cast<double>( count * sizeof( Host ) );
+	return stats;
+}
+
+mart::bench::Stats run( const char* mode, int bits, std::size_t count, std::size_t total_elements )
+{
+	switch( bits ) {
+		case 16: return run<mart::nw::uint16_net_t, std::uint16_t>( mode, count, total_elements );
+		case 32: return run<mart::nw::uint32_net_t, std::uint32_t>( mode, count, total_elements );
+		default: return run<mart::nw::uint64_net_t, std::uint64_t>( mode, count, total_elements );
+	}
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0] << " [--elements <count>] [--out <json file>]\n";
+		return 0;
+	}
+	const auto elements = std::max( cmd.get( "--elements", std::size_t{ 200'000'000 } ), std::size_t{ 1 } );
+
+	const std::pair<const char*, ByteSwapKernel> modes[] = { { "loop", ByteSwapKernel::Scalar },
+															 { "scalar", ByteSwapKernel::Scalar },
+															 { "ssse3", ByteSwapKernel::Ssse3 },
+															 { "avx2", ByteSwapKernel::Avx2 } };
+
+	std::vector<mart::bench::Result> results;
+	for( const int bits : { 16, 32, 64 } ) {
+		for( const std::size_t count : { 16, 256, 4096, 256 * 1024 } ) {
+			for( const auto& [mode, kernel] : modes ) {
+				if( !mart::nw::set_byte_swap_kernel( kernel ) ) { continue; }
+				mart::bench::Result r;
+				r.params = { { "mode", mode },
+							 { "bits", std::to_string( bits ) },
+							 { "count", std::to_string( count ) } };
+				r.stats  = run( mode, bits, count, elements );
+				std::cerr << mode << " bits=" << bits << " count=" << count << ": " << r.stats.bytes_per_s / 1e6
+						  << " MB/s\n";
+				results.push_back( std::move( r ) );
+			}
+		}
+	}
+	mart::nw::set_byte_swap_kernel( mart::nw::best_byte_swap_kernel() );
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-netlib-byte-order-bench", results ) ? 0
+																												: 1;
+}
@@ -0,0 +1,190 @@
+/**
+ * log_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Measures cost per Logger::log call for different sinks, thread counts and argument mixes
+ *
+ * Usage: mart-common-log-bench [--threads <max threads>] [--messages <per thread>] [--file <log file>] [--out <json file>]
+ *
+ * For every combination of sink (null, file), producer thread count (1, 2, 4, ... max) and argument mix,
+ * all threads log through the same logger instance. Throughput is reported as wall clock time per message
+ * (over all threads) and latency percentiles are computed from the duration of each individual call.
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-common/logging/Logger.h>
+#include <mart-common/logging/Sinks.h>
+
+#include <im_str/im_str.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using mart::bench::bench_clock;
+
+class NullLog final : public mart::log::ILogSink {
+public:
+	std::atomic<std::size_t> bytes{ 0 };
+
+	mba::im_zstr getName() const override { return mba::im_zstr( "NULL" ); }
+
+private:
+	// count the bytes, so the formatting can't be optimized away
+	void _do_writeToLogImpl( std::string_view msg ) override { bytes.fetch_add( msg.size(), std::memory_order_relaxed ); }
+	void _do_flush() override {}
+};
+
+enum class ArgMix { String, Ints, Durations, HexDump, KeyValue };
+
+constexpr std::array<ArgMix, 5> all_arg_mixes{
+	ArgMix::String, ArgMix::Ints, ArgMix::Durations, ArgMix::HexDump, ArgMix::KeyValue };
+
+std::string_view to_string_view( ArgMix mix )
+{
+	switch( mix ) {
+		case ArgMix::String: return "string";
+		case ArgMix::Ints: return "ints";
+		case ArgMix::Durations: return "durations";
+		case ArgMix::HexDump: return "hexdump";
+		case ArgMix::KeyValue: return "kv";
+	}
+	return "unknown";
+}
+
+void log_one( mart::log::Logger& log, ArgMix mix, std::size_t i, mart::ConstMemoryView payload )
+{
+	switch( mix ) {
+		case ArgMix::String: log.debug_msg( "Connection to ", std::string_view( "server.example.com" ), " established" ); break;
+		case ArgMix::Ints: log.debug_msg( "Received packet ", i, " with size ", 1472, " from port ", 5060 ); break;
+		case ArgMix::Durations:
+			log.debug_msg( "Timing: rtt ", std::chrono::microseconds( 125 + i % 64 ), " timeout ", 250ms );
+			break;
+		case ArgMix::HexDump: log.debug_msg( "Payload: ", payload ); break;
+		case ArgMix::KeyValue:
+			log.debug( "Received packet",
+					   mart::log::kv( "seq", i ),
+					   mart::log::kv( "size", 1472 ),
+					   mart::log::kv( "rtt", std::chrono::microseconds( 125 + i % 64 ) ) );
+			break;
+	}
+}
+
+mart::bench::Stats
+run( mart::log::Logger& log, ArgMix mix, std::size_t thread_cnt, std::size_t messages_per_thread )
+{
+	std::array<mart::ByteType, 64> payload_storage{};
+	for( std::size_t i = 0; i < payload_storage.size(); ++i ) {
+		payload_storage[i] = static_cast<mart::ByteType>( i * 7 );
+	}
+	const auto payload = mart::ConstMemoryView( payload_storage );
+
+	std::vector<std::vector<std::int64_t>> samples( thread_cnt );
+	std::atomic<std::size_t>               ready{ 0 };
+	std::atomic<bool>                      go{ false };
+
+	std::vector<std::thread> threads;
+	for( std::size_t t = 0; t < thread_cnt; ++t ) {
+		threads.emplace_back( [&, t] {
+			auto& s = samples[t];
+			s.reserve( messages_per_thread );
+			// warm up thread local buffers
+			for( std::size_t i = 0; i < 100; ++i ) {
+				log_one( log, mix, i, payload );
+			}
+			ready++;
+			while( !go.load() ) {
+				std::this_thread::yield();
+			}
+			for( std::size_t i = 0; i < messages_per_thread; ++i ) {
+				const auto start = bench_clock::now();
+				log_one( log, mix, i, payload );
+				s.push_back( mart::bench::ns_between( start, bench_clock::now() ) );
+			}
+		} );
+	}
+	while( ready.load() != thread_cnt ) {
+		std::this_thread::yield();
+	}
+
+	const auto start = bench_clock::now();
+	go               = true;
+	for( auto& t : threads ) {
+		t.join();
+	}
+	const auto wall = bench_clock::now() - start;
+
+	std::vector<std::int64_t> all_samples;
+	all_samples.reserve( thread_cnt * messages_per_thread );
+	for( auto& s : samples ) {
+		all_samples.insert( all_samples.end(), s.begin(), s.end() );
+	}
+	return mart::bench::summarize(
+		all_samples, thread_cnt * messages_per_thread, std::chrono::duration_cast<std::chrono::nanoseconds>( wall ) );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0]
+				  << " [--threads <max threads>] [--messages <per thread>] [--file <log file>] [--out <json file>]\n";
+		return 0;
+	}
+
+	const auto max_threads = std::max<std::size_t>(
+		cmd.get( "--threads", static_cast<std::size_t>( std::max( 1u, std::thread::hardware_concurrency() ) ) ), 1 );
+	const auto messages  = cmd.get( "--messages", std::size_t{ 100'000 } );
+	const auto file_path = cmd.get( "--file", std::string( "mart-common-log-bench.log" ) );
+
+	// 1, 2, 4, ... max_threads
+	std::vector<std::size_t> thread_counts;
+	for( std::size_t t = 1; t < max_threads; t *= 2 ) {
+		thread_counts.push_back( t );
+	}
+	thread_counts.push_back( max_threads );
+
+	std::vector<mart::bench::Result> results;
+
+	for( const std::string_view sink_name : { std::string_view( "null" ), std::string_view( "file" ) } ) {
+		std::shared_ptr<mart::log::ILogSink> sink;
+		if( sink_name == "null" ) {
+			sink = std::make_shared<NullLog>();
+		} else {
+			sink = std::make_shared<mart::log::FileLog>( mba::im_zstr( file_path ) );
+		}
+		// Sinks flush after every message with Level::Status or higher, which would dominate the measurement
+		// -> messages are logged with Level::Debug
+		mart::log::Logger log( "bench", sink, mart::log::Level::Debug );
+
+		for( const auto threads : thread_counts ) {
+			for( const auto mix : all_arg_mixes ) {
+				auto stats = run( log, mix, threads, messages );
+				std::cerr << sink_name << " threads=" << threads << " args=" << to_string_view( mix )
+						  << " ns/msg=" << stats.ns_per_op << " p50=" << stats.p50_ns << " p99=" << stats.p99_ns
+						  << " p999=" << stats.p999_ns << '\n';
+				results.push_back( { { { "sink", std::string( sink_name ) },
+									   { "threads", std::to_string( threads ) },
+									   { "args", std::string( to_string_view( mix ) ) } },
+									 stats } );
+			}
+		}
+		sink->flush();
+	}
+	std::remove( file_path.c_str() );
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-common-log-bench", results ) ? 0 : 1;
+}
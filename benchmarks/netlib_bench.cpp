@@ -0,0 +1,372 @@
+/**
+ * netlib_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Loopback throughput and round trip latency of udp::Socket, tcp::Socket and un::Socket
+ *
+ * Usage: mart-netlib-bench [--messages <per pair and run>] [--max-pairs <count>] [--transport udp|tcp|unix]
+ *                          [--spin-us <max spin>] [--out <json file>]
+ *
+ * Baseline for changes to the port layer and the socket classes - only the plain send / recv calls are used.
+ * For every transport, message size and number of socket pairs (1, 2, 4, ... max-pairs; each pair with its own
+ * sender and receiver thread):
+ * - "throughput": every sender streams <messages> messages to its receiver. ops_per_s / mb_per_s are the totals of
+ *                 all pairs. Datagram senders never have more than a few messages in flight (to measure transmission
+ *                 and not drops) and messages dropped anyway are reported as "lost".
+ * - "latency":    every pair bounces a message back and forth (ping-pong); the percentiles are taken over the
+ *                 round trips of all pairs.
+ * With --spin-us, all sockets receive in spin-then-block mode (busy poll for up to <max spin> microseconds, before
+ * falling back to a blocking recv - see spin_then_block.hpp).
+ * NOTE: Each pair needs two cores to be meaningful - with more pairs than that, the threads just take turns.
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+#ifdef MART_NETLIB_BENCH_WITH_UNIX_SOCKETS
+#include <mart-netlib/unix.hpp>
+#endif
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+using namespace std::chrono_literals;
+using mart::bench::bench_clock;
+using mart::bench::ns_between;
+namespace tcp = mart::nw::ip::tcp;
+namespace udp = mart::nw::ip::udp;
+
+constexpr std::uint16_t tcp_port      = 3568;
+constexpr std::uint16_t udp_base_port = 3570; // two ports per pair
+constexpr std::size_t   max_pairs     = 16;
+
+// max messages / bytes in flight per datagram pair (the kernel accounts much more than the payload against the
+// receive buffer, so this stays well below the default buffer size)
+constexpr std::size_t dgram_window       = 64;
+constexpr std::size_t dgram_window_bytes = 64 * 1024;
+
+/*
+ * A connected pair of sockets a <-> b. send / recv are blocking, recv returns an empty or invalid view on timeout
+ * (only relevant for datagrams).
+ */
+class UdpPair {
+public:
+	static constexpr bool        is_stream = false;
+	static constexpr const char* name      = "udp";
+
+	explicit UdpPair( std::size_t index )
+	{
+		const auto          port = static_cast<std::uint16_t>( udp_base_port + 2 * index );
+		const udp::endpoint ep_a( mart::nw::ip::address_local_host, mart::nw::ip::port_nr( port ) );
+		const udp::endpoint ep_b( mart::nw::ip::address_local_host, mart::nw::ip::port_nr( port + 1 ) );
+		a.bind( ep_a );
+		b.bind( ep_b );
+		a.connect( ep_b );
+		b.connect( ep_a );
+	}
+
+	udp::Socket a;
+	udp::Socket b;
+};
+
+class TcpPair {
+public:
+	static constexpr bool        is_stream = true;
+	static constexpr const char* name      = "tcp";
+
+	TcpPair( std::size_t, tcp::Acceptor& acceptor )
+	{
+		a.connect( acceptor.getLocalEndpoint() );
+		b = acceptor.accept();
+	}
+
+	// a (the client) is destroyed first, so the active close (and TIME_WAIT) is on the client side
+	tcp::Socket b;
+	tcp::Socket a;
+};
+
+#ifdef MART_NETLIB_BENCH_WITH_UNIX_SOCKETS
+class UnixPair {
+public:
+	static constexpr bool        is_stream = false;
+	static constexpr const char* name      = "unix";
+
+	explicit UnixPair( std::size_t index )
+		: _path_a( make_path( index, 'a' ) )
+		, _path_b( make_path( index, 'b' ) )
+	{
+		const mart::nw::un::endpoint ep_a( std::string_view{ _path_a } );
+		const mart::nw::un::endpoint ep_b( std::string_view{ _path_b } );
+		a.bind( ep_a );
+		b.bind( ep_b );
+		a.connect( ep_b );
+		b.connect( ep_a );
+	}
+	~UnixPair()
+	{
+		a.close();
+		b.close();
+		::unlink( _path_a.c_str() );
+		::unlink( _path_b.c_str() );
+	}
+
+	mart::nw::un::Socket a;
+	mart::nw::un::Socket b;
+
+private:
+	static std::string make_path( std::size_t index, char side )
+	{
+		return "/tmp/mart-netlib-bench-" + std::to_string( ::getpid() ) + "-" + std::to_string( index ) + side;
+	}
+
+	std::string _path_a;
+	std::string _path_b;
+};
+#endif
+
+struct Context {
+	tcp::Acceptor*            acceptor = nullptr;
+	std::chrono::microseconds max_spin{ 0 }; // spin-then-block budget of all sockets (0: plain blocking recv)
+};
+
+template<class Pair>
+std::unique_ptr<Pair> make_pair( std::size_t index, Context& ctx )
+{
+	std::unique_ptr<Pair> pair;
+	if constexpr( Pair::is_stream ) {
+		pair = std::make_unique<Pair>( index, *ctx.acceptor );
+	} else {
+		pair = std::make_unique<Pair>( index );
+	}
+	pair->a.set_spin_then_block( ctx.max_spin );
+	pair->b.set_spin_then_block( ctx.max_spin );
+	return pair;
+}
+
+// receives exactly buffer.size() bytes from a stream (returns false, if the connection was closed)
+bool recv_exactly( tcp::Socket& socket, mart::MemoryView buffer )
+{
+	while( !buffer.empty() ) {
+		const auto rx = socket.recv( buffer );
+		if( rx.empty() ) { return false; }
+		buffer = buffer.subview( rx.size() );
+	}
+	return true;
+}
+
+template<class Socket>
+bool recv_message( Socket& socket, mart::MemoryView buffer )
+{
+	if constexpr( std::is_same_v<Socket, tcp::Socket> ) {
+		return recv_exactly( socket, buffer );
+	} else {
+		return socket.recv( buffer ).isValid();
+	}
+}
+
+struct RunResult {
+	mart::bench::Stats stats;
+	std::size_t        lost = 0;
+};
+
+template<class Pair>
+RunResult run_throughput( Context& ctx, std::size_t pair_count, std::size_t size, std::size_t messages )
+{
+	std::vector<std::unique_ptr<Pair>> pairs;
+	for( std::size_t i = 0; i < pair_count; ++i ) {
+		pairs.push_back( make_pair<Pair>( i, ctx ) );
+		if constexpr( !Pair::is_stream ) { pairs.back()->b.set_rx_timeout( 500ms ); }
+	}
+
+	std::vector<std::atomic<std::size_t>> received( pair_count );
+	std::vector<std::atomic<bool>>        receiver_done( pair_count );
+	std::vector<std::thread>              threads;
+
+	const auto start = bench_clock::now();
+	for( std::size_t p = 0; p < pair_count; ++p ) {
+		threads.emplace_back( [&, p] {
+			std::vector<mart::ByteType> buffer( Pair::is_stream ? 64 * 1024 : size );
+			if constexpr( Pair::is_stream ) {
+				// count bytes - the stream doesn't preserve message boundaries
+				std::size_t bytes = 0;
+				while( bytes < messages * size ) {
+					const auto rx = pairs[p]->b.recv( mart::view_elements_mutable( buffer ) );
+					if( rx.empty() ) { break; }
+					bytes += rx.size();
+					received[p].store( bytes / size, std::memory_order_relaxed );
+				}
+			} else {
+				for( std::size_t i = 0; i < messages; ++i ) {
+					if( !pairs[p]->b.recv( mart::view_elements_mutable( buffer ) ).isValid() ) { break; }
+					received[p].store( i + 1, std::memory_order_relaxed );
+				}
+			}
+			receiver_done[p] = true;
+		} );
+		threads.emplace_back( [&, p] {
+			const std::vector<mart::ByteType> msg( size );
+			const std::size_t window = std::clamp<std::size_t>( dgram_window_bytes / size, 1, dgram_window );
+			for( std::size_t i = 0; i < messages; ++i ) {
+				if constexpr( !Pair::is_stream ) {
+					while( i - received[p].load( std::memory_order_relaxed ) >= window && !receiver_done[p] ) {
+						std::this_thread::yield();
+					}
+				}
+				pairs[p]->a.send( mart::view_elements( msg ) );
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	const auto wall = bench_clock::now() - start;
+
+	std::size_t total = 0;
+	for( auto& r : received ) {
+		total += r.load();
+	}
+
+	RunResult                 res;
+	std::vector<std::int64_t> no_samples;
+	res.stats             = mart::bench::summarize( no_samples, total, wall );
+	res.stats.bytes_per_s = res.stats.ops_per_s * static_cast<double>( size );
+	res.lost              = pair_count * messages - total;
+	return res;
+}
+
+template<class Pair>
+RunResult run_latency( Context& ctx, std::size_t pair_count, std::size_t size, std::size_t round_trips )
+{
+	std::vector<std::unique_ptr<Pair>> pairs;
+	for( std::size_t i = 0; i < pair_count; ++i ) {
+		pairs.push_back( make_pair<Pair>( i, ctx ) );
+		if constexpr( !Pair::is_stream ) {
+			pairs.back()->a.set_rx_timeout( 500ms );
+			pairs.back()->b.set_rx_timeout( 500ms );
+		}
+	}
+
+	std::mutex                mutex;
+	std::vector<std::int64_t> samples;
+	samples.reserve( pair_count * round_trips );
+	std::atomic<std::size_t> completed{ 0 };
+	std::vector<std::thread> threads;
+
+	const auto start = bench_clock::now();
+	for( std::size_t p = 0; p < pair_count; ++p ) {
+		// echo
+		threads.emplace_back( [&, p] {
+			std::vector<mart::ByteType> buffer( size );
+			for( std::size_t i = 0; i < round_trips; ++i ) {
+				if( !recv_message( pairs[p]->b, mart::view_elements_mutable( buffer ) ) ) { return; }
+				pairs[p]->b.send( mart::view_elements( buffer ) );
+			}
+		} );
+		threads.emplace_back( [&, p] {
+			std::vector<mart::ByteType> msg( size );
+			std::vector<std::int64_t>   local_samples;
+			local_samples.reserve( round_trips );
+			for( std::size_t i = 0; i < round_trips; ++i ) {
+				const auto t0 = bench_clock::now();
+				pairs[p]->a.send( mart::view_elements( msg ) );
+				if( !recv_message( pairs[p]->a, mart::view_elements_mutable( msg ) ) ) { break; }
+				local_samples.push_back( ns_between( t0, bench_clock::now() ) );
+			}
+			completed.fetch_add( local_samples.size() );
+			std::lock_guard<std::mutex> lock( mutex );
+			samples.insert( samples.end(), local_samples.begin(), local_samples.end() );
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	const auto wall = bench_clock::now() - start;
+
+	RunResult res;
+	res.stats             = mart::bench::summarize( samples, completed.load(), wall );
+	res.stats.bytes_per_s = res.stats.ops_per_s * static_cast<double>( 2 * size );
+	res.lost              = pair_count * round_trips - completed.load();
+	return res;
+}
+
+template<class Pair>
+void run_transport( Context&                          ctx,
+					std::size_t                       max_pair_count,
+					std::size_t                       messages,
+					std::vector<mart::bench::Result>& results )
+{
+	// datagrams above 64k can't be sent over udp
+	for( const std::size_t size : { 16, 256, 1024, 8 * 1024, 32 * 1024 } ) {
+		for( std::size_t pair_count = 1; pair_count <= max_pair_count; pair_count *= 2 ) {
+			for( const bool latency : { false, true } ) {
+				// round trips are much slower than streaming
+				const std::size_t round_trips = std::max<std::size_t>( messages / 10, 1 );
+				const auto        res         = latency ? run_latency<Pair>( ctx, pair_count, size, round_trips )
+														: run_throughput<Pair>( ctx, pair_count, size, messages );
+
+				mart::bench::Result r;
+				r.params = { { "transport", Pair::name },
+							 { "mode", latency ? "latency" : "throughput" },
+							 { "size", std::to_string( size ) },
+							 { "pairs", std::to_string( pair_count ) },
+							 { "spin_us", std::to_string( ctx.max_spin.count() ) },
+							 { "lost", std::to_string( res.lost ) } };
+				r.stats  = res.stats;
+
+				std::cerr << Pair::name << ( latency ? " latency" : " throughput" ) << " size=" << size
+						  << " pairs=" << pair_count << ": " << r.stats.ops_per_s << " msgs/s, "
+						  << r.stats.bytes_per_s / 1e6 << " MB/s";
+				if( latency ) { std::cerr << ", p50=" << r.stats.p50_ns << "ns p99=" << r.stats.p99_ns << "ns"; }
+				std::cerr << ( res.lost ? ", lost=" + std::to_string( res.lost ) : std::string{} ) << "\n";
+				results.push_back( std::move( r ) );
+			}
+		}
+	}
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0] << " [--messages <per pair and run>] [--max-pairs <count>]"
+				  << " [--transport udp|tcp|unix] [--spin-us <max spin>] [--out <json file>]\n";
+		return 0;
+	}
+
+	const auto messages  = std::max( cmd.get( "--messages", std::size_t{ 100000 } ), std::size_t{ 1 } );
+	const auto max_count = std::clamp( cmd.get( "--max-pairs", std::size_t{ 4 } ), std::size_t{ 1 }, max_pairs );
+	const auto transport = cmd.get( "--transport", std::string{} );
+
+	tcp::Acceptor acceptor( tcp::endpoint( mart::nw::ip::address_local_host, mart::nw::ip::port_nr( tcp_port ) ),
+						   static_cast<int>( max_pairs ) );
+	Context ctx;
+	ctx.acceptor = &acceptor;
+	ctx.max_spin = std::chrono::microseconds( cmd.get( "--spin-us", std::size_t{ 0 } ) );
+
+	std::vector<mart::bench::Result> results;
+	if( transport.empty() || transport == "udp" ) { run_transport<UdpPair>( ctx, max_count, messages, results ); }
+	if( transport.empty() || transport == "tcp" ) { run_transport<TcpPair>( ctx, max_count, messages, results ); }
+#ifdef MART_NETLIB_BENCH_WITH_UNIX_SOCKETS
+	if( transport.empty() || transport == "unix" ) { run_transport<UnixPair>( ctx, max_count, messages, results ); }
+#endif
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-netlib-bench", results ) ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/**
+ * shm_ipc_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Compares the round trip latency of shm::Channel and unix domain datagram sockets
+ *
+ * Usage: mart-netlib-shm-ipc-bench [--round-trips <count>] [--size <message size>] [--busy-poll-us <duration>]
+ *                                  [--out <json file>]
+ *
+ * Two threads bounce a message back and forth (ping-pong). Each sample is one complete round trip.
+ * Transports: un::Socket (blocking recv), shm::Channel (sleeping on the futex right away) and shm::Channel
+ * with busy polling.
+ * NOTE: Busy polling only pays off, if both threads have a core of their own - on a single core, the
+ * spinning thread just delays the other one.
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/shm.hpp>
+#include <mart-netlib/unix.hpp>
+
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+
+using mart::bench::bench_clock;
+using mart::bench::ns_between;
+using namespace std::chrono_literals;
+namespace shm = mart::nw::shm;
+namespace un  = mart::nw::un;
+
+struct Config {
+	std::size_t               round_trips = 100000;
+	std::size_t               size        = 64;
+	std::chrono::microseconds busy_poll{ 50 };
+};
+
+mart::bench::Stats run_shm( const Config& config, std::chrono::nanoseconds busy_poll )
+{
+	shm::Channel ping_tx = shm::Channel::create_anonymous( 64 * 1024 );
+	shm::Channel ping_rx = shm::Channel::from_fd( ::dup( ping_tx.native_handle() ) );
+	shm::Channel pong_tx = shm::Channel::create_anonymous( 64 * 1024 );
+	shm::Channel pong_rx = shm::Channel::from_fd( ::dup( pong_tx.native_handle() ) );
+	ping_rx.set_busy_poll( busy_poll );
+	pong_rx.set_busy_poll( busy_poll );
+
+	std::thread echo( [&] {
+		std::vector<mart::ByteType> buffer( config.size );
+		for( std::size_t i = 0; i < config.round_trips; ++i ) {
+			const auto msg = ping_rx.recv( mart::view_elements_mutable( buffer ) );
+			pong_tx.send( msg );
+		}
+	} );
+
+	std::vector<mart::ByteType> msg( config.size );
+	std::vector<mart::ByteType> buffer( config.size );
+	std::vector<std::int64_t>   samples;
+	samples.reserve( config.round_trips );
+
+	const auto start = bench_clock::now();
+	for( std::size_t i = 0; i < config.round_trips; ++i ) {
+		const auto t0 = bench_clock::now();
+		ping_tx.send( mart::view_elements( msg ) );
+		(void)pong_rx.recv( mart::view_elements_mutable( buffer ) );
+		samples.push_back( ns_between( t0, bench_clock::now() ) );
+	}
+	const auto wall = bench_clock::now() - start;
+	echo.join();
+
+	return mart::bench::summarize( samples, config.round_trips, wall );
+}
+
+mart::bench::Stats run_unix( const Config& config )
+{
+	const auto         pid       = std::to_string( ::getpid() );
+	const std::string  ping_path = "/tmp/mart-netlib-shm-bench-ping-" + pid;
+	const std::string  pong_path = "/tmp/mart-netlib-shm-bench-pong-" + pid;
+	const un::endpoint ping_ep( std::string_view{ ping_path } );
+	const un::endpoint pong_ep( std::string_view{ pong_path } );
+
+	un::Socket ping;
+	ping.bind( ping_ep );
+	un::Socket pong;
+	pong.bind( pong_ep );
+
+	std::thread echo( [&] {
+		std::vector<mart::ByteType> buffer( config.size );
+		for( std::size_t i = 0; i < config.round_trips; ++i ) {
+			const auto msg = pong.recv( mart::view_elements_mutable( buffer ) );
+			pong.sendto( msg, ping_ep );
+		}
+	} );
+
+	std::vector<mart::ByteType> msg( config.size );
+	std::vector<mart::ByteType> buffer( config.size );
+	std::vector<std::int64_t>   samples;
+	samples.reserve( config.round_trips );
+
+	const auto start = bench_clock::now();
+	for( std::size_t i = 0; i < config.round_trips; ++i ) {
+		const auto t0 = bench_clock::now();
+		ping.sendto( mart::view_elements( msg ), pong_ep );
+		(void)ping.recv( mart::view_elements_mutable( buffer ) );
+		samples.push_back( ns_between( t0, bench_clock::now() ) );
+	}
+	const auto wall = bench_clock::now() - start;
+	echo.join();
+
+	::unlink( ping_path.c_str() );
+	::unlink( pong_path.c_str() );
+	return mart::bench::summarize( samples, config.round_trips, wall );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0] << " [--round-trips <count>] [--size <message size>]"
+				  << " [--busy-poll-us <duration>] [--out <json file>]\n";
+		return 0;
+	}
+
+	Config config;
+	config.round_trips = std::max( cmd.get( "--round-trips", config.round_trips ), std::size_t{ 1 } );
+	config.size        = std::max( cmd.get( "--size", config.size ), std::size_t{ 1 } );
+	config.busy_poll   = std::chrono::microseconds( cmd.get( "--busy-poll-us", std::size_t{ 50 } ) );
+
+	const auto size = std::to_string( config.size );
+
+	std::vector<mart::bench::Result> results;
+	const auto add = [&]( std::string transport, mart::bench::Stats stats ) {
+		std::cerr << transport << ": p50=" << stats.p50_ns << "ns p99=" << stats.p99_ns << "ns\n";
+		mart::bench::Result r;
+		r.params = { { "transport", std::move( transport ) }, { "size", size } };
+		r.stats  = stats;
+		results.push_back( std::move( r ) );
+	};
+
+	add( "unix_dgram", run_unix( config ) );
+	add( "shm_futex", run_shm( config, 0ns ) );
+	add( "shm_busy_poll", run_shm( config, config.busy_poll ) );
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-netlib-shm-ipc-bench", results ) ? 0 : 1;
+}
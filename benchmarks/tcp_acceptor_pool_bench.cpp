@@ -0,0 +1,108 @@
+/**
+ * tcp_acceptor_pool_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Measures the connection rate of tcp::AcceptorPool over loopback for an increasing number of workers
+ *
+ * Usage: mart-netlib-tcp-acceptor-pool-bench [--max-workers <count>] [--clients <count>] [--ms <per run>]
+ *                                            [--out <json file>]
+ *
+ * For 1, 2, 4, ... up to max-workers workers, <clients> threads repeatedly connect to the pool and immediately
+ * close the connection again. Throughput (ops_per_s) is the number of connections accepted per second.
+ * The clients close first, so the TIME_WAIT state ends up on the client side, where linux reuses it for new
+ * loopback connections (net.ipv4.tcp_tw_reuse = 2, the default) - otherwise, long runs exhaust the ephemeral ports.
+ * NOTE: The clients need cpu time too - on loopback, the rate only scales as long as there are idle cores left.
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/tcp_acceptor_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using mart::bench::bench_clock;
+namespace tcp = mart::nw::ip::tcp;
+
+std::uint64_t run( std::size_t workers, std::size_t clients, std::chrono::milliseconds duration )
+{
+	tcp::AcceptorPool::Config config;
+	config.local        = tcp::endpoint{ "127.0.0.1:3566" };
+	config.worker_count = workers;
+	config.backlog      = 1024;
+	config.socket_mode  = tcp::Acceptor::SocketMode::NonBlocking;
+
+	// the connection is closed right away - we only measure the accept path
+	tcp::AcceptorPool pool( config, []( std::size_t, tcp::Socket ) {} );
+
+	std::atomic<bool>        stop{ false };
+	std::vector<std::thread> threads;
+	for( std::size_t i = 0; i < clients; ++i ) {
+		threads.emplace_back( [&] {
+			while( !stop.load( std::memory_order_relaxed ) ) {
+				tcp::Socket sock;
+				(void)sock.try_connect( pool.local_endpoint() );
+			}
+		} );
+	}
+
+	// skip the startup phase
+	std::this_thread::sleep_for( 100ms );
+	const auto start_cnt = pool.accepted();
+	const auto start     = bench_clock::now();
+	std::this_thread::sleep_for( duration );
+	const auto cnt  = pool.accepted() - start_cnt;
+	const auto wall = bench_clock::now() - start;
+
+	stop = true;
+	for( auto& t : threads ) {
+		t.join();
+	}
+	pool.stop();
+	return static_cast<std::uint64_t>( static_cast<double>( cnt ) / std::chrono::duration<double>( wall ).count() );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0] << " [--max-workers <count>] [--clients <count>] [--ms <per run>]"
+				  << " [--out <json file>]\n";
+		return 0;
+	}
+
+	const std::size_t cpus        = std::max( std::thread::hardware_concurrency(), 1u );
+	const auto        max_workers = std::max( cmd.get( "--max-workers", cpus ), std::size_t{ 1 } );
+	const auto        clients     = std::max( cmd.get( "--clients", std::size_t{ 8 } ), std::size_t{ 1 } );
+	const auto        duration    = std::chrono::milliseconds( cmd.get( "--ms", std::size_t{ 2000 } ) );
+
+	std::vector<mart::bench::Result> results;
+	for( std::size_t workers = 1; workers <= max_workers; workers *= 2 ) {
+		const auto cps = run( workers, clients, duration );
+
+		mart::bench::Result r;
+		r.params          = { { "workers", std::to_string( workers ) }, { "clients", std::to_string( clients ) } };
+		r.stats.ops       = static_cast<std::size_t>( cps * duration.count() / 1000 );
+		r.stats.ops_per_s = static_cast<double>( cps );
+		r.stats.ns_per_op = cps == 0 ? 0 : 1e9 / static_cast<double>( cps );
+		results.push_back( std::move( r ) );
+
+		std::cerr << "workers=" << workers << ": " << cps << " connections/s\n";
+	}
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-netlib-tcp-acceptor-pool-bench", results )
+			   ? 0
+			   : 1;
+}
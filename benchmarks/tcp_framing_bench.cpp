@@ -0,0 +1,145 @@
+/**
+ * tcp_framing_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Compares length prefixed messages over tcp with and without FramedReader / FramedWriter
+ *
+ * Usage: mart-netlib-tcp-framing-bench [--messages <count>] [--out <json file>]
+ *
+ * For different payload sizes, a sender thread transmits <messages> frames over loopback, which are received
+ * and checked by the main thread. Throughput (ops_per_s) is in frames per second.
+ * - naive: one send for header and payload of each frame (gather write) and two recv calls per frame
+ *          (header, then payload)
+ * - framed: tcp::FramedWriter / tcp::FramedReader
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/tcp_framing.hpp>
+
+#include <cstring>
+#include <thread>
+
+namespace {
+
+using mart::bench::bench_clock;
+namespace tcp = mart::nw::ip::tcp;
+
+const tcp::endpoint server_ep{ "127.0.0.1:3567" };
+
+// client is destroyed first, so TIME_WAIT doesn't end up on the server port
+struct Connection {
+	tcp::Socket server;
+	tcp::Socket client;
+};
+
+Connection connect( tcp::Acceptor& acceptor )
+{
+	Connection con;
+	con.client.connect( server_ep );
+	con.server = acceptor.accept();
+	return con;
+}
+
+void recv_exactly( tcp::Socket& socket, mart::MemoryView buffer )
+{
+	while( !buffer.empty() ) {
+		const auto rx = socket.recv( buffer );
+		if( rx.empty() ) { throw std::runtime_error( "Connection closed unexpectedly" ); }
+		buffer = buffer.subview( rx.size() );
+	}
+}
+
+mart::bench::Stats run_naive( tcp::Acceptor& acceptor, std::size_t size, std::size_t messages )
+{
+	auto                        con = connect( acceptor );
+	std::vector<mart::ByteType> payload( size );
+
+	std::thread sender( [&] {
+		const auto                  header = mart::nw::to_net_order( static_cast<std::uint32_t>( size ) );
+		const mart::ConstMemoryView parts[] = { mart::view_bytes( header ), mart::view_elements( payload ) };
+		for( std::size_t i = 0; i < messages; ++i ) {
+			con.client.send( mart::ArrayView<const mart::ConstMemoryView>( parts ) );
+		}
+	} );
+
+	std::vector<mart::ByteType> buffer( size );
+	std::size_t                 bytes = 0;
+
+	const auto start = bench_clock::now();
+	for( std::size_t i = 0; i < messages; ++i ) {
+		mart::nw::uint32_net_t header{};
+		recv_exactly( con.server, mart::view_bytes_mutable( header ) );
+		const auto frame_size = mart::nw::to_host_order( header );
+		recv_exactly( con.server, mart::view_elements_mutable( buffer ).subview( 0, frame_size ) );
+		bytes += frame_size;
+	}
+	const auto wall = bench_clock::now() - start;
+	sender.join();
+
+	std::vector<std::int64_t> no_samples;
+	return mart::bench::summarize( no_samples, bytes == size * messages ? messages : 0, wall );
+}
+
+mart::bench::Stats run_framed( tcp::Acceptor& acceptor, std::size_t size, std::size_t messages )
+{
+	auto                        con = connect( acceptor );
+	std::vector<mart::ByteType> payload( size );
+
+	std::thread sender( [&] {
+		tcp::FramedWriter writer( con.client );
+		for( std::size_t i = 0; i < messages; ++i ) {
+			writer.write( mart::view_elements( payload ) );
+		}
+		writer.flush();
+	} );
+
+	tcp::FramedReader reader( con.server );
+	std::size_t       bytes = 0;
+
+	const auto start = bench_clock::now();
+	for( std::size_t i = 0; i < messages; ++i ) {
+		const auto frame = reader.read();
+		if( !frame ) { throw std::runtime_error( "Connection closed unexpectedly" ); }
+		bytes += frame->size();
+	}
+	const auto wall = bench_clock::now() - start;
+	sender.join();
+
+	std::vector<std::int64_t> no_samples;
+	return mart::bench::summarize( no_samples, bytes == size * messages ? messages : 0, wall );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0] << " [--messages <count>] [--out <json file>]\n";
+		return 0;
+	}
+	const auto messages = std::max( cmd.get( "--messages", std::size_t{ 200000 } ), std::size_t{ 1 } );
+
+	tcp::Acceptor acceptor( server_ep );
+
+	std::vector<mart::bench::Result> results;
+	for( const std::size_t size : { 16, 64, 256, 1024, 16 * 1024 } ) {
+		for( const bool framed : { false, true } ) {
+			mart::bench::Result r;
+			r.params = { { "mode", framed ? "framed" : "naive" }, { "payload_size", std::to_string( size ) } };
+			r.stats  = framed ? run_framed( acceptor, size, messages ) : run_naive( acceptor, size, messages );
+			std::cerr << r.params[0].second << " size=" << size << ": " << r.stats.ops_per_s << " frames/s\n";
+			results.push_back( std::move( r ) );
+		}
+	}
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-netlib-tcp-framing-bench", results ) ? 0
+																												 : 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * tcp_zerocopy_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Compares the cpu cost of tcp::Socket::send with send_zerocopy (MSG_ZEROCOPY) over loopback
+ *
+ * Usage: mart-netlib-tcp-zerocopy-bench [--megabytes <per run>] [--buffers <count>] [--out <json file>]
+ *
+ * For every chunk size, the sender streams the given amount of data to a receiver thread, cycling through
+ * <buffers> send buffers. In zerocopy mode, a buffer is only reused after its completion notification arrived.
+ * Besides throughput and send call latencies, the cpu time of the sending thread per GB is reported ("cpu_ms_per_gb").
+ * NOTE: Over loopback the kernel has to copy the data on the receive path anyway ("copied" counts the affected
+ * send calls), so the difference to a real nic is mostly the saved copy on the sending side.
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/tcp.hpp>
+
+#include <ctime>
+#include <thread>
+
+namespace {
+
+using mart::bench::bench_clock;
+using mart::nw::ip::tcp::endpoint;
+
+enum class Mode { Copy, Zerocopy };
+
+std::string_view to_string_view( Mode mode )
+{
+	switch( mode ) {
+		case Mode::Copy: return "copy";
+		case Mode::Zerocopy: return "zerocopy";
+	}
+	return "unknown";
+}
+
+// cpu time consumed by the calling thread
+std::int64_t thread_cpu_ns()
+{
+#if defined( CLOCK_THREAD_CPUTIME_ID )
+	timespec ts{};
+	clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+	return static_cast<std::int64_t>( ts.tv_sec ) * 1'000'000'000 + ts.tv_nsec;
+#else
+	// whole process - includes the receiver
+	return static_cast<std::int64_t>( std::clock() ) * ( 1'000'000'000 / CLOCKS_PER_SEC );
+#endif
+}
+
+struct RunResult {
+	mart::bench::Stats stats;
+	double             cpu_ms_per_gb = 0;
+	double             gb_per_s      = 0;
+	std::size_t        copied        = 0;
+	bool               zerocopy      = false;
+};
+
+RunResult run( Mode mode, std::size_t chunk_size, std::size_t total_bytes, std::size_t buffer_count )
+{
+	const endpoint                server_ep{ "127.0.0.1:3564" };
+	mart::nw::ip::tcp::Acceptor acceptor( server_ep );
+
+	std::thread receiver( [&] {
+		auto                        con = acceptor.accept( std::chrono::seconds( 5 ) );
+		std::vector<mart::ByteType> storage( 1024 * 1024 );
+		const mart::MemoryView      buffer( storage.data(), storage.size() );
+		// read until the sender closes the connection, such that the listening port doesn't end up in TIME_WAIT
+		for( auto data = con.recv( buffer ); data.isValid() && data.size() != 0; data = con.recv( buffer ) ) {
+		}
+	} );
+
+	auto tx = mart::nw::ip::tcp::connect( server_ep );
+
+	RunResult res;
+	if( mode == Mode::Zerocopy ) { res.zerocopy = tx.try_enable_zerocopy(); }
+
+	std::vector<std::vector<mart::ByteType>> buffers(
+		buffer_count, std::vector<mart::ByteType>( chunk_size, mart::ByteType{ 0x5a } ) );
+	std::vector<mart::nw::ip::tcp::Socket::ZerocopyId> ids( buffer_count );
+
+	const std::size_t         chunks = total_bytes / chunk_size;
+	std::vector<std::int64_t> samples;
+	samples.reserve( chunks );
+
+	const auto start     = bench_clock::now();
+	const auto cpu_start = thread_cpu_ns();
+	for( std::size_t i = 0; i < chunks; ++i ) {
+		const std::size_t          slot = i % buffer_count;
+		const mart::ConstMemoryView data( buffers[slot].data(), chunk_size );
+
+		const auto call_start = bench_clock::now();
+		if( mode == Mode::Copy ) {
+			tx.send( data );
+		} else {
+			// the buffer is still in use by the kernel
+			if( !tx.zerocopy_completed( ids[slot] ) ) { tx.wait_zerocopy_completion( ids[slot] ); }
+			ids[slot] = tx.send_zerocopy( data );
+			res.copied += tx.reap_zerocopy_completions().copied;
+		}
+		samples.push_back( mart::bench::ns_between( call_start, bench_clock::now() ) );
+	}
+	while( tx.zerocopy_pending() != 0 ) {
+		res.copied += tx.reap_zerocopy_completions( std::chrono::milliseconds( 100 ) ).copied;
+	}
+	const auto cpu_ns = thread_cpu_ns() - cpu_start;
+	tx.close();
+	receiver.join();
+	const auto wall = bench_clock::now() - start;
+
+	const double gb   = static_cast<double>( chunks * chunk_size ) / 1e9;
+	res.stats         = mart::bench::summarize(
+		samples, chunks, std::chrono::duration_cast<std::chrono::nanoseconds>( wall ) );
+	res.cpu_ms_per_gb = static_cast<double>( cpu_ns ) / 1e6 / gb;
+	res.gb_per_s      = gb / std::chrono::duration<double>( wall ).count();
+	return res;
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0] << " [--megabytes <per run>] [--buffers <count>] [--out <json file>]\n";
+		return 0;
+	}
+
+	const auto total_bytes = cmd.get( "--megabytes", std::size_t{ 2048 } ) * 1024 * 1024;
+	const auto buffers     = std::max( cmd.get( "--buffers", std::size_t{ 8 } ), std::size_t{ 1 } );
+
+	std::vector<mart::bench::Result> results;
+	for( std::size_t size : { 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 } ) {
+		for( Mode mode : { Mode::Copy, Mode::Zerocopy } ) {
+			const auto res = run( mode, size, total_bytes, buffers );
+
+			mart::bench::Result r;
+			r.params = { { "mode", std::string( to_string_view( mode ) ) },
+						 { "chunk_size", std::to_string( size ) },
+						 { "zerocopy_enabled", res.zerocopy ? "true" : "false" },
+						 { "copied", std::to_string( res.copied ) },
+						 { "gb_per_s", std::to_string( res.gb_per_s ) },
+						 { "cpu_ms_per_gb", std::to_string( res.cpu_ms_per_gb ) } };
+			r.stats  = res.stats;
+			results.push_back( std::move( r ) );
+
+			std::cerr << to_string_view( mode ) << " chunk=" << size << ": " << res.gb_per_s << " GB/s, "
+					  << res.cpu_ms_per_gb << " ms cpu/GB (copied " << res.copied << ")\n";
+		}
+	}
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-netlib-tcp-zerocopy-bench", results ) ? 0
+																												  : 1;
+}
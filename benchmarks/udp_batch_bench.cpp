@@ -0,0 +1,177 @@
+/**
+ * udp_batch_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Compares udp throughput over loopback of single datagram send/recv with batched and segmented send/recv
+ *
+ * Usage: mart-netlib-udp-batch-bench [--messages <count>] [--batch <datagrams per call>] [--window <datagrams>]
+ *                                    [--out <json file>]
+ *
+ * For every datagram size, a sender thread pushes the given number of datagrams to a receiver thread,
+ * either one sendto/recvfrom per datagram ("single"), with send_batch/recv_batch ("batch")
+ * or with send_segmented/recv_coalesced ("segmented": udp segmentation offload and GRO, if supported by the kernel).
+ * Throughput (ops_per_s) is the number of received datagrams per second, latency percentiles
+ * are taken from the individual send calls (one call per datagram or per batch respectively).
+ * To avoid measuring mostly drops, the sender never has more than <window> datagrams in flight
+ * (which should fit into the default socket receive buffer). Datagrams dropped anyway are reported as "lost".
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/udp.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using mart::bench::bench_clock;
+using mart::nw::ip::udp::endpoint;
+
+enum class Mode { Single, Batch, Segmented };
+
+std::string_view to_string_view( Mode mode )
+{
+	switch( mode ) {
+		case Mode::Single: return "single";
+		case Mode::Batch: return "batch";
+		case Mode::Segmented: return "segmented";
+	}
+	return "unknown";
+}
+
+struct RunResult {
+	mart::bench::Stats stats;
+	std::size_t        lost = 0;
+};
+
+void receive_all( mart::nw::ip::udp::Socket& rx,
+				  Mode                       mode,
+				  std::size_t                datagram_size,
+				  std::size_t                messages,
+				  std::atomic<std::size_t>&  received )
+{
+	const std::size_t batch = mode == Mode::Batch ? mart::nw::ip::udp::Socket::max_recv_batch_size : 1;
+	// coalesced datagrams need space for up to 64k
+	const std::size_t buffer_size = mode == Mode::Segmented ? 64 * 1024 : datagram_size;
+
+	std::vector<mart::ByteType>                            storage( batch * buffer_size );
+	std::vector<mart::MemoryView>                          buffers;
+	std::vector<mart::nw::ip::udp::Socket::RecvfromResult> results( batch );
+	for( std::size_t i = 0; i < batch; ++i ) {
+		buffers.push_back( mart::MemoryView( storage.data() + i * buffer_size, buffer_size ) );
+	}
+
+	while( received.load( std::memory_order_relaxed ) < messages ) {
+		std::size_t cnt = 0;
+		switch( mode ) {
+			case Mode::Single: cnt = rx.try_recvfrom( buffers[0] ).data.isValid() ? 1 : 0; break;
+			case Mode::Batch: cnt = rx.recv_batch( buffers, results ); break;
+			case Mode::Segmented: cnt = rx.recv_coalesced( buffers[0] ).segment_count(); break;
+		}
+		// timeout: the remaining datagrams were dropped
+		if( cnt == 0 ) { break; }
+		received.fetch_add( cnt, std::memory_order_release );
+	}
+}
+
+RunResult run( Mode mode, std::size_t datagram_size, std::size_t messages, std::size_t batch, std::size_t window )
+{
+	const endpoint rx_ep{ "127.0.0.1:3563" };
+
+	mart::nw::ip::udp::Socket rx;
+	mart::nw::ip::udp::Socket tx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 200ms );
+	if( mode == Mode::Segmented ) { rx.try_enable_gro(); }
+
+	std::vector<mart::ByteType>        payload( datagram_size, mart::ByteType{ 0x5a } );
+	std::vector<mart::ConstMemoryView> data( batch, mart::ConstMemoryView( payload.data(), payload.size() ) );
+	std::vector<endpoint>              eps( batch, rx_ep );
+
+	std::vector<mart::ByteType> segmented_payload( batch * datagram_size, mart::ByteType{ 0x5a } );
+
+	std::vector<std::int64_t> samples;
+	samples.reserve( mode == Mode::Single ? messages : messages / batch + 1 );
+
+	std::atomic<std::size_t> received{ 0 };
+	const auto               start = bench_clock::now();
+
+	std::thread receiver( [&] { receive_all( rx, mode, datagram_size, messages, received ); } );
+
+	std::size_t sent = 0;
+	while( sent < messages ) {
+		const std::size_t next = mode == Mode::Single ? 1 : std::min( batch, messages - sent );
+		while( sent + next - received.load( std::memory_order_acquire ) > window ) {
+			std::this_thread::yield();
+		}
+
+		const auto call_start = bench_clock::now();
+		switch( mode ) {
+			case Mode::Single: tx.sendto( data[0], rx_ep ); break;
+			case Mode::Batch:
+				tx.send_batch( mart::ArrayView<const mart::ConstMemoryView>( data.data(), next ),
+							   mart::ArrayView<const endpoint>( eps.data(), next ) );
+				break;
+			case Mode::Segmented:
+				tx.send_segmented(
+					mart::ConstMemoryView( segmented_payload.data(), next * datagram_size ), datagram_size, rx_ep );
+				break;
+		}
+		sent += next;
+		samples.push_back( mart::bench::ns_between( call_start, bench_clock::now() ) );
+	}
+	receiver.join();
+	auto wall = bench_clock::now() - start;
+	// don't count the final timeout, if datagrams got lost
+	const std::size_t total = received.load();
+	if( total < messages ) { wall -= 200ms; }
+
+	RunResult res;
+	res.stats = mart::bench::summarize( samples, total, std::chrono::duration_cast<std::chrono::nanoseconds>( wall ) );
+	res.lost  = messages - total;
+	return res;
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0]
+				  << " [--messages <count>] [--batch <datagrams per call>] [--window <datagrams>] [--out <json file>]\n";
+		return 0;
+	}
+
+	const auto messages = cmd.get( "--messages", std::size_t{ 200'000 } );
+	const auto batch    = std::max( cmd.get( "--batch", std::size_t{ 32 } ), std::size_t{ 1 } );
+	const auto window   = std::max( cmd.get( "--window", std::size_t{ 64 } ), batch );
+
+	std::vector<mart::bench::Result> results;
+	for( std::size_t size : { 64, 512, 1400 } ) {
+		for( Mode mode : { Mode::Single, Mode::Batch, Mode::Segmented } ) {
+			const auto res = run( mode, size, messages, batch, window );
+
+			mart::bench::Result r;
+			r.params = { { "mode", std::string( to_string_view( mode ) ) },
+						 { "size", std::to_string( size ) },
+						 { "batch", std::to_string( mode == Mode::Single ? 1 : batch ) },
+						 { "lost", std::to_string( res.lost ) } };
+			r.stats  = res.stats;
+			results.push_back( std::move( r ) );
+
+			std::cerr << to_string_view( mode ) << " size=" << size << ": " << static_cast<std::size_t>( res.stats.ops_per_s )
+					  << " pps (lost " << res.lost << ")\n";
+		}
+	}
+
+	return mart::bench::write_json( cmd.get( "--out", std::string{} ), "mart-netlib-udp-batch-bench", results ) ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/**
+ * udp_sharded_server_bench.cpp (mart-common/benchmarks)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Measures how udp::ShardedServer's receive rate scales with the number of shards over loopback
+ *
+ * Usage: mart-netlib-udp-sharded-server-bench [--max-shards <count>] [--senders <count>] [--ms <per run>]
+ *                                             [--size <datagram size>] [--out <json file>]
+ *
+ * For 1, 2, 4, ... up to max-shards shards, <senders> threads (each with its own socket, so the kernel
+ * can spread them over the shards) blast datagrams with send_batch at the server for the given time.
+ * Throughput (ops_per_s) is the number of datagrams processed by the server per second - datagrams
+ * dropped because the shards couldn't keep up are not counted.
+ * NOTE: The senders need cpu time too - on loopback, the rate only scales as long as there are idle cores left.
+ */
+
+#include "bench_common.hpp"
+
+#include <mart-netlib/udp_sharded_server.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using mart::bench::bench_clock;
+using mart::nw::ip::udp::endpoint;
+
+std::uint64_t
+run( std::size_t shards, std::size_t senders, std::size_t datagram_size, std::chrono::milliseconds duration )
+{
+	mart::nw::ip::udp::ShardedServer::Config config;
+	config.local          = endpoint{ "127.0.0.1:3565" };
+	config.shard_count    = shards;
+	config.rx_buffer_size = 4 * 1024 * 1024;
+
+	std::atomic<std::uint64_t> checksum{ 0 };
+
+	mart::nw::ip::udp::ShardedServer server(
+		config, [&]( std::size_t, mart::nw::ip::udp::Socket&, const auto& datagram ) {
+			// touch the data, like a real handler would
+			if( datagram.data.size() != 0 && datagram.data[0] == mart::ByteType{ 0 } ) {
+				checksum.fetch_add( 1, std::memory_order_relaxed );
+			}
+		} );
+
+	std::atomic<bool>        stop{ false };
+	std::vector<std::thread> threads;
+	for( std::size_t i = 0; i < senders; ++i ) {
+		threads.emplace_back( [&] {
+			mart::nw::ip::udp::Socket          tx;
+			std::vector<mart::ByteType>        payload( datagram_size, mart::ByteType{ 0x5a } );
+			std::vector<mart::ConstMemoryView> data( 32, mart::ConstMemoryView( payload.data(), payload.size() ) );
+			std::vector<endpoint>              eps( 32, server.local_endpoint() );
+			while( !stop.load( std::memory_order_relaxed ) ) {
+				// the receive buffer may be full - that's expected
+				(void)tx.try_send_batch( data, eps );
+			}
+		} );
+	}
+
+	// skip the startup phase
+	std::this_thread::sleep_for( 100ms );
+	const auto start_cnt = server.received();
+	const auto start     = bench_clock::now();
+	std::this_thread::sleep_for( duration );
+	const auto cnt  = server.received() - start_cnt;
+	const auto wall = bench_clock::now() - start;
+
+	stop = true;
+	for( auto& t : threads ) {
+		t.join();
+	}
+	server.stop();
+	return static_cast<std::uint64_t>( static_cast<double>( cnt ) / std::chrono::duration<double>( wall ).count() );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const mart::bench::CmdLine cmd( argc, argv );
+	if( cmd.has( "--help" ) ) {
+		std::cout << "Usage: " << argv[0]
+				  << " [--max-shards <count>] [--senders <count>] [--ms <per run>] [--size <datagram size>]"
+					 " [--out <json file>]\n";
+		return 0;
+	}
+
+	const std::size_t cpus       = std::max( std::thread::hardware_concurrency(), 1u );
+	const auto        max_shards = std::max( cmd.get( "--max-shards", cpus ), std::size_t{ 1 } );
+	const auto        senders    = std::max( cmd.get( "--senders", std::size_t{ 8 } ), std::size_t{ 1 } );
+	const auto        duration   = std::chrono::milliseconds( cmd.get( "--ms", std::size_t{ 2000 } ) );
+	const auto        size       = cmd.get( "--size", std::size_t{ 64 } );
+
+	std::vector<mart::bench::Result> results;
+	for( std::size_t shards = 1; shards <= max_shards; shards *= 2 ) {
+		const auto pps = run( shards, senders, size, duration );
+
+		mart::bench::Result r;
+		r.params          = { { "shards", std::to_string( shards ) },
+							  { "senders", std::to_string( senders ) },
+							  { "size", std::to_string( size ) } };
+		r.stats.ops       = static_cast<std::size_t>( pps * duration.count() / 1000 );
+		r.stats.ops_per_s = static_cast<double>( pps );
+		r.stats.ns_per_op = pps == 0 ? 0 : 1e9 / static_cast<double>( pps );
+		results.push_back( std::move( r ) );
+
+		std::cerr << "shards=" << shards << ": " << pps << " pps\n";
+	}
+
+	return mart::bench::write_json(
+			   cmd.get( "--out", std::string{} ), "mart-netlib-udp-sharded-server-bench", results )
+			   ? 0
+			   : 1;
+}
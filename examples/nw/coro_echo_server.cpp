@@ -0,0 +1,64 @@
+#include <mart-netlib/coro.hpp>
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <iostream>
+
+namespace coro = mart::nw::coro;
+namespace tcp  = mart::nw::ip::tcp;
+namespace udp  = mart::nw::ip::udp;
+using namespace std::chrono_literals;
+
+coro::Task<> serve_connection( tcp::Socket con )
+{
+	std::cout << "New connection from " << con.get_remote_endpoint().toString() << std::endl;
+	char buffer[1024];
+	while( true ) {
+		auto data = co_await con.async_recv( mart::view_bytes_mutable( buffer ) );
+		if( data.empty() ) { break; } // orderly shutdown by peer
+		co_await con.async_send( data );
+	}
+	std::cout << "Connection from " << con.get_remote_endpoint().toString() << " closed" << std::endl;
+}
+
+coro::Task<> accept_connections( coro::Scheduler& scheduler, tcp::Acceptor& acceptor )
+{
+	while( true ) {
+		scheduler.spawn( serve_connection( co_await acceptor.async_accept() ) );
+	}
+}
+
+coro::Task<> serve_udp( udp::Socket& sock )
+{
+	char buffer[1024];
+	while( true ) {
+		auto res = co_await sock.async_recvfrom( mart::view_bytes_mutable( buffer ) );
+		sock.try_sendto( res.data, res.remote_address );
+	}
+}
+
+coro::Task<> print_statistics( coro::Scheduler& scheduler )
+{
+	while( true ) {
+		co_await scheduler.sleep_for( 10s );
+		std::cout << scheduler.task_count() - 3 << " open connections" << std::endl;
+	}
+}
+
+// Same as reactor_echo_server, but written with coroutines: serves a tcp echo service and an udp echo service
+// from a single thread
+int main()
+{
+	coro::Scheduler scheduler;
+
+	tcp::Acceptor acceptor( tcp::endpoint{ "127.0.0.1:3435" } );
+	udp::Socket   udp_sock;
+	udp_sock.bind( udp::endpoint{ "127.0.0.1:3435" } );
+
+	scheduler.spawn( accept_connections( scheduler, acceptor ) );
+	scheduler.spawn( serve_udp( udp_sock ) );
+	scheduler.spawn( print_statistics( scheduler ) );
+
+	std::cout << "Echo server listening on tcp and udp port 3435" << std::endl;
+	scheduler.run();
+}
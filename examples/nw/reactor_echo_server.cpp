@@ -0,0 +1,65 @@
+#include <mart-netlib/reactor.hpp>
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace tcp = mart::nw::ip::tcp;
+namespace udp = mart::nw::ip::udp;
+using namespace std::chrono_literals;
+
+// Serves a tcp echo service and an udp echo service from a single thread
+int main()
+{
+	mart::nw::Reactor reactor;
+
+	tcp::Acceptor acceptor( tcp::endpoint{ "127.0.0.1:3435" } );
+	udp::Socket   udp_sock;
+	udp_sock.bind( udp::endpoint{ "127.0.0.1:3435" } );
+
+	std::map<mart::nw::socks::port_layer::handle_t, std::unique_ptr<tcp::Socket>> connections;
+
+	std::vector<tcp::Socket> accepted;
+	reactor.add( acceptor, [&]( mart::nw::Events ) {
+		// the new sockets are created in non-blocking mode, as required by the reactor
+		accepted.clear();
+		const auto res = acceptor.accept_all( accepted, tcp::Acceptor::SocketMode::NonBlocking );
+		if( !res.error.success() && !res.drained() ) {
+			// e.g. out of file descriptors - the pending connections stay in the backlog
+			std::cerr << "Failed to accept connection: " << mart::nw::socks::to_text_rep( res.error ) << std::endl;
+		}
+
+		for( auto& sock : accepted ) {
+			std::cout << "New connection from " << sock.get_remote_endpoint().toString() << std::endl;
+			auto  handle = sock.get_raw_socket_handle();
+			auto& con    = *connections.emplace( handle, std::make_unique<tcp::Socket>( std::move( sock ) ) )
+							 .first->second;
+
+			reactor.add( con, mart::nw::Interest::Read, [&, handle]( mart::nw::Events ev ) {
+				char buffer[1024];
+				auto data = con.recv( mart::view_bytes_mutable( buffer ) );
+				if( data.isValid() && data.size() != 0 ) {
+					con.send( data );
+				} else if( ev.hangup || data.isValid() ) {
+					// orderly shutdown by peer
+					reactor.remove( con );
+					connections.erase( handle );
+				}
+			} );
+		}
+	} );
+
+	reactor.add( udp_sock, mart::nw::Interest::Read, [&]( mart::nw::Events ) {
+		char buffer[1024];
+		auto res = udp_sock.try_recvfrom( mart::view_bytes_mutable( buffer ) );
+		if( res.data.isValid() ) { udp_sock.try_sendto( res.data, res.remote_address ); }
+	} );
+
+	reactor.add_periodic_timer( 10s, [&] { std::cout << connections.size() << " open connections" << std::endl; } );
+
+	std::cout << "Echo server listening on tcp and udp port 3435" << std::endl;
+	reactor.run();
+}
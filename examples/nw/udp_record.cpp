@@ -0,0 +1,79 @@
+#include <mart-netlib/udp_capture.hpp>
+
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace udp = mart::nw::ip::udp;
+using namespace std::chrono_literals;
+
+namespace {
+std::atomic<bool> stop{ false };
+
+extern "C" void on_signal( int )
+{
+	stop = true;
+}
+} // namespace
+
+// Appends all datagrams that arrive at <listen endpoint> with receive time and source to a capture file
+// (see udp_capture.hpp), until ctrl+c or - if given - <seconds> have passed. Replay with udp_replay.
+int main( int argc, char** argv )
+{
+	if( argc < 3 ) {
+		std::cerr << "Usage: " << argv[0] << " <listen endpoint (e.g. 127.0.0.1:3435)> <file> [<seconds>]\n";
+		return 1;
+	}
+	const udp::endpoint local_ep( std::string_view{ argv[1] } );
+	const std::string   file_name = argv[2];
+	const auto          end       = argc > 3 ? std::chrono::steady_clock::now() + std::stoi( argv[3] ) * 1s
+											 : std::chrono::steady_clock::time_point::max();
+
+	std::signal( SIGINT, on_signal );
+
+	udp::Socket sock;
+	sock.bind( local_ep );
+	// short timeout, so we regularly check for the end of the recording
+	sock.set_rx_timeout( 100ms );
+	// absorb bursts, while we are busy writing to the file
+	sock.as_raii_socket().setsockopt(
+		mart::nw::socks::SocketOptionLevel::Socket, mart::nw::socks::SocketOption::so_rcvbuf, 8 * 1024 * 1024 );
+	// let the kernel timestamp each datagram on arrival - taking the time after recv_batch returned would give all
+	// datagrams of a batch the same time and lose the inter-arrival times udp_replay reproduces
+	if( !sock.try_enable_rx_timestamps() ) {
+		std::cerr << "Kernel rx timestamps are not supported - using the time of reception instead\n";
+	}
+
+	udp::CaptureWriter writer( file_name );
+
+	// receive as many datagrams per syscall as possible
+	constexpr std::size_t                               batch_size = udp::Socket::max_recv_batch_size;
+	std::vector<mart::ByteType>                         storage( batch_size * udp::capture_max_payload_size );
+	std::array<mart::MemoryView, batch_size>            buffers;
+	std::array<udp::Socket::RecvfromResult, batch_size> results;
+	for( std::size_t i = 0; i < batch_size; ++i ) {
+		buffers[i] = mart::view_elements_mutable( storage ).subview( i * udp::capture_max_payload_size,
+																	 udp::capture_max_payload_size );
+	}
+
+	std::cout << "Recording datagrams sent to " << local_ep.toStringEx() << " into " << file_name << std::endl;
+
+	std::uint64_t bytes = 0;
+	while( !stop && std::chrono::steady_clock::now() < end ) {
+		const std::size_t cnt = sock.recv_batch( buffers, results );
+		const auto        now = std::chrono::system_clock::now();
+		for( std::size_t i = 0; i < cnt; ++i ) {
+			const auto rx_time = results[i].rx_timestamp != std::chrono::system_clock::time_point{}
+									 ? results[i].rx_timestamp
+									 : now;
+			writer.write( rx_time, results[i].remote_address, results[i].data );
+			bytes += results[i].data.size();
+		}
+	}
+	writer.flush();
+
+	std::cout << "Recorded " << writer.record_count() << " datagrams (" << bytes << " bytes)" << std::endl;
+}
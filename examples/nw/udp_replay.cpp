@@ -0,0 +1,112 @@
+#include <mart-netlib/udp_capture.hpp>
+
+#include <array>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace udp = mart::nw::ip::udp;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// sends the datagrams with the original gaps between them, divided by speed
+std::uint64_t replay_timed( udp::CaptureReader& reader, udp::Socket& sock, double speed )
+{
+	std::uint64_t                         cnt = 0;
+	std::chrono::system_clock::time_point first_rx{};
+	Clock::time_point                     start{};
+
+	while( const auto record = reader.read() ) {
+		if( cnt == 0 ) {
+			first_rx = record->rx_time;
+			start    = Clock::now();
+		}
+		const auto due = start
+						 + std::chrono::duration_cast<Clock::duration>( ( record->rx_time - first_rx ) / speed );
+		// sleep_for is only precise to a few tens of microseconds - spin for the rest
+		while( true ) {
+			const auto remaining = due - Clock::now();
+			if( remaining <= 0s ) { break; }
+			if( remaining > 100us ) { std::this_thread::sleep_for( remaining - 100us ); }
+		}
+		sock.send( record->data );
+		++cnt;
+	}
+	return cnt;
+}
+
+// sends the datagrams as fast as possible in batches (sendmmsg on linux)
+std::uint64_t replay_fast( udp::CaptureReader& reader, udp::Socket& sock )
+{
+	// record.data is only valid until the next read, so the batch needs its own copy
+	constexpr std::size_t                                batch_size = 64;
+	std::array<std::vector<mart::ByteType>, batch_size> storage;
+	std::array<mart::ConstMemoryView, batch_size>       batch;
+
+	std::uint64_t cnt  = 0;
+	bool          done = false;
+	while( !done ) {
+		std::size_t n = 0;
+		while( n < batch_size ) {
+			const auto record = reader.read();
+			if( !record ) {
+				done = true;
+				break;
+			}
+			storage[n].assign( record->data.begin(), record->data.end() );
+			batch[n] = mart::view_elements( storage[n] );
+			++n;
+		}
+		sock.send_batch( mart::ArrayView<const mart::ConstMemoryView>( batch.data(), n ) );
+		cnt += n;
+	}
+	return cnt;
+}
+
+} // namespace
+
+// Resends the datagrams from a capture file (see udp_record) to <target endpoint>
+int main( int argc, char** argv )
+{
+	if( argc < 3 ) {
+		std::cerr << "Usage: " << argv[0] << " <file> <target endpoint (e.g. 127.0.0.1:3435)>"
+				  << " [--speed <factor> | --fast]\n"
+				  << "  Without options, the datagrams are sent with their original timing.\n"
+				  << "  --speed <factor>: scales the timing (2: twice as fast)\n"
+				  << "  --fast:           as fast as possible\n";
+		return 1;
+	}
+	const std::string   file_name = argv[1];
+	const udp::endpoint target( std::string_view{ argv[2] } );
+
+	double speed = 1.0;
+	bool   fast  = false;
+	for( int i = 3; i < argc; ++i ) {
+		const std::string_view arg = argv[i];
+		if( arg == "--fast" ) {
+			fast = true;
+		} else if( arg == "--speed" && i + 1 < argc ) {
+			speed = std::stod( argv[++i] );
+		}
+	}
+	if( speed <= 0 ) {
+		std::cerr << "Speed has to be positive\n";
+		return 1;
+	}
+
+	udp::CaptureReader reader( file_name );
+	udp::Socket        sock;
+	sock.connect( target );
+
+	const auto          start = Clock::now();
+	const std::uint64_t cnt   = fast ? replay_fast( reader, sock ) : replay_timed( reader, sock, speed );
+	const auto          wall  = std::chrono::duration<double>( Clock::now() - start );
+
+	std::cout << "Sent " << cnt << " datagrams to " << target.toStringEx() << " in " << wall.count() << "s"
+			  << std::endl;
+}
@@ -51,16 +51,17 @@ int main( int argc, char** argv )
 
 	std::cout << "Listening on " << local_ep.toStringEx() << " and writing to" << file_name << std::endl;
 
-	std::string buffer( 1000, '\0' );
+	udp::Socket::PacketPool pool( 1000, 4 );
+
+	// one line per message (see udp_record / udp_replay for binary capture files with timestamps)
+	std::ofstream file( file_name, std::ios_base::out | std::ios_base::app );
 
 	while( true ) {
-		auto res = sock.try_recv( mart::view_elements_mutable( buffer ).asBytes() );
+		auto packet = sock.try_recv_pooled( pool );
 
-		if( res.isValid() ) {
-			auto msg = to_stringview( res );
+		if( packet ) {
+			auto msg = to_stringview( packet.data() );
 			if( msg == "EXIT" ) { return 0; }
-			std::ofstream file( file_name, std::ios_base::out | std::ios_base::trunc );
-			file.seekp( 0 );
 			file << msg << "\n";
 			std::cout << "\"" << msg << "\"" << std::endl;
 		}
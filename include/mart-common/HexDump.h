@@ -0,0 +1,201 @@
+#ifndef LIB_MART_COMMON_GUARD_HEX_DUMP_H
+#define LIB_MART_COMMON_GUARD_HEX_DUMP_H
+/**
+ * HexDump.h (mart-common)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Table based conversion of bytes into hex digits and buffered output of memory dumps
+ *
+ * Streaming each byte with std::setw(2) << std::hex is slow, as each byte results in several virtual calls
+ * and a locale lookup. The functions here translate each byte with a single table lookup
+ * and write the result to the stream in large blocks.
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <ios>
+#include <ostream>
+#include <string_view>
+
+/* Proprietary Library Includes */
+/* Project Includes */
+#include "./ArrayView.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace hex {
+
+namespace _impl_hex {
+
+// 256 entries with two characters each: "000102...ff"
+constexpr std::array<char, 512> make_table( bool upper ) noexcept
+{
+	std::array<char, 512> table{};
+	const char*           digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	for( std::size_t i = 0; i < 256; ++i ) {
+		table[2 * i]     = digits[i >> 4];
+		table[2 * i + 1] = digits[i & 0xF];
+	}
+	return table;
+}
+
+constexpr std::array<char, 512> lower_table = make_table( false );
+constexpr std::array<char, 512> upper_table = make_table( true );
+
+} // namespace _impl_hex
+
+/**
+ * Describes how a single byte is rendered. Mirrors the effect of the ostream flags on
+ * out << std::hex << std::setw( 2 ) << std::setfill( fill ) << (int)byte
+ */
+struct ByteFormat {
+	bool upper     = false; // std::uppercase
+	bool left      = false; // std::left: pad after the digit ("a0" instead of "0a")
+	bool show_base = false; // std::showbase: "0xa" (no padding necessary, as this is always wider than 2)
+	char fill      = '0';
+
+	static ByteFormat from_stream( const std::ostream& out, char fill ) noexcept
+	{
+		ByteFormat fmt;
+		fmt.upper     = ( out.flags() & std::ios::uppercase ) != 0;
+		fmt.left      = ( out.flags() & std::ios::adjustfield ) == std::ios::left;
+		fmt.show_base = ( out.flags() & std::ios::showbase ) != 0;
+		fmt.fill      = fill;
+		return fmt;
+	}
+
+	// maximum number of characters write_byte can produce
+	static constexpr std::size_t max_size = 4;
+};
+
+/**
+ * Writes the two hex digits of b to out and returns the position behind the last written character
+ */
+inline char* write_byte( char* out, ByteType b, bool upper = false ) noexcept
+{
+	const char* digits = ( upper ? _impl_hex::upper_table.data() : _impl_hex::lower_table.data() )
+						 + 2 * static_cast<unsigned char>( b );
+	out[0] = digits[0];
+	out[1] = digits[1];
+	return out + 2;
+}
+
+/**
+ * Writes b according to the given format and returns the position behind the last written character
+ */
+inline char* write_byte( char* out, ByteType b, const ByteFormat& fmt ) noexcept
+{
+	const auto value = static_cast<unsigned char>( b );
+	if( value >= 16 && !fmt.show_base ) { return write_byte( out, b, fmt.upper ); }
+
+	const char digit = ( fmt.upper ? _impl_hex::upper_table : _impl_hex::lower_table )[2 * value + 1];
+	if( fmt.show_base && value != 0 ) {
+		*out++ = '0';
+		*out++ = fmt.upper ? 'X' : 'x';
+		if( value >= 16 ) { return write_byte( out, b, fmt.upper ); }
+		*out++ = digit;
+		return out;
+	}
+	// single digit (or zero, which never gets a base prefix) padded to width 2
+	if( fmt.left ) {
+		out[0] = digit;
+		out[1] = fmt.fill;
+	} else {
+		out[0] = fmt.fill;
+		out[1] = digit;
+	}
+	return out + 2;
+}
+
+/**
+ * Writes 2*data.size() hex digits to out (which must be large enough) and returns the end of the written range
+ */
+inline char* encode( char* out, ConstMemoryView data, bool upper = false ) noexcept
+{
+	const char* table = upper ? _impl_hex::upper_table.data() : _impl_hex::lower_table.data();
+	for( ByteType b : data ) {
+		std::memcpy( out, table + 2 * static_cast<unsigned char>( b ), 2 );
+		out += 2;
+	}
+	return out;
+}
+
+/**
+ * Collects output in a local buffer and forwards it to the stream in large blocks
+ * NOTE: uses unformatted output (ostream::write), so the stream's width setting is not consumed
+ */
+class BufferedWriter {
+public:
+	static constexpr std::size_t buffer_size = 1024;
+
+	explicit BufferedWriter( std::ostream& out ) noexcept
+		: _out( &out )
+	{
+	}
+	BufferedWriter( const BufferedWriter& ) = delete;
+	BufferedWriter& operator=( const BufferedWriter& ) = delete;
+	~BufferedWriter() { flush(); }
+
+	// returns a pointer to at least n (<= buffer_size) writable characters. Call commit( end ) afterwards
+	char* reserve( std::size_t n )
+	{
+		if( static_cast<std::size_t>( _buffer + buffer_size - _pos ) < n ) { flush(); }
+		return _pos;
+	}
+	void commit( char* end ) noexcept { _pos = end; }
+
+	void put( char c )
+	{
+		char* p = reserve( 1 );
+		*p      = c;
+		commit( p + 1 );
+	}
+
+	void append( std::string_view str )
+	{
+		while( !str.empty() ) {
+			const std::size_t n = std::min( str.size(), buffer_size );
+			char*             p = reserve( n );
+			std::memcpy( p, str.data(), n );
+			commit( p + n );
+			str.remove_prefix( n );
+		}
+	}
+
+	void append( std::size_t cnt, char c )
+	{
+		while( cnt != 0 ) {
+			const std::size_t n = std::min( cnt, buffer_size );
+			char*             p = reserve( n );
+			std::memset( p, c, n );
+			commit( p + n );
+			cnt -= n;
+		}
+	}
+
+	void flush()
+	{
+		if( _pos != _buffer ) { _out->write( _buffer, _pos - _buffer ); }
+		_pos = _buffer;
+	}
+
+private:
+	std::ostream* _out;
+	char          _buffer[buffer_size];
+	char*         _pos = _buffer;
+};
+
+} // namespace hex
+} // namespace mart
+
+#endif
@@ -25,6 +25,7 @@
 /* Proprietary Library Includes */
 /* Project Includes */
 #include "./ArrayView.h"
+#include "./HexDump.h"
 #include "./StringView.h" //getSpaces
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -154,19 +155,28 @@ struct formatted_data_range {
 
 inline std::ostream& operator<<( std::ostream& out, const formatted_data_range& range )
 {
-	os_flag_guard g( out );
+	// NOTE: output is identical to streaming each byte with out << std::hex << std::setw( 2 ) << std::setfill( '0' )
+	const auto byte_fmt = hex::ByteFormat::from_stream( out, '0' );
 
 	out << range.fmt_info.start_delimiter << ' ';
 
+	hex::BufferedWriter writer( out );
 	for( std::size_t i = 0; i < range.range.size(); ++i ) {
-		out << std::hex << std::setw( 2 ) << std::setfill( '0' ) << (int)range.range[i] << ' ';
+		// byte + ' ' + row separator
+		char* pos = writer.reserve( hex::ByteFormat::max_size + 4 );
+		pos       = hex::write_byte( pos, range.range[i], byte_fmt );
+		*pos++    = ' ';
 		if( ( i + 1 ) % range.fmt_info.row_size == 0 ) {
-			out << "\n  ";
-		} else {
-			if( ( i + 1 ) % range.fmt_info.chunck_size == 0 ) { out << "  "; }
+			*pos++ = '\n';
+			*pos++ = ' ';
+			*pos++ = ' ';
+		} else if( ( i + 1 ) % range.fmt_info.chunck_size == 0 ) {
+			*pos++ = ' ';
+			*pos++ = ' ';
 		}
+		writer.commit( pos );
 	}
-	out << range.fmt_info.end_delimiter;
+	writer.put( range.fmt_info.end_delimiter );
 
 	return out;
 }
@@ -23,6 +23,9 @@
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
 
 #include <mutex>
 #include <thread>
@@ -40,6 +43,8 @@
 #include "LoggerConfig.h"
 #include "MartLogFWD.h"
 #include "default_formatter.h"
+#include "structured.h"
+#include "timestamp_formatter.h"
 #include "types.h"
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -85,6 +90,8 @@ public:
 		: _startTime{mart::now()}
 		, _currentLogLevel{logLvl}
 		, _enabled{true}
+		, _format{Format::Text}
+		, _timestampFormat{TimestampFormat::RelativeMs}
 		, _sinks{}
 		, _loggingName( _createLoggingName( moduleName ) )
 	{
@@ -105,6 +112,8 @@ public:
 	Logger( const LoggerConf_t& cfg )
 		: Logger( cfg.moduleName, cfg.logLvl )
 	{
+		setFormat( cfg.format );
+		setTimestampFormat( cfg.timestamp );
 	}
 
 	/**
@@ -192,8 +201,83 @@ public:
 	template<class... ARGS>
 	LIB_MART_COMMON_NO_INLINE void log_impl( Level lvl, ARGS&&... args )
 	{
-		_fillBuffer( lvl, AddNewline::Yes, std::forward<ARGS>( args )... );
-		_writeBufferToSinks( lvl );
+		const Format fmt = getFormat();
+		if( fmt == Format::Text ) {
+			_fillBuffer( lvl, AddNewline::Yes, std::forward<ARGS>( args )... );
+			_writeBufferToSinks( lvl );
+			return;
+		}
+
+		// In structured mode, the formatted message becomes the "msg" field
+		auto& buffer = _sbuffer();
+		buffer.clear();
+		formatForLog( buffer.stream, args... );
+		_writeRecordToSinks( lvl, _fillRecord( lvl, fmt, buffer.view() ) );
+	}
+
+	/* ####### structured log interface #######*/
+	/**
+	 * Logs a message together with a list of key/value pairs (see kv( key, value ) in structured.h)
+	 *
+	 * Depending on the configured Format, the output is either a line of json, logfmt or - in Text mode -
+	 * the normal log prefix and message followed by the fields in logfmt notation.
+	 */
+	template<class... Ts>
+	inline void log_kv( Level lvl, std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		if( !_shouldBeLogged( lvl ) ) return;
+		log_kv_impl( lvl, msg, fields... );
+	}
+
+	template<class... Ts>
+	LIB_MART_COMMON_NO_INLINE void log_kv_impl( Level lvl, std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		const Format fmt = getFormat();
+		if( fmt == Format::Text ) {
+			auto& record = _record();
+			record.clear();
+			_appendTextPrefix( record, lvl );
+			record.append( msg.data(), msg.size() );
+
+			ValueWriter w( record, Format::Logfmt );
+			( ( record.push_back( ' ' ), w.key( fields.key ), encode_kv_value( w, fields.value ) ), ... );
+			record.push_back( '\n' );
+			_writeRecordToSinks( lvl, record );
+			return;
+		}
+
+		_writeRecordToSinks( lvl, _fillRecord( lvl, fmt, msg, fields... ) );
+	}
+
+	template<class... Ts>
+	inline void error( std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		log_kv( Level::Error, msg, fields... );
+	}
+
+	template<class... Ts>
+	inline void status( std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		log_kv( Level::Status, msg, fields... );
+	}
+
+	// there is no separate info level - info messages are logged with Level::Status
+	template<class... Ts>
+	inline void info( std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		log_kv( Level::Status, msg, fields... );
+	}
+
+	template<class... Ts>
+	inline void debug( std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		log_kv( Level::Debug, msg, fields... );
+	}
+
+	template<class... Ts>
+	inline void trace( std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		log_kv( Level::Trace, msg, fields... );
 	}
 
 	template<class... ARGS>
@@ -238,6 +322,18 @@ public:
 
 	void setName( const std::string_view name ) { _loggingName = _createLoggingName( name ); }
 
+	/**
+	 * Selects the encoding of the log lines (human readable text, json lines or logfmt)
+	 */
+	Format getFormat() const noexcept { return _format.load( std::memory_order_relaxed ); }
+	void   setFormat( Format fmt ) noexcept { _format.store( fmt, std::memory_order_relaxed ); }
+
+	/**
+	 * Selects between the time since creation of the logger (default) and wall clock time (ISO-8601) in the log prefix
+	 */
+	TimestampFormat getTimestampFormat() const noexcept { return _timestampFormat.load( std::memory_order_relaxed ); }
+	void setTimestampFormat( TimestampFormat fmt ) noexcept { _timestampFormat.store( fmt, std::memory_order_relaxed ); }
+
 	/* ### Change sinks ###*/
 	void addSink( std::shared_ptr<ILogSink> sink )
 	{
@@ -297,6 +393,8 @@ private:
 	mart::copter_time_point     _startTime;
 	mart::CopyableAtomic<Level> _currentLogLevel;
 	mart::CopyableAtomic<bool>  _enabled;
+	mart::CopyableAtomic<Format> _format;
+	mart::CopyableAtomic<TimestampFormat> _timestampFormat;
 
 	std::vector<std::shared_ptr<ILogSink>> _sinks;
 
@@ -307,10 +405,61 @@ private:
 	static constexpr std::string_view space_string_litteral
 		= "                                                                                                         ";
 
-	static std::ostringstream& _sbuffer()
+	// std::ostream, that formats into a std::string. Unlike std::ostringstream::str(), reading the result
+	// doesn't copy it and clearing it keeps the capacity, so we don't allocate in steady state
+	struct MessageBuffer {
+		struct StringBuf : std::streambuf {
+			std::string str;
+
+			int_type overflow( int_type ch ) override
+			{
+				if( !traits_type::eq_int_type( ch, traits_type::eof() ) ) {
+					str.push_back( traits_type::to_char_type( ch ) );
+				}
+				return traits_type::not_eof( ch );
+			}
+			std::streamsize xsputn( const char* s, std::streamsize n ) override
+			{
+				str.append( s, static_cast<std::size_t>( n ) );
+				return n;
+			}
+		};
+
+		MessageBuffer() { buf.str.reserve( 512 ); }
+
+		std::string_view view() const noexcept { return buf.str; }
+		void             clear() noexcept { buf.str.clear(); }
+
+		StringBuf    buf;
+		std::ostream stream{ &buf };
+	};
+
+	static MessageBuffer& _sbuffer()
+	{
+		thread_local MessageBuffer buffer;
+		return buffer;
+	}
+
+	// Thread id as streamed by operator<< (like the text prefix always did) - rendered once per thread
+	static std::string_view _thread_id_text()
+	{
+		thread_local const std::string id = [] {
+			std::ostringstream ss;
+			ss << std::this_thread::get_id();
+			return ss.str();
+		}();
+		return id;
+	}
+
+	// Buffer for structured records - keeps its capacity, so we don't allocate in steady state
+	static std::string& _record()
 	{
-		thread_local std::ostringstream stream;
-		return stream;
+		thread_local std::string record = [] {
+			std::string r;
+			r.reserve( 512 );
+			return r;
+		}();
+		return record;
 	}
 
 	// checks if a message  with priority <lvl> should be logged or not
@@ -331,16 +480,14 @@ private:
 	template<class... ARGS>
 	void _fillBuffer( Level lvl, AddNewline newLine, ARGS&&... args )
 	{
-		std::ostream& buffer = _sbuffer();
-		// line prefix
-		formatForLog(
-			buffer, lvl, " - At ", std::setw( 7 ), passedTime<milliseconds>( _startTime ), " - ", _loggingName, ": " );
-
-		// Add thread Id and spacer in trace mode
-		if( _currentLogLevel == Level::TRACE ) {
-			ostream_flag_saver _( buffer );
-			formatForLog( buffer, "[ThreadID: ", std::this_thread::get_id(), "]: ", _spacer );
-		}
+		auto& msg_buffer = _sbuffer();
+		msg_buffer.clear();
+		std::ostream& buffer = msg_buffer.stream;
+		// line prefix (the record buffer is not in use in text mode, so we can use it as scratch space)
+		auto& prefix = _record();
+		prefix.clear();
+		_appendTextPrefix( prefix, lvl );
+		buffer.write( prefix.data(), static_cast<std::streamsize>( prefix.size() ) );
 
 		// write actual message
 		formatForLog( buffer, args... );
@@ -349,11 +496,70 @@ private:
 		if( newLine == AddNewline::Yes ) { buffer << '\n'; }
 	}
 
-	// write contents to all registered log sinks and reset buffer
+	// "STATUS - At 12     ms - [module]: " or "STATUS - 2020-04-01T13:37:00.123456Z - [module]: "
+	// plus thread id and spacer in trace mode
+	void _appendTextPrefix( std::string& out, Level lvl ) const
+	{
+		constexpr std::size_t lvl_width = 6;
+
+		const auto lvl_str = to_string_view( lvl );
+		out.append( lvl_str.data(), lvl_str.size() );
+		if( lvl_str.size() < lvl_width ) { out.append( lvl_width - lvl_str.size(), ' ' ); }
+
+		char ts_buffer[timestamp::buffer_size];
+		if( getTimestampFormat() == TimestampFormat::Iso8601 ) {
+			out.append( " - " );
+			out.append( timestamp::iso8601( ts_buffer, std::chrono::system_clock::now() ) );
+		} else {
+			out.append( " - At " );
+			out.append( timestamp::relative_ms( ts_buffer, passedTime<milliseconds>( _startTime ) ) );
+		}
+		out.append( " - " );
+		out.append( std::string_view( _loggingName ) );
+		out.append( ": " );
+
+		if( _currentLogLevel == Level::TRACE ) {
+			out.append( "[ThreadID: " );
+			out.append( _thread_id_text() );
+			out.append( "]: " );
+			out.append( _spacer );
+		}
+	}
+
+	// Composes a structured record: common fields (level, time, module, thread), the message and user fields
+	template<class... Ts>
+	std::string& _fillRecord( Level lvl, Format fmt, std::string_view msg, const KeyValue<Ts>&... fields )
+	{
+		auto& record = _record();
+		record.clear();
+
+		RecordWriter w( record, fmt );
+		w.begin();
+		w.field( "level", lvl );
+		if( getTimestampFormat() == TimestampFormat::Iso8601 ) {
+			w.field( "ts", std::chrono::system_clock::now() );
+		} else {
+			w.field( "t_ms", passedTime<milliseconds>( _startTime ).count() );
+		}
+		w.field( "module", std::string_view( _loggingName ) );
+		if( _currentLogLevel == Level::TRACE ) { w.field( "thread", _impl_kv::this_thread_id_string() ); }
+		w.field( "msg", msg );
+		( w.field( fields ), ... );
+		w.end();
+		return record;
+	}
+
+	void _writeRecordToSinks( Level lvl, std::string_view record )
+	{
+		for( const auto& se : _sinks ) {
+			se->writeToLog( record, lvl );
+		}
+	}
+
+	// write contents to all registered log sinks (the buffer gets cleared, when the next message is composed)
 	void _writeBufferToSinks( Level lvl )
 	{
-		auto text = _sbuffer().str();
-		_sbuffer().str( std::string{} );
+		const auto text = _sbuffer().view();
 		for( const auto& se : _sinks ) {
 			se->writeToLog( text, lvl );
 		}
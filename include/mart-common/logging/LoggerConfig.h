@@ -23,8 +23,10 @@ namespace log {
 
 // TODO: move to separate file
 struct LoggerConf_t {
-	mba::im_zstr moduleName;
-	Level        logLvl = defaultLogLevel;
+	mba::im_zstr    moduleName;
+	Level           logLvl    = defaultLogLevel;
+	Format          format    = Format::Text;
+	TimestampFormat timestamp = TimestampFormat::RelativeMs;
 };
 
 } // namespace log
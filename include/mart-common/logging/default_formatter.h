@@ -15,10 +15,12 @@
  */
 
 /* ######## INCLUDES ######### */
+#include "timestamp_formatter.h"
 #include "types.h"
 
 /* Proprietary Library Includes */
 #include "../ArrayView.h"
+#include "../HexDump.h"
 
 /* Standard Library Includes */
 #include <algorithm>
@@ -78,14 +80,9 @@ inline void defaultFormatForLog(std::ostream& out, std::chrono::seconds value)
 inline void defaultFormatForLog(std::ostream& out, std::chrono::minutes value)		{ out << value.count() << "min"; }
 inline void defaultFormatForLog(std::ostream& out, std::chrono::hours value)		{ out << value.count() << "h"; }
 
-// TODO: c++11
 inline void defaultFormatForLog(std::ostream& out, std::chrono::system_clock::time_point value) {
-	using namespace std::chrono_literals;
-
-	const auto t = std::chrono::system_clock::to_time_t(value);
-	out << std::put_time(std::gmtime(&t), "(%Z) %F_%T-");
-	ostream_flag_saver _(out);
-	out << std::setfill('0') << std::setw(6) << value.time_since_epoch() / 1us % 1000000 << "us";
+	char buffer[timestamp::buffer_size];
+	out << timestamp::legacy( buffer, value );
 }
 
 template<class Clock, class Dur>
@@ -119,19 +116,17 @@ inline void defaultFormatForLog( std::ostream& out, mart::ArrayView<T> arr )
 }
 
 namespace _impl_log {
-inline void printOneLine( std::ostream& out, mart::ConstMemoryView mem, size_t fillto = 0 )
+// "[ 01 02 ff ]" (the opening bracket has already been written), padded with spaces to the width of fillto bytes
+inline void
+printOneLine( hex::BufferedWriter& out, mart::ConstMemoryView mem, const hex::ByteFormat& fmt, size_t fillto = 0 )
 {
-	constexpr std::string_view space(
-		"                                                                                                              "
-		"                                       " );
-	const auto spaces = [&]( size_t cnt ) { return space.substr( 0, std::min( cnt, space.size() ) ); };
-
-	out << '[';
 	for( ByteType b : mem ) {
-		out << ' ' << std::setw( 2 ) << static_cast<int>( b );
+		char* pos = out.reserve( 1 + hex::ByteFormat::max_size );
+		*pos      = ' ';
+		out.commit( hex::write_byte( pos + 1, b, fmt ) );
 	}
-	if( fillto > mem.size() ) { out << spaces( ( fillto - mem.size() ) * 3 ); }
-	out << " ]";
+	if( fillto > mem.size() ) { out.append( ( fillto - mem.size() ) * 3, ' ' ); }
+	out.append( " ]" );
 }
 } // namespace _impl_log
 
@@ -139,19 +134,32 @@ inline void defaultFormatForLog( std::ostream& out, mart::ConstMemoryView mem )
 {
 	constexpr std::size_t ElementsPerLine = 20;
 
-	ostream_flag_saver _( out );
-	out << std::right << std::hex << std::setfill( '0' );
+	// same output as out << std::right << std::hex << std::setfill( '0' ) << std::setw( 2 ) << (int)byte
+	// NOTE: the first token is written with a formatted output operation, so a pending setw() is consumed as before
+	auto fmt = hex::ByteFormat::from_stream( out, '0' );
+	fmt.left = false;
+
+	const auto write_first_token = [&out]( const auto& token ) {
+		ostream_flag_saver _( out );
+		out << std::right << std::setfill( '0' ) << token;
+	};
 
 	if( mem.size() <= ElementsPerLine ) {
-		_impl_log::printOneLine( out, mem );
+		write_first_token( '[' );
+		hex::BufferedWriter writer( out );
+		_impl_log::printOneLine( writer, mem, fmt );
 	} else {
+		write_first_token( "\n\t" );
+		hex::BufferedWriter writer( out );
+		bool                first = true;
 		while( !mem.empty() ) {
-			out << "\n\t";
+			writer.append( first ? std::string_view( "[" ) : std::string_view( "\n\t[" ) );
+			first      = false;
 			auto parts = mem.split( std::min( ElementsPerLine, mem.size() ) );
-			_impl_log::printOneLine( out, parts.first, ElementsPerLine );
+			_impl_log::printOneLine( writer, parts.first, fmt, ElementsPerLine );
 			mem = parts.second;
 		}
-		out << '\n';
+		writer.put( '\n' );
 	}
 }
 
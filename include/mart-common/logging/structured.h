@@ -0,0 +1,377 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_STRUCTURED_H
+#define LIB_MART_COMMON_GUARD_LOGGING_STRUCTURED_H
+/**
+ * structured.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Key/value pairs for structured logging and their json / logfmt encoding
+ *
+ * Usage:
+ *
+ *   log.info( "Connection established", kv( "port", 8080 ), kv( "latency", 12us ) );
+ *
+ * Values are encoded directly into a (thread local) character buffer - no ostreams are involved
+ * and once the buffer has grown to the size of the longest log line, no more memory is allocated.
+ *
+ * Supported value types are: bool, integers, floating point numbers, anything that is convertible
+ * to std::string_view, std::chrono durations, system_clock time points, std::thread::id, nullptr
+ * and all types for which a to_string_view( const T& ) function can be found via ADL
+ * (e.g. mart::log::Level or enums defined with the mart enum macros).
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#if __has_include( <charconv> )
+#include <charconv>
+#endif
+
+/* Project Includes */
+#include "timestamp_formatter.h"
+#include "types.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+namespace _impl_kv {
+
+// strings are stored as views, small trivial types by value and everything else by reference
+// (which is fine as long as the KeyValue object is - as intended - only used as a temporary inside the log call)
+template<class T>
+using storage_t = std::conditional_t<
+	std::is_convertible_v<const T&, std::string_view> && !std::is_same_v<T, std::nullptr_t>,
+	std::string_view,
+	std::conditional_t<std::is_trivially_copyable_v<T> && sizeof( T ) <= 16, T, const T&>>;
+
+} // namespace _impl_kv
+
+template<class T>
+struct KeyValue {
+	std::string_view key;
+	T                value;
+};
+
+template<class T>
+constexpr KeyValue<_impl_kv::storage_t<T>> kv( std::string_view key, const T& value ) noexcept
+{
+	return { key, value };
+}
+
+namespace _impl_kv {
+
+template<class T>
+struct is_duration : std::false_type {
+};
+template<class Rep, class Period>
+struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type {
+};
+
+template<class T, class = void>
+struct has_to_string_view : std::false_type {
+};
+template<class T>
+struct has_to_string_view<T, std::void_t<decltype( to_string_view( std::declval<const T&>() ) )>> : std::true_type {
+};
+
+template<class T>
+constexpr bool dependent_false_v = false;
+
+// clang-format off
+template<class Period> constexpr std::string_view duration_suffix()                   { return {}; }
+template<> constexpr std::string_view duration_suffix<std::nano>()                    { return "ns"; }
+template<> constexpr std::string_view duration_suffix<std::micro>()                   { return "us"; }
+template<> constexpr std::string_view duration_suffix<std::milli>()                   { return "ms"; }
+template<> constexpr std::string_view duration_suffix<std::ratio<1>>()                { return "s"; }
+template<> constexpr std::string_view duration_suffix<std::ratio<60>>()               { return "min"; }
+template<> constexpr std::string_view duration_suffix<std::ratio<3600>>()             { return "h"; }
+// clang-format on
+
+template<class Int>
+std::string_view int_to_chars( char* first, char* last, Int value ) noexcept
+{
+#if __has_include( <charconv> )
+	const auto res = std::to_chars( first, last, value );
+	return { first, static_cast<std::size_t>( res.ptr - first ) };
+#else
+	const bool     neg = value < 0;
+	unsigned long long v = neg ? 0ull - static_cast<unsigned long long>( value ) : static_cast<unsigned long long>( value );
+	char*          pos = last;
+	do {
+		*--pos = static_cast<char>( '0' + v % 10 );
+		v /= 10;
+	} while( v != 0 && pos != first );
+	if( neg && pos != first ) { *--pos = '-'; }
+	return { pos, static_cast<std::size_t>( last - pos ) };
+#endif
+}
+
+inline std::string_view double_to_chars( char* first, char* last, double value ) noexcept
+{
+#if defined( __cpp_lib_to_chars ) && __cpp_lib_to_chars >= 201611L
+	const auto res = std::to_chars( first, last, value );
+	return { first, static_cast<std::size_t>( res.ptr - first ) };
+#else
+	const int n = std::snprintf( first, static_cast<std::size_t>( last - first ), "%.17g", value );
+	return { first, n < 0 ? 0u : std::min( static_cast<std::size_t>( n ), static_cast<std::size_t>( last - first ) ) };
+#endif
+}
+
+// The textual representation of a thread id is only available via ostream, so it is rendered once per thread
+inline std::string_view this_thread_id_string()
+{
+	thread_local const std::string id = [] {
+		std::ostringstream ss;
+		ss << "0x" << std::hex << std::this_thread::get_id();
+		return ss.str();
+	}();
+	return id;
+}
+
+constexpr char hex_digits[] = "0123456789abcdef";
+
+} // namespace _impl_kv
+
+/**
+ * Appends values to a character buffer and applies the quoting and escaping rules of the selected format
+ *
+ * Strings are quoted and escaped (json) or quoted if necessary (logfmt),
+ * numbers and booleans are written as plain tokens.
+ */
+class ValueWriter {
+public:
+	ValueWriter( std::string& out, Format fmt ) noexcept
+		: _out( &out )
+		, _fmt( fmt )
+	{
+	}
+
+	Format format() const noexcept { return _fmt; }
+
+	void raw( std::string_view token ) { _out->append( token.data(), token.size() ); }
+
+	void null() { raw( "null" ); }
+
+	void string( std::string_view str )
+	{
+		if( _fmt == Format::Json ) {
+			_append_json_string( str );
+		} else if( _fmt == Format::Logfmt && _needs_logfmt_quotes( str ) ) {
+			_append_quoted_escaped( str );
+		} else {
+			raw( str );
+		}
+	}
+
+	// duration / units: number directly followed by a suffix - one token in logfmt, a string in json
+	void number_with_suffix( std::string_view number, std::string_view suffix )
+	{
+		if( _fmt == Format::Json ) { _out->push_back( '"' ); }
+		raw( number );
+		raw( suffix );
+		if( _fmt == Format::Json ) { _out->push_back( '"' ); }
+	}
+
+	void key( std::string_view key )
+	{
+		if( _fmt == Format::Json ) {
+			_append_json_string( key );
+			_out->push_back( ':' );
+		} else {
+			// logfmt keys can't be quoted, so we replace everything that would break parsing
+			if( key.empty() ) { _out->push_back( '_' ); }
+			for( char c : key ) {
+				_out->push_back( _is_logfmt_key_char( c ) ? c : '_' );
+			}
+			_out->push_back( '=' );
+		}
+	}
+
+private:
+	std::string* _out;
+	Format       _fmt;
+
+	static constexpr bool _is_logfmt_key_char( char c ) noexcept
+	{
+		return static_cast<unsigned char>( c ) > ' ' && c != '=' && c != '"' && c != '\x7f';
+	}
+
+	static bool _needs_logfmt_quotes( std::string_view str ) noexcept
+	{
+		if( str.empty() ) { return true; }
+		for( char c : str ) {
+			if( !_is_logfmt_key_char( c ) || c == '\\' ) { return true; }
+		}
+		return false;
+	}
+
+	static constexpr bool _needs_escape( char c ) noexcept
+	{
+		return static_cast<unsigned char>( c ) < 0x20 || c == '"' || c == '\\';
+	}
+
+	void _append_escaped_char( char c )
+	{
+		switch( c ) {
+			case '"': raw( "\\\"" ); break;
+			case '\\': raw( "\\\\" ); break;
+			case '\n': raw( "\\n" ); break;
+			case '\r': raw( "\\r" ); break;
+			case '\t': raw( "\\t" ); break;
+			case '\b': raw( "\\b" ); break;
+			case '\f': raw( "\\f" ); break;
+			default: {
+				const auto uc    = static_cast<unsigned char>( c );
+				const char esc[] = { '\\', 'u', '0', '0', _impl_kv::hex_digits[uc >> 4], _impl_kv::hex_digits[uc & 0xF] };
+				raw( std::string_view( esc, sizeof( esc ) ) );
+			}
+		}
+	}
+
+	void _append_quoted_escaped( std::string_view str )
+	{
+		_out->push_back( '"' );
+		// copy runs of characters that don't need escaping in one go
+		std::size_t run_start = 0;
+		for( std::size_t i = 0; i < str.size(); ++i ) {
+			if( _needs_escape( str[i] ) || str[i] == '\x7f' ) {
+				raw( str.substr( run_start, i - run_start ) );
+				_append_escaped_char( str[i] );
+				run_start = i + 1;
+			}
+		}
+		raw( str.substr( run_start ) );
+		_out->push_back( '"' );
+	}
+
+	void _append_json_string( std::string_view str ) { _append_quoted_escaped( str ); }
+};
+
+/**
+ * Encodes a single value. Dispatches on the value type at compile time.
+ */
+template<class T>
+void encode_kv_value( ValueWriter& w, const T& value )
+{
+	using namespace _impl_kv;
+	if constexpr( std::is_same_v<T, bool> ) {
+		w.raw( value ? "true" : "false" );
+	} else if constexpr( std::is_integral_v<T> ) {
+		// NOTE: consistent with defaultFormatForLog, char types are written as numbers
+		char buffer[24];
+		if constexpr( sizeof( T ) == 1 ) {
+			w.raw( int_to_chars( buffer, buffer + sizeof( buffer ), static_cast<int>( value ) ) );
+		} else {
+			w.raw( int_to_chars( buffer, buffer + sizeof( buffer ), value ) );
+		}
+	} else if constexpr( std::is_floating_point_v<T> ) {
+		if( std::isfinite( value ) ) {
+			char buffer[32];
+			w.raw( double_to_chars( buffer, buffer + sizeof( buffer ), static_cast<double>( value ) ) );
+		} else if( w.format() == Format::Json ) {
+			w.null(); // json has no representation for nan / inf
+		} else {
+			w.raw( std::isnan( value ) ? "NaN" : ( value > 0 ? "+Inf" : "-Inf" ) );
+		}
+	} else if constexpr( std::is_same_v<T, std::nullptr_t> ) {
+		w.null();
+	} else if constexpr( std::is_convertible_v<const T&, std::string_view> ) {
+		w.string( std::string_view( value ) );
+	} else if constexpr( is_duration<T>::value ) {
+		constexpr auto suffix = duration_suffix<typename T::period>();
+		char           buffer[24];
+		if constexpr( suffix.empty() ) {
+			const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( value );
+			w.number_with_suffix( int_to_chars( buffer, buffer + sizeof( buffer ), ns.count() ), "ns" );
+		} else {
+			w.number_with_suffix( int_to_chars( buffer, buffer + sizeof( buffer ), value.count() ), suffix );
+		}
+	} else if constexpr( std::is_same_v<T, std::chrono::system_clock::time_point> ) {
+		char buffer[timestamp::buffer_size];
+		w.string( timestamp::iso8601( buffer, value ) );
+	} else if constexpr( std::is_same_v<T, std::thread::id> ) {
+		if( value == std::this_thread::get_id() ) {
+			w.string( this_thread_id_string() );
+		} else {
+			char buffer[24];
+			w.raw( int_to_chars( buffer, buffer + sizeof( buffer ), std::hash<std::thread::id>{}( value ) ) );
+		}
+	} else if constexpr( has_to_string_view<T>::value ) {
+		w.string( std::string_view( to_string_view( value ) ) );
+	} else {
+		static_assert( dependent_false_v<T>,
+					   "No structured log encoding for this type available. Provide a to_string_view( const T& ) "
+					   "function or convert the value to a supported type" );
+	}
+}
+
+/**
+ * Writes one log record (one line) consisting of a sequence of key/value fields
+ */
+class RecordWriter {
+public:
+	RecordWriter( std::string& out, Format fmt ) noexcept
+		: _out( &out )
+		, _writer( out, fmt )
+	{
+	}
+
+	void begin()
+	{
+		_first = true;
+		if( _writer.format() == Format::Json ) { _out->push_back( '{' ); }
+	}
+
+	template<class T>
+	void field( std::string_view key, const T& value )
+	{
+		_separator();
+		_writer.key( key );
+		encode_kv_value( _writer, value );
+	}
+
+	template<class T>
+	void field( const KeyValue<T>& kv )
+	{
+		field( kv.key, kv.value );
+	}
+
+	void end()
+	{
+		if( _writer.format() == Format::Json ) { _out->push_back( '}' ); }
+		_out->push_back( '\n' );
+	}
+
+	ValueWriter& value_writer() noexcept { return _writer; }
+
+private:
+	std::string* _out;
+	ValueWriter  _writer;
+	bool         _first = true;
+
+	void _separator()
+	{
+		if( !_first ) { _out->push_back( _writer.format() == Format::Json ? ',' : ' ' ); }
+		_first = false;
+	}
+};
+
+} // namespace log
+} // namespace mart
+
+#endif
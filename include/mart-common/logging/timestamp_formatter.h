@@ -0,0 +1,214 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_TIMESTAMP_FORMATTER_H
+#define LIB_MART_COMMON_GUARD_LOGGING_TIMESTAMP_FORMATTER_H
+/**
+ * timestamp_formatter.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Fast rendering of the timestamps used in log lines
+ *
+ * Converting a time point into a calendar date (gmtime) and formatting it (put_time) is expensive,
+ * but consecutive log messages of a thread usually fall into the same second. So the date/second part
+ * is cached per thread and only the sub-second digits are rendered for each message.
+ *
+ * All functions render into a caller provided buffer of at least timestamp::buffer_size bytes
+ * and return a view into that buffer.
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+namespace timestamp {
+
+constexpr std::size_t buffer_size = 64;
+
+namespace _impl {
+
+inline bool gmtime_threadsafe( std::time_t t, std::tm& out ) noexcept
+{
+#ifdef _MSC_VER
+	return gmtime_s( &out, &t ) == 0;
+#else
+	return gmtime_r( &t, &out ) != nullptr;
+#endif
+}
+
+// writes exactly <Digits> decimal digits (with leading zeros)
+template<int Digits>
+inline char* write_fixed( char* out, std::int64_t value ) noexcept
+{
+	for( int i = Digits - 1; i >= 0; --i ) {
+		out[i] = static_cast<char>( '0' + value % 10 );
+		value /= 10;
+	}
+	return out + Digits;
+}
+
+inline char* write_int( char* out, std::int64_t value ) noexcept
+{
+	char  tmp[24];
+	char* pos = tmp + sizeof( tmp );
+	// work with negative numbers to avoid overflow for min()
+	const bool neg = value < 0;
+	if( !neg ) { value = -value; }
+	do {
+		*--pos = static_cast<char>( '0' - value % 10 );
+		value /= 10;
+	} while( value != 0 );
+	if( neg ) { *--pos = '-'; }
+	const auto len = static_cast<std::size_t>( tmp + sizeof( tmp ) - pos );
+	std::memcpy( out, pos, len );
+	return out + len;
+}
+
+// splits a time point into full seconds and the (always positive) sub second part
+template<class SubSecond>
+inline std::pair<std::int64_t, std::int64_t> split_seconds( std::chrono::system_clock::time_point tp ) noexcept
+{
+	using namespace std::chrono;
+	const auto since_epoch = duration_cast<SubSecond>( tp.time_since_epoch() );
+	auto       secs        = duration_cast<seconds>( since_epoch );
+	auto       sub         = since_epoch - secs;
+	if( sub.count() < 0 ) {
+		secs -= seconds( 1 );
+		sub += seconds( 1 );
+	}
+	return { secs.count(), sub.count() };
+}
+
+/**
+ * Caches the rendered representation of the last second that was formatted by this thread
+ */
+template<class Renderer>
+struct SecondCache {
+	std::int64_t second = std::numeric_limits<std::int64_t>::min();
+	std::string  text;
+
+	std::string_view get( std::int64_t sec )
+	{
+		if( sec != second ) {
+			text.clear();
+			Renderer::render( sec, text );
+			second = sec;
+		}
+		return text;
+	}
+};
+
+// "YYYY-MM-DDTHH:MM:SS"
+struct Iso8601Renderer {
+	static void render( std::int64_t sec, std::string& out )
+	{
+		std::tm tm{};
+		if( !gmtime_threadsafe( static_cast<std::time_t>( sec ), tm ) ) { return; }
+		char  buffer[32];
+		char* pos = write_fixed<4>( buffer, tm.tm_year + 1900 );
+		*pos++    = '-';
+		pos       = write_fixed<2>( pos, tm.tm_mon + 1 );
+		*pos++    = '-';
+		pos       = write_fixed<2>( pos, tm.tm_mday );
+		*pos++    = 'T';
+		pos       = write_fixed<2>( pos, tm.tm_hour );
+		*pos++    = ':';
+		pos       = write_fixed<2>( pos, tm.tm_min );
+		*pos++    = ':';
+		pos       = write_fixed<2>( pos, tm.tm_sec );
+		out.assign( buffer, pos );
+	}
+};
+
+// "(%Z) %F_%T-" - the format used by defaultFormatForLog( system_clock::time_point )
+struct LegacyRenderer {
+	static void render( std::int64_t sec, std::string& out )
+	{
+		std::tm tm{};
+		if( !gmtime_threadsafe( static_cast<std::time_t>( sec ), tm ) ) { return; }
+		std::ostringstream ss;
+		ss << std::put_time( &tm, "(%Z) %F_%T-" );
+		out = ss.str();
+	}
+};
+
+template<class Renderer>
+inline std::string_view cached_second( std::int64_t sec )
+{
+	thread_local SecondCache<Renderer> cache;
+	return cache.get( sec );
+}
+
+inline char* append( char* out, std::string_view str ) noexcept
+{
+	std::memcpy( out, str.data(), str.size() );
+	return out + str.size();
+}
+
+} // namespace _impl
+
+/**
+ * Relative time in milliseconds as used in the default log prefix:
+ * The number is left aligned in a field of width 7, followed by "ms" (e.g. "12     ms")
+ */
+inline std::string_view relative_ms( char ( &buffer )[buffer_size], std::chrono::milliseconds ms ) noexcept
+{
+	constexpr std::ptrdiff_t width = 7;
+
+	char* pos = _impl::write_int( buffer, ms.count() );
+	while( pos - buffer < width ) {
+		*pos++ = ' ';
+	}
+	*pos++ = 'm';
+	*pos++ = 's';
+	return { buffer, static_cast<std::size_t>( pos - buffer ) };
+}
+
+/**
+ * Wall clock time in ISO-8601 format with microsecond resolution in UTC ("2020-04-01T13:37:00.123456Z")
+ */
+inline std::string_view iso8601( char ( &buffer )[buffer_size], std::chrono::system_clock::time_point tp )
+{
+	const auto [sec, us] = _impl::split_seconds<std::chrono::microseconds>( tp );
+
+	char* pos = _impl::append( buffer, _impl::cached_second<_impl::Iso8601Renderer>( sec ) );
+	*pos++    = '.';
+	pos       = _impl::write_fixed<6>( pos, us );
+	*pos++    = 'Z';
+	return { buffer, static_cast<std::size_t>( pos - buffer ) };
+}
+
+/**
+ * The format used by defaultFormatForLog( system_clock::time_point ) ("(GMT) 2020-04-01_13:37:00-123456us")
+ */
+inline std::string_view legacy( char ( &buffer )[buffer_size], std::chrono::system_clock::time_point tp )
+{
+	const auto [sec, us] = _impl::split_seconds<std::chrono::microseconds>( tp );
+
+	char* pos = _impl::append( buffer, _impl::cached_second<_impl::LegacyRenderer>( sec ) );
+	pos       = _impl::write_fixed<6>( pos, us );
+	*pos++    = 'u';
+	*pos++    = 's';
+	return { buffer, static_cast<std::size_t>( pos - buffer ) };
+}
+
+} // namespace timestamp
+} // namespace log
+} // namespace mart
+
+#endif
@@ -62,6 +62,36 @@ constexpr inline std::string_view to_string_view( Level lvl ) noexcept
 
 // clang-format on
 
+// Encoding of a log line:
+// - Text:   human readable prefix followed by the message ("STATUS - At 12     ms - [main]: ...")
+// - Json:   one json object per line (json lines)
+// - Logfmt: space separated key=value pairs
+enum class Format { Text, Json, Logfmt };
+
+constexpr inline std::string_view to_string_view( Format fmt ) noexcept
+{
+	switch( fmt ) {
+		case Format::Text: return "Text";
+		case Format::Json: return "Json";
+		case Format::Logfmt: return "Logfmt";
+	}
+	return "Unknown";
+}
+
+// Timestamp at the beginning of a log line:
+// - RelativeMs: milliseconds since creation of the logger ("12     ms")
+// - Iso8601:    wall clock time in UTC ("2020-04-01T13:37:00.123456Z")
+enum class TimestampFormat { RelativeMs, Iso8601 };
+
+constexpr inline std::string_view to_string_view( TimestampFormat fmt ) noexcept
+{
+	switch( fmt ) {
+		case TimestampFormat::RelativeMs: return "RelativeMs";
+		case TimestampFormat::Iso8601: return "Iso8601";
+	}
+	return "Unknown";
+}
+
 } // namespace log
 } // namespace mart
 
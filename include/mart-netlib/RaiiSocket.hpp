@@ -18,15 +18,21 @@
 /* Project Includes */
 #include "basic_types.hpp"
 #include "port_layer.hpp"
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+#include "socket_stats.hpp"
+#endif
 
 /* Proprietary Library Includes */
 #include <mart-common/ArrayView.h>
 
 /* Standard Library Includes */
+#include <array>
 #include <cerrno>
 #include <chrono>
 #include <cstring>
+#include <memory>
 #include <string_view>
+#include <vector>
 
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -49,8 +55,53 @@ inline byte_range to_byte_range( const std::string_view memory )
 	return byte_range{reinterpret_cast<unsigned char const*>( memory.data() ), memory.size()};
 }
 
+// converts a sequence of memory views into the byte ranges expected by the port_layer (on the stack for a few views)
+template<class Range>
+class ByteRanges {
+public:
+	template<class View>
+	explicit ByteRanges( mart::ArrayView<const View> views )
+		: _size( views.size() )
+	{
+		if( _size > _local.size() ) {
+			_heap.resize( _size );
+			_data = _heap.data();
+		}
+		for( std::size_t i = 0; i < _size; ++i ) {
+			View view = views[i]; // the view itself is const, not necessarily the memory it refers to
+			_data[i]  = Range{reinterpret_cast<decltype( Range{}._data )>( view.data() ), view.size()};
+		}
+	}
+
+	const Range* data() const noexcept { return _data; }
+	std::size_t  size() const noexcept { return _size; }
+
+private:
+	std::array<Range, 16> _local{};
+	std::vector<Range>    _heap;
+	Range*                _data = _local.data();
+	std::size_t           _size;
+};
+
 } // namespace _detail_socket_
 
+/**
+ * Removes the first n bytes from a sequence of buffers (e.g. what was sent by a partial scatter / gather send):
+ * Completely consumed buffers are dropped, a partially consumed one is shrunk in place.
+ */
+template<class View>
+mart::ArrayView<View> consume_front( mart::ArrayView<View> views, std::size_t n ) noexcept
+{
+	std::size_t i = 0;
+	while( i < views.size() && n >= views[i].size() ) {
+		n -= views[i].size();
+		++i;
+	}
+	views = views.subview( i );
+	if( !views.empty() ) { views[0] = views[0].subview( n ); }
+	return views;
+}
+
 inline std::string_view to_text_rep( ErrorCode code )
 {
 #ifdef _MSC_VER
@@ -78,6 +129,7 @@ public:
 		: _handle( handle )
 	{
 		_setBlocking_uncached( true );
+		_init_stats();
 	}
 	RaiiSocket( Domain domain, TransportType type ) noexcept { _open( domain, type ); }
 	~RaiiSocket() noexcept { close(); }
@@ -89,6 +141,9 @@ public:
 	RaiiSocket( RaiiSocket&& other ) noexcept
 		: _handle{std::exchange( other._handle, port_layer::handle_t::Invalid )}
 		, _is_blocking{std::exchange( other._is_blocking, false )}
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		, _stats{std::move( other._stats )}
+#endif
 	{
 	}
 
@@ -97,6 +152,9 @@ public:
 		close();
 		_handle      = std::exchange( other._handle, port_layer::handle_t::Invalid );
 		_is_blocking = std::exchange( other._is_blocking, true );
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		_stats = std::move( other._stats );
+#endif
 		return *this;
 	}
 
@@ -107,6 +165,10 @@ public:
 	{
 		ErrorCode ret = port_layer::close_socket( _handle );
 		_handle       = port_layer::handle_t::Invalid;
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		// the stats stay available until the socket object is destroyed
+		if( _stats ) { _stats->set_handle( _handle ); }
+#endif
 		return ret;
 	}
 
@@ -114,6 +176,11 @@ public:
 
 	port_layer::handle_t release() { return std::exchange( _handle, port_layer::handle_t::Invalid ); }
 
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+	// Traffic / error counters and syscall durations (nullptr, if the socket was never opened)
+	const SocketStats* stats() const noexcept { return _stats.get(); }
+#endif
+
 	/* ###### send / rec ############### */
 	struct SendResult {
 		mart::ConstMemoryView    remaining_data;
@@ -122,13 +189,16 @@ public:
 
 	SendResult send( mart::ConstMemoryView data, int flags = 0 )
 	{
-		auto res = port_layer::send( _handle, _detail_socket_::to_byte_range( data ), flags );
+		auto res = _tx( data.size(),
+						[&] { return port_layer::send( _handle, _detail_socket_::to_byte_range( data ), flags ); } );
 		return {data.subview( res.value_or( 0 ) ), res};
 	}
 
 	SendResult sendto( mart::ConstMemoryView data, int flags, const Sockaddr& addr )
 	{
-		auto res = port_layer::sendto( _handle, _detail_socket_::to_byte_range( data ), flags, addr );
+		auto res = _tx( data.size(), [&] {
+			return port_layer::sendto( _handle, _detail_socket_::to_byte_range( data ), flags, addr );
+		} );
 		return {data.subview( res.value_or( 0 ) ), res};
 	}
 
@@ -137,9 +207,31 @@ public:
 		ReturnValue<txrx_size_t> result;
 	};
 
+	/**
+	 * Runs f, which returns a RecvResult, but may issue several receive calls to get it (e.g. the non-blocking polls
+	 * of a spin-then-block receive) and records only the final outcome as a single receive in the stats.
+	 */
+	template<class F>
+	RecvResult record_as_single_rx( F&& f ) noexcept
+	{
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		if( !_stats || _rx_stats_suspended ) { return f(); }
+		const auto start    = std::chrono::steady_clock::now();
+		_rx_stats_suspended = true;
+		auto res            = f();
+		_rx_stats_suspended = false;
+		const auto received = static_cast<std::size_t>( res.result.value_or( 0 ) );
+		_stats->record_rx( res.result.error_code(), received, 1, std::chrono::steady_clock::now() - start );
+		return res;
+#else
+		return f();
+#endif
+	}
+
 	RecvResult recv( mart::MemoryView buffer, int flags )
 	{
-		auto res = port_layer::recv( _handle, _detail_socket_::to_mutable_byte_range( buffer ), flags );
+		auto res = _rx(
+			[&] { return port_layer::recv( _handle, _detail_socket_::to_mutable_byte_range( buffer ), flags ); } );
 		if( res.success() ) {
 			return {buffer.subview( 0, res.value() ), res};
 		} else {
@@ -149,7 +241,126 @@ public:
 
 	RecvResult recvfrom( mart::MemoryView buffer, int flags, Sockaddr& src_addr )
 	{
-		auto res = port_layer::recvfrom( _handle, _detail_socket_::to_mutable_byte_range( buffer ), flags, src_addr );
+		auto res = _rx( [&] {
+			return port_layer::recvfrom( _handle, _detail_socket_::to_mutable_byte_range( buffer ), flags, src_addr );
+		} );
+		if( res.success() ) {
+			return {buffer.subview( 0, res.value() ), res};
+		} else {
+			return {mart::MemoryView{}, res};
+		}
+	}
+
+	/* ###### scatter / gather send / recv (see port_layer::sendv / recvv) ############### */
+	ReturnValue<txrx_size_t> send( mart::ArrayView<const mart::ConstMemoryView> data, int flags = 0 ) noexcept
+	{
+		const _detail_socket_::ByteRanges<byte_range> ranges( data );
+		return _tx( _total_size( data ),
+					[&] { return port_layer::sendv( _handle, ranges.data(), ranges.size(), flags ); } );
+	}
+
+	ReturnValue<txrx_size_t>
+	sendto( mart::ArrayView<const mart::ConstMemoryView> data, int flags, const Sockaddr& addr ) noexcept
+	{
+		const _detail_socket_::ByteRanges<byte_range> ranges( data );
+		return _tx( _total_size( data ),
+					[&] { return port_layer::sendv( _handle, ranges.data(), ranges.size(), flags, &addr ); } );
+	}
+
+	ReturnValue<txrx_size_t> recv( mart::ArrayView<const mart::MemoryView> buffers, int flags ) noexcept
+	{
+		const _detail_socket_::ByteRanges<byte_range_mut> ranges( buffers );
+		return _rx( [&] { return port_layer::recvv( _handle, ranges.data(), ranges.size(), flags ); } );
+	}
+
+	ReturnValue<txrx_size_t>
+	recvfrom( mart::ArrayView<const mart::MemoryView> buffers, int flags, Sockaddr& src_addr ) noexcept
+	{
+		const _detail_socket_::ByteRanges<byte_range_mut> ranges( buffers );
+		return _rx( [&] { return port_layer::recvv( _handle, ranges.data(), ranges.size(), flags, &src_addr ); } );
+	}
+
+	/* ###### batched send / recv (see port_layer::sendmmsg / recvmmsg) ############### */
+	ReturnValue<int> sendmmsg( mart::ArrayView<port_layer::SendMsg> msgs, int flags ) noexcept
+	{
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		const auto start = std::chrono::steady_clock::now();
+		const auto res   = port_layer::sendmmsg( _handle, msgs.data(), msgs.size(), flags );
+		if( _stats ) {
+			const auto  cnt       = static_cast<std::size_t>( res.value_or( 0 ) );
+			std::size_t requested = 0;
+			std::size_t sent      = 0;
+			for( std::size_t i = 0; i < msgs.size(); ++i ) {
+				requested += msgs[i].data.size();
+				if( i < cnt ) { sent += static_cast<std::size_t>( msgs[i].size ); }
+			}
+			_stats->record_tx( res.error_code(), requested, sent, cnt, std::chrono::steady_clock::now() - start );
+		}
+		return res;
+#else
+		return port_layer::sendmmsg( _handle, msgs.data(), msgs.size(), flags );
+#endif
+	}
+
+	ReturnValue<int> recvmmsg( mart::ArrayView<port_layer::RecvMsg> msgs, int flags ) noexcept
+	{
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		const auto start = std::chrono::steady_clock::now();
+		const auto res   = port_layer::recvmmsg( _handle, msgs.data(), msgs.size(), flags );
+		if( _stats ) {
+			const auto  cnt      = static_cast<std::size_t>( res.value_or( 0 ) );
+			std::size_t received = 0;
+			for( std::size_t i = 0; i < cnt; ++i ) {
+				received += static_cast<std::size_t>( msgs[i].size );
+			}
+			_stats->record_rx( res.error_code(), received, cnt, std::chrono::steady_clock::now() - start );
+		}
+		return res;
+#else
+		return port_layer::recvmmsg( _handle, msgs.data(), msgs.size(), flags );
+#endif
+	}
+
+	/* ###### udp segmentation offload (see port_layer::send_segmented / recv_coalesced) ############### */
+	SendResult
+	send_segmented( mart::ConstMemoryView data, int flags, const Sockaddr* to, std::uint16_t segment_size ) noexcept
+	{
+		auto res = _tx( data.size(), [&] {
+			return port_layer::send_segmented(
+				_handle, _detail_socket_::to_byte_range( data ), flags, to, segment_size );
+		} );
+		return {data.subview( res.value_or( 0 ) ), res};
+	}
+
+	RecvResult recv_coalesced( mart::MemoryView buffer, int flags, Sockaddr* from, int& segment_size ) noexcept
+	{
+		auto res = _rx( [&] {
+			return port_layer::recv_coalesced(
+				_handle, _detail_socket_::to_mutable_byte_range( buffer ), flags, from, segment_size );
+		} );
+		if( res.success() ) {
+			return {buffer.subview( 0, res.value() ), res};
+		} else {
+			return {mart::MemoryView{}, res};
+		}
+	}
+
+	/* ###### kernel receive timestamps (see port_layer::enable_rx_timestamps / recv_timestamped) ############### */
+	ErrorCode enable_rx_timestamps( bool enable ) noexcept
+	{
+		return port_layer::enable_rx_timestamps( _handle, enable );
+	}
+
+	RecvResult recv_timestamped( mart::MemoryView          buffer,
+								 int                       flags,
+								 Sockaddr*                 from,
+								 std::chrono::nanoseconds& timestamp,
+								 bool*                     truncated = nullptr ) noexcept
+	{
+		auto res = _rx( [&] {
+			return port_layer::recv_timestamped(
+				_handle, _detail_socket_::to_mutable_byte_range( buffer ), flags, from, timestamp, truncated );
+		} );
 		if( res.success() ) {
 			return {buffer.subview( 0, res.value() ), res};
 		} else {
@@ -157,6 +368,33 @@ public:
 		}
 	}
 
+	/* ###### zero copy transmission (see port_layer::send_zerocopy / read_zerocopy_completions) ############### */
+	SendResult send_zerocopy( mart::ConstMemoryView data, int flags ) noexcept
+	{
+		auto res = _tx( data.size(), [&] {
+			return port_layer::send_zerocopy( _handle, _detail_socket_::to_byte_range( data ), flags );
+		} );
+		return {data.subview( res.value_or( 0 ) ), res};
+	}
+
+	ReturnValue<int> read_zerocopy_completions( mart::ArrayView<port_layer::ZerocopyCompletion> completions,
+												std::chrono::milliseconds                       timeout ) noexcept
+	{
+		return port_layer::read_zerocopy_completions( _handle, completions.data(), completions.size(), timeout );
+	}
+
+	// false on timeout (negative timeout: wait indefinitely, zero: just check)
+	ReturnValue<bool> wait_readable( std::chrono::microseconds timeout ) const noexcept
+	{
+		return port_layer::wait_readable( _handle, timeout );
+	}
+
+	/* ###### file transmission (see port_layer::send_file) ############### */
+	ReturnValue<txrx_size_t> send_file( int file_fd, std::int64_t& offset, std::size_t count ) noexcept
+	{
+		return _tx( count, [&] { return port_layer::send_file( _handle, file_fd, offset, count ); } );
+	}
+
 	/* ###### connection related ############### */
 
 	auto bind( const Sockaddr& addr ) noexcept { return port_layer::bind( _handle, addr ); }
@@ -175,14 +413,19 @@ public:
 		}
 	}
 
-	RaiiSocket accept( Sockaddr& remote_addr ) noexcept
+	RaiiSocket accept( Sockaddr& remote_addr ) noexcept { return accept( remote_addr, false ); }
+
+	// The blocking mode of the new socket is set as part of the accept call (no additional syscall on linux)
+	RaiiSocket accept( Sockaddr& remote_addr, bool non_blocking ) noexcept
 	{
-		auto res = port_layer::accept( _handle, remote_addr );
+		auto       res = port_layer::accept( _handle, remote_addr, non_blocking );
+		RaiiSocket ret;
 		if( res ) {
-			return RaiiSocket( res.value() );
-		} else {
-			return RaiiSocket{};
+			ret._handle      = res.value();
+			ret._is_blocking = !non_blocking;
+			ret._init_stats();
 		}
+		return ret;
 	}
 
 	auto getsockname( Sockaddr& src_addr ) const noexcept { return port_layer::getsockname( _handle, src_addr );	}
@@ -243,6 +486,7 @@ private:
 		if( res ) {
 			_handle = res.value();
 			_setBlocking_uncached( true );
+			_init_stats();
 		}
 		return res.error_code();
 	}
@@ -254,8 +498,66 @@ private:
 		return res;
 	}
 
+	/*
+	 * Wrappers around the actual send / recv calls, which update the stats (if enabled).
+	 * Without MART_NETLIB_ENABLE_SOCKET_STATS, they just call f.
+	 */
+	template<class F>
+	auto _tx( std::size_t requested, F&& f ) noexcept -> decltype( f() )
+	{
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		const auto start = std::chrono::steady_clock::now();
+		const auto res   = f();
+		if( _stats ) {
+			const auto sent = static_cast<std::size_t>( res.value_or( 0 ) );
+			_stats->record_tx( res.error_code(), requested, sent, 1, std::chrono::steady_clock::now() - start );
+		}
+		return res;
+#else
+		(void)requested;
+		return f();
+#endif
+	}
+
+	template<class F>
+	auto _rx( F&& f ) noexcept -> decltype( f() )
+	{
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		const auto start = std::chrono::steady_clock::now();
+		const auto res   = f();
+		if( _stats && !_rx_stats_suspended ) {
+			const auto received = static_cast<std::size_t>( res.value_or( 0 ) );
+			_stats->record_rx( res.error_code(), received, 1, std::chrono::steady_clock::now() - start );
+		}
+		return res;
+#else
+		return f();
+#endif
+	}
+
+	static std::size_t _total_size( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
+	{
+		std::size_t total = 0;
+		for( const auto& d : data ) {
+			total += d.size();
+		}
+		return total;
+	}
+
+	void _init_stats() noexcept
+	{
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+		if( !_stats ) { _stats.reset( new( std::nothrow ) SocketStats() ); }
+		if( _stats ) { _stats->set_handle( _handle ); }
+#endif
+	}
+
 	port_layer::handle_t _handle      = port_layer::handle_t::Invalid;
 	bool                 _is_blocking = true;
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+	std::unique_ptr<SocketStats> _stats;
+	bool                         _rx_stats_suspended = false; // see record_as_single_rx
+#endif
 };
 
 } // namespace socks
@@ -195,9 +195,32 @@ enum class TransportType {
 
 enum class Protocol { Default, Udp, Tcp };
 
-enum class SocketOptionLevel { Socket };
+enum class SocketOptionLevel { Socket, Udp, Ip };
+
+enum class SocketOption {
+	so_rcvtimeo,
+	so_sndtimeo,
+	so_reuseaddr,
+	udp_segment,  // SocketOptionLevel::Udp, int: default segment size for udp segmentation offload (linux only)
+	udp_gro,      // SocketOptionLevel::Udp, int: receive coalesced datagrams (linux only)
+	so_zerocopy,  // SocketOptionLevel::Socket, int: allow send_zerocopy to avoid copying the data (linux only)
+	so_reuseport, // SocketOptionLevel::Socket, int: several sockets may bind to the same address (not on windows)
+	so_rcvbuf,    // SocketOptionLevel::Socket, int: size of the kernel receive buffer
+	so_sndbuf,    // SocketOptionLevel::Socket, int: size of the kernel send buffer
+	so_busy_poll, // SocketOptionLevel::Socket, int: us to busy poll the device queue on blocking receives (linux only)
+
+	ip_multicast_ttl,   // SocketOptionLevel::Ip, int: time to live of outgoing multicast datagrams (default: 1)
+	ip_multicast_loop,  // SocketOptionLevel::Ip, int: deliver sent multicast datagrams to local members (default: 1)
+	ip_multicast_if,    // SocketOptionLevel::Ip, uint32_net_t: interface (address) for outgoing multicast datagrams
+	ip_add_membership,  // SocketOptionLevel::Ip, MulticastRequest: join a multicast group
+	ip_drop_membership, // SocketOptionLevel::Ip, MulticastRequest: leave a multicast group
+};
 
-enum class SocketOption { so_rcvtimeo, so_sndtimeo, so_reuseaddr };
+// option value of ip_add_membership / ip_drop_membership (same layout as ip_mreq)
+struct MulticastRequest {
+	uint32_net_t group;           // multicast group address
+	uint32_net_t local_interface; // address of the interface on which to join the group (0: chosen by the kernel)
+};
 
 enum class Direction { Tx, Rx };
 
@@ -239,7 +262,10 @@ enum class ErrorCodeValues : int {
 	NoError         = 0,
 	TryAgain        = EAGAIN,
 	InvalidArgument = EINVAL,
+	NotSupported    = EOPNOTSUPP,
 	WouldBlock      = EWOULDBLOCK,
+	MessageSize     = EMSGSIZE,
+	NoBufferSpace   = ENOBUFS,
 	Timeout         = 10060,     // Windows
 	WsaeConnReset   = 0x00002746 // Windows WSAECONNRESET ECONNRESET
 };
@@ -0,0 +1,70 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_BYTE_ORDER_HPP
+#define LIB_MART_COMMON_GUARD_NW_BYTE_ORDER_HPP
+/**
+ * byte_order.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Byte order conversion of whole arrays (e.g. the samples in a packet)
+ *
+ * Array versions of to_host_order / to_net_order from basic_types.hpp. On x86-64 (gcc / clang), the bytes are
+ * swapped with SSSE3 or AVX2 shuffles, if the cpu supports them (checked at runtime), elsewhere by a scalar loop.
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "basic_types.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <cstdint>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+/*#### array conversion #########*/
+// src and dst must have the same size and must either be identical or not overlap at all
+
+void to_host_order( mart::ArrayView<const uint16_net_t> src, mart::ArrayView<uint16_host_t> dst ) noexcept;
+void to_host_order( mart::ArrayView<const uint32_net_t> src, mart::ArrayView<uint32_host_t> dst ) noexcept;
+void to_host_order( mart::ArrayView<const uint64_net_t> src, mart::ArrayView<uint64_host_t> dst ) noexcept;
+
+void to_net_order( mart::ArrayView<const uint16_host_t> src, mart::ArrayView<uint16_net_t> dst ) noexcept;
+void to_net_order( mart::ArrayView<const uint32_host_t> src, mart::ArrayView<uint32_net_t> dst ) noexcept;
+void to_net_order( mart::ArrayView<const uint64_host_t> src, mart::ArrayView<uint64_net_t> dst ) noexcept;
+
+// In place conversion of integers, that were e.g. copied from a packet in network byte order (and vice versa)
+void to_host_order_in_place( mart::ArrayView<std::uint16_t> data ) noexcept;
+void to_host_order_in_place( mart::ArrayView<std::uint32_t> data ) noexcept;
+void to_host_order_in_place( mart::ArrayView<std::uint64_t> data ) noexcept;
+
+void to_net_order_in_place( mart::ArrayView<std::uint16_t> data ) noexcept;
+void to_net_order_in_place( mart::ArrayView<std::uint32_t> data ) noexcept;
+void to_net_order_in_place( mart::ArrayView<std::uint64_t> data ) noexcept;
+
+// Reverses the bytes of each element (independent of the host byte order)
+void bswap( mart::ArrayView<const std::uint16_t> src, mart::ArrayView<std::uint16_t> dst ) noexcept;
+void bswap( mart::ArrayView<const std::uint32_t> src, mart::ArrayView<std::uint32_t> dst ) noexcept;
+void bswap( mart::ArrayView<const std::uint64_t> src, mart::ArrayView<std::uint64_t> dst ) noexcept;
+
+/*#### kernel selection (mainly for tests and benchmarks) #########*/
+
+enum class ByteSwapKernel { Scalar, Ssse3, Avx2 };
+
+// the fastest kernel supported by this build and cpu (used by default)
+ByteSwapKernel best_byte_swap_kernel() noexcept;
+// the kernel currently used by the array conversions
+ByteSwapKernel byte_swap_kernel() noexcept;
+// returns false (and keeps the current kernel), if kernel isn't supported by this build or cpu
+bool set_byte_swap_kernel( ByteSwapKernel kernel ) noexcept;
+
+} // namespace mart::nw
+
+#endif
@@ -0,0 +1,575 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_CORO_HPP
+#define LIB_MART_COMMON_GUARD_NW_CORO_HPP
+/**
+ * coro.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	C++20 coroutine support: awaitable socket operations and a single threaded scheduler
+ *
+ * Allows writing non-blocking protocol code as straight-line code:
+ *
+ *     coro::Task<void> echo( tcp::Socket sock ) {
+ *         char buffer[1024];
+ *         while( true ) {
+ *             auto data = co_await sock.async_recv( mart::view_bytes_mutable( buffer ) );
+ *             if( data.empty() ) { co_return; }
+ *             co_await sock.async_send( data );
+ *         }
+ *     }
+ *
+ * Every operation is first tried directly. Only if it would block, the coroutine gets suspended until the
+ * Scheduler (which waits on a Reactor) sees the socket become readable / writable.
+ * The awaitables may only be used in coroutines that run on a Scheduler (on the scheduler's thread).
+ * Sockets are switched to non-blocking mode on first use and must not be closed while an operation is pending.
+ *
+ * NOTE: Only available when compiling as C++20 and - like the Reactor - only implemented for linux (epoll).
+ * The rest of the library stays C++17.
+ */
+
+#if !defined( __cpp_impl_coroutine ) || !__has_include( <coroutine> )
+#error "mart-netlib/coro.hpp requires C++20 coroutine support"
+#endif
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "reactor.hpp"
+#include "tcp.hpp"
+
+#include "detail/socket_base.hpp"
+
+#include <mart-netlib/network_exceptions.hpp>
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::coro {
+
+template<class T>
+class Task;
+
+namespace detail {
+
+template<class T>
+struct TaskPromiseStorage {
+	std::optional<T> value;
+	void             return_value( T v ) { value.emplace( std::move( v ) ); }
+	T                take() { return std::move( *value ); }
+};
+
+template<>
+struct TaskPromiseStorage<void> {
+	void return_void() noexcept {}
+	void take() noexcept {}
+};
+
+template<class T>
+struct TaskPromise : TaskPromiseStorage<T> {
+	std::coroutine_handle<> continuation = std::noop_coroutine();
+	std::exception_ptr      exception;
+
+	Task<T>             get_return_object() noexcept;
+	std::suspend_always initial_suspend() noexcept { return {}; }
+
+	// resumes whoever awaited the task (symmetric transfer - no stack growth for long await chains)
+	struct FinalAwaiter {
+		bool                    await_ready() noexcept { return false; }
+		std::coroutine_handle<> await_suspend( std::coroutine_handle<TaskPromise> h ) noexcept
+		{
+			return h.promise().continuation;
+		}
+		void await_resume() noexcept {}
+	};
+	FinalAwaiter final_suspend() noexcept { return {}; }
+
+	void unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+/*
+ * An operation that couldn't be completed right away. try_complete is called by the scheduler whenever the
+ * socket becomes ready and returns true once the operation finished (successfully or with an error).
+ */
+struct Waiter {
+	std::coroutine_handle<> handle;
+	virtual bool            try_complete() noexcept = 0;
+
+protected:
+	~Waiter() = default;
+};
+
+inline bool would_block( socks::ErrorCode error ) noexcept
+{
+	using socks::ErrorCodeValues;
+	const auto v = error.value();
+	return v == ErrorCodeValues::WouldBlock || v == ErrorCodeValues::TryAgain;
+}
+
+[[noreturn]] inline void throw_error( socks::ErrorCode error, std::string_view what )
+{
+	ip::tcp::_detail_tcp_::throw_error( error, what );
+}
+
+} // namespace detail
+
+/**
+ * Lazily started coroutine, that produces a T (or rethrows the exception that escaped the coroutine body).
+ * The coroutine starts running when the task is co_awaited or handed to Scheduler::spawn.
+ */
+template<class T = void>
+class [[nodiscard]] Task {
+public:
+	using promise_type = detail::TaskPromise<T>;
+
+	Task() noexcept = default;
+	Task( Task&& other ) noexcept
+		: _handle( std::exchange( other._handle, nullptr ) )
+	{
+	}
+	Task& operator=( Task&& other ) noexcept
+	{
+		Task( std::move( other ) ).swap( *this );
+		return *this;
+	}
+	~Task()
+	{
+		if( _handle ) { _handle.destroy(); }
+	}
+
+	void swap( Task& other ) noexcept { std::swap( _handle, other._handle ); }
+
+	bool valid() const noexcept { return _handle != nullptr; }
+
+	auto operator co_await() && noexcept
+	{
+		struct Awaiter {
+			std::coroutine_handle<promise_type> handle;
+
+			bool                    await_ready() noexcept { return !handle || handle.done(); }
+			std::coroutine_handle<> await_suspend( std::coroutine_handle<> awaiting ) noexcept
+			{
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+			T await_resume()
+			{
+				assert( handle && "Awaited an empty task" );
+				if( handle.promise().exception ) { std::rethrow_exception( handle.promise().exception ); }
+				return handle.promise().take();
+			}
+		};
+		return Awaiter{ _handle };
+	}
+
+private:
+	explicit Task( std::coroutine_handle<promise_type> handle ) noexcept
+		: _handle( handle )
+	{
+	}
+
+	std::coroutine_handle<promise_type> _handle = nullptr;
+
+	friend promise_type;
+};
+
+template<class T>
+Task<T> detail::TaskPromise<T>::get_return_object() noexcept
+{
+	return Task<T>( std::coroutine_handle<TaskPromise>::from_promise( *this ) );
+}
+
+/**
+ * Runs coroutines on the calling thread and resumes them, when the socket they are waiting for becomes ready.
+ * One scheduler can drive any number of connections - there is no per connection thread or allocation
+ * (apart from the coroutine frames themselves).
+ */
+class Scheduler {
+public:
+	using clock = Reactor::clock;
+
+	Scheduler() = default;
+	~Scheduler()
+	{
+		// destroying the root frames also destroys all tasks they are awaiting
+		for( void* h : _roots ) {
+			std::coroutine_handle<>::from_address( h ).destroy();
+		}
+	}
+
+	Scheduler( const Scheduler& ) = delete;
+	Scheduler& operator=( const Scheduler& ) = delete;
+
+	// Starts task on the next iteration of run(). Can be called from within a coroutine
+	void spawn( Task<void> task )
+	{
+		auto h = _run_root( *this, std::move( task ) ).handle;
+		_roots.insert( h.address() );
+		_ready.push_back( h );
+	}
+
+	/**
+	 * Runs the spawned tasks until all of them are finished or stop() is called.
+	 * Rethrows the first exception that escaped a spawned task (after that task was finished).
+	 */
+	void run()
+	{
+		Scheduler* const previous = std::exchange( _current, this );
+		struct Restore {
+			Scheduler* previous;
+			~Restore() { _current = previous; }
+		} restore{ previous };
+
+		_stop = false;
+		while( !_stop ) {
+			while( !_ready.empty() && !_stop ) {
+				auto h = _ready.front();
+				_ready.pop_front();
+				h.resume();
+				if( _exception ) { std::rethrow_exception( std::exchange( _exception, nullptr ) ); }
+			}
+			if( _roots.empty() || _stop ) { break; }
+			_reactor.run_once( _ready.empty() ? std::chrono::milliseconds( -1 ) : std::chrono::milliseconds( 0 ) );
+		}
+	}
+
+	// Makes run() return after the currently running coroutine suspended. Unfinished tasks stay suspended
+	void stop() noexcept { _stop = true; }
+
+	std::size_t task_count() const noexcept { return _roots.size(); }
+
+	// Suspends the awaiting coroutine for (at least) duration
+	auto sleep_for( clock::duration duration )
+	{
+		struct Awaiter {
+			Scheduler&      scheduler;
+			clock::duration duration;
+
+			bool await_ready() const noexcept { return duration <= clock::duration::zero(); }
+			void await_suspend( std::coroutine_handle<> h )
+			{
+				scheduler._reactor.add_timer( duration, [s = &scheduler, h] { s->_ready.push_back( h ); } );
+			}
+			void await_resume() noexcept {}
+		};
+		return Awaiter{ *this, duration };
+	}
+
+	// The scheduler that is currently executing run() on this thread (nullptr, if none)
+	static Scheduler* current() noexcept { return _current; }
+
+	/**
+	 * Used by the awaitables: calls waiter.try_complete() whenever handle becomes ready for interest (Read or Write).
+	 * Only one coroutine at a time can wait for a socket to become readable (and one for writable) - throws,
+	 * if there already is one.
+	 */
+	void wait( socks::port_layer::handle_t handle, Interest interest, detail::Waiter& waiter )
+	{
+		auto& state = _fds[handle];
+		auto& slot  = interest == Interest::Read ? state.reader : state.writer;
+		if( slot && slot != &waiter ) {
+			if( interest == Interest::Read ) {
+				throw generic_nw_error( "Another coroutine is already waiting to receive from this socket" );
+			}
+			throw generic_nw_error( "Another coroutine is already waiting to send via this socket" );
+		}
+		slot = &waiter;
+
+		if( state.registered ) {
+			_reactor.modify( handle, state.interest() );
+		} else {
+			auto cb = [this, handle]( Events ev ) { _on_ready( handle, ev ); };
+			_reactor.add( handle, state.interest(), std::move( cb ), TriggerMode::OneShot );
+			state.registered = true;
+		}
+	}
+
+private:
+	// detached coroutine, that runs a spawned task and removes itself from the scheduler, when the task is done
+	struct Root {
+		struct promise_type {
+			promise_type( Scheduler& scheduler, Task<void>& ) noexcept
+				: scheduler( scheduler )
+			{
+			}
+
+			Root get_return_object() noexcept { return { std::coroutine_handle<promise_type>::from_promise( *this ) }; }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+
+			struct FinalAwaiter {
+				bool await_ready() noexcept { return false; }
+				bool await_suspend( std::coroutine_handle<promise_type> h ) noexcept
+				{
+					h.promise().scheduler._roots.erase( h.address() );
+					return false; // don't suspend -> the frame destroys itself
+				}
+				void await_resume() noexcept {}
+			};
+			FinalAwaiter final_suspend() noexcept { return {}; }
+			void         return_void() noexcept {}
+			void         unhandled_exception() noexcept { std::terminate(); }
+
+			Scheduler& scheduler;
+		};
+		std::coroutine_handle<> handle;
+	};
+
+	static Root _run_root( Scheduler& self, Task<void> task )
+	{
+		try {
+			co_await std::move( task );
+		} catch( ... ) {
+			if( !self._exception ) { self._exception = std::current_exception(); }
+		}
+	}
+
+	struct FdState {
+		detail::Waiter* reader     = nullptr;
+		detail::Waiter* writer     = nullptr;
+		bool            registered = false;
+
+		Interest interest() const noexcept
+		{
+			return ( reader ? Interest::Read : Interest::None ) | ( writer ? Interest::Write : Interest::None );
+		}
+	};
+
+	void _on_ready( socks::port_layer::handle_t handle, Events ev )
+	{
+		auto it = _fds.find( handle );
+		if( it == _fds.end() ) { return; }
+		auto& state = it->second;
+
+		// on errors / hangup, the operations themselves report what happened
+		const bool failed = ev.error || ev.hangup;
+		if( state.reader && ( ev.readable || failed ) && state.reader->try_complete() ) {
+			_ready.push_back( std::exchange( state.reader, nullptr )->handle );
+		}
+		if( state.writer && ( ev.writable || failed ) && state.writer->try_complete() ) {
+			_ready.push_back( std::exchange( state.writer, nullptr )->handle );
+		}
+
+		if( state.interest() != Interest::None ) {
+			_reactor.modify( handle, state.interest() ); // re-arm the one shot registration
+		} else {
+			// don't keep idle sockets registered - they might get closed and the handle reused
+			_reactor.remove( handle );
+			_fds.erase( it );
+		}
+	}
+
+	static inline thread_local Scheduler* _current = nullptr;
+
+	Reactor                                                  _reactor;
+	std::deque<std::coroutine_handle<>>                      _ready;
+	std::unordered_set<void*>                                _roots; // addresses of the root frames
+	std::unordered_map<socks::port_layer::handle_t, FdState> _fds;
+	std::exception_ptr                                       _exception;
+	bool                                                     _stop = false;
+};
+
+namespace detail {
+
+// common part of all socket awaitables: try first, only suspend if the operation would block
+template<class Derived, Interest interest>
+struct SocketAwaitable : Waiter {
+	explicit SocketAwaitable( socks::RaiiSocket& socket ) noexcept
+		: socket( socket )
+	{
+	}
+
+	bool await_ready() noexcept
+	{
+		if( socket.is_blocking() ) { (void)socket.set_blocking( false ); }
+		return static_cast<Derived*>( this )->try_complete();
+	}
+	void await_suspend( std::coroutine_handle<> h )
+	{
+		Scheduler* const scheduler = Scheduler::current();
+		assert( scheduler && "Socket operations can only be awaited in coroutines that run on a Scheduler" );
+		handle = h;
+		scheduler->wait( socket.get_handle(), interest, *this );
+	}
+
+	socks::RaiiSocket& socket;
+	socks::ErrorCode   error = socks::ErrorCode::Ok();
+};
+
+} // namespace detail
+
+// Result: the received data (a prefix of the buffer). Empty, if the peer closed the connection. Throws on errors
+class RecvAwaitable : public detail::SocketAwaitable<RecvAwaitable, Interest::Read> {
+public:
+	RecvAwaitable( socks::RaiiSocket& socket, mart::MemoryView buffer ) noexcept
+		: SocketAwaitable( socket )
+		, _buffer( buffer )
+	{
+	}
+
+	bool try_complete() noexcept override
+	{
+		const auto res = socket.recv( _buffer, 0 );
+		if( res.result.success() ) {
+			_buffer = res.received_data;
+			return true;
+		}
+		error = res.result.error_code();
+		return !detail::would_block( error );
+	}
+
+	mart::MemoryView await_resume()
+	{
+		if( !error.success() && !detail::would_block( error ) ) {
+			detail::throw_error( error, "Failed to receive data. Details:  " );
+		}
+		return _buffer;
+	}
+
+private:
+	mart::MemoryView _buffer;
+};
+
+// Sends all of data (suspending as often as necessary). Throws on errors
+class SendAwaitable : public detail::SocketAwaitable<SendAwaitable, Interest::Write> {
+public:
+	SendAwaitable( socks::RaiiSocket& socket, mart::ConstMemoryView data ) noexcept
+		: SocketAwaitable( socket )
+		, _remaining( data )
+	{
+	}
+
+	bool try_complete() noexcept override
+	{
+		while( !_remaining.empty() ) {
+			const auto res = socket.send( _remaining, 0 );
+			if( !res.result.success() ) {
+				error = res.result.error_code();
+				return !detail::would_block( error );
+			}
+			_remaining = res.remaining_data;
+		}
+		error = socks::ErrorCode::Ok();
+		return true;
+	}
+
+	void await_resume()
+	{
+		if( !error.success() ) { detail::throw_error( error, "Failed to send data. Details:  " ); }
+	}
+
+private:
+	mart::ConstMemoryView _remaining;
+};
+
+// Result: the accepted connection (in non-blocking mode). Throws on errors
+class AcceptAwaitable : public detail::SocketAwaitable<AcceptAwaitable, Interest::Read> {
+public:
+	explicit AcceptAwaitable( ip::tcp::Acceptor& acceptor ) noexcept
+		: SocketAwaitable( acceptor.getSocket() )
+		, _acceptor( acceptor )
+	{
+	}
+
+	bool try_complete() noexcept override
+	{
+		_result = _acceptor._accept( ip::tcp::Acceptor::SocketMode::NonBlocking, error );
+		return _result->is_valid() || !detail::would_block( error );
+	}
+
+	ip::tcp::Socket await_resume()
+	{
+		if( !error.success() ) { detail::throw_error( error, "Failed to accept tcp connection. Details:  " ); }
+		return std::move( *_result );
+	}
+
+private:
+	ip::tcp::Acceptor&             _acceptor;
+	std::optional<ip::tcp::Socket> _result;
+};
+
+// Result: the received datagram and its source. Throws on errors
+template<class EndpointT>
+class RecvfromAwaitable : public detail::SocketAwaitable<RecvfromAwaitable<EndpointT>, Interest::Read> {
+	using Base = detail::SocketAwaitable<RecvfromAwaitable<EndpointT>, Interest::Read>;
+
+public:
+	using Socket         = socks::detail::DgramSocket<EndpointT>;
+	using RecvfromResult = typename Socket::RecvfromResult;
+
+	RecvfromAwaitable( Socket& socket, mart::MemoryView buffer ) noexcept
+		: Base( socket.as_raii_socket() )
+		, _dgram_socket( socket )
+		, _buffer( buffer )
+	{
+	}
+
+	bool try_complete() noexcept override
+	{
+		typename EndpointT::abi_endpoint_type addr{};
+
+		// the socket is non-blocking, so there is nothing to gain from the spin-then-block mode
+		const auto res = _dgram_socket._recvfrom_once( _buffer, 0, addr, _result.rx_timestamp, nullptr );
+		if( res.result.success() ) {
+			_result.data           = res.received_data;
+			_result.remote_address = EndpointT( addr );
+			return true;
+		}
+		this->error = res.result.error_code();
+		return !detail::would_block( this->error );
+	}
+
+	RecvfromResult await_resume()
+	{
+		if( !this->error.success() && !detail::would_block( this->error ) ) {
+			detail::throw_error( this->error, "Failed to receive datagram. Details:  " );
+		}
+		return _result;
+	}
+
+private:
+	Socket&          _dgram_socket;
+	mart::MemoryView _buffer;
+	RecvfromResult   _result{};
+};
+
+} // namespace mart::nw::coro
+
+/* ###### member functions of the socket classes, that return the awaitables ###### */
+
+namespace mart::nw::ip::tcp {
+
+inline coro::RecvAwaitable Socket::async_recv( mart::MemoryView buffer ) noexcept
+{
+	return { _socket, buffer };
+}
+
+inline coro::SendAwaitable Socket::async_send( mart::ConstMemoryView data ) noexcept
+{
+	return { _socket, data };
+}
+
+inline coro::AcceptAwaitable Acceptor::async_accept() noexcept
+{
+	assert( _state == State::listening );
+	return coro::AcceptAwaitable( *this );
+}
+
+} // namespace mart::nw::ip::tcp
+
+#endif
@@ -18,7 +18,9 @@
 /* ######## INCLUDES ######### */
 /* Project Includes */
 #include <mart-netlib/RaiiSocket.hpp>
+#include <mart-netlib/packet_pool.hpp>
 #include <mart-netlib/port_layer.hpp>
+#include <mart-netlib/spin_then_block.hpp>
 
 /* Proprietary Library Includes */
 #include <mart-common/ArrayView.h>
@@ -26,11 +28,18 @@
 
 /* Standard Library Includes */
 #include <chrono>
+#include <cstdint>
 
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
 namespace nw {
+
+namespace coro { // see coro.hpp (C++20)
+template<class EndpointT>
+class RecvfromAwaitable;
+} // namespace coro
+
 namespace socks {
 namespace detail {
 
@@ -77,8 +86,35 @@ public:
 	void close();
 
 	// clang-format on
+
+	// Returns false, if no data arrived within timeout (negative: wait indefinitely)
+	bool wait_readable( std::chrono::microseconds timeout );
+
+	/**
+	 * Spin-then-block receive mode (see spin_then_block.hpp): recv / recvfrom first busy poll with non-blocking
+	 * calls for up to max_spin (adapted to the recent inter-arrival times), before they fall back to a blocking call.
+	 * 0 (the default) disables it. Non-blocking sockets never spin.
+	 */
+	void set_spin_then_block( std::chrono::nanoseconds max_spin ) noexcept { _spin.set_max_spin( max_spin ); }
+	const SpinThenBlockStats& spin_then_block_stats() const noexcept { return _spin.stats(); }
+
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+	// see socket_stats.hpp
+	const socks::SocketStats* stats() const noexcept { return _socket.stats(); }
+#endif
 protected:
+	// recv_once( int flags ) -> RaiiSocket::RecvResult
+	template<class Recv>
+	RaiiSocket::RecvResult _spin_then_block_recv( Recv&& recv_once )
+	{
+		// the receive returns immediately anyway - spinning would only delay the would-block result
+		if( !_socket.is_blocking() || !_spin.enabled() ) { return recv_once( 0 ); }
+		// the failed polls while spinning are not separate receives as far as the socket stats are concerned
+		return _socket.record_as_single_rx( [&] { return _spin.recv( _socket.get_handle(), recv_once ); } );
+	}
+
 	nw::socks::RaiiSocket _socket;
+	SpinThenBlock         _spin;
 };
 
 /*
@@ -108,9 +144,23 @@ public:
 	}
 	void send( mart::ConstMemoryView data );
 
-	mart::MemoryView try_recv( mart::MemoryView buffer ) noexcept { return _socket.recv( buffer, 0 ).received_data; }
+	mart::MemoryView try_recv( mart::MemoryView buffer ) noexcept
+	{
+		return _spin_then_block_recv( [&]( int flags ) { return _socket.recv( buffer, flags ); } ).received_data;
+	}
 	mart::MemoryView recv( mart::MemoryView buffer );
 
+	/* Scatter / gather: the buffers are sent as / filled from a single datagram */
+	bool try_send( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
+	{
+		return _socket.send( data, 0 ).success();
+	}
+	void send( mart::ArrayView<const mart::ConstMemoryView> data );
+
+	// Returns the size of the received datagram (recv returns 0 on timeout / when the call would block)
+	socks::ReturnValue<std::size_t> try_recv( mart::ArrayView<const mart::MemoryView> buffers ) noexcept;
+	std::size_t                     recv( mart::ArrayView<const mart::MemoryView> buffers );
+
 	void clearRxBuff();
 };
 
@@ -153,28 +203,165 @@ public:
 		sendto( data, _ep_remote );
 	}
 
+	/* ###### scatter / gather ###### */
+	// data is sent as a single datagram (e.g. header + payload without copying them into one buffer first)
+	bool try_sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep ) noexcept
+	{
+		return _socket.sendto( data, 0, ep.toSockAddr() ).success();
+	}
+	void sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep );
+
+	struct ScatterRecvResult {
+		std::size_t size; // size of the datagram, that was distributed over the buffers (0: nothing received)
+		endpoint    remote_address;
+	};
+	ScatterRecvResult try_recvfrom( mart::ArrayView<const mart::MemoryView> buffers ) noexcept
+	{
+		typename EndpointT::abi_endpoint_type addr{};
+
+		auto res = _socket.recvfrom( buffers, 0, addr );
+		if( !res.success() ) { return { 0, endpoint{} }; }
+		return { static_cast<std::size_t>( res.value() ), endpoint( addr ) };
+	}
+	ScatterRecvResult recvfrom( mart::ArrayView<const mart::MemoryView> buffers );
+
+	/**
+	 * Sends data[i] to eps[i] with as few syscalls as possible (sendmmsg on linux).
+	 * If eps is empty, all datagrams are sent to the default remote endpoint (or the connected peer).
+	 *
+	 * The try_ version returns the number of datagrams that were sent before the first failure
+	 * (an error code, if not even the first one could be sent), send_batch throws, if not all datagrams could be sent
+	 */
+	socks::ReturnValue<std::size_t> try_send_batch( mart::ArrayView<const mart::ConstMemoryView> data,
+													mart::ArrayView<const endpoint>           eps = {} ) noexcept;
+	void send_batch( mart::ArrayView<const mart::ConstMemoryView> data, mart::ArrayView<const endpoint> eps = {} );
+
 	struct RecvfromResult {
 		mart::MemoryView data;
 		endpoint         remote_address;
+		// time at which the datagram arrived at the socket, as recorded by the kernel
+		// (only set by recvfrom / recv_batch and their try_ versions and only if rx timestamps are enabled)
+		std::chrono::system_clock::time_point rx_timestamp{};
 	};
 	RecvfromResult try_recvfrom( mart::MemoryView buffer ) noexcept
 	{
 		using abiep = typename EndpointT::abi_endpoint_type;
 		abiep addr{};
 
-		auto res = _socket.recvfrom( buffer, 0, addr );
+		std::chrono::system_clock::time_point rx_timestamp{};
+
+		auto res = _recvfrom( buffer, addr, rx_timestamp );
 
-		return { res.received_data, endpoint( addr ) };
+		return { res.received_data, endpoint( addr ), rx_timestamp };
 	}
 	RecvfromResult recvfrom( mart::MemoryView buffer );
 
+	// co_await: receives the next datagram (C++20 - only available if coro.hpp is included)
+	// NOTE: a template, so it isn't instantiated by the explicit instantiations in the (c++17) library
+	template<class Awaitable = coro::RecvfromAwaitable<EndpointT>>
+	Awaitable async_recvfrom( mart::MemoryView buffer ) noexcept
+	{
+		return Awaitable( *this, buffer );
+	}
+
+	/**
+	 * Lets the kernel timestamp incoming datagrams (SO_TIMESTAMPING / SO_TIMESTAMPNS), which - unlike taking the time
+	 * after recvfrom returned - doesn't include the time the datagram waited in the socket's receive queue
+	 * or the scheduling delay of the receiving thread. Returns false, if that isn't supported.
+	 * The timestamps are reported by recvfrom / recv_batch and used as rx_time of pooled packets.
+	 */
+	bool try_enable_rx_timestamps( bool enable = true ) noexcept;
+	bool rx_timestamps_enabled() const noexcept { return _rx_timestamps; }
+
+	// maximum number of datagrams that are received by a single call to recv_batch
+	static constexpr std::size_t max_recv_batch_size = 64;
+
+	/**
+	 * Waits (if blocking) for at least one datagram and then receives all immediately available datagrams
+	 * (up to max_recv_batch_size) with as few syscalls as possible (recvmmsg on linux).
+	 *
+	 * results[i] contains the part of buffers[i] that was filled with the i-th datagram and its source.
+	 * Returns the number of received datagrams (recv_batch returns 0 on timeout / when the call would block)
+	 */
+	socks::ReturnValue<std::size_t> try_recv_batch( mart::ArrayView<const mart::MemoryView> buffers,
+													mart::ArrayView<RecvfromResult>         results ) noexcept;
+	std::size_t recv_batch( mart::ArrayView<const mart::MemoryView> buffers, mart::ArrayView<RecvfromResult> results );
+
+	/* ###### pooled receive ###### */
+	using PacketPool = BasicPacketPool<endpoint>;
+	using Packet     = PooledPacket<endpoint>;
+
+	/**
+	 * Receives a datagram into a slab from pool and returns it as a refcounted packet
+	 * (data, source endpoint and receive time), that can be handed to other threads without copying.
+	 * The receive time is the kernel timestamp if rx timestamps are enabled and the current time otherwise.
+	 *
+	 * Both return an empty packet on timeout / when the call would block. Otherwise, recv_pooled throws and
+	 * try_recv_pooled returns an empty packet and sets error (if not nullptr), in particular to
+	 * - ErrorCodeValues::NoBufferSpace, if the pool is exhausted (the datagram stays in the socket's receive queue)
+	 * - ErrorCodeValues::MessageSize, if the datagram was larger than the slab size (it is dropped)
+	 */
+	Packet try_recv_pooled( PacketPool& pool, socks::ErrorCode* error = nullptr ) noexcept;
+	Packet recv_pooled( PacketPool& pool );
+
+	/* ###### udp segmentation offload ###### */
+
+	/**
+	 * Sends data as a sequence of datagrams with segment_size bytes each (the last one may be shorter)
+	 * to ep (or the default remote endpoint / connected peer).
+	 *
+	 * If the kernel supports udp segmentation offload (UDP_SEGMENT), up to 64 datagrams are handed to the kernel
+	 * as a single buffer, otherwise (or if the kernel rejects the request) this falls back to batched sending.
+	 * Returns the number of sent bytes (the try_ version reports an error, if not even the first datagram could be sent)
+	 */
+	socks::ReturnValue<std::size_t>
+	try_send_segmented( mart::ConstMemoryView data, std::size_t segment_size, const endpoint& ep ) noexcept;
+	socks::ReturnValue<std::size_t> try_send_segmented( mart::ConstMemoryView data, std::size_t segment_size ) noexcept;
+	void send_segmented( mart::ConstMemoryView data, std::size_t segment_size, const endpoint& ep );
+	void send_segmented( mart::ConstMemoryView data, std::size_t segment_size );
+
+	// false if udp segmentation offload isn't supported for this socket (send_segmented then uses the fallback)
+	bool supports_segmentation_offload() noexcept;
+
+	/**
+	 * Let the kernel coalesce consecutive datagrams from the same source into a single buffer (UDP_GRO).
+	 * Returns false, if that isn't supported. recv_coalesced still works in that case,
+	 * but only receives one datagram per call.
+	 */
+	bool try_enable_gro( bool enable = true ) noexcept;
+
+	struct CoalescedRecvResult {
+		mart::MemoryView data;
+		endpoint         remote_address;
+		// all datagrams in data have this size, except for the last one, which may be shorter
+		std::size_t segment_size;
+
+		std::size_t segment_count() const noexcept
+		{
+			return segment_size == 0 ? 0 : ( data.size() + segment_size - 1 ) / segment_size;
+		}
+		mart::MemoryView segment( std::size_t i ) const noexcept
+		{
+			return data.max_subview( i * segment_size, segment_size );
+		}
+	};
+
+	/**
+	 * Receives one or more coalesced datagrams. With GRO enabled, buffer should be
+	 * able to hold the largest possible udp datagram (64k), otherwise data gets truncated.
+	 * recv_coalesced returns an empty result on timeout / when the call would block.
+	 */
+	CoalescedRecvResult try_recv_coalesced( mart::MemoryView buffer ) noexcept;
+	CoalescedRecvResult recv_coalesced( mart::MemoryView buffer );
+
 	void clearRxBuff();
 
 	auto close()
 	{
 
-		_ep_local  = {};
-		_ep_remote = {};
+		_ep_local      = {};
+		_ep_remote     = {};
+		_rx_timestamps = false;
 		return DgramSocketBase::close();
 	}
 
@@ -187,12 +374,35 @@ public:
 	void set_default_remote_endpoint( endpoint ep ) noexcept { _ep_remote = std::move( ep ); }
 
 private:
+	friend coro::RecvfromAwaitable<EndpointT>;
+
 	static inline bool _txWasSuccess( mart::ConstMemoryView data, const mart::nw::socks::RaiiSocket::SendResult& ret )
 	{
 		return ret.result.success() && mart::narrow<nw::socks::txrx_size_t>( data.size() ) == ret.result.value();
 	}
-	endpoint _ep_local{};
-	endpoint _ep_remote{};
+	socks::ReturnValue<std::size_t>
+	_send_segmented( mart::ConstMemoryView data, std::size_t segment_size, const Sockaddr* to ) noexcept;
+	socks::ReturnValue<std::size_t>
+	_send_segments_individually( mart::ConstMemoryView data, std::size_t segment_size, const Sockaddr* to ) noexcept;
+
+	// truncated (if not nullptr) reports, whether the datagram was larger than buffer
+	nw::socks::RaiiSocket::RecvResult _recvfrom( mart::MemoryView                       buffer,
+												 typename EndpointT::abi_endpoint_type& addr,
+												 std::chrono::system_clock::time_point& rx_timestamp,
+												 bool*                                  truncated = nullptr ) noexcept;
+	nw::socks::RaiiSocket::RecvResult _recvfrom_once( mart::MemoryView                       buffer,
+													  int                                    flags,
+													  typename EndpointT::abi_endpoint_type& addr,
+													  std::chrono::system_clock::time_point& rx_timestamp,
+													  bool*                                  truncated ) noexcept;
+	Packet _recv_pooled( PacketPool& pool, socks::ErrorCode& error ) noexcept;
+
+	enum class OffloadSupport : std::uint8_t { Unknown, Yes, No };
+
+	endpoint       _ep_local{};
+	endpoint       _ep_remote{};
+	OffloadSupport _gso_support   = OffloadSupport::Unknown;
+	bool           _rx_timestamps = false;
 };
 
 } // namespace detail
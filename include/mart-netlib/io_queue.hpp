@@ -0,0 +1,135 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_IO_QUEUE_HPP
+#define LIB_MART_COMMON_GUARD_NW_IO_QUEUE_HPP
+/**
+ * io_queue.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Submission / completion queue for asynchronous recv, send and accept operations
+ *
+ * Operations are first prepared, then handed to the os with a single submit() call and their results are
+ * collected later on as completions (identified by a user provided tag).
+ * On linux kernels that support it (5.6+), the queue is backed by io_uring (using the raw syscalls, no liburing).
+ * Everywhere else - or if io_uring is disabled e.g. by a seccomp filter - the operations are executed by the
+ * regular port_layer functions, as soon as poll reports the socket as ready.
+ *
+ * NOTE: Like the rest of the port layer, this is supposed to be usable from c++11
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "port_layer.hpp"
+
+/* Standard Library Includes */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+namespace socks {
+namespace port_layer {
+
+enum class IoBackend {
+	Auto,    // io_uring if available, otherwise fallback
+	IoUring, // io_uring or nothing: if io_uring isn't available, the queue is invalid (see IoQueue::is_valid)
+	Fallback // always use poll + regular port_layer calls (e.g. for testing / comparison)
+};
+
+struct IoCompletion {
+	std::uint64_t user_data; // tag passed to the corresponding prepare_xxx call
+	ErrorCode     error;     // ErrorCodeValues::NoError on success
+	txrx_size_t   size;      // recv / send: number of transferred bytes
+	handle_t      handle;    // accept: the new connection (the caller has to close it)
+
+	bool success() const noexcept { return error.success(); }
+};
+
+class IoQueue {
+public:
+	// The number of entries is rounded up to the next power of two by the kernel
+	explicit IoQueue( unsigned entries = 256, IoBackend backend = IoBackend::Auto ) noexcept;
+	~IoQueue();
+
+	// the kernel keeps pointers into the queue's memory
+	IoQueue( const IoQueue& ) = delete;
+	IoQueue& operator=( const IoQueue& ) = delete;
+
+	// Checks (once per process), if the kernel supports io_uring with recv, send and accept
+	static bool io_uring_supported() noexcept;
+
+	// false, if IoBackend::IoUring was requested, but io_uring isn't available. An invalid queue must not be used
+	bool is_valid() const noexcept;
+
+	// The backend that is actually in use (never IoBackend::Auto)
+	IoBackend backend() const noexcept;
+
+	/* ###### registration ###### */
+
+	/**
+	 * Registers buffers with the kernel, such that the pages don't have to be mapped for every single operation.
+	 * Registered buffers are used by prepare_recv_fixed / prepare_send_fixed. Any previous registration is replaced.
+	 * The memory has to stay valid until unregister_buffers is called or the queue is destroyed.
+	 */
+	ErrorCode register_buffers( const byte_range_mut* buffers, std::size_t count ) noexcept;
+	ErrorCode unregister_buffers() noexcept;
+
+	/**
+	 * Registers socket handles with the kernel, which avoids the reference counting on the file for every operation.
+	 * Operations on a registered handle automatically use the registration. Any previous registration is replaced.
+	 * NOTE: the kernel keeps the sockets alive until they are unregistered (closing them is not enough)
+	 */
+	ErrorCode register_handles( const handle_t* handles, std::size_t count ) noexcept;
+	ErrorCode unregister_handles() noexcept;
+
+	/* ###### submission ###### */
+	// The prepare functions only queue the operation and return false, if the submission queue is full.
+	// The buffers have to stay valid until the corresponding completion was retrieved
+
+	bool prepare_recv( handle_t handle, byte_range_mut buffer, int flags, std::uint64_t user_data ) noexcept;
+	bool prepare_send( handle_t handle, byte_range buffer, int flags, std::uint64_t user_data ) noexcept;
+	bool prepare_accept( handle_t handle, std::uint64_t user_data ) noexcept;
+
+	// buffer has to lie within the registered buffer with index buffer_index
+	bool
+	prepare_recv_fixed( handle_t handle, byte_range_mut buffer, unsigned buffer_index, std::uint64_t user_data ) noexcept;
+	bool prepare_send_fixed( handle_t handle, byte_range buffer, unsigned buffer_index, std::uint64_t user_data ) noexcept;
+
+	// Hands all prepared operations to the os and returns their number
+	ReturnValue<int> submit() noexcept;
+
+	std::size_t prepared_count() const noexcept;
+	std::size_t in_flight_count() const noexcept;
+
+	/* ###### completion ###### */
+
+	// Copies up to count already available completions into out and returns their number (never blocks)
+	std::size_t peek_completions( IoCompletion* out, std::size_t count ) noexcept;
+
+	/**
+	 * Submits prepared operations and waits until at least min_complete completions are available
+	 * (or until no more operations are in flight). Then copies up to count completions into out.
+	 * Returns the number of copied completions.
+	 */
+	ReturnValue<int> wait_completions( IoCompletion* out, std::size_t count, std::size_t min_complete = 1 ) noexcept;
+
+private:
+	struct Impl;
+	struct UringImpl;
+	struct FallbackImpl;
+
+	std::unique_ptr<Impl> _impl;
+};
+
+} // namespace port_layer
+} // namespace socks
+} // namespace nw
+} // namespace mart
+
+#endif
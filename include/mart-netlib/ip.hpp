@@ -99,6 +99,39 @@ constexpr bool is_valid_v4_address( const std::string_view string )
 	return _impl_addr_v4::parse_address( string ).has_value();
 }
 
+// ##### Multicast groups
+
+// 224.0.0.0/4
+constexpr bool is_multicast( address_v4 addr ) noexcept
+{
+	return ( addr.inHostOrder() & 0xF0'00'00'00 ) == 0xE0'00'00'00;
+}
+
+// 224.0.0.0/24 (local network control block): never forwarded by routers, independent of the multicast ttl
+constexpr bool is_link_local_multicast( address_v4 addr ) noexcept
+{
+	return ( addr.inHostOrder() & 0xFF'FF'FF'00 ) == 0xE0'00'00'00;
+}
+
+// 239.0.0.0/8 (administratively scoped): the range for groups of applications within an organization
+constexpr bool is_admin_scoped_multicast( address_v4 addr ) noexcept
+{
+	return ( addr.inHostOrder() & 0xFF'00'00'00 ) == 0xEF'00'00'00;
+}
+
+constexpr address_v4 multicast_all_hosts( uint32_host_t{0xE0'00'00'01} ); // 224.0.0.1
+
+// Group address, if string is a valid ipv4 address within 224.0.0.0/4
+constexpr std::optional<address_v4> try_parse_multicast_group( const std::string_view string ) noexcept
+{
+	const auto res = try_parse_v4_address( string );
+	if( res && is_multicast( *res ) ) {
+		return res;
+	} else {
+		return {};
+	}
+}
+
 // ##### Port
 
 class port_nr {
@@ -0,0 +1,257 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_PACKET_POOL_HPP
+#define LIB_MART_COMMON_GUARD_NW_PACKET_POOL_HPP
+/**
+ * packet_pool.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Pool of fixed size receive buffers, that are handed out as refcounted packets
+ *
+ * All slabs are allocated up front. Free slabs are kept on a lock-free stack, so packets can be
+ * allocated and released from any thread without locks or heap allocations.
+ * A PooledPacket is a cheap handle (a single pointer) - copying it across threads only increments
+ * a reference count and the slab returns to the pool when the last handle is gone.
+ *
+ * NOTE: The pool has to outlive all packets that were allocated from it
+ */
+
+/* ######## INCLUDES ######### */
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+template<class EndpointT>
+class BasicPacketPool;
+
+namespace _detail_packet_pool_ {
+
+inline constexpr std::uint32_t no_slab = std::numeric_limits<std::uint32_t>::max();
+
+template<class EndpointT>
+struct alignas( 64 ) Slab { // separate cache lines, as different packets are usually used by different threads
+	std::atomic<std::uint32_t>            refs{ 0 };
+	std::atomic<std::uint32_t>            next_free{ no_slab };
+	std::size_t                           size = 0;
+	EndpointT                             source{};
+	std::chrono::system_clock::time_point rx_time{};
+	mart::ByteType*                       data = nullptr;
+	BasicPacketPool<EndpointT>*           pool = nullptr;
+};
+
+} // namespace _detail_packet_pool_
+
+/**
+ * Refcounted handle to a packet in a BasicPacketPool (or an empty handle).
+ * The packet content is immutable once it is shared - only the first owner (e.g. the receive function)
+ * may write into buffer() and set the packet information via assign().
+ */
+template<class EndpointT>
+class PooledPacket {
+public:
+	using endpoint   = EndpointT;
+	using time_point = std::chrono::system_clock::time_point;
+
+	PooledPacket() noexcept = default;
+	PooledPacket( const PooledPacket& other ) noexcept
+		: _slab( other._slab )
+	{
+		if( _slab ) { _slab->refs.fetch_add( 1, std::memory_order_relaxed ); }
+	}
+	PooledPacket( PooledPacket&& other ) noexcept
+		: _slab( std::exchange( other._slab, nullptr ) )
+	{
+	}
+	PooledPacket& operator=( const PooledPacket& other ) noexcept
+	{
+		PooledPacket( other ).swap( *this );
+		return *this;
+	}
+	PooledPacket& operator=( PooledPacket&& other ) noexcept
+	{
+		PooledPacket( std::move( other ) ).swap( *this );
+		return *this;
+	}
+	~PooledPacket() { reset(); }
+
+	void swap( PooledPacket& other ) noexcept { std::swap( _slab, other._slab ); }
+
+	// Drops this reference (the slab is returned to the pool, if this was the last one)
+	void reset() noexcept;
+
+	explicit operator bool() const noexcept { return _slab != nullptr; }
+
+	mart::ConstMemoryView data() const noexcept
+	{
+		return _slab ? mart::ConstMemoryView( _slab->data, _slab->size ) : mart::ConstMemoryView{};
+	}
+	std::size_t     size() const noexcept { return _slab ? _slab->size : 0; }
+	const endpoint& source() const noexcept
+	{
+		assert( _slab );
+		return _slab->source;
+	}
+	time_point rx_time() const noexcept { return _slab ? _slab->rx_time : time_point{}; }
+
+	long use_count() const noexcept
+	{
+		return _slab ? static_cast<long>( _slab->refs.load( std::memory_order_relaxed ) ) : 0;
+	}
+
+	/* ###### producer side ###### */
+
+	// The whole slab (only to be used while this is the only reference)
+	mart::MemoryView buffer() const noexcept;
+	// Sets the size of the valid data in buffer() and the packet information
+	void assign( std::size_t size, const endpoint& source, time_point rx_time ) noexcept;
+
+private:
+	using Slab = _detail_packet_pool_::Slab<EndpointT>;
+
+	explicit PooledPacket( Slab* slab ) noexcept
+		: _slab( slab )
+	{
+	}
+
+	Slab* _slab = nullptr;
+
+	friend class BasicPacketPool<EndpointT>;
+};
+
+template<class EndpointT>
+class BasicPacketPool {
+public:
+	using packet = PooledPacket<EndpointT>;
+
+	// slab_count is limited to 2^32-1
+	BasicPacketPool( std::size_t slab_size, std::size_t slab_count )
+		: _slab_size( slab_size )
+		, _slab_count( slab_count )
+		, _slabs( new Slab[slab_count] )
+		, _memory( new mart::ByteType[slab_size * slab_count] )
+	{
+		assert( slab_count < _detail_packet_pool_::no_slab );
+		for( std::size_t i = 0; i < slab_count; ++i ) {
+			_slabs[i].data = _memory.get() + i * slab_size;
+			_slabs[i].pool = this;
+			_slabs[i].next_free.store( i + 1 < slab_count ? static_cast<std::uint32_t>( i + 1 )
+														  : _detail_packet_pool_::no_slab,
+									   std::memory_order_relaxed );
+		}
+		_free_head.store( slab_count == 0 ? _detail_packet_pool_::no_slab : 0, std::memory_order_relaxed );
+		_available.store( slab_count, std::memory_order_relaxed );
+	}
+
+	// slabs keep a pointer to the pool
+	BasicPacketPool( const BasicPacketPool& ) = delete;
+	BasicPacketPool& operator=( const BasicPacketPool& ) = delete;
+
+	~BasicPacketPool() { assert( available() == _slab_count && "Packets must not outlive their pool" ); }
+
+	/**
+	 * Takes a slab from the pool. The returned packet is the only reference and has size 0.
+	 * Returns an empty packet, if the pool is exhausted.
+	 */
+	packet try_allocate() noexcept
+	{
+		// the upper 32 bits are a tag that is incremented on every change, which prevents the aba problem
+		std::uint64_t head = _free_head.load( std::memory_order_acquire );
+		while( index_of( head ) != _detail_packet_pool_::no_slab ) {
+			Slab&               slab = _slabs[index_of( head )];
+			const std::uint64_t next
+				= make_head( slab.next_free.load( std::memory_order_relaxed ), tag_of( head ) + 1 );
+			if( _free_head.compare_exchange_weak( head, next, std::memory_order_acquire, std::memory_order_acquire ) ) {
+				_available.fetch_sub( 1, std::memory_order_relaxed );
+				slab.refs.store( 1, std::memory_order_relaxed );
+				slab.size = 0;
+				return packet( &slab );
+			}
+		}
+		return packet{};
+	}
+
+	std::size_t slab_size() const noexcept { return _slab_size; }
+	std::size_t slab_count() const noexcept { return _slab_count; }
+	// number of free slabs (only a snapshot, if other threads are using the pool)
+	std::size_t available() const noexcept { return _available.load( std::memory_order_relaxed ); }
+
+private:
+	using Slab = _detail_packet_pool_::Slab<EndpointT>;
+
+	static constexpr std::uint32_t index_of( std::uint64_t head ) noexcept
+	{
+		return static_cast<std::uint32_t>( head );
+	}
+	static constexpr std::uint32_t tag_of( std::uint64_t head ) noexcept
+	{
+		return static_cast<std::uint32_t>( head >> 32 );
+	}
+	static constexpr std::uint64_t make_head( std::uint32_t index, std::uint32_t tag ) noexcept
+	{
+		return ( static_cast<std::uint64_t>( tag ) << 32 ) | index;
+	}
+
+	void release( Slab& slab ) noexcept
+	{
+		const auto    index = static_cast<std::uint32_t>( &slab - _slabs.get() );
+		std::uint64_t head  = _free_head.load( std::memory_order_relaxed );
+		do {
+			slab.next_free.store( index_of( head ), std::memory_order_relaxed );
+		} while( !_free_head.compare_exchange_weak(
+			head, make_head( index, tag_of( head ) + 1 ), std::memory_order_release, std::memory_order_relaxed ) );
+		_available.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	std::size_t                       _slab_size;
+	std::size_t                       _slab_count;
+	std::unique_ptr<Slab[]>           _slabs;
+	std::unique_ptr<mart::ByteType[]> _memory;
+	std::atomic<std::uint64_t>        _free_head{ 0 };
+	std::atomic<std::size_t>          _available{ 0 };
+
+	friend class PooledPacket<EndpointT>;
+};
+
+template<class EndpointT>
+void PooledPacket<EndpointT>::reset() noexcept
+{
+	if( _slab && _slab->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) { _slab->pool->release( *_slab ); }
+	_slab = nullptr;
+}
+
+template<class EndpointT>
+mart::MemoryView PooledPacket<EndpointT>::buffer() const noexcept
+{
+	if( !_slab ) { return {}; }
+	assert( use_count() == 1 );
+	return mart::MemoryView( _slab->data, _slab->pool->slab_size() );
+}
+
+template<class EndpointT>
+void PooledPacket<EndpointT>::assign( std::size_t size, const endpoint& source, time_point rx_time ) noexcept
+{
+	assert( _slab && use_count() == 1 && size <= _slab->pool->slab_size() );
+	_slab->size    = size;
+	_slab->source  = source;
+	_slab->rx_time = rx_time;
+}
+
+} // namespace mart::nw
+
+#endif
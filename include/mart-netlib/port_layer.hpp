@@ -65,6 +65,9 @@ ErrorCode close_socket( handle_t handle ) noexcept;
 
 ReturnValue<handle_t> accept( handle_t handle, Sockaddr& addr ) noexcept;
 ReturnValue<handle_t> accept( handle_t handle ) noexcept;
+// The new socket is created in the requested blocking mode (and close-on-exec) with a single syscall (accept4)
+// on linux. On other platforms, the mode is set with an additional call after accept
+ReturnValue<handle_t> accept( handle_t handle, Sockaddr& addr, bool non_blocking ) noexcept;
 
 ErrorCode connect( handle_t handle, const Sockaddr& addr ) noexcept;
 ErrorCode bind( handle_t handle, const Sockaddr& addr ) noexcept;
@@ -75,6 +78,152 @@ ReturnValue<txrx_size_t> sendto( handle_t handle, byte_range buf, int flags, con
 ReturnValue<txrx_size_t> recv( handle_t handle, byte_range_mut buf, int flags ) noexcept;
 ReturnValue<txrx_size_t> recvfrom( handle_t handle, byte_range_mut buf, int flags, Sockaddr& from ) noexcept;
 
+// Flag for recv & co. that makes a single call non-blocking, independent of the socket's blocking mode
+// (0 on windows, which has no such flag - check with wait_readable first)
+int dontwait_flag() noexcept;
+
+// Waits until handle is readable (data, pending connection, orderly shutdown by the peer or a pending error).
+// Returns false on timeout. A negative timeout waits indefinitely, zero only checks the current state.
+ReturnValue<bool> wait_readable( handle_t handle, std::chrono::microseconds timeout ) noexcept;
+
+/* ############# Scatter / gather ############# */
+// Sends / receives a single message from / into several buffers with one syscall (sendmsg / recvmsg, WSASendTo /
+// WSARecvFrom on windows). For stream sockets, sendv may send less than the total size of bufs (just like send).
+// to / from may be nullptr (connected socket / source address not needed)
+
+ReturnValue<txrx_size_t>
+sendv( handle_t handle, const byte_range* bufs, std::size_t count, int flags, const Sockaddr* to = nullptr ) noexcept;
+ReturnValue<txrx_size_t>
+recvv( handle_t handle, const byte_range_mut* bufs, std::size_t count, int flags, Sockaddr* from = nullptr ) noexcept;
+
+/* ############# Batched datagram transmission ############# */
+// On linux, these map to sendmmsg / recvmmsg (several datagrams per syscall),
+// on other platforms they fall back to a loop over sendto / recvfrom
+
+struct SendMsg {
+	byte_range      data;
+	const Sockaddr* to;   // destination (nullptr: send to connected peer)
+	txrx_size_t     size; // [out] number of bytes sent
+};
+
+struct RecvMsg {
+	byte_range_mut           data;
+	Sockaddr*                from;      // [out] source address (nullptr: not needed)
+	txrx_size_t              size;      // [out] number of bytes received
+	std::chrono::nanoseconds timestamp; // [out] kernel receive timestamp (0: none - see enable_rx_timestamps)
+};
+
+// Returns the number of sent messages. An error is only reported, if not even the first message could be sent.
+ReturnValue<int> sendmmsg( handle_t handle, SendMsg* msgs, std::size_t count, int flags ) noexcept;
+
+// Waits (if the socket is blocking) until at least one datagram is available and then receives
+// up to count datagrams that are immediately available. Returns the number of received datagrams.
+// NOTE: on windows, at most one datagram is received per call
+ReturnValue<int> recvmmsg( handle_t handle, RecvMsg* msgs, std::size_t count, int flags ) noexcept;
+
+/* ############# UDP segmentation offload ############# */
+// Only available on linux (UDP_SEGMENT / UDP_GRO). On other platforms send_segmented returns
+// ErrorCodeValues::NotSupported and recv_coalesced receives a single datagram per call
+
+// Sends buf as a sequence of datagrams with segment_size bytes each (the last one may be shorter) with a single syscall.
+// Fails without sending anything, if the kernel doesn't support segmentation offload for this socket
+ReturnValue<txrx_size_t>
+send_segmented( handle_t handle, byte_range buf, int flags, const Sockaddr* to, std::uint16_t segment_size ) noexcept;
+
+// Like recvfrom, but if the kernel coalesced several datagrams into buf (requires SocketOption::udp_gro),
+// segment_size is set to the size of the individual datagrams (all but the last one have that size).
+// For a single datagram, segment_size is the received size.
+ReturnValue<txrx_size_t>
+recv_coalesced( handle_t handle, byte_range_mut buf, int flags, Sockaddr* from, int& segment_size ) noexcept;
+
+/* ############# Zero copy transmission ############# */
+// Only available on linux (MSG_ZEROCOPY), elsewhere the functions return ErrorCodeValues::NotSupported.
+// Requires SocketOption::so_zerocopy - otherwise send_zerocopy behaves like send.
+//
+// The kernel keeps referencing the pages of buf after send_zerocopy returned. Every successful call gets
+// the next id of a per-socket counter (starting at 0) and once the kernel doesn't need the data anymore,
+// a completion for that id is queued on the socket's error queue (several ids may be reported at once).
+
+ReturnValue<txrx_size_t> send_zerocopy( handle_t handle, byte_range buf, int flags ) noexcept;
+
+struct ZerocopyCompletion {
+	std::uint32_t first;  // the sends with ids [first, last] are completed
+	std::uint32_t last;   // (inclusive)
+	bool          copied; // the kernel had to copy the data anyway (e.g. for loopback traffic)
+};
+
+// Waits up to timeout (negative: indefinitely) for completions and reads up to count of them (never blocks after that).
+// Returns the number of completions (0: none available in time)
+ReturnValue<int> read_zerocopy_completions( handle_t                  handle,
+											ZerocopyCompletion*       out,
+											std::size_t               count,
+											std::chrono::milliseconds timeout ) noexcept;
+
+/* ############# File transmission / splicing ############# */
+// Data is moved inside the kernel, without ever being copied to user space (linux: sendfile / splice).
+
+// Sends up to count bytes of the (regular) file file_fd, starting at offset, which is advanced by the number of
+// sent bytes. Returns 0 at the end of the file. Doesn't change the file position of file_fd.
+// Outside of linux, the data is read into a buffer on the stack and sent from there (windows: NotSupported)
+ReturnValue<txrx_size_t> send_file( handle_t handle, int file_fd, std::int64_t& offset, std::size_t count ) noexcept;
+
+/**
+ * Forwards data from one file descriptor to another (socket -> file, socket -> socket, file -> socket)
+ * through a pipe owned by the Splicer. Only available on linux, elsewhere is_valid() is false and transfer
+ * returns ErrorCodeValues::NotSupported.
+ */
+class Splicer {
+public:
+	Splicer() noexcept;
+	~Splicer();
+	Splicer( const Splicer& ) = delete;
+	Splicer& operator=( const Splicer& ) = delete;
+
+	// false, if the pipe couldn't be created
+	bool is_valid() const noexcept { return _pipe[0] != -1; }
+
+	/**
+	 * Moves up to count bytes from in_fd to out_fd (for sockets: to_native( handle )) and returns the number of
+	 * bytes written to out_fd. 0 (with pending() == 0) means in_fd is at its end / the peer closed the connection.
+	 * Like recv, it reads at most once from in_fd and doesn't wait for more data than is currently available.
+	 * Data that was taken from in_fd, but could not be written to out_fd (e.g. a non-blocking socket with a full send
+	 * buffer) stays in the pipe and is written first by the next call. That call has to use the same out_fd -
+	 * otherwise it returns ErrorCodeValues::InvalidArgument without moving any data.
+	 * Errors (including WouldBlock of non-blocking sockets) are only reported, if nothing was written.
+	 */
+	ReturnValue<txrx_size_t> transfer( int in_fd, int out_fd, std::size_t count ) noexcept;
+
+	// number of bytes in the pipe
+	std::size_t pending() const noexcept { return _pending; }
+
+private:
+	int         _pipe[2];
+	std::size_t _pending  = 0;
+	std::size_t _capacity = 0;
+	int         _out_fd   = -1; // destination of the pending data
+};
+
+/* ############# Kernel receive timestamps ############# */
+// Only available on linux, elsewhere enable_rx_timestamps returns ErrorCodeValues::NotSupported
+// and recv_timestamped never reports a timestamp.
+
+// Lets the kernel record the (CLOCK_REALTIME) time at which each packet arrived at the socket.
+// Uses SO_TIMESTAMPING (software and - if the nic was configured for it - hardware timestamps) where available
+// and falls back to SO_TIMESTAMPNS otherwise.
+// NOTE: The kernel may enable timestamping asynchronously, so packets arriving right afterwards may lack a timestamp
+ErrorCode enable_rx_timestamps( handle_t handle, bool enable ) noexcept;
+
+// Like recvfrom (from may be nullptr), but also extracts the kernel receive timestamp (time since epoch) from the
+// control messages. timestamp is set to zero, if the kernel didn't provide one (e.g. timestamps not enabled).
+// On stream sockets, the timestamp belongs to the last packet that contributed to the received data.
+// If truncated isn't nullptr, it is set to true, if the datagram didn't fit into buf (the rest is discarded)
+ReturnValue<txrx_size_t> recv_timestamped( handle_t                  handle,
+										   byte_range_mut            buf,
+										   int                       flags,
+										   Sockaddr*                 from,
+										   std::chrono::nanoseconds& timestamp,
+										   bool*                     truncated = nullptr ) noexcept;
+
 ErrorCode setsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, byte_range data ) noexcept;
 ErrorCode getsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, byte_range_mut& buffer ) noexcept;
 
@@ -0,0 +1,186 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_REACTOR_HPP
+#define LIB_MART_COMMON_GUARD_NW_REACTOR_HPP
+/**
+ * reactor.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Single threaded event loop, that dispatches socket readiness and timers to callbacks
+ *
+ * Instead of using one thread per blocking socket, many sockets can be registered with a single Reactor,
+ * which waits for any of them to become readable / writable and then calls the associated callback.
+ * NOTE: Currently only implemented for linux (epoll)
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "RaiiSocket.hpp"
+#include "port_layer.hpp"
+#include "tcp.hpp"
+
+#include "detail/socket_base.hpp"
+
+/* Standard Library Includes */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+
+enum class Interest : std::uint8_t {
+	None      = 0,
+	Read      = 1,
+	Write     = 2,
+	ReadWrite = Read | Write,
+};
+
+constexpr Interest operator|( Interest l, Interest r ) noexcept
+{
+	return static_cast<Interest>( static_cast<std::uint8_t>( l ) | static_cast<std::uint8_t>( r ) );
+}
+
+constexpr bool has_interest( Interest set, Interest i ) noexcept
+{
+	return ( static_cast<std::uint8_t>( set ) & static_cast<std::uint8_t>( i ) ) != 0;
+}
+
+enum class TriggerMode {
+	Level,  // callback is called as long as the socket is readable / writable
+	Edge,   // callback is only called when the state changes -> the socket has to be drained until it would block
+	OneShot // callback is called once, afterwards the registration has to be re-armed with Reactor::modify
+};
+
+struct Events {
+	bool readable = false;
+	bool writable = false;
+	bool error    = false;
+	bool hangup   = false; // peer closed the connection (or at least its sending side)
+};
+
+class Reactor {
+public:
+	using handle_t      = socks::port_layer::handle_t;
+	using clock         = std::chrono::steady_clock;
+	using Callback      = std::function<void( Events )>;
+	using TimerCallback = std::function<void()>;
+
+	enum class TimerId : std::uint64_t { Invalid = 0 };
+
+	Reactor();
+	~Reactor();
+
+	// callbacks usually capture a reference to the reactor, so it can't be moved around
+	Reactor( const Reactor& ) = delete;
+	Reactor& operator=( const Reactor& ) = delete;
+
+	/* ###### socket registration ###### */
+
+	/**
+	 * Calls cb, whenever handle becomes ready for the given interest.
+	 * Throws, if the handle is invalid or already registered.
+	 * A socket has to be removed from the reactor before it gets closed.
+	 *
+	 * The overloads for the socket classes also put the socket into non-blocking mode, which is required
+	 * for edge triggered registrations (the socket has to be read / written until the call would block).
+	 */
+	void add( handle_t handle, Interest interest, Callback cb, TriggerMode mode = TriggerMode::Level );
+	void add( socks::RaiiSocket& socket, Interest interest, Callback cb, TriggerMode mode = TriggerMode::Level );
+	void add( socks::detail::HighLevelSocketBase& socket,
+			  Interest                            interest,
+			  Callback                            cb,
+			  TriggerMode                         mode = TriggerMode::Level );
+	void add( ip::tcp::Acceptor& acceptor, Callback cb, TriggerMode mode = TriggerMode::Level );
+
+	// changes the interest of an existing registration (also re-arms a TriggerMode::OneShot registration)
+	void modify( handle_t handle, Interest interest );
+	void modify( const socks::RaiiSocket& socket, Interest interest ) { modify( socket.get_handle(), interest ); }
+	void modify( const socks::detail::HighLevelSocketBase& socket, Interest interest )
+	{
+		modify( socket.get_raw_socket_handle(), interest );
+	}
+
+	// Removes the registration (no-op, if the handle isn't registered). Can be called from within a callback
+	void remove( handle_t handle ) noexcept;
+	void remove( const socks::RaiiSocket& socket ) noexcept { remove( socket.get_handle() ); }
+	void remove( const socks::detail::HighLevelSocketBase& socket ) noexcept { remove( socket.get_raw_socket_handle() ); }
+	void remove( ip::tcp::Acceptor& acceptor ) noexcept { remove( acceptor.getSocket().get_handle() ); }
+
+	bool        is_registered( handle_t handle ) const noexcept;
+	std::size_t registration_count() const noexcept { return _registrations.size(); }
+
+	/* ###### timers ###### */
+
+	// calls cb once after delay
+	TimerId add_timer( clock::duration delay, TimerCallback cb );
+	// calls cb every period (first call after one period)
+	TimerId add_periodic_timer( clock::duration period, TimerCallback cb );
+	// returns false, if the timer had already expired / was cancelled before. Can be called from within a callback
+	bool cancel_timer( TimerId id ) noexcept;
+
+	/* ###### event loop ###### */
+
+	// Dispatches events and timers until stop() is called
+	void run();
+
+	/**
+	 * Waits at most max_wait for events / timers (or not at all for max_wait == 0) and dispatches all that are ready.
+	 * Returns the number of invoked callbacks.
+	 */
+	std::size_t run_once( std::chrono::milliseconds max_wait );
+
+	// Makes run() return after the current iteration. Can be called from any thread
+	void stop() noexcept;
+
+private:
+	struct Registration {
+		Callback      cb;
+		Interest      interest;
+		TriggerMode   mode;
+		std::uint32_t generation;
+	};
+
+	struct Timer {
+		clock::time_point deadline;
+		clock::duration   period; // zero for one shot timers
+		TimerCallback     cb;
+	};
+
+	using native_handle_t = socks::port_layer::native_handle_t;
+
+	TimerId     _add_timer( clock::time_point deadline, clock::duration period, TimerCallback cb );
+	int         _timeout_ms( std::chrono::milliseconds max_wait ) const noexcept;
+	std::size_t _dispatch_timers();
+	void        _wakeup() noexcept;
+
+	native_handle_t _epoll_fd  = -1;
+	native_handle_t _wakeup_fd = -1;
+
+	std::unordered_map<native_handle_t, std::unique_ptr<Registration>> _registrations;
+	// registrations removed during dispatch are only destroyed after the current batch of events was processed
+	std::vector<std::unique_ptr<Registration>> _removed;
+	std::uint32_t                              _next_generation = 1;
+
+	std::unordered_map<std::uint64_t, std::unique_ptr<Timer>> _timers;
+	std::vector<std::pair<clock::time_point, std::uint64_t>>  _timer_heap;
+	std::uint64_t                                             _next_timer_id = 1;
+
+	std::atomic<bool> _stop_requested{ false };
+};
+
+} // namespace nw
+} // namespace mart
+
+#endif
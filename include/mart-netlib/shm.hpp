@@ -0,0 +1,142 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_SHM_HPP
+#define LIB_MART_COMMON_GUARD_NW_SHM_HPP
+/**
+ * shm.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Message channel between processes on the same host, based on a ring buffer in shared memory
+ *
+ * An alternative to unix domain datagram sockets for latency critical local ipc: messages are copied directly into
+ * the shared ring buffer by the sender and out of it by the receiver (or read in place via try_peek), there is no
+ * syscall on the fast path. A blocked receiver (or a sender waiting for space) is woken up via a futex,
+ * but the futex is only touched, if the other side actually sleeps.
+ * A receiver can additionally busy poll for a while, before it goes to sleep.
+ *
+ * A channel is unidirectional with exactly one sending and one receiving side at a time (e.g. two processes,
+ * or two threads). Messages are delivered in order and - unlike datagrams - never dropped: if the ring is full,
+ * send waits until the receiver made room.
+ * NOTE: Currently only implemented for linux (futex)
+ */
+
+/* ######## INCLUDES ######### */
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::shm {
+
+namespace _detail_shm_ {
+struct Header;
+}
+
+class Channel {
+public:
+	/**
+	 * Creates a new, named channel (shm_open) with at least capacity bytes of buffer space (rounded up to a power
+	 * of two). Throws if a channel with that name already exists or the shared memory can't be created.
+	 * name has to start with a '/' and must not contain any further slashes.
+	 */
+	static Channel create( std::string_view name, std::size_t capacity );
+	/**
+	 * Opens an existing, named channel. Throws if it doesn't exist or isn't a valid channel.
+	 * If the channel is concurrently being created, waits (up to a second) until its creator has initialized it.
+	 */
+	static Channel open( std::string_view name );
+	// Removes the name (the memory is released, when the last process closed the channel). Returns false on error
+	static bool unlink( std::string_view name ) noexcept;
+
+	/**
+	 * Creates a channel in anonymous shared memory (memfd) - e.g. to hand it to a child process, or to pass
+	 * native_handle() to another process over a unix domain socket (SCM_RIGHTS), which then uses from_fd.
+	 */
+	static Channel create_anonymous( std::size_t capacity );
+	// Takes ownership of fd, which refers to the shared memory of an existing channel
+	static Channel from_fd( int fd );
+
+	Channel() noexcept = default;
+	Channel( Channel&& other ) noexcept;
+	Channel& operator=( Channel&& other ) noexcept;
+	~Channel();
+
+	bool        is_valid() const noexcept { return _header != nullptr; }
+	int         native_handle() const noexcept { return _fd; }
+	std::size_t capacity() const noexcept { return _capacity; }
+	// larger messages can't be sent
+	std::size_t max_message_size() const noexcept;
+
+	/* ###### sending side ###### */
+	// Returns false, if there isn't enough space in the ring (or the message is larger than max_message_size)
+	bool try_send( mart::ConstMemoryView data ) noexcept;
+	// Waits at most the tx timeout for enough space. Throws on timeout or if the message is too large
+	void send( mart::ConstMemoryView data );
+
+	/* ###### receiving side ###### */
+	/**
+	 * Copies the next message into buffer and returns the filled part of it or an invalid view, if there is no
+	 * message. Like with datagrams, the rest of a message that doesn't fit into buffer is discarded.
+	 */
+	mart::MemoryView try_recv( mart::MemoryView buffer ) noexcept;
+	// Busy polls / waits at most the rx timeout for a message. Returns an invalid view on timeout
+	mart::MemoryView recv( mart::MemoryView buffer );
+
+	/**
+	 * Zero copy alternative to try_recv: returns the next message in place (an invalid view, if there is none).
+	 * The view stays valid until pop() is called, which releases the message.
+	 */
+	mart::ConstMemoryView try_peek() noexcept;
+	void                  pop() noexcept;
+
+	/* ###### configuration ###### */
+	// how long send / recv wait at most
+	void                      set_tx_timeout( std::chrono::microseconds timeout ) noexcept { _tx_timeout = timeout; }
+	void                      set_rx_timeout( std::chrono::microseconds timeout ) noexcept { _rx_timeout = timeout; }
+	std::chrono::microseconds get_tx_timeout() const noexcept { return _tx_timeout; }
+	std::chrono::microseconds get_rx_timeout() const noexcept { return _rx_timeout; }
+
+	/**
+	 * How long recv spins, checking for new messages, before it goes to sleep (0: sleep right away).
+	 * Avoids the wakeup latency of the futex, at the cost of burning cpu time on the receiving side.
+	 */
+	void                     set_busy_poll( std::chrono::nanoseconds duration ) noexcept { _busy_poll = duration; }
+	std::chrono::nanoseconds get_busy_poll() const noexcept { return _busy_poll; }
+
+private:
+	// capacity 0: read it from the (already initialized) header
+	static Channel _map( int fd, std::size_t capacity );
+
+	void _close() noexcept;
+
+	int                   _fd           = -1;
+	void*                 _mapping      = nullptr;
+	std::size_t           _mapping_size = 0;
+	_detail_shm_::Header* _header       = nullptr;
+	mart::ByteType*       _data         = nullptr;
+	std::size_t           _capacity     = 0;
+
+	// local copies of the other side's position - only refreshed, if they don't suffice
+	// (avoids pulling the cache line the other side is writing to on every message)
+	std::uint64_t _cached_read_pos  = 0; // sending side
+	std::uint64_t _cached_write_pos = 0; // receiving side
+	std::uint64_t _peeked_end       = 0; // read position after the message returned by try_peek (0: none)
+
+	std::chrono::microseconds _tx_timeout = std::chrono::hours( 300 );
+	std::chrono::microseconds _rx_timeout = std::chrono::hours( 300 );
+	std::chrono::nanoseconds  _busy_poll{ 0 };
+};
+
+} // namespace mart::nw::shm
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_SOCKET_STATS_HPP
+#define LIB_MART_COMMON_GUARD_NW_SOCKET_STATS_HPP
+/**
+ * socket_stats.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Optional per socket statistics (traffic, errors, would-block, partial sends, syscall durations)
+ *
+ * Only collected, if MART_NETLIB_ENABLE_SOCKET_STATS is defined (cmake option of the same name, which defines it
+ * for the library and everything that links against it - it changes the layout of RaiiSocket).
+ * Without it, RaiiSocket doesn't contain any instrumentation code at all.
+ *
+ * With it, every RaiiSocket owns a SocketStats object, that is updated by all send / recv functions and is
+ * registered in the process wide SocketStatsRegistry for the lifetime of the socket object.
+ * The counters are relaxed atomics: they can be read from any thread while the socket is in use,
+ * but a snapshot isn't necessarily consistent across counters.
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "basic_types.hpp"
+#include "port_layer.hpp"
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+namespace socks {
+
+#ifdef MART_NETLIB_ENABLE_SOCKET_STATS
+inline constexpr bool socket_stats_enabled = true;
+#else
+inline constexpr bool socket_stats_enabled = false;
+#endif
+
+/**
+ * Histogram with logarithmic buckets: bucket i counts durations in [2^i, 2^(i+1)) ns (bucket 0 also counts 0ns)
+ */
+class LatencyHistogram {
+public:
+	static constexpr std::size_t bucket_count = 40; // the last bucket collects everything above ~9 minutes
+
+	void record( std::chrono::nanoseconds duration ) noexcept
+	{
+		const auto ns = static_cast<std::uint64_t>( std::max<std::chrono::nanoseconds::rep>( duration.count(), 0 ) );
+		_buckets[bucket_index( ns )].fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	static std::size_t bucket_index( std::uint64_t ns ) noexcept
+	{
+		std::size_t idx = 0;
+		while( ns > 1 && idx < bucket_count - 1 ) {
+			ns >>= 1;
+			++idx;
+		}
+		return idx;
+	}
+
+	std::uint64_t bucket( std::size_t idx ) const noexcept { return _buckets[idx].load( std::memory_order_relaxed ); }
+
+	std::uint64_t count() const noexcept
+	{
+		std::uint64_t sum = 0;
+		for( const auto& b : _buckets ) {
+			sum += b.load( std::memory_order_relaxed );
+		}
+		return sum;
+	}
+
+	// Upper bound of the bucket that contains the p-quantile (p in [0,1]) - 0 if nothing was recorded
+	std::chrono::nanoseconds percentile( double p ) const noexcept
+	{
+		const std::uint64_t total = count();
+		if( total == 0 ) { return std::chrono::nanoseconds( 0 ); }
+
+		const auto    rank = static_cast<std::uint64_t>( p * static_cast<double>( total - 1 ) ) + 1;
+		std::uint64_t sum  = 0;
+		for( std::size_t i = 0; i < bucket_count; ++i ) {
+			sum += bucket( i );
+			if( sum >= rank ) { return std::chrono::nanoseconds( ( std::int64_t( 1 ) << ( i + 1 ) ) - 1 ); }
+		}
+		return std::chrono::nanoseconds::max();
+	}
+
+private:
+	std::array<std::atomic<std::uint64_t>, bucket_count> _buckets{};
+};
+
+class SocketStats {
+public:
+	struct ErrorCount {
+		int           code;
+		std::uint64_t count;
+	};
+
+	// registers itself in SocketStatsRegistry::instance()
+	SocketStats() noexcept;
+	~SocketStats();
+	SocketStats( const SocketStats& ) = delete;
+	SocketStats& operator=( const SocketStats& ) = delete;
+
+	/* ###### recording (called by RaiiSocket) ###### */
+	// requested: bytes passed to the call, transferred: bytes actually sent (only relevant on success)
+	void record_tx( ErrorCode                error,
+					std::size_t              requested,
+					std::size_t              transferred,
+					std::size_t              messages,
+					std::chrono::nanoseconds duration ) noexcept
+	{
+		_syscalls.record( duration );
+		if( !error.success() ) {
+			_record_error( error );
+			return;
+		}
+		_bytes_sent.fetch_add( transferred, std::memory_order_relaxed );
+		_msgs_sent.fetch_add( messages, std::memory_order_relaxed );
+		if( transferred < requested ) { _partial_sends.fetch_add( 1, std::memory_order_relaxed ); }
+	}
+
+	void record_rx( ErrorCode                error,
+					std::size_t              transferred,
+					std::size_t              messages,
+					std::chrono::nanoseconds duration ) noexcept
+	{
+		_syscalls.record( duration );
+		if( !error.success() ) {
+			_record_error( error );
+			return;
+		}
+		_bytes_received.fetch_add( transferred, std::memory_order_relaxed );
+		_msgs_received.fetch_add( messages, std::memory_order_relaxed );
+	}
+
+	void set_handle( port_layer::handle_t handle ) noexcept
+	{
+		_handle.store( static_cast<port_layer::native_handle_t>( handle ), std::memory_order_relaxed );
+	}
+
+	/* ###### queries ###### */
+	// handle of the socket (handle_t::Invalid after it was closed)
+	port_layer::handle_t handle() const noexcept
+	{
+		return static_cast<port_layer::handle_t>( _handle.load( std::memory_order_relaxed ) );
+	}
+
+	std::uint64_t bytes_sent() const noexcept { return _bytes_sent.load( std::memory_order_relaxed ); }
+	std::uint64_t bytes_received() const noexcept { return _bytes_received.load( std::memory_order_relaxed ); }
+	std::uint64_t msgs_sent() const noexcept { return _msgs_sent.load( std::memory_order_relaxed ); }
+	std::uint64_t msgs_received() const noexcept { return _msgs_received.load( std::memory_order_relaxed ); }
+	// EWOULDBLOCK / EAGAIN (which includes rx / tx timeouts on posix systems)
+	std::uint64_t would_block() const noexcept { return _would_block.load( std::memory_order_relaxed ); }
+	// sends that transferred only part of the data
+	std::uint64_t partial_sends() const noexcept { return _partial_sends.load( std::memory_order_relaxed ); }
+	// all other errors
+	std::uint64_t errors() const noexcept { return _errors.load( std::memory_order_relaxed ); }
+
+	// errors() broken down by error code (codes beyond the first max_error_codes distinct ones are only in errors())
+	std::vector<ErrorCount> error_counts() const
+	{
+		std::vector<ErrorCount> ret;
+		for( const auto& slot : _error_slots ) {
+			const int code = slot.code.load( std::memory_order_acquire );
+			if( code != 0 ) { ret.push_back( { code, slot.count.load( std::memory_order_relaxed ) } ); }
+		}
+		return ret;
+	}
+
+	// duration of all send / recv calls
+	const LatencyHistogram& syscall_durations() const noexcept { return _syscalls; }
+
+	void print( std::ostream& out ) const
+	{
+		out << "socket " << _handle.load( std::memory_order_relaxed )      //
+			<< ": tx " << msgs_sent() << " msgs / " << bytes_sent() << " B" //
+			<< ", rx " << msgs_received() << " msgs / " << bytes_received() << " B"
+			<< ", would_block " << would_block() << ", partial_sends " << partial_sends() << ", errors " << errors();
+		for( const auto& e : error_counts() ) {
+			out << " [" << e.code << "]=" << e.count;
+		}
+		out << ", syscalls " << _syscalls.count() << " (p50 <= " << _syscalls.percentile( 0.5 ).count()
+			<< "ns, p99 <= " << _syscalls.percentile( 0.99 ).count() << "ns)";
+	}
+
+	static constexpr std::size_t max_error_codes = 8;
+
+private:
+	void _record_error( ErrorCode error ) noexcept
+	{
+		if( error.value() == ErrorCodeValues::WouldBlock || error.value() == ErrorCodeValues::TryAgain ) {
+			_would_block.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+		_errors.fetch_add( 1, std::memory_order_relaxed );
+
+		const int code = error.raw_value();
+		for( auto& slot : _error_slots ) {
+			int current = slot.code.load( std::memory_order_acquire );
+			if( current == 0 && slot.code.compare_exchange_strong( current, code, std::memory_order_acq_rel ) ) {
+				current = code;
+			}
+			if( current == code ) {
+				slot.count.fetch_add( 1, std::memory_order_relaxed );
+				return;
+			}
+		}
+	}
+
+	struct ErrorSlot {
+		std::atomic<int>           code{ 0 };
+		std::atomic<std::uint64_t> count{ 0 };
+	};
+
+	std::atomic<port_layer::native_handle_t> _handle{ static_cast<port_layer::native_handle_t>(
+		port_layer::handle_t::Invalid ) };
+	std::atomic<std::uint64_t>               _bytes_sent{ 0 };
+	std::atomic<std::uint64_t>               _bytes_received{ 0 };
+	std::atomic<std::uint64_t>               _msgs_sent{ 0 };
+	std::atomic<std::uint64_t>               _msgs_received{ 0 };
+	std::atomic<std::uint64_t>               _would_block{ 0 };
+	std::atomic<std::uint64_t>               _partial_sends{ 0 };
+	std::atomic<std::uint64_t>               _errors{ 0 };
+
+	std::array<ErrorSlot, max_error_codes> _error_slots{};
+	LatencyHistogram                       _syscalls;
+};
+
+/**
+ * Process wide list of all existing SocketStats objects
+ */
+class SocketStatsRegistry {
+public:
+	static SocketStatsRegistry& instance()
+	{
+		static SocketStatsRegistry registry;
+		return registry;
+	}
+
+	// Calls f( const SocketStats& ) for every registered socket. Sockets can't be destroyed while this runs
+	template<class F>
+	void for_each( F&& f ) const
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		for( const SocketStats* s : _stats ) {
+			f( *s );
+		}
+	}
+
+	std::size_t size() const
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		return _stats.size();
+	}
+
+	// one line per socket
+	void dump( std::ostream& out ) const
+	{
+		for_each( [&]( const SocketStats& s ) {
+			s.print( out );
+			out << '\n';
+		} );
+	}
+
+	void add( const SocketStats* stats )
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		_stats.push_back( stats );
+	}
+
+	void remove( const SocketStats* stats ) noexcept
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		_stats.erase( std::remove( _stats.begin(), _stats.end(), stats ), _stats.end() );
+	}
+
+private:
+	mutable std::mutex              _mutex;
+	std::vector<const SocketStats*> _stats;
+};
+
+inline SocketStats::SocketStats() noexcept
+{
+	// registering can only fail if we run out of memory
+	try {
+		SocketStatsRegistry::instance().add( this );
+	} catch( ... ) {
+	}
+}
+
+inline SocketStats::~SocketStats()
+{
+	SocketStatsRegistry::instance().remove( this );
+}
+
+} // namespace socks
+} // namespace nw
+} // namespace mart
+
+#endif
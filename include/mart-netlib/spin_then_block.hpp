@@ -0,0 +1,155 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_SPIN_THEN_BLOCK_HPP
+#define LIB_MART_COMMON_GUARD_NW_SPIN_THEN_BLOCK_HPP
+/**
+ * spin_then_block.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Adaptive spin-then-block receive mode
+ *
+ * A blocking receive pays the wakeup latency of the receiving thread (several microseconds), whereas busy polling
+ * with non-blocking receives reacts almost immediately, but keeps a core busy all the time.
+ * SpinThenBlock busy polls for a limited budget and then falls back to a regular blocking receive.
+ * The budget adapts to the recent inter-arrival times: about twice the average gap between messages
+ * (limited to max_spin) and no spinning at all, if the messages are on average further apart than max_spin.
+ * Every spin phase that ends without data halves the budget (e.g. because the sender doesn't get a core while we
+ * spin), the next message that is received while spinning restores it.
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "basic_types.hpp"
+#include "port_layer.hpp"
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+namespace socks {
+
+struct SpinThenBlockStats {
+	std::uint64_t            served_spinning = 0; // receives that got their data while busy polling
+	std::uint64_t            served_blocking = 0; // receives that got their data from the blocking call
+	std::uint64_t            timeouts        = 0; // receives that got nothing (rx timeout / non-blocking socket)
+	std::chrono::nanoseconds spin_budget{ 0 };    // current busy poll duration
+	std::chrono::nanoseconds mean_gap{ 0 };       // moving average of the time between two received messages
+};
+
+class SpinThenBlock {
+public:
+	using clock = std::chrono::steady_clock;
+
+	// 0 disables spinning. Until the first gap between two messages was observed, the budget is max_spin
+	void set_max_spin( std::chrono::nanoseconds max_spin ) noexcept
+	{
+		_max_spin = max_spin.count() > 0 ? max_spin : std::chrono::nanoseconds( 0 );
+		_update_budget();
+	}
+	std::chrono::nanoseconds max_spin() const noexcept { return _max_spin; }
+	bool                     enabled() const noexcept { return _max_spin.count() > 0; }
+
+	const SpinThenBlockStats& stats() const noexcept { return _stats; }
+
+	/**
+	 * recv_once( int flags ) has to perform a single receive call with the given flags and return a result with
+	 * a member `result` (ReturnValue<txrx_size_t>) like RaiiSocket::RecvResult.
+	 * While spinning, it is called with port_layer::dontwait_flag(), the final blocking call gets flags == 0
+	 * (so the socket's rx timeout still applies, but only after the spin budget was used up).
+	 * Only meant for blocking sockets - on a non-blocking one, every call would use up the whole budget.
+	 */
+	template<class Recv>
+	auto recv( port_layer::handle_t handle, Recv&& recv_once ) -> decltype( recv_once( 0 ) )
+	{
+		if( !enabled() ) { return recv_once( 0 ); }
+
+		const bool spin = _stats.spin_budget.count() > 0;
+		if( spin ) {
+			const int  dontwait   = port_layer::dontwait_flag();
+			const auto spin_until = clock::now() + _stats.spin_budget;
+			do {
+				// without a dontwait flag (windows), only call recv_once when data is available
+				if( dontwait == 0
+					&& !port_layer::wait_readable( handle, std::chrono::microseconds( 0 ) ).value_or( true ) ) {
+					continue;
+				}
+				auto res = recv_once( dontwait );
+				if( res.result.success() ) {
+					_backoff = 0;
+					_on_arrival( true );
+					return res;
+				}
+				if( !_would_block( res.result.error_code() ) ) { return res; }
+			} while( clock::now() < spin_until );
+		}
+
+		if( spin && _backoff < max_backoff ) {
+			++_backoff;
+			_update_budget();
+		}
+
+		auto res = recv_once( 0 );
+		if( res.result.success() ) {
+			_on_arrival( false );
+		} else if( _would_block( res.result.error_code() ) ) {
+			++_stats.timeouts;
+		}
+		return res;
+	}
+
+private:
+	static bool _would_block( ErrorCode error ) noexcept
+	{
+		return error.value() == ErrorCodeValues::WouldBlock || error.value() == ErrorCodeValues::TryAgain
+			   || error.value() == ErrorCodeValues::Timeout;
+	}
+
+	void _on_arrival( bool while_spinning ) noexcept
+	{
+		++( while_spinning ? _stats.served_spinning : _stats.served_blocking );
+
+		const auto now = clock::now();
+		if( _last_arrival != clock::time_point{} ) {
+			const auto gap = std::chrono::duration_cast<std::chrono::nanoseconds>( now - _last_arrival );
+			// exponential moving average with weight 1/8
+			_stats.mean_gap = _has_gap ? _stats.mean_gap + ( gap - _stats.mean_gap ) / 8 : gap;
+			_has_gap        = true;
+		}
+		_last_arrival = now;
+		_update_budget();
+	}
+
+	void _update_budget() noexcept
+	{
+		if( !_has_gap || !enabled() ) {
+			_stats.spin_budget = _max_spin / ( 1 << _backoff );
+		} else if( _stats.mean_gap > _max_spin ) {
+			// most messages would arrive after the budget is used up anyway
+			_stats.spin_budget = std::chrono::nanoseconds( 0 );
+		} else {
+			_stats.spin_budget = std::min( 2 * _stats.mean_gap, _max_spin ) / ( 1 << _backoff );
+		}
+	}
+
+	static constexpr int max_backoff = 6;
+
+	std::chrono::nanoseconds _max_spin{ 0 };
+	SpinThenBlockStats       _stats{};
+	clock::time_point        _last_arrival{};
+	bool                     _has_gap = false;
+	int                      _backoff = 0;
+};
+
+} // namespace socks
+} // namespace nw
+} // namespace mart
+
+#endif
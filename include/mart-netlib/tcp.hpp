@@ -27,51 +27,36 @@
 #include <mart-common/ArrayView.h>
 
 /* Standard Library Includes */
+#include <array>
 #include <cassert>
+#include <cerrno>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <optional>
+#include <string>
 #include <string_view>
-
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
+#include <utility>
+#include <vector>
 
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
 namespace nw {
-namespace ip {
-namespace tcp {
 
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
-{
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
-
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
-}
+namespace coro { // see coro.hpp (C++20)
+class RecvAwaitable;
+class SendAwaitable;
+class AcceptAwaitable;
+} // namespace coro
 
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
-{
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
-}
+namespace ip {
+namespace tcp {
 
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
-{
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
-}
+namespace _detail_tcp_ {
+// throws a generic_nw_error with the message what + detail, followed by the code and description of error
+[[noreturn]] void throw_error( socks::ErrorCode error, std::string_view what, std::string_view detail = {} );
+} // namespace _detail_tcp_
 
 using endpoint = ip::basic_endpoint_v4<mart::nw::ip::TransportProtocol::Tcp>;
 
@@ -89,33 +74,33 @@ public:
 		connect( remote );
 		// TODO: throw exception, if bind fails
 	}
+	// NOTE: the moved from socket is invalid (no new native socket is created for it)
 	Socket( Socket&& other ) noexcept
 		: mart::nw::socks::detail::HighLevelSocketBase( std::move( other ) )
-		, _ep_local( std::move( other._ep_local ) )
-		, _ep_remote( std::move( other._ep_remote ) )
+		, _ep_local( std::exchange( other._ep_local, endpoint{} ) )
+		, _ep_remote( std::exchange( other._ep_remote, endpoint{} ) )
+		, _zerocopy( std::exchange( other._zerocopy, ZerocopyState{} ) )
 	{
-		other = Socket{};
 	}
 	Socket& operator=( Socket&& other ) noexcept
 	{
 		mart::nw::socks::detail::HighLevelSocketBase::operator=( std::move( other ) );
 		_ep_local                                             = std::exchange( other._ep_local, endpoint{} );
 		_ep_remote                                            = std::exchange( other._ep_remote, endpoint{} );
+		_zerocopy                                             = std::exchange( other._zerocopy, ZerocopyState{} );
 		return *this;
 	}
 	void connect( endpoint ep )
 	{
 		auto result = _socket.connect( ep.toSockAddr() );
 		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Could not connect socket to address ", ep.toStringEx() ) );
+			_detail_tcp_::throw_error( result, "Could not connect socket to address ", ep.toStringEx() );
 		}
 		_ep_remote = ep;
 
 		auto t_ep = getSockAddress( _socket );
 		if( !t_ep.result.success() ) {
-			throw generic_nw_error(
-				make_error_message_with_appended_last_errno( t_ep.result, "Could not get port of connected socket " ) );
+			_detail_tcp_::throw_error( t_ep.result, "Could not get port of connected socket " );
 		}
 		_ep_local = t_ep.ep;
 	}
@@ -137,8 +122,7 @@ public:
 		assert( _socket.is_valid() );
 		auto result = _socket.bind( ep.toSockAddr_in() );
 		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Could not bind tcp socket to address ", ep.toStringEx() ) );
+			_detail_tcp_::throw_error( result, "Could not bind tcp socket to address ", ep.toStringEx() );
 		}
 
 		_ep_local = ep;
@@ -148,34 +132,237 @@ public:
 		while( !data.empty() ) {
 			const auto res = _socket.send( data, 0 );
 			if( !_txWasSuccess( data, res ) ) {
-				throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
-					res.result.error_code(), "Failed to send data. Details:  " ) );
+				_detail_tcp_::throw_error( res.result.error_code(), "Failed to send data. Details:  " );
 			}
 			data = res.remaining_data;
 		}
 	}
 
+	/**
+	 * Sends all buffers as one contiguous byte stream (gather write - e.g. header + payload without copying them
+	 * into a single buffer first). Partial writes are continued until everything was sent.
+	 */
+	void send( mart::ArrayView<const mart::ConstMemoryView> data )
+	{
+		auto res = _socket.send( data, 0 );
+		if( !res.success() ) { _throw_send_error( res.error_code() ); }
+
+		std::size_t total = 0;
+		for( const auto& d : data ) {
+			total += d.size();
+		}
+		if( static_cast<std::size_t>( res.value() ) == total ) { return; }
+
+		// partial write: continue with a copy of the views, that can be adjusted to what is left
+		std::vector<mart::ConstMemoryView>    storage( data.begin(), data.end() );
+		mart::ArrayView<mart::ConstMemoryView> remaining = socks::consume_front(
+			mart::ArrayView<mart::ConstMemoryView>( storage.data(), storage.size() ), res.value() );
+		while( !remaining.empty() ) {
+			res = _socket.send( remaining, 0 );
+			if( !res.success() ) { _throw_send_error( res.error_code() ); }
+			remaining = socks::consume_front( remaining, res.value() );
+		}
+	}
+
+	/**
+	 * Receives whatever is available (up to the combined size of all buffers) and distributes it over the buffers
+	 * in order (scatter read). Returns the number of received bytes (0: connection was closed by the peer)
+	 * or nothing on timeout / if the call would block.
+	 */
+	std::optional<std::size_t> recv( mart::ArrayView<const mart::MemoryView> buffers )
+	{
+		using mart::nw::socks::ErrorCodeValues;
+		const auto res = _socket.recv( buffers, 0 );
+		if( res.success() ) { return static_cast<std::size_t>( res.value() ); }
+		if( is_none_of<ErrorCodeValues,
+					   ErrorCodeValues::WouldBlock,
+					   ErrorCodeValues::TryAgain,
+					   ErrorCodeValues::Timeout>( res.error_code().value() ) ) {
+			_detail_tcp_::throw_error( res.error_code(), "Failed to receive data. Details:  " );
+		}
+		return std::nullopt;
+	}
+
+	/* ###### zero copy transmission ###### */
+	// Identifies a send_zerocopy call. The data passed to it must neither be modified nor freed,
+	// until zerocopy_completed returns true for the id (even if the socket was closed in between).
+	enum class ZerocopyId : std::uint32_t {};
+
+	struct ZerocopyCompletions {
+		std::size_t completed = 0; // number of completed kernel send calls
+		std::size_t copied    = 0; // of which the kernel had to copy the data anyway (always the case for loopback)
+	};
+
+	// Returns false, if zero copy transmission isn't supported (send_zerocopy then just copies the data)
+	bool try_enable_zerocopy() noexcept
+	{
+		_zerocopy.enabled = _socket.setsockopt( socks::SocketOptionLevel::Socket, socks::SocketOption::so_zerocopy, 1 )
+								.success();
+		return _zerocopy.enabled;
+	}
+
+	bool is_zerocopy_enabled() const noexcept { return _zerocopy.enabled; }
+
+	/**
+	 * Like send, but the kernel transmits directly from the pages of data instead of copying it into socket buffers.
+	 * This only pays off for large buffers (roughly 10KB and above).
+	 * If zero copy isn't enabled (or the kernel runs out of memory for the notifications), the data is copied
+	 * and the returned id is completed immediately.
+	 */
+	ZerocopyId send_zerocopy( mart::ConstMemoryView data )
+	{
+		// "completed" id for data that was copied
+		auto last = static_cast<ZerocopyId>( _zerocopy.done - 1 );
+		while( !data.empty() ) {
+			if( !_zerocopy.enabled ) {
+				send( data );
+				break;
+			}
+			const auto res = _socket.send_zerocopy( data, 0 );
+			if( !res.result.success() && res.result.error_code().raw_value() == ENOBUFS ) {
+				// too many outstanding notifications -> wait for some of them or copy this chunk
+				if( _zerocopy.next == _zerocopy.done
+					|| reap_zerocopy_completions( std::chrono::milliseconds( 100 ) ).completed == 0 ) {
+					const auto copied = _socket.send( data, 0 );
+					if( !copied.result.success() ) {
+						_detail_tcp_::throw_error( copied.result.error_code(), "Failed to send data. Details:  " );
+					}
+					data = copied.remaining_data;
+				}
+				continue;
+			}
+			if( !res.result.success() ) {
+				_detail_tcp_::throw_error( res.result.error_code(), "Failed to send data (zero copy). Details:  " );
+			}
+			last = static_cast<ZerocopyId>( _zerocopy.next++ );
+			data = res.remaining_data;
+		}
+		return last;
+	}
+
+	// true, if the data of the corresponding send_zerocopy call (and of all previous ones) can be reused
+	// (also true for a default constructed id)
+	bool zerocopy_completed( ZerocopyId id ) const noexcept
+	{
+		// pending ids lie within [done, next) (modulo 2^32)
+		return static_cast<std::uint32_t>( static_cast<std::uint32_t>( id ) - _zerocopy.done )
+			   >= static_cast<std::uint32_t>( _zerocopy.next - _zerocopy.done );
+	}
+
+	// number of send_zerocopy kernel calls, whose data is still in use by the kernel
+	std::size_t zerocopy_pending() const noexcept { return _zerocopy.next - _zerocopy.done; }
+
+	/**
+	 * Processes the completion notifications queued by the kernel.
+	 * Waits up to timeout for the first notification, if any zero copy send is still pending.
+	 */
+	ZerocopyCompletions reap_zerocopy_completions( std::chrono::milliseconds timeout = std::chrono::milliseconds( 0 ) )
+	{
+		ZerocopyCompletions ret;
+		std::array<socks::port_layer::ZerocopyCompletion, 32> buffer{};
+		while( zerocopy_pending() != 0 ) {
+			const auto res = _socket.read_zerocopy_completions( buffer, timeout );
+			if( !res.success() || res.value() == 0 ) { break; }
+			for( int i = 0; i < res.value(); ++i ) {
+				const auto  c   = buffer[static_cast<std::size_t>( i )];
+				std::size_t cnt = c.last - c.first + 1u;
+				ret.completed += cnt;
+				if( c.copied ) { ret.copied += cnt; }
+				_zerocopy.mark_completed( c.first, c.last );
+			}
+			if( static_cast<std::size_t>( res.value() ) < buffer.size() ) { break; }
+			timeout = std::chrono::milliseconds( 0 );
+		}
+		return ret;
+	}
+
+	// Returns false, if id wasn't completed within timeout
+	bool wait_zerocopy_completion( ZerocopyId id, std::chrono::milliseconds timeout = std::chrono::hours( 300 ) )
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		while( !zerocopy_completed( id ) ) {
+			const auto remaining
+				= std::chrono::duration_cast<std::chrono::milliseconds>( deadline - std::chrono::steady_clock::now() );
+			if( remaining.count() <= 0 ) { return false; }
+			reap_zerocopy_completions( remaining );
+		}
+		return true;
+	}
+
+	/* ###### file transmission ###### */
+	static constexpr std::uint64_t to_end_of_file = std::numeric_limits<std::uint64_t>::max();
+
+	/**
+	 * Sends up to length bytes of the (regular) file fd, starting at offset, without copying them through user space
+	 * (sendfile on linux, a read/send loop on other posix systems, not supported on windows). Doesn't change the file
+	 * position of fd. Returns the number of sent bytes, which is less than length, if the file ends earlier
+	 * or - for a non-blocking socket - if the send buffer is full (continue with offset + returned value).
+	 * Throws on errors.
+	 */
+	std::uint64_t send_file( int fd, std::uint64_t offset = 0, std::uint64_t length = to_end_of_file );
+	std::uint64_t
+	send_file( const std::string& path, std::uint64_t offset = 0, std::uint64_t length = to_end_of_file );
+
 	template<class T, T... Vals>
 	bool is_none_of( T v )
 	{
 		return ( true && ... && ( v != Vals ) );
 	}
 
+	// uses the spin-then-block mode, if enabled (see set_spin_then_block)
 	mart::MemoryView recv( mart::MemoryView buffer )
 	{
 		using mart::nw::socks::ErrorCodeValues;
-		const auto res = _socket.recv( buffer, 0 );
+		const auto res = _spin_then_block_recv( [&]( int flags ) { return _socket.recv( buffer, flags ); } );
 		if( !res.result
 			&& is_none_of<ErrorCodeValues,
 						  ErrorCodeValues::WouldBlock,
 						  ErrorCodeValues::TryAgain,
 						  ErrorCodeValues::Timeout>( res.result.error_code().value() ) ) {
-			throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
-				res.result.error_code(), "Failed to receive data. Details:  " ) );
+			_detail_tcp_::throw_error( res.result.error_code(), "Failed to receive data. Details:  " );
 		}
 		return res.received_data;
 	}
 
+	/* ###### kernel receive timestamps ###### */
+	// Lets the kernel timestamp incoming data (SO_TIMESTAMPING / SO_TIMESTAMPNS). Returns false, if not supported
+	bool try_enable_rx_timestamps( bool enable = true ) noexcept
+	{
+		return _socket.enable_rx_timestamps( enable ).success();
+	}
+
+	struct TimestampedRecvResult {
+		mart::MemoryView data;
+		// arrival time of the last packet that contributed to data, as recorded by the kernel
+		// (default constructed if rx timestamps are not enabled / not supported)
+		std::chrono::system_clock::time_point rx_timestamp;
+	};
+
+	// Like recv, but additionally reports the kernel receive timestamp
+	TimestampedRecvResult recv_timestamped( mart::MemoryView buffer )
+	{
+		using mart::nw::socks::ErrorCodeValues;
+		std::chrono::nanoseconds timestamp{};
+
+		const auto res = _socket.recv_timestamped( buffer, 0, nullptr, timestamp );
+		if( !res.result
+			&& is_none_of<ErrorCodeValues,
+						  ErrorCodeValues::WouldBlock,
+						  ErrorCodeValues::TryAgain,
+						  ErrorCodeValues::Timeout>( res.result.error_code().value() ) ) {
+			_detail_tcp_::throw_error( res.result.error_code(), "Failed to receive data. Details:  " );
+		}
+		return { res.received_data,
+				 std::chrono::system_clock::time_point(
+					 std::chrono::duration_cast<std::chrono::system_clock::duration>( timestamp ) ) };
+	}
+
+	/* ###### coroutine support (C++20 - only available if coro.hpp is included) ###### */
+	// co_await: receives whatever is available (empty on orderly shutdown by the peer)
+	coro::RecvAwaitable async_recv( mart::MemoryView buffer ) noexcept;
+	// co_await: sends all of data
+	coro::SendAwaitable async_send( mart::ConstMemoryView data ) noexcept;
+
 	const endpoint& get_local_endpoint() const { return _ep_local; }
 	const endpoint& get_remote_endpoint() const { return _ep_remote; }
 
@@ -200,6 +387,11 @@ private:
 		return ret;
 	}
 
+	[[noreturn]] static void _throw_send_error( mart::nw::socks::ErrorCode error )
+	{
+		_detail_tcp_::throw_error( error, "Failed to send data. Details:  " );
+	}
+
 	static inline bool _txWasSuccess( mart::ConstMemoryView data, const mart::nw::socks::RaiiSocket::SendResult& ret )
 	{
 		return ret.result.success() && mart::narrow<nw::socks::txrx_size_t>( data.size() ) == ret.result.value();
@@ -212,9 +404,39 @@ private:
 	{
 	}
 
+	// unlike Socket{}, this doesn't create a native socket
+	static Socket _invalid() noexcept { return Socket( net::socks::RaiiSocket{}, endpoint{}, endpoint{} ); }
+
+	struct ZerocopyState {
+		bool          enabled = false;
+		std::uint32_t next    = 0; // id the kernel assigns to the next zero copy send
+		std::uint32_t done    = 0; // all sends with lower ids are completed
+		// completions that arrived before those of lower ids
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> out_of_order;
+
+		void mark_completed( std::uint32_t first, std::uint32_t last )
+		{
+			if( first != done ) {
+				out_of_order.emplace_back( first, last );
+				return;
+			}
+			done = last + 1;
+			for( auto it = out_of_order.begin(); it != out_of_order.end(); ) {
+				if( it->first == done ) {
+					done = it->second + 1;
+					out_of_order.erase( it );
+					it = out_of_order.begin();
+				} else {
+					++it;
+				}
+			}
+		}
+	};
+
 	friend Acceptor;
-	endpoint _ep_local{};
-	endpoint _ep_remote{};
+	endpoint      _ep_local{};
+	endpoint      _ep_remote{};
+	ZerocopyState _zerocopy{};
 };
 
 inline Socket connect( endpoint ep )
@@ -235,8 +457,8 @@ public:
 			// TODO: The creation of this exception message seems to be pretty costly in terms of binary size - have to
 			// investigate NOTE: Preliminary tests suggest, that the dynamic memory allocation for the message text
 			// could be the main problem, but that is just a possibility
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				mart::nw::socks::port_layer::get_last_socket_error(), "Could not create tcp acceptor." ) );
+			_detail_tcp_::throw_error( mart::nw::socks::port_layer::get_last_socket_error(),
+									   "Could not create tcp acceptor." );
 		}
 	}
 
@@ -244,14 +466,19 @@ public:
 		: _socket_handle( std::move( other._socket_handle ) )
 		, _ep_local( std::move( other._ep_local ) )
 		, _state( other._state )
+		, _local_ep_is_fixed( other._local_ep_is_fixed )
+		, _timeout( other._timeout )
 	{
 		other = Acceptor{};
 	}
 	Acceptor& operator=( Acceptor&& other ) noexcept
 	{
-		_socket_handle  = std::move( other._socket_handle );
-		_ep_local       = std::move( other._ep_local );
-		other._ep_local = endpoint{};
+		_socket_handle     = std::move( other._socket_handle );
+		_ep_local          = std::move( other._ep_local );
+		_state             = other._state;
+		_local_ep_is_fixed = other._local_ep_is_fixed;
+		_timeout           = other._timeout;
+		other._ep_local    = endpoint{};
 		return *this;
 	}
 
@@ -270,12 +497,11 @@ public:
 
 		auto result = _socket_handle.bind( ep.toSockAddr_in() );
 		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Could not bind tcp acceptor to address ", ep.toStringEx() ) );
+			_detail_tcp_::throw_error( result, "Could not bind tcp acceptor to address ", ep.toStringEx() );
 		}
 
-		_ep_local = ep;
-		_state    = State::bound;
+		_set_local_endpoint( ep );
+		_state = State::bound;
 	}
 
 	bool try_bind( endpoint ep )
@@ -285,8 +511,8 @@ public:
 		auto result = _socket_handle.bind( ep.toSockAddr_in() );
 		if( !result.success() ) { return false; }
 
-		_ep_local = ep;
-		_state    = State::bound;
+		_set_local_endpoint( ep );
+		_state = State::bound;
 		return true;
 	}
 
@@ -296,8 +522,8 @@ public:
 
 		auto result = _socket_handle.listen( backlog );
 		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Tcp acceptor could not start to listen on address ", _ep_local.toStringEx() ) );
+			_detail_tcp_::throw_error(
+				result, "Tcp acceptor could not start to listen on address ", _ep_local.toStringEx() );
 		}
 		_state = State::listening;
 	}
@@ -315,47 +541,131 @@ public:
 	bool is_valid() { return _socket_handle.is_valid(); }
 
 public:
-	Socket try_accept()
+	// Mode of the accepted sockets. It is set as part of the accept call (accept4), so it doesn't cost an extra syscall
+	enum class SocketMode { Blocking, NonBlocking };
+
+	// Accepts a pending connection without waiting. Returns an invalid socket, if there is none
+	Socket try_accept( SocketMode mode = SocketMode::Blocking )
 	{
 		assert( _state == State::listening );
-		_socket_handle.set_blocking( false );
+		_socket_handle.set_blocking( false ); // cached - only a syscall, if accept() was used in between
 
-		mart::net::socks::port_layer::SockaddrIn addr;
+		socks::ErrorCode error{};
+		return _accept( mode, error );
+	}
 
-		auto sock = _socket_handle.accept( addr );
-		auto res  = Socket::getSockAddress( sock );
-		if( sock.is_valid() && res.result.success() ) {
-			return Socket( std::move( sock ), res.ep, endpoint( addr ) );
-		} else {
-			return {};
+	struct AcceptAllResult {
+		std::size_t accepted = 0;
+		// why accept_all stopped: WouldBlock / TryAgain, if the backlog was drained, NoError, if max_count was
+		// reached and a real error otherwise (e.g. the process ran out of file descriptors)
+		socks::ErrorCode error{};
+
+		bool drained() const noexcept
+		{
+			return error.value() == socks::ErrorCodeValues::WouldBlock
+				   || error.value() == socks::ErrorCodeValues::TryAgain;
 		}
-	}
+	};
 
-	Socket accept( std::chrono::microseconds timeout = std::chrono::hours( 300 ) )
+	/**
+	 * Accepts all pending connections (at most max_count) without waiting and appends them to sockets.
+	 * Stops at the first error - the remaining connections stay in the backlog. If that error isn't
+	 * "drained" (e.g. EMFILE), the listening socket stays readable, so don't just poll it again right away.
+	 * Meant for event loops, where a single readiness notification may stand for many queued connections.
+	 */
+	AcceptAllResult accept_all( std::vector<Socket>& sockets,
+								SocketMode           mode      = SocketMode::Blocking,
+								std::size_t          max_count = std::numeric_limits<std::size_t>::max() )
 	{
-		_socket_handle.set_blocking( true );
-		_socket_handle.set_rx_timeout( timeout );
-		_socket_handle.set_tx_timeout( timeout );
+		assert( _state == State::listening );
+		_socket_handle.set_blocking( false );
 
-		mart::net::socks::port_layer::SockaddrIn addr;
+		AcceptAllResult res{};
+		for( ; res.accepted < max_count; ++res.accepted ) {
+			auto sock = _accept( mode, res.error );
+			if( !sock.is_valid() ) { break; }
+			sockets.push_back( std::move( sock ) );
+		}
+		return res;
+	}
 
-		auto sock = _socket_handle.accept( addr );
-		auto res  = Socket::getSockAddress( sock );
-		if( sock.is_valid() && res.result.success() ) {
-			return Socket( std::move( sock ), res.ep, endpoint( addr ) );
-		} else {
-			return {};
+	// Waits at most timeout for a connection. Returns an invalid socket on timeout / error
+	Socket accept( std::chrono::microseconds timeout = std::chrono::hours( 300 ),
+				   SocketMode                mode    = SocketMode::Blocking )
+	{
+		socks::ErrorCode error{};
+		return accept( timeout, mode, error );
+	}
+
+	// Same as above, but if no connection is returned, error tells why (WouldBlock / TryAgain on timeout)
+	Socket accept( std::chrono::microseconds timeout, SocketMode mode, socks::ErrorCode& error )
+	{
+		_socket_handle.set_blocking( true );
+		if( timeout != _timeout ) {
+			_socket_handle.set_rx_timeout( timeout );
+			_socket_handle.set_tx_timeout( timeout );
+			_timeout = timeout;
 		}
+
+		return _accept( mode, error );
 	}
 
-	nw::socks::RaiiSocket& getSocket() { return _socket_handle; }
+	// co_await: accepts the next incoming connection (C++20 - only available if coro.hpp is included)
+	coro::AcceptAwaitable async_accept() noexcept;
+
+	nw::socks::RaiiSocket& getSocket()
+	{
+		// the timeout might get changed through the raw socket
+		_timeout = nw::socks::RaiiSocket::invalid_timeout_v;
+		return _socket_handle;
+	}
 
 	endpoint getLocalEndpoint() const { return _ep_local; }
 
 private:
-	nw::socks::RaiiSocket _socket_handle;
-	endpoint              _ep_local{};
-	State                 _state = State::open;
+	void _set_local_endpoint( endpoint ep ) noexcept
+	{
+		if( ep.port.inHostOrder() == 0 ) {
+			// ask the os, which port it picked
+			const auto res = Socket::getSockAddress( _socket_handle );
+			if( res.result.success() ) { ep = res.ep; }
+		}
+		_ep_local = ep;
+		// if the address isn't a wildcard, every accepted socket has the same local endpoint -> no need to ask the os
+		_local_ep_is_fixed = ep.address != ip::address_any && ep.port.inHostOrder() != 0;
+	}
+
+	// On failure, returns an invalid socket and sets error
+	Socket _accept( SocketMode mode, socks::ErrorCode& error ) noexcept
+	{
+		mart::net::socks::port_layer::SockaddrIn addr;
+
+		auto sock = _socket_handle.accept( addr, mode == SocketMode::NonBlocking );
+		if( !sock.is_valid() ) {
+			error = mart::nw::socks::port_layer::get_last_socket_error();
+			return Socket::_invalid();
+		}
+
+		endpoint local = _ep_local;
+		if( !_local_ep_is_fixed ) {
+			auto res = Socket::getSockAddress( sock );
+			if( !res.result.success() ) {
+				error = res.result;
+				return Socket::_invalid();
+			}
+			local = res.ep;
+		}
+		error = socks::ErrorCode::Ok();
+		return Socket( std::move( sock ), local, endpoint( addr ) );
+	}
+
+	nw::socks::RaiiSocket     _socket_handle;
+	endpoint                  _ep_local{};
+	State                     _state             = State::open;
+	bool                      _local_ep_is_fixed = false;
+	std::chrono::microseconds _timeout           = nw::socks::RaiiSocket::invalid_timeout_v; // last set timeout
+
+	friend coro::AcceptAwaitable;
 };
 
 inline std::optional<endpoint> parse_v4_endpoint( std::string_view str )
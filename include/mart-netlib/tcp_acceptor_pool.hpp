@@ -0,0 +1,106 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_TCP_ACCEPTOR_POOL_HPP
+#define LIB_MART_COMMON_GUARD_NW_TCP_ACCEPTOR_POOL_HPP
+/**
+ * tcp_acceptor_pool.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Multi threaded tcp acceptor, with one listening socket per worker thread bound to the same endpoint
+ *
+ * With a single listening socket, all threads that accept connections contend on the same accept queue.
+ * With SO_REUSEPORT, every worker gets its own listening socket (and accept queue) and the kernel distributes
+ * incoming connections over them, so the connection rate scales with the number of workers.
+ * NOTE: Requires SO_REUSEPORT (linux / bsd), the constructor throws if that isn't supported
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "tcp.hpp"
+
+/* Standard Library Includes */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::tcp {
+
+class AcceptorPool {
+public:
+	struct Config {
+		endpoint    local;               // port 0: all workers listen on the same, randomly chosen port
+		std::size_t worker_count = 0;    // 0: one per hardware thread
+		bool        pin_threads  = true; // pin worker i to cpu i (modulo the number of cpus)
+		int         backlog      = 128;  // per listening socket
+
+		Acceptor::SocketMode socket_mode = Acceptor::SocketMode::Blocking; // mode of the accepted sockets
+
+		// how fast a worker notices stop() if no connections arrive
+		std::chrono::milliseconds stop_latency{ 50 };
+	};
+
+	/**
+	 * Called by the worker threads for every accepted connection. Calls for the same worker never run
+	 * concurrently, but as long as the handler runs, that worker doesn't accept new connections - long running
+	 * work should be handed off to other threads. Exceptions escaping the handler terminate the program.
+	 */
+	using Handler = std::function<void( std::size_t worker, Socket connection )>;
+
+	// Binds all listening sockets and starts the workers. Throws if a socket can't be bound
+	AcceptorPool( const Config& config, Handler handler );
+	~AcceptorPool();
+
+	AcceptorPool( const AcceptorPool& ) = delete;
+	AcceptorPool& operator=( const AcceptorPool& ) = delete;
+
+	// Stops and joins the workers (connections still in the backlog are reset). Idempotent.
+	void stop() noexcept;
+
+	std::size_t     worker_count() const noexcept { return _workers.size(); }
+	const endpoint& local_endpoint() const noexcept { return _local; }
+
+	// number of connections accepted so far (per worker / in total)
+	std::uint64_t accepted( std::size_t worker ) const noexcept;
+	std::uint64_t accepted() const noexcept;
+
+	/**
+	 * If the process or system runs out of resources (EMFILE, ENFILE, ENOBUFS, ENOMEM), the connection stays in
+	 * the backlog and the worker retries after stop_latency. Returns how often that happened (per worker / in total).
+	 */
+	std::uint64_t resource_errors( std::size_t worker ) const noexcept;
+	std::uint64_t resource_errors() const noexcept;
+
+	/**
+	 * A worker stops on any other accept error than a timeout, an interrupted call, a connection that was aborted
+	 * before it was accepted or a lack of resources - its listening socket is most likely unusable.
+	 * Returns the error that stopped worker or ErrorCodeValues::NoError, if it is (still) running.
+	 */
+	socks::ErrorCode error( std::size_t worker ) const noexcept;
+	// number of workers that stopped because of an error
+	std::size_t failed_workers() const noexcept;
+
+private:
+	struct Worker;
+
+	void run( Worker& worker ) noexcept;
+
+	Handler                              _handler;
+	Config                               _config;
+	endpoint                             _local;
+	std::atomic<bool>                    _stop{ false };
+	std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+} // namespace mart::nw::ip::tcp
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_TCP_FRAMING_HPP
+#define LIB_MART_COMMON_GUARD_NW_TCP_FRAMING_HPP
+/**
+ * tcp_framing.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Length prefixed messages (frames) on top of a tcp::Socket
+ *
+ * Every frame is a 4 byte payload size in network byte order, followed by the payload.
+ *
+ * Instead of one recv for the header and one for the payload of each message, FramedReader receives as much as
+ * the kernel has available (up to the size of its buffer) and returns the frames in place from that buffer.
+ * Only an incomplete frame at the end of the buffer is moved to the front before the next recv.
+ * FramedWriter collects small frames and sends them together with a single call.
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "tcp.hpp"
+
+/* Standard Library Includes */
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::tcp {
+
+inline constexpr std::size_t frame_header_size = sizeof( std::uint32_t );
+
+class FramedReader {
+public:
+	/**
+	 * The socket has to outlive the reader.
+	 * buffer_size: how much is requested from the kernel per recv. Larger frames are supported up to max_frame_size
+	 * (the buffer grows as necessary), a larger frame size in a header makes read throw.
+	 */
+	explicit FramedReader( Socket&     socket,
+						   std::size_t buffer_size    = 64 * 1024,
+						   std::size_t max_frame_size = 16 * 1024 * 1024 );
+
+	/**
+	 * Returns the payload of the next frame. The view points into the internal buffer and stays valid until the
+	 * next call to read. Receives from the socket, only if no complete frame is buffered and then repeats the recv
+	 * until a frame is complete.
+	 * Returns nothing, if the recv timed out / would block (the data received so far is kept) or if the peer closed
+	 * the connection (see is_closed). Throws, if the connection was closed in the middle of a frame, on socket errors
+	 * and if a frame exceeds max_frame_size.
+	 */
+	std::optional<mart::ConstMemoryView> read();
+
+	// Like read, but never calls recv - only returns frames that have already been received
+	std::optional<mart::ConstMemoryView> try_read_buffered();
+
+	// true, after the peer closed the connection (and all frames have been read)
+	bool        is_closed() const noexcept { return _closed; }
+	std::size_t buffered_bytes() const noexcept { return _end - _begin; }
+
+private:
+	std::optional<mart::ConstMemoryView> _next_frame();
+	void                                 _make_room_for( std::size_t frame_size );
+
+	Socket*                     _socket;
+	std::vector<mart::ByteType> _buffer;
+	std::size_t                 _begin = 0; // start of the first unread byte
+	std::size_t                 _end   = 0; // end of the received data
+	std::size_t                 _max_frame_size;
+	bool                        _closed = false;
+};
+
+class FramedWriter {
+public:
+	/**
+	 * The socket has to outlive the writer.
+	 * Frames are collected until more than flush_threshold bytes are buffered. Frames with a larger payload aren't
+	 * copied at all, but sent together with the already buffered frames by a single gather send.
+	 */
+	explicit FramedWriter( Socket& socket, std::size_t flush_threshold = 64 * 1024 );
+
+	// Appends a frame. Throws, if the payload is too large for the 4 byte header or on socket errors
+	void write( mart::ConstMemoryView payload );
+	// Sends all buffered frames. Has to be called at the end of a batch of frames (the destructor doesn't flush)
+	void flush();
+
+	std::size_t buffered_bytes() const noexcept { return _buffer.size(); }
+
+private:
+	Socket*                     _socket;
+	std::vector<mart::ByteType> _buffer;
+	std::size_t                 _flush_threshold;
+};
+
+} // namespace mart::nw::ip::tcp
+
+#endif
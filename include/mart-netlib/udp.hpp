@@ -43,6 +43,32 @@ extern template class DgramSocket<mart::nw::ip::udp::endpoint>;
 namespace mart::nw {
 namespace ip::udp {
 using Socket = mart::nw::socks::detail::DgramSocket<endpoint>;
+
+/* ###### ipv4 multicast ###### */
+
+/**
+ * Receives datagrams sent to group on the interface with the address local_interface (address_any: the kernel
+ * picks one). The socket has to be bound to the port the group's datagrams are sent to (and to address_any or
+ * the group address - use so_reuseaddr, if several sockets on this host should receive them).
+ * NOTE: On linux, a socket bound to address_any also receives the datagrams of groups joined by other sockets.
+ * Returns ErrorCodeValues::InvalidArgument, if group isn't a multicast address (the non-try version throws).
+ */
+socks::ErrorCode try_join_multicast_group( Socket&    socket,
+										   address_v4 group,
+										   address_v4 local_interface = address_any ) noexcept;
+void             join_multicast_group( Socket& socket, address_v4 group, address_v4 local_interface = address_any );
+socks::ErrorCode try_leave_multicast_group( Socket&    socket,
+											address_v4 group,
+											address_v4 local_interface = address_any ) noexcept;
+void             leave_multicast_group( Socket& socket, address_v4 group, address_v4 local_interface = address_any );
+
+// number of routers multicast datagrams sent from socket may pass (default: 1 - only the local network)
+bool try_set_multicast_ttl( Socket& socket, int ttl ) noexcept;
+// whether multicast datagrams sent from socket are delivered to members on this host (default: true)
+bool try_set_multicast_loopback( Socket& socket, bool enable ) noexcept;
+// interface (identified by its address) for multicast datagrams sent from socket
+bool try_set_multicast_interface( Socket& socket, address_v4 local_interface ) noexcept;
+
 } // namespace ip::udp
 } // namespace mart::nw
 
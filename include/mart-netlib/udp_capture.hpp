@@ -0,0 +1,119 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_UDP_CAPTURE_HPP
+#define LIB_MART_COMMON_GUARD_NW_UDP_CAPTURE_HPP
+/**
+ * udp_capture.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Compact binary files of timestamped udp datagrams (for recording and replaying traffic)
+ *
+ * File format (all integers little endian):
+ * - file header: "MARTUDPC" (8 bytes), u32 format version (1), u32 reserved (0)
+ * - per record:  u64 receive time (ns since the unix epoch), u32 source address, u16 source port,
+ *                u16 payload size, followed by the payload
+ *
+ * Writer and reader go through a large buffer, such that the file is accessed with a few large calls
+ * instead of one per datagram.
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "network_exceptions.hpp"
+#include "udp.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+inline constexpr std::size_t capture_file_header_size   = 16;
+inline constexpr std::size_t capture_record_header_size = 16;
+// udp payloads are at most 65507 bytes (ipv4), so the payload size always fits into the u16 size field
+inline constexpr std::size_t capture_max_payload_size = 0xFFFF;
+
+struct CaptureRecord {
+	std::chrono::system_clock::time_point rx_time;
+	endpoint                              source;
+	mart::ConstMemoryView                 data;
+};
+
+class CaptureWriter {
+public:
+	/**
+	 * Creates (or truncates) the file at path and writes the file header.
+	 * Records are collected in a buffer of buffer_size bytes, that is written with a single call, when it is full.
+	 */
+	explicit CaptureWriter( const std::string& path, std::size_t buffer_size = 4 * 1024 * 1024 );
+	// flushes (errors are ignored - call flush explicitly, if they matter)
+	~CaptureWriter();
+
+	CaptureWriter( CaptureWriter&& ) noexcept = default;
+
+	// Appends a record. Throws, if data is larger than capture_max_payload_size or if writing to the file fails
+	void write( std::chrono::system_clock::time_point rx_time, const endpoint& source, mart::ConstMemoryView data );
+	void write( const CaptureRecord& record ) { write( record.rx_time, record.source, record.data ); }
+
+	// Writes all buffered records to the file
+	void flush();
+
+	std::uint64_t record_count() const noexcept { return _record_count; }
+
+private:
+	struct FileCloser {
+		void operator()( std::FILE* f ) const noexcept { std::fclose( f ); }
+	};
+
+	std::unique_ptr<std::FILE, FileCloser> _file;
+	std::string                            _path;
+	std::vector<mart::ByteType>            _buffer;
+	std::size_t                            _used         = 0;
+	std::uint64_t                          _record_count = 0;
+};
+
+class CaptureReader {
+public:
+	// Opens the file and checks the header (throws, if it isn't a capture file)
+	explicit CaptureReader( const std::string& path, std::size_t buffer_size = 4 * 1024 * 1024 );
+
+	/**
+	 * Returns the next record or nothing at the end of the file.
+	 * record.data points into the internal buffer and stays valid until the next call to read.
+	 * Throws, if the file ends in the middle of a record or on read errors.
+	 */
+	std::optional<CaptureRecord> read();
+
+private:
+	struct FileCloser {
+		void operator()( std::FILE* f ) const noexcept { std::fclose( f ); }
+	};
+
+	// makes sure, that at least size bytes are buffered (returns false at the end of the file)
+	bool _fill( std::size_t size );
+
+	std::unique_ptr<std::FILE, FileCloser> _file;
+	std::string                            _path;
+	std::vector<mart::ByteType>            _buffer;
+	std::size_t                            _begin = 0; // first unread byte
+	std::size_t                            _end   = 0; // end of the data read from the file
+	bool                                   _eof   = false;
+};
+
+} // namespace mart::nw::ip::udp
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_UDP_SHARDED_SERVER_HPP
+#define LIB_MART_COMMON_GUARD_NW_UDP_SHARDED_SERVER_HPP
+/**
+ * udp_sharded_server.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Multi threaded udp server, with one socket per worker thread bound to the same endpoint (SO_REUSEPORT)
+ *
+ * The kernel distributes incoming datagrams over the sockets based on a hash of the source and destination
+ * address, so datagrams from one peer are always processed by the same worker (in order) and receive processing
+ * scales with the number of workers - as long as there are enough distinct peers.
+ * NOTE: Requires SO_REUSEPORT (linux / bsd), the constructor throws if that isn't supported
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "udp.hpp"
+
+/* Standard Library Includes */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+class ShardedServer {
+public:
+	struct Config {
+		endpoint    local;            // port 0: all shards bind to the same, randomly chosen port
+		std::size_t shard_count = 0;  // 0: one per hardware thread
+		bool        pin_threads = true; // pin worker i to cpu i (modulo the number of cpus)
+
+		std::size_t max_datagram_size = 2048; // larger datagrams get truncated
+		std::size_t batch_size        = 32;   // datagrams received per syscall (see Socket::recv_batch)
+
+		int                       rx_buffer_size = 0; // SO_RCVBUF per socket (0: system default)
+		std::chrono::microseconds busy_poll{ 0 };     // SO_BUSY_POLL (0: disabled, linux only)
+
+		// how fast a worker notices stop() if no datagrams arrive
+		std::chrono::milliseconds stop_latency{ 50 };
+	};
+
+	/**
+	 * Called by the worker threads for every received datagram. socket is the shard's own socket,
+	 * which can be used to reply (datagram.remote_address). Calls for the same shard never run concurrently.
+	 * Exceptions escaping the handler terminate the program.
+	 */
+	using Handler = std::function<void( std::size_t shard, Socket& socket, const Socket::RecvfromResult& datagram )>;
+
+	// Binds all sockets and starts the workers. Throws if a socket can't be bound or a worker can't be started
+	ShardedServer( const Config& config, Handler handler );
+	~ShardedServer();
+
+	ShardedServer( const ShardedServer& ) = delete;
+	ShardedServer& operator=( const ShardedServer& ) = delete;
+
+	// Stops and joins the workers (datagrams still queued in the sockets are discarded). Idempotent.
+	void stop() noexcept;
+
+	std::size_t     shard_count() const noexcept { return _shards.size(); }
+	const endpoint& local_endpoint() const noexcept { return _local; }
+
+	// number of datagrams processed so far (per shard / in total)
+	std::uint64_t received( std::size_t shard ) const noexcept;
+	std::uint64_t received() const noexcept;
+
+	/**
+	 * A worker stops on the first receive error other than a timeout or an interrupted call - its socket is
+	 * most likely unusable. The shard's datagrams are then no longer processed (the kernel keeps assigning peers
+	 * to it), so check this periodically and restart the server, if necessary.
+	 * Returns the error that stopped the worker of shard or ErrorCodeValues::NoError, if it is (still) running.
+	 */
+	socks::ErrorCode error( std::size_t shard ) const noexcept;
+	// number of shards whose worker stopped because of an error
+	std::size_t failed_shards() const noexcept;
+
+private:
+	struct Shard;
+
+	void run( Shard& shard ) noexcept;
+
+	Handler                             _handler;
+	Config                              _config;
+	endpoint                            _local;
+	std::atomic<bool>                   _stop{ false };
+	std::vector<std::unique_ptr<Shard>> _shards;
+};
+
+} // namespace mart::nw::ip::udp
+
+#endif
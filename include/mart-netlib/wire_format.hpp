@@ -0,0 +1,258 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_WIRE_FORMAT_HPP
+#define LIB_MART_COMMON_GUARD_NW_WIRE_FORMAT_HPP
+/**
+ * wire_format.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Compile time description of binary message layouts with zero copy accessors
+ *
+ * A message schema is a struct with the size of the message and one constexpr Field per member
+ * (type, byte offset and byte order):
+ *
+ *   struct StatusMsg {
+ *       static constexpr std::size_t                            size = 8;
+ *       static constexpr wire::Field<std::uint32_t, 0>          seq{};
+ *       static constexpr wire::Field<std::uint16_t, 4>          heart_rate{};
+ *       static constexpr wire::Field<std::int16_t, 6, wire::le> temperature{};
+ *   };
+ *   static_assert( wire::is_valid_layout<StatusMsg>( StatusMsg::seq, StatusMsg::heart_rate, StatusMsg::temperature ) );
+ *
+ *   if( auto msg = wire::View<StatusMsg>::try_from( received ) ) {
+ *       std::uint32_t seq = msg->get( StatusMsg::seq ); // converted to host order
+ *   }
+ *   wire::Writer<StatusMsg>( buffer ).set( StatusMsg::seq, 5 ).set( StatusMsg::heart_rate, 80 );
+ *
+ * The size of the buffer is checked once, when a View / Writer is created. Whether a field lies within the message
+ * is checked at compile time, so the accessors are just an (unaligned) load / store plus a byte swap if necessary.
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "basic_types.hpp"
+#include "network_exceptions.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::wire {
+
+enum class ByteOrder { Big, Little };
+
+inline constexpr ByteOrder be      = ByteOrder::Big; // network byte order
+inline constexpr ByteOrder le      = ByteOrder::Little;
+inline constexpr ByteOrder network = ByteOrder::Big;
+inline constexpr ByteOrder native  = MBA_BYTE_ORDER == MBA_ORDER_LITTLE_ENDIAN ? ByteOrder::Little : ByteOrder::Big;
+
+/**
+ * Describes a member of a message: T (an arithmetic or enum type) is stored at byte Offset in the given byte order.
+ * Fields carry no data - they are only used to select the member in View::get / Writer::set
+ */
+template<class T, std::size_t Offset, ByteOrder Order = ByteOrder::Big>
+struct Field {
+	static_assert( std::is_arithmetic_v<T> || std::is_enum_v<T>, "Fields have to be arithmetic or enum types" );
+	static_assert( sizeof( T ) == 1 || sizeof( T ) == 2 || sizeof( T ) == 4 || sizeof( T ) == 8,
+				   "Fields have to be 1, 2, 4 or 8 bytes large" );
+
+	using type                              = T;
+	static constexpr std::size_t offset     = Offset;
+	static constexpr std::size_t size       = sizeof( T );
+	static constexpr ByteOrder   byte_order = Order;
+};
+
+namespace _impl_wire {
+
+template<std::size_t N>
+struct uint_of_size;
+template<>
+struct uint_of_size<1> {
+	using type = std::uint8_t;
+};
+template<>
+struct uint_of_size<2> {
+	using type = std::uint16_t;
+};
+template<>
+struct uint_of_size<4> {
+	using type = std::uint32_t;
+};
+template<>
+struct uint_of_size<8> {
+	using type = std::uint64_t;
+};
+
+template<class T, ByteOrder Order>
+T load( const mart::ByteType* src ) noexcept
+{
+	using U = typename uint_of_size<sizeof( T )>::type;
+	U bits;
+	std::memcpy( &bits, src, sizeof( bits ) );
+	if constexpr( Order != native ) { bits = mart::nw::bswap( bits ); }
+	T value;
+	std::memcpy( &value, &bits, sizeof( value ) );
+	return value;
+}
+
+template<class T, ByteOrder Order>
+void store( mart::ByteType* dst, T value ) noexcept
+{
+	using U = typename uint_of_size<sizeof( T )>::type;
+	U bits;
+	std::memcpy( &bits, &value, sizeof( bits ) );
+	if constexpr( Order != native ) { bits = mart::nw::bswap( bits ); }
+	std::memcpy( dst, &bits, sizeof( bits ) );
+}
+
+[[noreturn]] inline void throw_too_small( std::size_t required, std::size_t available )
+{
+	throw generic_nw_error( mba::concat( "Buffer of ",
+										 std::to_string( available ),
+										 " bytes is too small for a message of ",
+										 std::to_string( required ),
+										 " bytes" ) );
+}
+
+} // namespace _impl_wire
+
+/**
+ * True, if all fields lie within the message and don't overlap.
+ * Use it in a static_assert next to the schema (Msg::size is the size of the message in bytes).
+ */
+template<class Msg, class... Fields>
+constexpr bool is_valid_layout( const Fields&... ) noexcept
+{
+	constexpr std::size_t cnt = sizeof...( Fields );
+	if constexpr( cnt == 0 ) {
+		return true;
+	} else {
+		constexpr std::size_t offsets[cnt] = { Fields::offset... };
+		constexpr std::size_t sizes[cnt]   = { Fields::size... };
+		for( std::size_t i = 0; i < cnt; ++i ) {
+			if( offsets[i] + sizes[i] > Msg::size ) { return false; }
+			for( std::size_t j = i + 1; j < cnt; ++j ) {
+				if( offsets[i] < offsets[j] + sizes[j] && offsets[j] < offsets[i] + sizes[i] ) { return false; }
+			}
+		}
+		return true;
+	}
+}
+
+// Read only view of a message of type Msg at the start of a memory range
+template<class Msg>
+class View {
+public:
+	static constexpr std::size_t size = Msg::size;
+
+	// Throws, if data is smaller than the message
+	explicit View( mart::ConstMemoryView data )
+		: _data( data.data() )
+		, _trailing( data.size() >= size ? data.subview( size ) : mart::ConstMemoryView{} )
+	{
+		if( data.size() < size ) { _impl_wire::throw_too_small( size, data.size() ); }
+	}
+
+	// Returns nothing, if data is smaller than the message
+	static std::optional<View> try_from( mart::ConstMemoryView data ) noexcept
+	{
+		if( data.size() < size ) { return std::nullopt; }
+		return View( data, Unchecked{} );
+	}
+
+	// value of the field (in host byte order)
+	template<class T, std::size_t Offset, ByteOrder Order>
+	T get( Field<T, Offset, Order> ) const noexcept
+	{
+		static_assert( Offset + sizeof( T ) <= size, "Field lies outside of the message" );
+		return _impl_wire::load<T, Order>( _data + Offset );
+	}
+
+	// the bytes of the message
+	mart::ConstMemoryView bytes() const noexcept { return mart::ConstMemoryView( _data, size ); }
+	// everything after the message (e.g. a variable length payload following a fixed size header)
+	mart::ConstMemoryView trailing() const noexcept { return _trailing; }
+
+private:
+	struct Unchecked {};
+	View( mart::ConstMemoryView data, Unchecked ) noexcept
+		: _data( data.data() )
+		, _trailing( data.subview( size ) )
+	{
+	}
+
+	const mart::ByteType* _data;
+	mart::ConstMemoryView _trailing;
+};
+
+// Encodes a message of type Msg directly into the start of a memory range
+template<class Msg>
+class Writer {
+public:
+	static constexpr std::size_t size = Msg::size;
+
+	// Throws, if buffer is smaller than the message
+	explicit Writer( mart::MemoryView buffer )
+		: _data( buffer.data() )
+	{
+		if( buffer.size() < size ) { _impl_wire::throw_too_small( size, buffer.size() ); }
+	}
+
+	// Returns nothing, if buffer is smaller than the message
+	static std::optional<Writer> try_from( mart::MemoryView buffer ) noexcept
+	{
+		if( buffer.size() < size ) { return std::nullopt; }
+		return Writer( buffer.data(), Unchecked{} );
+	}
+
+	// stores value (given in host byte order) in the byte order of the field
+	template<class T, std::size_t Offset, ByteOrder Order>
+	Writer& set( Field<T, Offset, Order>, typename Field<T, Offset, Order>::type value ) noexcept
+	{
+		static_assert( Offset + sizeof( T ) <= size, "Field lies outside of the message" );
+		_impl_wire::store<T, Order>( _data + Offset, value );
+		return *this;
+	}
+
+	template<class T, std::size_t Offset, ByteOrder Order>
+	T get( Field<T, Offset, Order> field ) const noexcept
+	{
+		return view().get( field );
+	}
+
+	// sets all bytes of the message (including padding between the fields) to zero
+	Writer& clear() noexcept
+	{
+		std::memset( _data, 0, size );
+		return *this;
+	}
+
+	// the encoded message (e.g. to pass it to send)
+	mart::MemoryView bytes() const noexcept { return mart::MemoryView( _data, size ); }
+	View<Msg>        view() const noexcept { return *View<Msg>::try_from( bytes() ); }
+
+private:
+	struct Unchecked {};
+	Writer( mart::ByteType* data, Unchecked ) noexcept
+		: _data( data )
+	{
+	}
+
+	mart::ByteType* _data;
+};
+
+} // namespace mart::nw::wire
+
+#endif
@@ -0,0 +1,275 @@
+#include <mart-netlib/byte_order.hpp>
+
+/**
+ * byte_order.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Scalar, SSSE3 and AVX2 kernels for the array byte order conversions
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#if defined( __x86_64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define MART_NETLIB_BYTE_ORDER_HAS_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define MART_NETLIB_BYTE_ORDER_HAS_X86_KERNELS 0
+#endif
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+namespace {
+
+// All kernels work on raw bytes, so they can be used for the net and host order types alike.
+// They process count elements of W bytes each and support src == dst.
+
+template<std::size_t W, class U>
+void bswap_scalar_impl( const unsigned char* src, unsigned char* dst, std::size_t count ) noexcept
+{
+	static_assert( sizeof( U ) == W );
+	for( std::size_t i = 0; i < count; ++i ) {
+		U value;
+		std::memcpy( &value, src + i * W, W );
+		value = mart::nw::bswap( value );
+		std::memcpy( dst + i * W, &value, W );
+	}
+}
+
+template<std::size_t W>
+void bswap_scalar( const unsigned char* src, unsigned char* dst, std::size_t count ) noexcept
+{
+	if constexpr( W == 2 ) {
+		bswap_scalar_impl<W, std::uint16_t>( src, dst, count );
+	} else if constexpr( W == 4 ) {
+		bswap_scalar_impl<W, std::uint32_t>( src, dst, count );
+	} else {
+		bswap_scalar_impl<W, std::uint64_t>( src, dst, count );
+	}
+}
+
+#if MART_NETLIB_BYTE_ORDER_HAS_X86_KERNELS
+
+// shuffle control that reverses the bytes within each W byte element of a 16 byte lane
+struct ShuffleControl {
+	alignas( 16 ) char bytes[16];
+};
+
+template<std::size_t W>
+constexpr ShuffleControl make_shuffle_control() noexcept
+{
+	ShuffleControl ret{};
+	for( std::size_t i = 0; i < 16; ++i ) {
+		ret.bytes[i] = static_cast<char>( i / W * W + ( W - 1 - i % W ) );
+	}
+	return ret;
+}
+
+template<std::size_t W>
+constexpr ShuffleControl shuffle_control = make_shuffle_control<W>();
+
+template<std::size_t W>
+__attribute__( ( target( "ssse3" ) ) ) __m128i shuffle_mask() noexcept
+{
+	return _mm_load_si128( reinterpret_cast<const __m128i*>( shuffle_control<W>.bytes ) );
+}
+
+template<std::size_t W>
+__attribute__( ( target( "ssse3" ) ) ) void
+bswap_ssse3( const unsigned char* src, unsigned char* dst, std::size_t count ) noexcept
+{
+	const __m128i     mask  = shuffle_mask<W>();
+	const std::size_t bytes = count * W;
+
+	std::size_t i = 0;
+	for( ; i + 32 <= bytes; i += 32 ) {
+		const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i + 16 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_shuffle_epi8( a, mask ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i + 16 ), _mm_shuffle_epi8( b, mask ) );
+	}
+	for( ; i + 16 <= bytes; i += 16 ) {
+		const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_shuffle_epi8( a, mask ) );
+	}
+	bswap_scalar<W>( src + i, dst + i, ( bytes - i ) / W );
+}
+
+template<std::size_t W>
+__attribute__( ( target( "avx2" ) ) ) void
+bswap_avx2( const unsigned char* src, unsigned char* dst, std::size_t count ) noexcept
+{
+	// _mm256_shuffle_epi8 shuffles within each 16 byte lane, so both lanes use the same control
+	const __m256i     mask  = _mm256_broadcastsi128_si256( shuffle_mask<W>() );
+	const std::size_t bytes = count * W;
+
+	std::size_t i = 0;
+	for( ; i + 64 <= bytes; i += 64 ) {
+		const __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i ) );
+		const __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i + 32 ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), _mm256_shuffle_epi8( a, mask ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i + 32 ), _mm256_shuffle_epi8( b, mask ) );
+	}
+	for( ; i + 32 <= bytes; i += 32 ) {
+		const __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), _mm256_shuffle_epi8( a, mask ) );
+	}
+	bswap_ssse3<W>( src + i, dst + i, ( bytes - i ) / W );
+}
+
+#endif
+
+bool is_supported( ByteSwapKernel kernel ) noexcept
+{
+	switch( kernel ) {
+		case ByteSwapKernel::Scalar: return true;
+#if MART_NETLIB_BYTE_ORDER_HAS_X86_KERNELS
+		case ByteSwapKernel::Ssse3: return __builtin_cpu_supports( "ssse3" );
+		case ByteSwapKernel::Avx2: return __builtin_cpu_supports( "avx2" );
+#else
+		case ByteSwapKernel::Ssse3:
+		case ByteSwapKernel::Avx2: return false;
+#endif
+	}
+	return false;
+}
+
+std::atomic<ByteSwapKernel>& active_kernel() noexcept
+{
+	static std::atomic<ByteSwapKernel> kernel{ best_byte_swap_kernel() };
+	return kernel;
+}
+
+template<std::size_t W>
+void swap_bytes( const void* src, void* dst, std::size_t src_size, std::size_t dst_size ) noexcept
+{
+	assert( src_size == dst_size );
+	assert( src == dst || static_cast<const unsigned char*>( src ) + src_size * W <= static_cast<unsigned char*>( dst )
+			|| static_cast<unsigned char*>( dst ) + dst_size * W <= static_cast<const unsigned char*>( src ) );
+
+	const auto s     = static_cast<const unsigned char*>( src );
+	const auto d     = static_cast<unsigned char*>( dst );
+	const auto count = std::min( src_size, dst_size );
+
+	switch( active_kernel().load( std::memory_order_relaxed ) ) {
+#if MART_NETLIB_BYTE_ORDER_HAS_X86_KERNELS
+		case ByteSwapKernel::Avx2: bswap_avx2<W>( s, d, count ); return;
+		case ByteSwapKernel::Ssse3: bswap_ssse3<W>( s, d, count ); return;
+#endif
+		default: bswap_scalar<W>( s, d, count ); return;
+	}
+}
+
+// conversion between host and network order: a byte swap on little endian hosts, a copy otherwise
+template<std::size_t W>
+void convert( const void* src, void* dst, std::size_t src_size, std::size_t dst_size ) noexcept
+{
+#if MBA_BYTE_ORDER == MBA_ORDER_LITTLE_ENDIAN
+	swap_bytes<W>( src, dst, src_size, dst_size );
+#else
+	assert( src_size == dst_size );
+	if( src != dst ) { std::memmove( dst, src, std::min( src_size, dst_size ) * W ); }
+#endif
+}
+
+} // namespace
+
+void to_host_order( mart::ArrayView<const uint16_net_t> src, mart::ArrayView<uint16_host_t> dst ) noexcept
+{
+	convert<2>( src.data(), dst.data(), src.size(), dst.size() );
+}
+void to_host_order( mart::ArrayView<const uint32_net_t> src, mart::ArrayView<uint32_host_t> dst ) noexcept
+{
+	convert<4>( src.data(), dst.data(), src.size(), dst.size() );
+}
+void to_host_order( mart::ArrayView<const uint64_net_t> src, mart::ArrayView<uint64_host_t> dst ) noexcept
+{
+	convert<8>( src.data(), dst.data(), src.size(), dst.size() );
+}
+
+void to_net_order( mart::ArrayView<const uint16_host_t> src, mart::ArrayView<uint16_net_t> dst ) noexcept
+{
+	convert<2>( src.data(), dst.data(), src.size(), dst.size() );
+}
+void to_net_order( mart::ArrayView<const uint32_host_t> src, mart::ArrayView<uint32_net_t> dst ) noexcept
+{
+	convert<4>( src.data(), dst.data(), src.size(), dst.size() );
+}
+void to_net_order( mart::ArrayView<const uint64_host_t> src, mart::ArrayView<uint64_net_t> dst ) noexcept
+{
+	convert<8>( src.data(), dst.data(), src.size(), dst.size() );
+}
+
+void to_host_order_in_place( mart::ArrayView<std::uint16_t> data ) noexcept
+{
+	convert<2>( data.data(), data.data(), data.size(), data.size() );
+}
+void to_host_order_in_place( mart::ArrayView<std::uint32_t> data ) noexcept
+{
+	convert<4>( data.data(), data.data(), data.size(), data.size() );
+}
+void to_host_order_in_place( mart::ArrayView<std::uint64_t> data ) noexcept
+{
+	convert<8>( data.data(), data.data(), data.size(), data.size() );
+}
+
+// the conversion is symmetric
+void to_net_order_in_place( mart::ArrayView<std::uint16_t> data ) noexcept
+{
+	to_host_order_in_place( data );
+}
+void to_net_order_in_place( mart::ArrayView<std::uint32_t> data ) noexcept
+{
+	to_host_order_in_place( data );
+}
+void to_net_order_in_place( mart::ArrayView<std::uint64_t> data ) noexcept
+{
+	to_host_order_in_place( data );
+}
+
+void bswap( mart::ArrayView<const std::uint16_t> src, mart::ArrayView<std::uint16_t> dst ) noexcept
+{
+	swap_bytes<2>( src.data(), dst.data(), src.size(), dst.size() );
+}
+void bswap( mart::ArrayView<const std::uint32_t> src, mart::ArrayView<std::uint32_t> dst ) noexcept
+{
+	swap_bytes<4>( src.data(), dst.data(), src.size(), dst.size() );
+}
+void bswap( mart::ArrayView<const std::uint64_t> src, mart::ArrayView<std::uint64_t> dst ) noexcept
+{
+	swap_bytes<8>( src.data(), dst.data(), src.size(), dst.size() );
+}
+
+ByteSwapKernel best_byte_swap_kernel() noexcept
+{
+	if( is_supported( ByteSwapKernel::Avx2 ) ) { return ByteSwapKernel::Avx2; }
+	if( is_supported( ByteSwapKernel::Ssse3 ) ) { return ByteSwapKernel::Ssse3; }
+	return ByteSwapKernel::Scalar;
+}
+
+ByteSwapKernel byte_swap_kernel() noexcept
+{
+	return active_kernel().load( std::memory_order_relaxed );
+}
+
+bool set_byte_swap_kernel( ByteSwapKernel kernel ) noexcept
+{
+	if( !is_supported( kernel ) ) { return false; }
+	active_kernel().store( kernel, std::memory_order_relaxed );
+	return true;
+}
+
+} // namespace mart::nw
@@ -22,6 +22,8 @@
 
 #include <mart-netlib/detail/socket_base.hpp>
 
+#include "error_message.hpp"
+
 /* Proprietary Library Includes */
 #include <mart-common/ArrayView.h>
 #include <mart-common/utils.h>
@@ -33,13 +35,10 @@
 #include <string_view>
 
 #include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cstring>
 
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
-
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
@@ -47,40 +46,6 @@ namespace nw {
 namespace socks {
 namespace detail {
 
-namespace {
-
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
-{
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
-
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
-}
-
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
-{
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
-}
-
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
-{
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
-}
-
-} // namespace
-
 template<class EndpointT>
 DgramSocket<EndpointT>::DgramSocket( EndpointT local, EndpointT remote )
 	: DgramSocket()
@@ -151,6 +116,76 @@ bool is_none_of( T v )
 }
 } // namespace
 
+template<class EndpointT>
+void DgramSocket<EndpointT>::sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep )
+{
+	const auto res = _socket.sendto( data, 0, ep.toSockAddr() );
+	if( !res.success() ) {
+		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+			res.error_code(), "Failed to send data to ", ep.toString(), ". Details:  " ) );
+	}
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::ScatterRecvResult
+DgramSocket<EndpointT>::recvfrom( mart::ArrayView<const mart::MemoryView> buffers )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	typename EndpointT::abi_endpoint_type addr{};
+
+	const auto res = _socket.recvfrom( buffers, 0, addr );
+	if( res.success() ) { return { static_cast<std::size_t>( res.value() ), EndpointT( addr ) }; }
+	if( is_none_of<ErrorCodeValues,
+				   ErrorCodeValues::WouldBlock,
+				   ErrorCodeValues::TryAgain,
+				   ErrorCodeValues::Timeout,
+				   ErrorCodeValues::WsaeConnReset>( res.error_code().value() ) ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to receive data. Details:  " ) );
+	}
+	return { 0, endpoint{} };
+}
+
+template<class EndpointT>
+nw::socks::RaiiSocket::RecvResult
+DgramSocket<EndpointT>::_recvfrom( mart::MemoryView                       buffer,
+								   typename EndpointT::abi_endpoint_type& addr,
+								   std::chrono::system_clock::time_point& rx_timestamp,
+								   bool*                                  truncated ) noexcept
+{
+	return _spin_then_block_recv(
+		[&]( int flags ) { return _recvfrom_once( buffer, flags, addr, rx_timestamp, truncated ); } );
+}
+
+template<class EndpointT>
+nw::socks::RaiiSocket::RecvResult
+DgramSocket<EndpointT>::_recvfrom_once( mart::MemoryView                       buffer,
+										int                                    flags,
+										typename EndpointT::abi_endpoint_type& addr,
+										std::chrono::system_clock::time_point& rx_timestamp,
+										bool*                                  truncated ) noexcept
+{
+	// plain recvfrom doesn't report truncation
+	if( !_rx_timestamps && truncated == nullptr ) { return _socket.recvfrom( buffer, flags, addr ); }
+
+	std::chrono::nanoseconds timestamp{};
+
+	auto res = _socket.recv_timestamped( buffer, flags, &addr, timestamp, truncated );
+	if( res.result.success() && timestamp.count() != 0 ) {
+		rx_timestamp = std::chrono::system_clock::time_point(
+			std::chrono::duration_cast<std::chrono::system_clock::duration>( timestamp ) );
+	}
+	return res;
+}
+
+template<class EndpointT>
+bool DgramSocket<EndpointT>::try_enable_rx_timestamps( bool enable ) noexcept
+{
+	const bool success = _socket.enable_rx_timestamps( enable ).success();
+	if( success ) { _rx_timestamps = enable; }
+	return success;
+}
+
 template<class EndpointT>
 typename DgramSocket<EndpointT>::RecvfromResult DgramSocket<EndpointT>::recvfrom( mart::MemoryView buffer )
 {
@@ -158,7 +193,9 @@ typename DgramSocket<EndpointT>::RecvfromResult DgramSocket<EndpointT>::recvfrom
 	using abi_addr = typename EndpointT::abi_endpoint_type;
 	abi_addr addr{};
 
-	auto res = _socket.recvfrom( buffer, 0, addr );
+	std::chrono::system_clock::time_point rx_timestamp{};
+
+	auto res = _recvfrom( buffer, addr, rx_timestamp );
 	if( !res.result
 		&& is_none_of<ErrorCodeValues,
 					  ErrorCodeValues::WouldBlock,
@@ -169,7 +206,371 @@ typename DgramSocket<EndpointT>::RecvfromResult DgramSocket<EndpointT>::recvfrom
 			res.result.error_code(), "Failed to receive data. Details:  " ) );
 	}
 
-	return { res.received_data, EndpointT( addr ) };
+	return { res.received_data, EndpointT( addr ), rx_timestamp };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::Packet DgramSocket<EndpointT>::_recv_pooled( PacketPool&       pool,
+																			   socks::ErrorCode& error ) noexcept
+{
+	Packet packet = pool.try_allocate();
+	if( !packet ) {
+		error = socks::ErrorCode{ ErrorCodeValues::NoBufferSpace };
+		return packet;
+	}
+
+	typename EndpointT::abi_endpoint_type addr{};
+
+	std::chrono::system_clock::time_point rx_time{};
+
+	bool       truncated = false;
+	const auto res       = _recvfrom( packet.buffer(), addr, rx_time, &truncated );
+	if( !res.result ) {
+		error = res.result.error_code();
+		return Packet{};
+	}
+	if( truncated ) {
+		// the rest of the datagram is lost - don't pretend the clipped data was the whole message
+		error = socks::ErrorCode{ ErrorCodeValues::MessageSize };
+		return Packet{};
+	}
+
+	packet.assign( res.received_data.size(),
+				   EndpointT( addr ),
+				   rx_time == decltype( rx_time ){} ? std::chrono::system_clock::now() : rx_time );
+	error = socks::ErrorCode::Ok();
+	return packet;
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::Packet DgramSocket<EndpointT>::try_recv_pooled( PacketPool&       pool,
+																				  socks::ErrorCode* error ) noexcept
+{
+	socks::ErrorCode result{};
+	auto             packet = _recv_pooled( pool, result );
+	if( error != nullptr ) { *error = result; }
+	return packet;
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::Packet DgramSocket<EndpointT>::recv_pooled( PacketPool& pool )
+{
+	using mart::nw::socks::ErrorCodeValues;
+
+	socks::ErrorCode error{};
+	auto             packet = _recv_pooled( pool, error );
+	if( error.success() ) { return packet; }
+
+	if( !is_none_of<ErrorCodeValues,
+					ErrorCodeValues::WouldBlock,
+					ErrorCodeValues::TryAgain,
+					ErrorCodeValues::Timeout,
+					ErrorCodeValues::WsaeConnReset>( error.value() ) ) {
+		return Packet{};
+	}
+	if( error.value() == ErrorCodeValues::NoBufferSpace ) {
+		throw nw::generic_nw_error( mba::concat(
+			"Failed to receive data: All ", std::to_string( pool.slab_count() ), " packets of the pool are in use" ) );
+	}
+	if( error.value() == ErrorCodeValues::MessageSize ) {
+		throw nw::generic_nw_error( mba::concat( "Failed to receive data: Datagram was larger than the slab size of ",
+												 std::to_string( pool.slab_size() ),
+												 " bytes and got truncated" ) );
+	}
+	throw nw::generic_nw_error(
+		make_error_message_with_appended_last_errno( error, "Failed to receive data. Details:  " ) );
+}
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t>
+DgramSocket<EndpointT>::try_send_batch( mart::ArrayView<const mart::ConstMemoryView> data,
+										mart::ArrayView<const endpoint>           eps ) noexcept
+{
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	using RType    = socks::ReturnValue<std::size_t>;
+
+	if( !eps.empty() && eps.size() != data.size() ) { return RType{ ErrorCodeValues::InvalidArgument }; }
+
+	// Addresses have to be converted to their abi representation, which we do in chunks to limit stack usage
+	constexpr std::size_t chunk_size = 64;
+
+	std::array<abi_addr, chunk_size>            addrs{};
+	std::array<port_layer::SendMsg, chunk_size> msgs{};
+
+	abi_addr        default_addr{};
+	const Sockaddr* default_dest = nullptr;
+	if( eps.empty() && _ep_remote.valid() ) {
+		default_addr = _ep_remote.toSockAddr();
+		default_dest = &default_addr;
+	}
+
+	std::size_t sent = 0;
+	while( sent < data.size() ) {
+		const std::size_t n = std::min( chunk_size, data.size() - sent );
+		for( std::size_t i = 0; i < n; ++i ) {
+			msgs[i].data = _detail_socket_::to_byte_range( data[sent + i] );
+			msgs[i].size = 0;
+			if( eps.empty() ) {
+				msgs[i].to = default_dest;
+			} else {
+				addrs[i]   = eps[sent + i].toSockAddr();
+				msgs[i].to = &addrs[i];
+			}
+		}
+
+		const auto res = _socket.sendmmsg( mart::ArrayView<port_layer::SendMsg>( msgs.data(), n ), 0 );
+		if( !res.success() ) {
+			if( sent == 0 ) { return RType{ res.error_code() }; }
+			break;
+		}
+		sent += static_cast<std::size_t>( res.value() );
+		if( static_cast<std::size_t>( res.value() ) < n ) { break; }
+	}
+	return RType{ sent };
+}
+
+template<class EndpointT>
+void DgramSocket<EndpointT>::send_batch( mart::ArrayView<const mart::ConstMemoryView> data,
+										 mart::ArrayView<const endpoint>           eps )
+{
+	std::size_t sent = 0;
+	while( sent < data.size() ) {
+		const auto res = try_send_batch( data.subview( sent ), eps.empty() ? eps : eps.subview( sent ) );
+		if( !res.success() || res.value() == 0 ) {
+			throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+				res.error_code(), "Failed to send batch of datagrams. Details:  " ) );
+		}
+		sent += res.value();
+	}
+}
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t>
+DgramSocket<EndpointT>::try_recv_batch( mart::ArrayView<const mart::MemoryView> buffers,
+										mart::ArrayView<RecvfromResult>         results ) noexcept
+{
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	using RType    = socks::ReturnValue<std::size_t>;
+
+	const std::size_t n = std::min( { buffers.size(), results.size(), max_recv_batch_size } );
+
+	std::array<abi_addr, max_recv_batch_size>            addrs{};
+	std::array<port_layer::RecvMsg, max_recv_batch_size> msgs{};
+	for( std::size_t i = 0; i < n; ++i ) {
+		msgs[i].data = _detail_socket_::to_mutable_byte_range( buffers[i] );
+		msgs[i].from = &addrs[i];
+		msgs[i].size = 0;
+	}
+
+	const auto res = _socket.recvmmsg( mart::ArrayView<port_layer::RecvMsg>( msgs.data(), n ), 0 );
+	if( !res.success() ) { return RType{ res.error_code() }; }
+
+	const auto received = static_cast<std::size_t>( res.value() );
+	for( std::size_t i = 0; i < received; ++i ) {
+		using std::chrono::system_clock;
+		const auto rx_timestamp
+			= system_clock::time_point( std::chrono::duration_cast<system_clock::duration>( msgs[i].timestamp ) );
+		results[i] = RecvfromResult{
+			buffers[i].subview( 0, static_cast<std::size_t>( msgs[i].size ) ), EndpointT( addrs[i] ), rx_timestamp };
+	}
+	return RType{ received };
+}
+
+template<class EndpointT>
+std::size_t DgramSocket<EndpointT>::recv_batch( mart::ArrayView<const mart::MemoryView> buffers,
+												mart::ArrayView<RecvfromResult>         results )
+{
+	using mart::nw::socks::ErrorCodeValues;
+
+	const auto res = try_recv_batch( buffers, results );
+	if( res.success() ) { return res.value(); }
+
+	if( is_none_of<ErrorCodeValues,
+				   ErrorCodeValues::WouldBlock,
+				   ErrorCodeValues::TryAgain,
+				   ErrorCodeValues::Timeout,
+				   ErrorCodeValues::WsaeConnReset>( res.error_code().value() ) ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to receive data. Details:  " ) );
+	}
+	return 0;
+}
+
+namespace {
+// largest udp payload that fits into a single ipv4 packet (the limit for a whole segmented send)
+constexpr std::size_t max_udp_payload = 65507;
+// maximum number of segments the kernel accepts per send (UDP_MAX_SEGMENTS)
+constexpr std::size_t max_gso_segments = 64;
+} // namespace
+
+template<class EndpointT>
+bool DgramSocket<EndpointT>::supports_segmentation_offload() noexcept
+{
+	if( _gso_support == OffloadSupport::Unknown && is_valid() ) {
+		// Kernels without udp segmentation offload (and non-udp sockets) reject the option.
+		// A segment size of 0 means, that regular sends are not segmented
+		const int no_default_segmentation = 0;
+		const auto res = _socket.setsockopt( SocketOptionLevel::Udp, SocketOption::udp_segment, no_default_segmentation );
+		_gso_support   = res.success() ? OffloadSupport::Yes : OffloadSupport::No;
+	}
+	return _gso_support == OffloadSupport::Yes;
+}
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t> DgramSocket<EndpointT>::_send_segments_individually( mart::ConstMemoryView data,
+																					  std::size_t segment_size,
+																					  const Sockaddr* to ) noexcept
+{
+	using RType = socks::ReturnValue<std::size_t>;
+
+	std::array<port_layer::SendMsg, max_gso_segments> msgs{};
+
+	std::size_t sent = 0;
+	while( sent < data.size() ) {
+		std::size_t n = 0;
+		for( ; n < msgs.size() && sent + n * segment_size < data.size(); ++n ) {
+			msgs[n].data = _detail_socket_::to_byte_range( data.max_subview( sent + n * segment_size, segment_size ) );
+			msgs[n].to   = to;
+			msgs[n].size = 0;
+		}
+
+		const auto res = _socket.sendmmsg( mart::ArrayView<port_layer::SendMsg>( msgs.data(), n ), 0 );
+		if( !res.success() ) {
+			if( sent == 0 ) { return RType{ res.error_code() }; }
+			break;
+		}
+		const auto cnt = static_cast<std::size_t>( res.value() );
+		for( std::size_t i = 0; i < cnt; ++i ) {
+			sent += static_cast<std::size_t>( msgs[i].size );
+		}
+		if( cnt < n ) { break; }
+	}
+	return RType{ sent };
+}
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t> DgramSocket<EndpointT>::_send_segmented( mart::ConstMemoryView data,
+																		  std::size_t           segment_size,
+																		  const Sockaddr*       to ) noexcept
+{
+	using RType = socks::ReturnValue<std::size_t>;
+
+	if( segment_size == 0 || segment_size > max_udp_payload ) { return RType{ ErrorCodeValues::InvalidArgument }; }
+	if( !supports_segmentation_offload() ) { return _send_segments_individually( data, segment_size, to ); }
+
+	const std::size_t chunk_size = std::min( max_gso_segments, max_udp_payload / segment_size ) * segment_size;
+
+	std::size_t sent = 0;
+	while( sent < data.size() ) {
+		const auto res
+			= _socket.send_segmented( data.max_subview( sent, chunk_size ), 0, to, static_cast<std::uint16_t>( segment_size ) );
+		if( res.result.success() ) {
+			sent += static_cast<std::size_t>( res.result.value() );
+			continue;
+		}
+
+		// The kernel rejected the offloaded send (e.g. because the outgoing device can't do checksum offload
+		// or the segments don't fit into the mtu) -> send the remaining data as individual datagrams.
+		// Any other error (e.g. a pending ECONNREFUSED) is reported, just like a plain send would do
+		const auto errc = res.result.error_code();
+		if( errc.raw_value() != EIO && errc.value() != ErrorCodeValues::InvalidArgument
+			&& errc.value() != ErrorCodeValues::MessageSize && errc.raw_value() != ENOPROTOOPT
+			&& errc.value() != ErrorCodeValues::NotSupported ) {
+			if( sent == 0 ) { return RType{ errc }; }
+			break;
+		}
+
+		// The route / device won't change its mind, so don't try the offloaded send again on this socket
+		_gso_support    = OffloadSupport::No;
+		const auto rest = _send_segments_individually( data.subview( sent ), segment_size, to );
+		if( !rest.success() ) {
+			if( sent == 0 ) { return rest; }
+			break;
+		}
+		sent += rest.value();
+		break;
+	}
+	return RType{ sent };
+}
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t> DgramSocket<EndpointT>::try_send_segmented( mart::ConstMemoryView data,
+																			 std::size_t           segment_size,
+																			 const endpoint&       ep ) noexcept
+{
+	const typename EndpointT::abi_endpoint_type addr = ep.toSockAddr();
+	return _send_segmented( data, segment_size, &addr );
+}
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t> DgramSocket<EndpointT>::try_send_segmented( mart::ConstMemoryView data,
+																			 std::size_t segment_size ) noexcept
+{
+	if( !_ep_remote.valid() ) { return _send_segmented( data, segment_size, nullptr ); }
+	return try_send_segmented( data, segment_size, _ep_remote );
+}
+
+template<class EndpointT>
+void DgramSocket<EndpointT>::send_segmented( mart::ConstMemoryView data, std::size_t segment_size, const endpoint& ep )
+{
+	const auto res = try_send_segmented( data, segment_size, ep );
+	if( !res.success() || res.value() != data.size() ) {
+		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+			res.error_code(), "Failed to send segmented data to ", ep.toString(), ". Details:  " ) );
+	}
+}
+
+template<class EndpointT>
+void DgramSocket<EndpointT>::send_segmented( mart::ConstMemoryView data, std::size_t segment_size )
+{
+	const auto res = try_send_segmented( data, segment_size );
+	if( !res.success() || res.value() != data.size() ) {
+		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+			res.error_code(), "Failed to send segmented data. Details:  " ) );
+	}
+}
+
+template<class EndpointT>
+bool DgramSocket<EndpointT>::try_enable_gro( bool enable ) noexcept
+{
+	const int value = enable ? 1 : 0;
+	return _socket.setsockopt( SocketOptionLevel::Udp, SocketOption::udp_gro, value ).success();
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::CoalescedRecvResult
+DgramSocket<EndpointT>::try_recv_coalesced( mart::MemoryView buffer ) noexcept
+{
+	typename EndpointT::abi_endpoint_type addr{};
+	int                                   segment_size = 0;
+
+	const auto res = _socket.recv_coalesced( buffer, 0, &addr, segment_size );
+	if( !res.result.success() ) { return { res.received_data, endpoint{}, 0 }; }
+
+	return { res.received_data, endpoint( addr ), static_cast<std::size_t>( segment_size ) };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::CoalescedRecvResult DgramSocket<EndpointT>::recv_coalesced( mart::MemoryView buffer )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	typename EndpointT::abi_endpoint_type addr{};
+	int                                   segment_size = 0;
+
+	const auto res = _socket.recv_coalesced( buffer, 0, &addr, segment_size );
+	if( !res.result.success() ) {
+		if( is_none_of<ErrorCodeValues,
+					   ErrorCodeValues::WouldBlock,
+					   ErrorCodeValues::TryAgain,
+					   ErrorCodeValues::Timeout,
+					   ErrorCodeValues::WsaeConnReset>( res.result.error_code().value() ) ) {
+			throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+				res.result.error_code(), "Failed to receive data. Details:  " ) );
+		}
+		return { res.received_data, endpoint{}, 0 };
+	}
+
+	return { res.received_data, endpoint( addr ), static_cast<std::size_t>( segment_size ) };
 }
 
 namespace {
@@ -0,0 +1,80 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_DETAIL_ERROR_MESSAGE_H
+#define LIB_MART_COMMON_GUARD_NW_DETAIL_ERROR_MESSAGE_H
+
+/**
+ * error_message.hpp (mart-netlib/detail)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Private helpers for the text of the exceptions thrown by mart-netlib
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/RaiiSocket.hpp>
+#include <mart-netlib/port_layer.hpp>
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+#include <im_str/im_str.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+
+#if __has_include( <charconv> )
+#include <charconv>
+#endif
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+namespace socks {
+namespace detail {
+
+inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
+{
+#if __has_include( <charconv> )
+	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
+	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
+#else
+	auto res = std::to_string( error.raw_value() );
+	auto n   = std::min( res.size(), buffer.size() );
+
+	std::copy_n( res.begin(), n, buffer.begin() );
+	return { buffer.begin(), n };
+#endif
+}
+
+inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
+{
+	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
+}
+
+template<class... Elements>
+mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
+{
+	std::array<char, 24> errno_buffer{};
+	return mba::concat( std::string_view( elements )...,
+						"| Error Code:",
+						errno_nr_as_string( error, errno_buffer ),
+						" Error Msg: ",
+						socks::to_text_rep( error ) );
+}
+
+} // namespace detail
+} // namespace socks
+} // namespace nw
+} // namespace mart
+
+#endif
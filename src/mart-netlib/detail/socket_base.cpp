@@ -22,6 +22,8 @@
 
 #include <mart-netlib/detail/socket_base.hpp>
 
+#include "error_message.hpp"
+
 /* Proprietary Library Includes */
 #include <mart-common/ArrayView.h>
 #include <mart-common/utils.h>
@@ -36,10 +38,6 @@
 #include <cerrno>
 #include <cstring>
 
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
-
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
@@ -47,40 +45,6 @@ namespace nw {
 namespace socks {
 namespace detail {
 
-namespace {
-
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
-{
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
-
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
-}
-
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
-{
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
-}
-
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
-{
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
-}
-
-} // namespace
-
 // TODO: look for more efficient solution
 std::string to_string( std::chrono::microseconds timeout )
 {
@@ -143,6 +107,16 @@ void HighLevelSocketBase::set_blocking( bool should_block )
 }
 
 
+bool HighLevelSocketBase::wait_readable( std::chrono::microseconds timeout )
+{
+	const auto res = _socket.wait_readable( timeout );
+	if( !res.success() ) {
+		throw generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to wait for data on socket" ) );
+	}
+	return res.value();
+}
+
 void HighLevelSocketBase::close() {
 	if( !try_close() ) {
 		throw generic_nw_error( make_error_message_with_appended_last_errno(
@@ -192,7 +166,7 @@ void DgramSocketBase::send( mart::ConstMemoryView data )
 mart::MemoryView DgramSocketBase::recv( mart::MemoryView buffer )
 {
 	using mart::nw::socks::ErrorCodeValues;
-	const auto res = _socket.recv( buffer, 0 );
+	const auto res = _spin_then_block_recv( [&]( int flags ) { return _socket.recv( buffer, flags ); } );
 	if( !res.result
 		&& is_none_of<ErrorCodeValues,
 					  ErrorCodeValues::WouldBlock,
@@ -205,6 +179,38 @@ mart::MemoryView DgramSocketBase::recv( mart::MemoryView buffer )
 	return res.received_data;
 }
 
+void DgramSocketBase::send( mart::ArrayView<const mart::ConstMemoryView> data )
+{
+	const auto res = _socket.send( data, 0 );
+	if( !res ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to send data. Details:  " ) );
+	}
+}
+
+socks::ReturnValue<std::size_t> DgramSocketBase::try_recv( mart::ArrayView<const mart::MemoryView> buffers ) noexcept
+{
+	const auto res = _socket.recv( buffers, 0 );
+	if( !res ) { return socks::ReturnValue<std::size_t>( res.error_code() ); }
+	return socks::ReturnValue<std::size_t>( static_cast<std::size_t>( res.value() ) );
+}
+
+std::size_t DgramSocketBase::recv( mart::ArrayView<const mart::MemoryView> buffers )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	const auto res = try_recv( buffers );
+	if( !res
+		&& is_none_of<ErrorCodeValues,
+					  ErrorCodeValues::WouldBlock,
+					  ErrorCodeValues::TryAgain,
+					  ErrorCodeValues::Timeout,
+					  ErrorCodeValues::WsaeConnReset>( res.error_code().value() ) ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to receive data. Details:  " ) );
+	}
+	return res.value_or( 0 );
+}
+
 
 
 
@@ -0,0 +1,52 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_DETAIL_THREAD_AFFINITY_H
+#define LIB_MART_COMMON_GUARD_NW_DETAIL_THREAD_AFFINITY_H
+
+/**
+ * thread_affinity.hpp (mart-netlib/detail)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Private helper to pin the worker threads of the multi threaded servers to a cpu
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <thread>
+
+/* Platform Includes */
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+namespace detail {
+
+inline void pin_to_cpu( std::thread& thread, unsigned cpu ) noexcept
+{
+#if defined( __linux__ )
+	::cpu_set_t set;
+	CPU_ZERO( &set );
+	CPU_SET( cpu, &set );
+	// failure (e.g. cpu excluded by a cgroup) only costs performance
+	(void)::pthread_setaffinity_np( thread.native_handle(), sizeof( set ), &set );
+#else
+	(void)thread;
+	(void)cpu;
+#endif
+}
+
+} // namespace detail
+} // namespace nw
+} // namespace mart
+
+#endif
@@ -0,0 +1,820 @@
+#include <mart-netlib/io_queue.hpp>
+
+/**
+ * io_queue.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	io_uring (raw syscalls) and poll based implementations of port_layer::IoQueue
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+/* Platform Includes */
+#ifdef MBA_UTILS_USE_WINSOCKS
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <WinSock2.h>
+
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+#if defined( __linux__ )
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define MART_NETLIB_IO_QUEUE_HAS_IO_URING 1
+#else
+#define MART_NETLIB_IO_QUEUE_HAS_IO_URING 0
+#endif
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+namespace socks {
+namespace port_layer {
+
+namespace {
+
+enum class OpCode { Recv, Send, Accept, RecvFixed, SendFixed };
+
+struct Op {
+	OpCode         code;
+	handle_t       handle;
+	unsigned char* data;
+	std::size_t    size;
+	int            flags;
+	unsigned       buffer_index;
+	std::uint64_t  user_data;
+};
+
+ErrorCode error_from_errno( int err ) noexcept
+{
+	return ErrorCode{ static_cast<ErrorCodeValues>( err ) };
+}
+
+bool is_would_block( ErrorCode errc ) noexcept
+{
+	return errc.value() == ErrorCodeValues::WouldBlock || errc.value() == ErrorCodeValues::TryAgain;
+}
+
+} // namespace
+
+struct IoQueue::Impl {
+	virtual ~Impl() = default;
+
+	virtual IoBackend backend() const noexcept = 0;
+
+	virtual ErrorCode register_buffers( const byte_range_mut* buffers, std::size_t count ) noexcept = 0;
+	virtual ErrorCode unregister_buffers() noexcept                                                 = 0;
+	virtual ErrorCode register_handles( const handle_t* handles, std::size_t count ) noexcept        = 0;
+	virtual ErrorCode unregister_handles() noexcept                                                 = 0;
+
+	virtual bool             prepare( const Op& op ) noexcept = 0;
+	virtual ReturnValue<int> submit() noexcept                = 0;
+
+	virtual std::size_t prepared_count() const noexcept  = 0;
+	virtual std::size_t in_flight_count() const noexcept = 0;
+
+	virtual std::size_t      peek_completions( IoCompletion* out, std::size_t count ) noexcept                         = 0;
+	virtual ReturnValue<int> wait_completions( IoCompletion* out, std::size_t count, std::size_t min_complete ) noexcept = 0;
+};
+
+/* ################################################################################ */
+/* ############# Fallback: poll + regular port_layer calls ######################## */
+
+struct IoQueue::FallbackImpl : IoQueue::Impl {
+	explicit FallbackImpl( unsigned entries )
+		: _capacity( std::max( entries, 1u ) )
+	{
+		_prepared.reserve( _capacity );
+	}
+
+	IoBackend backend() const noexcept override { return IoBackend::Fallback; }
+
+	// nothing to register - the regular calls don't profit from it
+	ErrorCode register_buffers( const byte_range_mut*, std::size_t ) noexcept override { return ErrorCode::Ok(); }
+	ErrorCode unregister_buffers() noexcept override { return ErrorCode::Ok(); }
+	ErrorCode register_handles( const handle_t*, std::size_t ) noexcept override { return ErrorCode::Ok(); }
+	ErrorCode unregister_handles() noexcept override { return ErrorCode::Ok(); }
+
+	bool prepare( const Op& op ) noexcept override
+	{
+		if( _prepared.size() >= _capacity ) { return false; }
+		_prepared.push_back( op );
+		return true;
+	}
+
+	ReturnValue<int> submit() noexcept override
+	{
+		const auto cnt = static_cast<int>( _prepared.size() );
+		_in_flight.insert( _in_flight.end(), _prepared.begin(), _prepared.end() );
+		_prepared.clear();
+		// execute everything that can be executed without blocking right away
+		const auto ret = _progress( 0 );
+		if( !ret.success() ) { return ReturnValue<int>( ret.error_code() ); }
+		return ReturnValue<int>( cnt );
+	}
+
+	std::size_t prepared_count() const noexcept override { return _prepared.size(); }
+	std::size_t in_flight_count() const noexcept override { return _in_flight.size(); }
+
+	std::size_t peek_completions( IoCompletion* out, std::size_t count ) noexcept override
+	{
+		if( _completed.size() < count && !_in_flight.empty() ) { _progress( 0 ); }
+		const std::size_t n = std::min( count, _completed.size() );
+		std::copy_n( _completed.begin(), n, out );
+		_completed.erase( _completed.begin(), _completed.begin() + static_cast<std::ptrdiff_t>( n ) );
+		return n;
+	}
+
+	ReturnValue<int> wait_completions( IoCompletion* out, std::size_t count, std::size_t min_complete ) noexcept override
+	{
+		const auto sub = submit();
+		if( !sub.success() ) { return sub; }
+		while( _completed.size() < min_complete && !_in_flight.empty() ) {
+			const auto ret = _progress( -1 );
+			if( !ret.success() ) { return ret; }
+		}
+		return ReturnValue<int>( static_cast<int>( peek_completions( out, count ) ) );
+	}
+
+private:
+#ifdef MBA_UTILS_USE_WINSOCKS
+	using pollfd_t = ::WSAPOLLFD;
+#else
+	using pollfd_t = ::pollfd;
+#endif
+
+	static int _poll( pollfd_t* fds, std::size_t count, int timeout_ms ) noexcept
+	{
+#ifdef MBA_UTILS_USE_WINSOCKS
+		return ::WSAPoll( fds, static_cast<ULONG>( count ), timeout_ms );
+#else
+		return ::poll( fds, static_cast<::nfds_t>( count ), timeout_ms );
+#endif
+	}
+
+	static int _dont_wait( int flags ) noexcept
+	{
+#ifdef MBA_UTILS_USE_WINSOCKS
+		return flags;
+#else
+		return flags | MSG_DONTWAIT;
+#endif
+	}
+
+	// returns false, if the operation would block and has to be retried later on
+	bool _execute( const Op& op ) noexcept
+	{
+		IoCompletion c{ op.user_data, ErrorCode::Ok(), 0, handle_t::Invalid };
+		switch( op.code ) {
+			case OpCode::Recv:
+			case OpCode::RecvFixed: {
+				const auto ret
+					= port_layer::recv( op.handle, byte_range_mut{ op.data, op.size }, _dont_wait( op.flags ) );
+				c.error = ret.error_code();
+				c.size  = ret.value_or( 0 );
+			} break;
+			case OpCode::Send:
+			case OpCode::SendFixed: {
+				const auto ret = port_layer::send( op.handle, byte_range{ op.data, op.size }, _dont_wait( op.flags ) );
+				c.error        = ret.error_code();
+				c.size         = ret.value_or( 0 );
+			} break;
+			case OpCode::Accept: {
+				const auto ret = port_layer::accept( op.handle );
+				c.error        = ret.error_code();
+				c.handle       = ret.value_or( handle_t::Invalid );
+			} break;
+		}
+		if( is_would_block( c.error ) ) { return false; }
+		_completed.push_back( c );
+		return true;
+	}
+
+	// Waits up to timeout_ms for any in-flight operation to become ready and executes all that are
+	ReturnValue<int> _progress( int timeout_ms ) noexcept
+	{
+		if( _in_flight.empty() ) { return ReturnValue<int>( 0 ); }
+
+		_pollfds.resize( _in_flight.size() );
+		for( std::size_t i = 0; i < _in_flight.size(); ++i ) {
+			const Op& op       = _in_flight[i];
+			_pollfds[i].fd     = to_native( op.handle );
+			_pollfds[i].events = ( op.code == OpCode::Send || op.code == OpCode::SendFixed ) ? POLLOUT : POLLIN;
+			_pollfds[i].revents = 0;
+		}
+
+		int ready = 0;
+		do {
+			ready = _poll( _pollfds.data(), _pollfds.size(), timeout_ms );
+		} while( ready < 0 && get_last_socket_error().raw_value() == EINTR );
+		if( ready < 0 ) { return ReturnValue<int>( get_last_socket_error() ); }
+
+		// keep the order of the operations that are not done yet
+		int         done = 0;
+		std::size_t keep = 0;
+		for( std::size_t i = 0; i < _in_flight.size(); ++i ) {
+			if( _pollfds[i].revents != 0 && _execute( _in_flight[i] ) ) {
+				++done;
+			} else {
+				_in_flight[keep++] = _in_flight[i];
+			}
+		}
+		_in_flight.resize( keep );
+		return ReturnValue<int>( done );
+	}
+
+	std::size_t              _capacity;
+	std::vector<Op>          _prepared;
+	std::vector<Op>          _in_flight;
+	std::vector<pollfd_t>    _pollfds;
+	std::deque<IoCompletion> _completed;
+};
+
+/* ################################################################################ */
+/* ############# io_uring ######################################################### */
+
+#if MART_NETLIB_IO_QUEUE_HAS_IO_URING
+
+namespace {
+namespace uring {
+
+// Subset of the kernel ABI from linux/io_uring.h, such that we neither depend on liburing nor on recent kernel headers
+
+#ifdef __NR_io_uring_setup
+constexpr long sys_setup    = __NR_io_uring_setup;
+constexpr long sys_enter    = __NR_io_uring_enter;
+constexpr long sys_register = __NR_io_uring_register;
+#else
+// same number on all architectures
+constexpr long sys_setup    = 425;
+constexpr long sys_enter    = 426;
+constexpr long sys_register = 427;
+#endif
+
+struct SqringOffsets {
+	std::uint32_t head;
+	std::uint32_t tail;
+	std::uint32_t ring_mask;
+	std::uint32_t ring_entries;
+	std::uint32_t flags;
+	std::uint32_t dropped;
+	std::uint32_t array;
+	std::uint32_t resv1;
+	std::uint64_t resv2;
+};
+
+struct CqringOffsets {
+	std::uint32_t head;
+	std::uint32_t tail;
+	std::uint32_t ring_mask;
+	std::uint32_t ring_entries;
+	std::uint32_t overflow;
+	std::uint32_t cqes;
+	std::uint32_t flags;
+	std::uint32_t resv1;
+	std::uint64_t resv2;
+};
+
+struct Params {
+	std::uint32_t sq_entries;
+	std::uint32_t cq_entries;
+	std::uint32_t flags;
+	std::uint32_t sq_thread_cpu;
+	std::uint32_t sq_thread_idle;
+	std::uint32_t features;
+	std::uint32_t wq_fd;
+	std::uint32_t resv[3];
+	SqringOffsets sq_off;
+	CqringOffsets cq_off;
+};
+
+struct Sqe {
+	std::uint8_t  opcode;
+	std::uint8_t  flags;
+	std::uint16_t ioprio;
+	std::int32_t  fd;
+	std::uint64_t off; // addr2 for accept
+	std::uint64_t addr;
+	std::uint32_t len;
+	std::uint32_t op_flags; // msg_flags / accept_flags / rw_flags
+	std::uint64_t user_data;
+	std::uint16_t buf_index;
+	std::uint16_t personality;
+	std::int32_t  splice_fd_in;
+	std::uint64_t pad[2];
+};
+static_assert( sizeof( Sqe ) == 64, "io_uring submission queue entries have to be 64 bytes" );
+
+struct Cqe {
+	std::uint64_t user_data;
+	std::int32_t  res;
+	std::uint32_t flags;
+};
+static_assert( sizeof( Cqe ) == 16, "io_uring completion queue entries have to be 16 bytes" );
+
+struct ProbeOp {
+	std::uint8_t  op;
+	std::uint8_t  resv;
+	std::uint16_t flags;
+	std::uint32_t resv2;
+};
+
+struct Probe {
+	std::uint8_t  last_op;
+	std::uint8_t  ops_len;
+	std::uint16_t resv;
+	std::uint32_t resv2[3];
+	ProbeOp       ops[256];
+};
+
+constexpr std::uint8_t op_read_fixed  = 4;
+constexpr std::uint8_t op_write_fixed = 5;
+constexpr std::uint8_t op_accept      = 13;
+constexpr std::uint8_t op_send        = 26;
+constexpr std::uint8_t op_recv        = 27;
+
+constexpr std::uint16_t op_supported    = 1u << 0;
+constexpr std::uint8_t  sqe_fixed_file  = 1u << 0;
+constexpr unsigned      enter_getevents = 1u << 0;
+constexpr std::uint32_t feat_single_mmap = 1u << 0;
+
+constexpr unsigned register_buffers     = 0;
+constexpr unsigned unregister_buffers   = 1;
+constexpr unsigned register_files       = 2;
+constexpr unsigned unregister_files     = 3;
+constexpr unsigned register_probe       = 8;
+
+constexpr off_t off_sq_ring = 0;
+constexpr off_t off_cq_ring = 0x8000000;
+constexpr off_t off_sqes    = 0x10000000;
+
+int setup( unsigned entries, Params* params ) noexcept
+{
+	return static_cast<int>( ::syscall( sys_setup, entries, params ) );
+}
+
+int enter( int fd, unsigned to_submit, unsigned min_complete, unsigned flags ) noexcept
+{
+	return static_cast<int>( ::syscall( sys_enter, fd, to_submit, min_complete, flags, nullptr, 0 ) );
+}
+
+int register_( int fd, unsigned opcode, const void* arg, unsigned nr_args ) noexcept
+{
+	return static_cast<int>( ::syscall( sys_register, fd, opcode, arg, nr_args ) );
+}
+
+// the kernel reads / writes the ring indices concurrently
+std::uint32_t load_acquire( const std::uint32_t* p ) noexcept
+{
+	return __atomic_load_n( p, __ATOMIC_ACQUIRE );
+}
+
+void store_release( std::uint32_t* p, std::uint32_t v ) noexcept
+{
+	__atomic_store_n( p, v, __ATOMIC_RELEASE );
+}
+
+template<class T>
+T* at_offset( void* base, std::uint32_t offset ) noexcept
+{
+	return reinterpret_cast<T*>( static_cast<unsigned char*>( base ) + offset );
+}
+
+} // namespace uring
+} // namespace
+
+struct IoQueue::UringImpl : IoQueue::Impl {
+	UringImpl() = default;
+	UringImpl( const UringImpl& ) = delete;
+	UringImpl& operator=( const UringImpl& ) = delete;
+
+	~UringImpl() override
+	{
+		if( _sqes != MAP_FAILED ) { ::munmap( _sqes, _sqes_size ); }
+		if( _cq_ring != MAP_FAILED && _cq_ring != _sq_ring ) { ::munmap( _cq_ring, _cq_ring_size ); }
+		if( _sq_ring != MAP_FAILED ) { ::munmap( _sq_ring, _sq_ring_size ); }
+		if( _ring_fd >= 0 ) { ::close( _ring_fd ); }
+	}
+
+	// returns false, if io_uring isn't available or doesn't support all required operations
+	bool init( unsigned entries ) noexcept
+	{
+		uring::Params params;
+		std::memset( &params, 0, sizeof( params ) );
+		_ring_fd = uring::setup( std::max( entries, 1u ), &params );
+		if( _ring_fd < 0 ) { return false; }
+
+		_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof( std::uint32_t );
+		_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof( uring::Cqe );
+		if( params.features & uring::feat_single_mmap ) {
+			_sq_ring_size = _cq_ring_size = std::max( _sq_ring_size, _cq_ring_size );
+		}
+
+		_sq_ring = ::mmap(
+			nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, uring::off_sq_ring );
+		if( _sq_ring == MAP_FAILED ) { return false; }
+		if( params.features & uring::feat_single_mmap ) {
+			_cq_ring = _sq_ring;
+		} else {
+			_cq_ring = ::mmap(
+				nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, uring::off_cq_ring );
+			if( _cq_ring == MAP_FAILED ) { return false; }
+		}
+		_sqes_size = params.sq_entries * sizeof( uring::Sqe );
+		_sqes      = ::mmap(
+            nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, uring::off_sqes );
+		if( _sqes == MAP_FAILED ) { return false; }
+
+		_sq_head    = uring::at_offset<std::uint32_t>( _sq_ring, params.sq_off.head );
+		_sq_tail    = uring::at_offset<std::uint32_t>( _sq_ring, params.sq_off.tail );
+		_sq_array   = uring::at_offset<std::uint32_t>( _sq_ring, params.sq_off.array );
+		_sq_mask    = *uring::at_offset<std::uint32_t>( _sq_ring, params.sq_off.ring_mask );
+		_sq_entries = params.sq_entries;
+		_cq_head    = uring::at_offset<std::uint32_t>( _cq_ring, params.cq_off.head );
+		_cq_tail    = uring::at_offset<std::uint32_t>( _cq_ring, params.cq_off.tail );
+		_cq_mask    = *uring::at_offset<std::uint32_t>( _cq_ring, params.cq_off.ring_mask );
+		_cqes       = uring::at_offset<uring::Cqe>( _cq_ring, params.cq_off.cqes );
+		_local_tail = *_sq_tail;
+
+		// enough slots for a completely full completion queue, so prepare usually doesn't have to allocate
+		_ops.reserve( params.cq_entries );
+		_free_ops.reserve( params.cq_entries );
+
+		// recv / send need linux 5.6, which is also the first version that supports probing
+		std::unique_ptr<uring::Probe> probe( new( std::nothrow ) uring::Probe() );
+		if( !probe ) { return false; }
+		if( uring::register_( _ring_fd, uring::register_probe, probe.get(), 256 ) < 0 ) { return false; }
+		for( std::uint8_t op : { uring::op_recv, uring::op_send, uring::op_accept } ) {
+			if( op > probe->last_op || !( probe->ops[op].flags & uring::op_supported ) ) { return false; }
+		}
+		return true;
+	}
+
+	IoBackend backend() const noexcept override { return IoBackend::IoUring; }
+
+	ErrorCode register_buffers( const byte_range_mut* buffers, std::size_t count ) noexcept override
+	{
+		unregister_buffers();
+		std::vector<::iovec> iovs( count );
+		for( std::size_t i = 0; i < count; ++i ) {
+			iovs[i].iov_base = buffers[i].data();
+			iovs[i].iov_len  = buffers[i].size();
+		}
+		return _register( uring::register_buffers, iovs.data(), static_cast<unsigned>( count ) );
+	}
+
+	ErrorCode unregister_buffers() noexcept override
+	{
+		const auto ret = _register( uring::unregister_buffers, nullptr, 0 );
+		// nothing registered is not an error
+		return ret.raw_value() == ENXIO ? ErrorCode::Ok() : ret;
+	}
+
+	ErrorCode register_handles( const handle_t* handles, std::size_t count ) noexcept override
+	{
+		unregister_handles();
+		std::vector<std::int32_t> fds( count );
+		for( std::size_t i = 0; i < count; ++i ) {
+			fds[i] = to_native( handles[i] );
+		}
+		const auto ret = _register( uring::register_files, fds.data(), static_cast<unsigned>( count ) );
+		if( ret.success() ) {
+			for( std::size_t i = 0; i < count; ++i ) {
+				_fixed_handles[fds[i]] = static_cast<std::uint32_t>( i );
+			}
+		}
+		return ret;
+	}
+
+	ErrorCode unregister_handles() noexcept override
+	{
+		_fixed_handles.clear();
+		const auto ret = _register( uring::unregister_files, nullptr, 0 );
+		return ret.raw_value() == ENXIO ? ErrorCode::Ok() : ret;
+	}
+
+	bool prepare( const Op& op ) noexcept override
+	{
+		if( _local_tail - uring::load_acquire( _sq_head ) >= _sq_entries ) { return false; }
+
+		std::uint32_t slot = 0;
+		if( !_free_ops.empty() ) {
+			slot = _free_ops.back();
+			_free_ops.pop_back();
+		} else {
+			try {
+				// peek_completions must not allocate, when it hands the slot back
+				_free_ops.reserve( _ops.size() + 1 );
+				_ops.push_back( InFlightOp{} );
+			} catch( ... ) {
+				return false;
+			}
+			slot = static_cast<std::uint32_t>( _ops.size() - 1 );
+		}
+		_ops[slot].user_data = op.user_data;
+		_ops[slot].code      = op.code;
+
+		const std::uint32_t idx = _local_tail & _sq_mask;
+		uring::Sqe&         sqe = static_cast<uring::Sqe*>( _sqes )[idx];
+		std::memset( &sqe, 0, sizeof( sqe ) );
+		sqe.fd        = to_native( op.handle );
+		sqe.addr      = reinterpret_cast<std::uint64_t>( op.data );
+		sqe.len       = static_cast<std::uint32_t>( op.size );
+		sqe.user_data = slot; // the completion is mapped back to the operation (and the caller's user_data)
+
+		const auto fixed = _fixed_handles.find( to_native( op.handle ) );
+		if( fixed != _fixed_handles.end() ) {
+			sqe.fd = static_cast<std::int32_t>( fixed->second );
+			sqe.flags |= uring::sqe_fixed_file;
+		}
+
+		switch( op.code ) {
+			case OpCode::Recv:
+				sqe.opcode   = uring::op_recv;
+				sqe.op_flags = static_cast<std::uint32_t>( op.flags );
+				break;
+			case OpCode::Send:
+				sqe.opcode   = uring::op_send;
+				sqe.op_flags = static_cast<std::uint32_t>( op.flags | MSG_NOSIGNAL );
+				break;
+			case OpCode::Accept:
+				sqe.opcode   = uring::op_accept;
+				sqe.op_flags = SOCK_CLOEXEC; // like port_layer::accept
+				break;
+			case OpCode::RecvFixed:
+				sqe.opcode    = uring::op_read_fixed;
+				sqe.buf_index = static_cast<std::uint16_t>( op.buffer_index );
+				break;
+			case OpCode::SendFixed:
+				sqe.opcode    = uring::op_write_fixed;
+				sqe.buf_index = static_cast<std::uint16_t>( op.buffer_index );
+				break;
+		}
+
+		_sq_array[idx] = idx;
+		++_local_tail;
+		++_prepared;
+		return true;
+	}
+
+	ReturnValue<int> submit() noexcept override { return _enter( 0 ); }
+
+	std::size_t prepared_count() const noexcept override { return _prepared; }
+	std::size_t in_flight_count() const noexcept override { return _in_flight; }
+
+	std::size_t peek_completions( IoCompletion* out, std::size_t count ) noexcept override
+	{
+		std::uint32_t       head = *_cq_head;
+		const std::uint32_t tail = uring::load_acquire( _cq_tail );
+
+		std::size_t n = 0;
+		for( ; head != tail && n < count; ++head, ++n ) {
+			const uring::Cqe& cqe = _cqes[head & _cq_mask];
+
+			const auto       slot = static_cast<std::uint32_t>( cqe.user_data );
+			const InFlightOp op   = _ops[slot];
+			_free_ops.push_back( slot );
+
+			// accept reports the new handle, all other operations the number of transferred bytes
+			const bool    is_accept = op.code == OpCode::Accept;
+			IoCompletion& c         = out[n];
+			c.user_data             = op.user_data;
+			c.error                 = cqe.res < 0 ? error_from_errno( -cqe.res ) : ErrorCode::Ok();
+			c.size                  = cqe.res < 0 || is_accept ? 0 : cqe.res;
+			c.handle = cqe.res < 0 || !is_accept ? handle_t::Invalid : static_cast<handle_t>( cqe.res );
+		}
+		uring::store_release( _cq_head, head );
+		_in_flight -= std::min( _in_flight, n );
+		return n;
+	}
+
+	ReturnValue<int> wait_completions( IoCompletion* out, std::size_t count, std::size_t min_complete ) noexcept override
+	{
+		const std::size_t available = uring::load_acquire( _cq_tail ) - *_cq_head;
+		// don't wait for more operations than there are
+		const std::size_t wait_for = std::min( min_complete, _in_flight + _prepared );
+		if( _prepared != 0 || available < wait_for ) {
+			const auto ret = _enter( available < wait_for ? static_cast<unsigned>( wait_for - available ) : 0 );
+			if( !ret.success() ) { return ret; }
+		}
+		return ReturnValue<int>( static_cast<int>( peek_completions( out, count ) ) );
+	}
+
+private:
+	ErrorCode _register( unsigned opcode, const void* arg, unsigned nr_args ) noexcept
+	{
+		if( uring::register_( _ring_fd, opcode, arg, nr_args ) < 0 ) { return error_from_errno( errno ); }
+		return ErrorCode::Ok();
+	}
+
+	// submits all prepared entries and optionally waits for min_complete completions
+	ReturnValue<int> _enter( unsigned min_complete ) noexcept
+	{
+		uring::store_release( _sq_tail, _local_tail );
+
+		const unsigned flags     = min_complete != 0 ? uring::enter_getevents : 0;
+		int            submitted = 0;
+		while( true ) {
+			const int ret = uring::enter( _ring_fd, static_cast<unsigned>( _prepared ), min_complete, flags );
+			if( ret >= 0 ) {
+				submitted = ret;
+				break;
+			}
+			if( errno != EINTR ) { return ReturnValue<int>( error_from_errno( errno ) ); }
+		}
+		_prepared -= std::min( _prepared, static_cast<std::size_t>( submitted ) );
+		_in_flight += static_cast<std::size_t>( submitted );
+		return ReturnValue<int>( submitted );
+	}
+
+	int         _ring_fd      = -1;
+	void*       _sq_ring      = MAP_FAILED;
+	std::size_t _sq_ring_size = 0;
+	void*       _cq_ring      = MAP_FAILED;
+	std::size_t _cq_ring_size = 0;
+	void*       _sqes         = MAP_FAILED;
+	std::size_t _sqes_size    = 0;
+
+	std::uint32_t* _sq_head    = nullptr;
+	std::uint32_t* _sq_tail    = nullptr;
+	std::uint32_t* _sq_array   = nullptr;
+	std::uint32_t  _sq_mask    = 0;
+	std::uint32_t  _sq_entries = 0;
+	std::uint32_t  _local_tail = 0; // tail including prepared, but not yet published entries
+
+	std::uint32_t* _cq_head = nullptr;
+	std::uint32_t* _cq_tail = nullptr;
+	std::uint32_t  _cq_mask = 0;
+	uring::Cqe*    _cqes    = nullptr;
+
+	std::size_t _prepared  = 0;
+	std::size_t _in_flight = 0;
+
+	std::unordered_map<native_handle_t, std::uint32_t> _fixed_handles;
+
+	// prepared and in flight operations - indexed by the user_data of their submission queue entry
+	struct InFlightOp {
+		std::uint64_t user_data;
+		OpCode        code;
+	};
+	std::vector<InFlightOp>    _ops;
+	std::vector<std::uint32_t> _free_ops;
+};
+
+#endif // MART_NETLIB_IO_QUEUE_HAS_IO_URING
+
+/* ################################################################################ */
+/* ############# IoQueue ########################################################## */
+
+IoQueue::IoQueue( unsigned entries, IoBackend backend ) noexcept
+{
+#if MART_NETLIB_IO_QUEUE_HAS_IO_URING
+	if( backend != IoBackend::Fallback && io_uring_supported() ) {
+		std::unique_ptr<UringImpl> impl( new( std::nothrow ) UringImpl() );
+		if( impl && impl->init( entries ) ) { _impl = std::move( impl ); }
+	}
+#endif
+	if( !_impl && backend != IoBackend::IoUring ) { _impl.reset( new FallbackImpl( entries ) ); }
+}
+
+IoQueue::~IoQueue() = default;
+
+bool IoQueue::io_uring_supported() noexcept
+{
+#if MART_NETLIB_IO_QUEUE_HAS_IO_URING
+	static const bool supported = [] {
+		UringImpl probe;
+		return probe.init( 2 );
+	}();
+	return supported;
+#else
+	return false;
+#endif
+}
+
+bool IoQueue::is_valid() const noexcept
+{
+	return _impl != nullptr;
+}
+
+IoBackend IoQueue::backend() const noexcept
+{
+	return _impl->backend();
+}
+
+ErrorCode IoQueue::register_buffers( const byte_range_mut* buffers, std::size_t count ) noexcept
+{
+	return _impl->register_buffers( buffers, count );
+}
+
+ErrorCode IoQueue::unregister_buffers() noexcept
+{
+	return _impl->unregister_buffers();
+}
+
+ErrorCode IoQueue::register_handles( const handle_t* handles, std::size_t count ) noexcept
+{
+	return _impl->register_handles( handles, count );
+}
+
+ErrorCode IoQueue::unregister_handles() noexcept
+{
+	return _impl->unregister_handles();
+}
+
+bool IoQueue::prepare_recv( handle_t handle, byte_range_mut buffer, int flags, std::uint64_t user_data ) noexcept
+{
+	return _impl->prepare( Op{ OpCode::Recv, handle, buffer.data(), buffer.size(), flags, 0, user_data } );
+}
+
+bool IoQueue::prepare_send( handle_t handle, byte_range buffer, int flags, std::uint64_t user_data ) noexcept
+{
+	return _impl->prepare( Op{
+		OpCode::Send, handle, const_cast<unsigned char*>( buffer.data() ), buffer.size(), flags, 0, user_data } );
+}
+
+bool IoQueue::prepare_accept( handle_t handle, std::uint64_t user_data ) noexcept
+{
+	return _impl->prepare( Op{ OpCode::Accept, handle, nullptr, 0, 0, 0, user_data } );
+}
+
+bool IoQueue::prepare_recv_fixed( handle_t       handle,
+								  byte_range_mut buffer,
+								  unsigned       buffer_index,
+								  std::uint64_t  user_data ) noexcept
+{
+	return _impl->prepare( Op{ OpCode::RecvFixed, handle, buffer.data(), buffer.size(), 0, buffer_index, user_data } );
+}
+
+bool IoQueue::prepare_send_fixed( handle_t      handle,
+								  byte_range    buffer,
+								  unsigned      buffer_index,
+								  std::uint64_t user_data ) noexcept
+{
+	return _impl->prepare( Op{ OpCode::SendFixed,
+							   handle,
+							   const_cast<unsigned char*>( buffer.data() ),
+							   buffer.size(),
+							   0,
+							   buffer_index,
+							   user_data } );
+}
+
+ReturnValue<int> IoQueue::submit() noexcept
+{
+	return _impl->submit();
+}
+
+std::size_t IoQueue::prepared_count() const noexcept
+{
+	return _impl->prepared_count();
+}
+
+std::size_t IoQueue::in_flight_count() const noexcept
+{
+	return _impl->in_flight_count();
+}
+
+std::size_t IoQueue::peek_completions( IoCompletion* out, std::size_t count ) noexcept
+{
+	return _impl->peek_completions( out, count );
+}
+
+ReturnValue<int> IoQueue::wait_completions( IoCompletion* out, std::size_t count, std::size_t min_complete ) noexcept
+{
+	return _impl->wait_completions( out, count, min_complete );
+}
+
+} // namespace port_layer
+} // namespace socks
+} // namespace nw
+} // namespace mart
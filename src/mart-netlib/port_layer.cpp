@@ -15,9 +15,13 @@
  */
 
 /* ######## INCLUDES ######### */
+#include <algorithm>
 #include <cassert>
+#include <climits> // IOV_MAX
+#include <cstddef> // offsetof
 #include <cstdio>
 #include <cstring> // memcpy
+#include <limits>
 #include <new>     // launder
 #include <type_traits>
 
@@ -51,11 +55,77 @@
 #include <cerrno>
 #include <fcntl.h>
 #include <netdb.h> //addrinfo
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h> //iovec
 #include <sys/un.h>
 #include <unistd.h> //close
 #endif
+
+#if defined( __linux__ )
+#include <netinet/in.h>
+#include <netinet/udp.h> // UDP_SEGMENT, UDP_GRO
+
+// older libc headers don't know about udp segmentation offload yet (values from linux/udp.h)
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#ifndef SOL_UDP
+#define SOL_UDP IPPROTO_UDP
+#endif
+
+#include <linux/errqueue.h> // sock_extended_err
+
+// MSG_ZEROCOPY needs linux 4.14 (values from linux/socket.h, asm-generic/socket.h and linux/errqueue.h)
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+#include <linux/net_tstamp.h> // SOF_TIMESTAMPING_xxx
+#include <sys/sendfile.h>
+#include <time.h>
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef SO_TIMESTAMPNS
+#define SO_TIMESTAMPNS 35
+#endif
+#ifndef SCM_TIMESTAMPNS
+#define SCM_TIMESTAMPNS SO_TIMESTAMPNS
+#endif
+#ifndef SO_TIMESTAMPING
+#define SO_TIMESTAMPING 37
+#endif
+#ifndef SCM_TIMESTAMPING
+#define SCM_TIMESTAMPING SO_TIMESTAMPING
+#endif
+
+#define MART_NETLIB_PORT_LAYER_HAS_MMSG 1
+#define MART_NETLIB_PORT_LAYER_HAS_UDP_GSO 1
+#define MART_NETLIB_PORT_LAYER_HAS_ZEROCOPY 1
+#define MART_NETLIB_PORT_LAYER_HAS_RX_TIMESTAMPS 1
+#define MART_NETLIB_PORT_LAYER_HAS_SPLICE 1
+#else
+#define MART_NETLIB_PORT_LAYER_HAS_MMSG 0
+#define MART_NETLIB_PORT_LAYER_HAS_UDP_GSO 0
+#define MART_NETLIB_PORT_LAYER_HAS_ZEROCOPY 0
+#define MART_NETLIB_PORT_LAYER_HAS_RX_TIMESTAMPS 0
+#define MART_NETLIB_PORT_LAYER_HAS_SPLICE 0
+#endif
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 #ifdef __has_cpp_attribute
@@ -188,6 +258,11 @@ static_assert( to_utype( handle_t::Invalid ) == -1, "" );
 
 #endif // MBA_UTILS_USE_WINSOCKS
 
+// MulticastRequest is passed to setsockopt as is
+static_assert( sizeof( MulticastRequest ) == sizeof( ::ip_mreq ), "" );
+static_assert( offsetof( MulticastRequest, group ) == offsetof( ::ip_mreq, imr_multiaddr ), "" );
+static_assert( offsetof( MulticastRequest, local_interface ) == offsetof( ::ip_mreq, imr_interface ), "" );
+
 // Wrapper functions for socket related functions, that are specific to a certain platform
 ErrorCode set_blocking( handle_t socket, bool should_block ) noexcept
 {
@@ -333,6 +408,8 @@ int to_native( SocketOptionLevel level )
 {
 	switch( level ) {
 		case mart::nw::socks::SocketOptionLevel::Socket: return SOL_SOCKET; break;
+		case mart::nw::socks::SocketOptionLevel::Udp: return IPPROTO_UDP; break;
+		case mart::nw::socks::SocketOptionLevel::Ip: return IPPROTO_IP; break;
 	}
 	assert( false );
 	return static_cast<int>( level );
@@ -344,6 +421,36 @@ int to_native( SocketOption option )
 		case mart::nw::socks::SocketOption::so_rcvtimeo: return SO_RCVTIMEO; break;
 		case mart::nw::socks::SocketOption::so_sndtimeo: return SO_SNDTIMEO; break;
 		case mart::nw::socks::SocketOption::so_reuseaddr: return SO_REUSEADDR; break;
+#if MART_NETLIB_PORT_LAYER_HAS_UDP_GSO
+		case mart::nw::socks::SocketOption::udp_segment: return UDP_SEGMENT; break;
+		case mart::nw::socks::SocketOption::udp_gro: return UDP_GRO; break;
+#else
+		// not available on this platform -> setsockopt fails
+		case mart::nw::socks::SocketOption::udp_segment:
+		case mart::nw::socks::SocketOption::udp_gro: return -1; break;
+#endif
+#if MART_NETLIB_PORT_LAYER_HAS_ZEROCOPY
+		case mart::nw::socks::SocketOption::so_zerocopy: return SO_ZEROCOPY; break;
+#else
+		case mart::nw::socks::SocketOption::so_zerocopy: return -1; break;
+#endif
+		case mart::nw::socks::SocketOption::so_rcvbuf: return SO_RCVBUF; break;
+		case mart::nw::socks::SocketOption::so_sndbuf: return SO_SNDBUF; break;
+#ifdef SO_REUSEPORT
+		case mart::nw::socks::SocketOption::so_reuseport: return SO_REUSEPORT; break;
+#else
+		case mart::nw::socks::SocketOption::so_reuseport: return -1; break;
+#endif
+#if defined( __linux__ )
+		case mart::nw::socks::SocketOption::so_busy_poll: return SO_BUSY_POLL; break;
+#else
+		case mart::nw::socks::SocketOption::so_busy_poll: return -1; break;
+#endif
+		case mart::nw::socks::SocketOption::ip_multicast_ttl: return IP_MULTICAST_TTL; break;
+		case mart::nw::socks::SocketOption::ip_multicast_loop: return IP_MULTICAST_LOOP; break;
+		case mart::nw::socks::SocketOption::ip_multicast_if: return IP_MULTICAST_IF; break;
+		case mart::nw::socks::SocketOption::ip_add_membership: return IP_ADD_MEMBERSHIP; break;
+		case mart::nw::socks::SocketOption::ip_drop_membership: return IP_DROP_MEMBERSHIP; break;
 	}
 	assert( false );
 	return static_cast<int>( option );
@@ -415,7 +522,38 @@ ReturnValue<handle_t> accept( handle_t handle, Sockaddr& addr ) noexcept
 
 ReturnValue<handle_t> accept( handle_t handle ) noexcept
 {
+#if defined( __linux__ )
+	// like the overload with non_blocking, don't leak the connection into child processes
+	const auto ret = static_cast<handle_t>( ::accept4( to_native( handle ), nullptr, nullptr, SOCK_CLOEXEC ) );
+	return make_return_value( handle_t::Invalid, ret );
+#else
 	return make_return_value( handle_t::Invalid, static_cast<handle_t>( ::accept( to_native( handle ), nullptr, 0 ) ) );
+#endif
+}
+
+ReturnValue<handle_t> accept( handle_t handle, Sockaddr& addr, bool non_blocking ) noexcept
+{
+	auto addr_len = to_native_addr_len( addr.size() );
+#if defined( __linux__ )
+	const int  flags = SOCK_CLOEXEC | ( non_blocking ? SOCK_NONBLOCK : 0 );
+	const auto ret
+		= static_cast<handle_t>( ::accept4( to_native( handle ), addr.to_native_ptr(), &addr_len, flags ) );
+	addr.set_valid_data_range( addr_len );
+	return make_return_value( handle_t::Invalid, ret );
+#else
+	const auto ret = static_cast<handle_t>( ::accept( to_native( handle ), addr.to_native_ptr(), &addr_len ) );
+	addr.set_valid_data_range( addr_len );
+	auto res = make_return_value( handle_t::Invalid, ret );
+	if( !res.success() ) { return res; }
+
+	// e.g. on bsd, the new socket inherits the blocking mode of the listening socket
+	const auto errc = set_blocking( res.value(), !non_blocking );
+	if( !errc.success() ) {
+		close_socket( res.value() );
+		return ReturnValue<handle_t>( errc );
+	}
+	return res;
+#endif
 }
 
 ReturnValue<txrx_size_t> send( handle_t handle, byte_range buf, int flags ) noexcept
@@ -481,6 +619,701 @@ ReturnValue<txrx_size_t> recvfrom( handle_t handle, byte_range_mut buf, int flag
 	return make_return_value( txrx_size_t{ -1 }, ret );
 }
 
+int dontwait_flag() noexcept
+{
+#ifdef MBA_UTILS_USE_WINSOCKS
+	return 0;
+#else
+	return MSG_DONTWAIT;
+#endif
+}
+
+ReturnValue<bool> wait_readable( handle_t handle, std::chrono::microseconds timeout ) noexcept
+{
+#ifdef MBA_UTILS_USE_WINSOCKS
+	::WSAPOLLFD pfd{};
+#else
+	::pollfd pfd{};
+#endif
+	pfd.fd     = to_native( handle );
+	pfd.events = POLLIN;
+
+#if defined( __linux__ )
+	// ppoll, because poll only supports millisecond resolution
+	::timespec ts{};
+	ts.tv_sec       = static_cast<::time_t>( timeout.count() / 1000000 );
+	ts.tv_nsec      = static_cast<long>( ( timeout.count() % 1000000 ) * 1000 );
+	const int ready = ::ppoll( &pfd, 1, timeout.count() < 0 ? nullptr : &ts, nullptr );
+#else
+	// round up, such that we don't return before the timeout expired
+	const int timeout_ms = timeout.count() < 0 ? -1 : narrow_cast<int>( ( timeout.count() + 999 ) / 1000 );
+#ifdef MBA_UTILS_USE_WINSOCKS
+	const int ready = ::WSAPoll( &pfd, 1, timeout_ms );
+#else
+	const int ready = ::poll( &pfd, 1, timeout_ms );
+#endif
+#endif
+	if( ready < 0 ) { return ReturnValue<bool>( get_last_socket_error() ); }
+	return ReturnValue<bool>( ready > 0 );
+}
+
+namespace {
+
+// iovec / WSABUF array that lives on the stack for the common case of a few buffers
+#ifdef MBA_UTILS_USE_WINSOCKS
+using native_buf_t = ::WSABUF;
+#else
+using native_buf_t = ::iovec;
+#endif
+
+class NativeBufs {
+public:
+	template<class Range>
+	NativeBufs( const Range* bufs, std::size_t count )
+		: _data( _local )
+		, _count( count )
+	{
+		if( count > local_count ) {
+#ifdef IOV_MAX
+			// the kernel would reject that anyway - don't allocate for it
+			if( count > static_cast<std::size_t>( IOV_MAX ) ) {
+				_fail( ErrorCodeValues::MessageSize );
+				return;
+			}
+#endif
+			// the port layer doesn't throw
+			try {
+				_heap.resize( count );
+			} catch( ... ) {
+				_fail( ErrorCodeValues::NoBufferSpace );
+				return;
+			}
+			_data = _heap.data();
+		}
+		for( std::size_t i = 0; i < count; ++i ) {
+#ifdef MBA_UTILS_USE_WINSOCKS
+			_data[i].buf = const_cast<char*>( reinterpret_cast<const char*>( bufs[i].data() ) );
+			_data[i].len = narrow_cast<ULONG>( bufs[i].size() );
+#else
+			_data[i].iov_base = const_cast<unsigned char*>( bufs[i].data() );
+			_data[i].iov_len  = bufs[i].size();
+#endif
+		}
+	}
+
+	native_buf_t* data() noexcept { return _data; }
+	std::size_t   size() const noexcept { return _count; }
+	// NoError, unless the buffers couldn't be set up (then data() is nullptr)
+	ErrorCode error() const noexcept { return _error; }
+
+private:
+	static constexpr std::size_t local_count = 16;
+
+	void _fail( ErrorCodeValues error ) noexcept
+	{
+		_data  = nullptr;
+		_count = 0;
+		_error = ErrorCode{ error };
+	}
+
+	native_buf_t              _local[local_count];
+	std::vector<native_buf_t> _heap;
+	native_buf_t*             _data;
+	std::size_t               _count;
+	ErrorCode                 _error{ ErrorCodeValues::NoError };
+};
+
+} // namespace
+
+ReturnValue<txrx_size_t>
+sendv( handle_t handle, const byte_range* bufs, std::size_t count, int flags, const Sockaddr* to ) noexcept
+{
+	if( to != nullptr && is_invalid_destination_address( *to ) ) {
+		return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+	NativeBufs native( bufs, count );
+	if( !native.error().success() ) { return ReturnValue<txrx_size_t>{ native.error() }; }
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+	DWORD      sent = 0;
+	const auto ret  = ::WSASendTo( to_native( handle ),
+                                  native.data(),
+                                  narrow_cast<DWORD>( native.size() ),
+                                  &sent,
+                                  static_cast<DWORD>( flags ),
+                                  to != nullptr ? to->to_native_ptr() : nullptr,
+                                  to != nullptr ? to_native_addr_len( to->size() ) : 0,
+                                  nullptr,
+                                  nullptr );
+	if( ret != 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+	return ReturnValue<txrx_size_t>{ narrow_cast<txrx_size_t>( sent ) };
+#else
+	::msghdr hdr{};
+	hdr.msg_iov    = native.data();
+	hdr.msg_iovlen = native.size();
+	if( to != nullptr ) {
+		hdr.msg_name    = const_cast<::sockaddr*>( to->to_native_ptr() );
+		hdr.msg_namelen = to_native_addr_len( to->size() );
+	}
+	return make_return_value( txrx_size_t{ -1 },
+							  narrow_cast<txrx_size_t>( ::sendmsg( to_native( handle ), &hdr, flags | MSG_NOSIGNAL ) ) );
+#endif
+}
+
+ReturnValue<txrx_size_t>
+recvv( handle_t handle, const byte_range_mut* bufs, std::size_t count, int flags, Sockaddr* from ) noexcept
+{
+	NativeBufs native( bufs, count );
+	if( !native.error().success() ) { return ReturnValue<txrx_size_t>{ native.error() }; }
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+	DWORD         received  = 0;
+	DWORD         wsa_flags = static_cast<DWORD>( flags );
+	address_len_t from_len  = from != nullptr ? to_native_addr_len( from->size() ) : 0;
+
+	const auto ret = ::WSARecvFrom( to_native( handle ),
+									native.data(),
+									narrow_cast<DWORD>( native.size() ),
+									&received,
+									&wsa_flags,
+									from != nullptr ? from->to_native_ptr() : nullptr,
+									from != nullptr ? &from_len : nullptr,
+									nullptr,
+									nullptr );
+	if( ret != 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+	if( from != nullptr ) { from->set_valid_data_range( from_len ); }
+	return ReturnValue<txrx_size_t>{ narrow_cast<txrx_size_t>( received ) };
+#else
+	::msghdr hdr{};
+	hdr.msg_iov    = native.data();
+	hdr.msg_iovlen = native.size();
+	if( from != nullptr ) {
+		hdr.msg_name    = from->to_native_ptr();
+		hdr.msg_namelen = to_native_addr_len( from->size() );
+	}
+	const auto ret = narrow_cast<txrx_size_t>( ::recvmsg( to_native( handle ), &hdr, flags ) );
+	if( ret < 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+	if( from != nullptr ) { from->set_valid_data_range( hdr.msg_namelen ); }
+	return ReturnValue<txrx_size_t>{ ret };
+#endif
+}
+
+namespace {
+
+// number of messages that are passed to the kernel per sendmmsg / recvmmsg call
+constexpr std::size_t mmsg_chunk_size = 64;
+
+#if MART_NETLIB_PORT_LAYER_HAS_RX_TIMESTAMPS
+// control message buffer for the kernel receive timestamps
+// (SO_TIMESTAMPING reports three timestamps: software, legacy, raw hardware)
+union RxTimestampControl {
+	char      buffer[CMSG_SPACE( 3 * sizeof( ::timespec ) )];
+	::cmsghdr align;
+};
+
+// extracts the receive timestamp (time since epoch) from the control messages of hdr (0: there is none)
+std::chrono::nanoseconds extract_rx_timestamp( ::msghdr& hdr ) noexcept
+{
+	const auto to_ns = []( const ::timespec& ts ) {
+		return std::chrono::seconds( ts.tv_sec ) + std::chrono::nanoseconds( ts.tv_nsec );
+	};
+	std::chrono::nanoseconds timestamp{ 0 };
+	for( ::cmsghdr* cmsg = CMSG_FIRSTHDR( &hdr ); cmsg != nullptr; cmsg = CMSG_NXTHDR( &hdr, cmsg ) ) {
+		if( cmsg->cmsg_level != SOL_SOCKET ) { continue; }
+		if( cmsg->cmsg_type == SCM_TIMESTAMPNS ) {
+			::timespec ts;
+			std::memcpy( &ts, CMSG_DATA( cmsg ), sizeof( ts ) );
+			timestamp = to_ns( ts );
+		} else if( cmsg->cmsg_type == SCM_TIMESTAMPING ) {
+			::timespec ts[3];
+			std::memcpy( &ts, CMSG_DATA( cmsg ), sizeof( ts ) );
+			// prefer the software timestamp - the hardware one is usually not in the CLOCK_REALTIME domain
+			timestamp = ( ts[0].tv_sec != 0 || ts[0].tv_nsec != 0 ) ? to_ns( ts[0] ) : to_ns( ts[2] );
+		}
+	}
+	return timestamp;
+}
+#endif
+
+std::size_t count_valid_destinations( const SendMsg* msgs, std::size_t count )
+{
+	std::size_t i = 0;
+	while( i < count && ( msgs[i].to == nullptr || !is_invalid_destination_address( *msgs[i].to ) ) ) {
+		++i;
+	}
+	return i;
+}
+
+#if MART_NETLIB_PORT_LAYER_HAS_MMSG
+std::size_t min_size( std::size_t l, std::size_t r )
+{
+	return l < r ? l : r;
+}
+#endif
+
+} // namespace
+
+ReturnValue<int> sendmmsg( handle_t handle, SendMsg* msgs, std::size_t count, int flags ) noexcept
+{
+	// same check as in sendto, but we can still send all messages in front of the invalid one
+	const std::size_t valid_cnt = count_valid_destinations( msgs, count );
+	if( valid_cnt == 0 && count != 0 ) {
+		return ReturnValue<int>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+
+#if MART_NETLIB_PORT_LAYER_HAS_MMSG
+	flags = flags | MSG_NOSIGNAL;
+
+	std::size_t total = 0;
+	while( total < valid_cnt ) {
+		const std::size_t n = min_size( mmsg_chunk_size, valid_cnt - total );
+
+		::mmsghdr hdrs[mmsg_chunk_size];
+		::iovec   iovs[mmsg_chunk_size];
+		for( std::size_t i = 0; i < n; ++i ) {
+			const SendMsg& msg = msgs[total + i];
+			iovs[i].iov_base   = const_cast<char*>( msg.data.char_ptr() );
+			iovs[i].iov_len    = msg.data.size();
+
+			hdrs[i]                    = ::mmsghdr{};
+			hdrs[i].msg_hdr.msg_iov    = &iovs[i];
+			hdrs[i].msg_hdr.msg_iovlen = 1;
+			if( msg.to != nullptr ) {
+				hdrs[i].msg_hdr.msg_name    = const_cast<::sockaddr*>( msg.to->to_native_ptr() );
+				hdrs[i].msg_hdr.msg_namelen = to_native_addr_len( msg.to->size() );
+			}
+		}
+
+		const int ret = ::sendmmsg( to_native( handle ), hdrs, narrow_cast<unsigned int>( n ), flags );
+		if( ret < 0 ) {
+			if( total == 0 ) { return ReturnValue<int>{ get_last_socket_error() }; }
+			break;
+		}
+		for( int i = 0; i < ret; ++i ) {
+			msgs[total + i].size = narrow_cast<txrx_size_t>( hdrs[i].msg_len );
+		}
+		total += narrow_cast<std::size_t>( ret );
+		if( narrow_cast<std::size_t>( ret ) < n ) { break; }
+	}
+	return ReturnValue<int>{ narrow_cast<int>( total ) };
+#else
+	std::size_t total = 0;
+	for( ; total < valid_cnt; ++total ) {
+		SendMsg&   msg = msgs[total];
+		const auto res = msg.to != nullptr ? port_layer::sendto( handle, msg.data, flags, *msg.to )
+										   : port_layer::send( handle, msg.data, flags );
+		if( !res.success() ) {
+			if( total == 0 ) { return ReturnValue<int>{ res.error_code() }; }
+			break;
+		}
+		msg.size      = res.value();
+		msg.timestamp = std::chrono::nanoseconds{ 0 };
+	}
+	return ReturnValue<int>{ narrow_cast<int>( total ) };
+#endif
+}
+
+ReturnValue<int> recvmmsg( handle_t handle, RecvMsg* msgs, std::size_t count, int flags ) noexcept
+{
+#if MART_NETLIB_PORT_LAYER_HAS_MMSG
+	std::size_t total = 0;
+	while( total < count ) {
+		const std::size_t n = min_size( mmsg_chunk_size, count - total );
+
+		::mmsghdr          hdrs[mmsg_chunk_size];
+		::iovec            iovs[mmsg_chunk_size];
+		RxTimestampControl controls[mmsg_chunk_size];
+		for( std::size_t i = 0; i < n; ++i ) {
+			RecvMsg& msg     = msgs[total + i];
+			iovs[i].iov_base = msg.data.char_ptr();
+			iovs[i].iov_len  = msg.data.size();
+
+			hdrs[i]                        = ::mmsghdr{};
+			hdrs[i].msg_hdr.msg_iov        = &iovs[i];
+			hdrs[i].msg_hdr.msg_iovlen     = 1;
+			hdrs[i].msg_hdr.msg_control    = controls[i].buffer;
+			hdrs[i].msg_hdr.msg_controllen = sizeof( controls[i].buffer );
+			if( msg.from != nullptr ) {
+				hdrs[i].msg_hdr.msg_name    = msg.from->to_native_ptr();
+				hdrs[i].msg_hdr.msg_namelen = to_native_addr_len( msg.from->size() );
+			}
+		}
+
+		// only the first call may block (and only until the first datagram arrives)
+		const int chunk_flags = total == 0 ? flags | MSG_WAITFORONE : flags | MSG_DONTWAIT;
+		const int ret = ::recvmmsg( to_native( handle ), hdrs, narrow_cast<unsigned int>( n ), chunk_flags, nullptr );
+		if( ret < 0 ) {
+			if( total == 0 ) { return ReturnValue<int>{ get_last_socket_error() }; }
+			break;
+		}
+		for( int i = 0; i < ret; ++i ) {
+			RecvMsg& msg  = msgs[total + i];
+			msg.size      = narrow_cast<txrx_size_t>( hdrs[i].msg_len );
+			msg.timestamp = extract_rx_timestamp( hdrs[i].msg_hdr );
+			if( msg.from != nullptr ) { msg.from->set_valid_data_range( hdrs[i].msg_hdr.msg_namelen ); }
+		}
+		total += narrow_cast<std::size_t>( ret );
+		if( narrow_cast<std::size_t>( ret ) < n ) { break; }
+	}
+	return ReturnValue<int>{ narrow_cast<int>( total ) };
+#else
+	std::size_t total = 0;
+	for( ; total < count; ++total ) {
+		RecvMsg& msg = msgs[total];
+#ifdef MBA_UTILS_USE_WINSOCKS
+		// there is no per call non-blocking flag on windows
+		if( total != 0 ) { break; }
+		const int msg_flags = flags;
+#else
+		const int msg_flags = total == 0 ? flags : flags | MSG_DONTWAIT;
+#endif
+		const auto res = msg.from != nullptr ? port_layer::recvfrom( handle, msg.data, msg_flags, *msg.from )
+											 : port_layer::recv( handle, msg.data, msg_flags );
+		if( !res.success() ) {
+			if( total == 0 ) { return ReturnValue<int>{ res.error_code() }; }
+			break;
+		}
+		msg.size      = res.value();
+		msg.timestamp = std::chrono::nanoseconds{ 0 };
+	}
+	return ReturnValue<int>{ narrow_cast<int>( total ) };
+#endif
+}
+
+ReturnValue<txrx_size_t>
+send_segmented( handle_t handle, byte_range buf, int flags, const Sockaddr* to, std::uint16_t segment_size ) noexcept
+{
+#if MART_NETLIB_PORT_LAYER_HAS_UDP_GSO
+	if( to != nullptr && is_invalid_destination_address( *to ) ) {
+		return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+
+	::iovec iov;
+	iov.iov_base = const_cast<char*>( buf.char_ptr() );
+	iov.iov_len  = buf.size();
+
+	::msghdr hdr{};
+	hdr.msg_iov    = &iov;
+	hdr.msg_iovlen = 1;
+	if( to != nullptr ) {
+		hdr.msg_name    = const_cast<::sockaddr*>( to->to_native_ptr() );
+		hdr.msg_namelen = to_native_addr_len( to->size() );
+	}
+
+	union {
+		char      buffer[CMSG_SPACE( sizeof( std::uint16_t ) )];
+		::cmsghdr align;
+	} control;
+	std::memset( &control, 0, sizeof( control ) );
+	hdr.msg_control    = control.buffer;
+	hdr.msg_controllen = sizeof( control.buffer );
+
+	::cmsghdr* cmsg  = CMSG_FIRSTHDR( &hdr );
+	cmsg->cmsg_level = SOL_UDP;
+	cmsg->cmsg_type  = UDP_SEGMENT;
+	cmsg->cmsg_len   = CMSG_LEN( sizeof( std::uint16_t ) );
+	std::memcpy( CMSG_DATA( cmsg ), &segment_size, sizeof( segment_size ) );
+
+	return make_return_value( txrx_size_t{ -1 },
+							  narrow_cast<txrx_size_t>( ::sendmsg( to_native( handle ), &hdr, flags | MSG_NOSIGNAL ) ) );
+#else
+	(void)handle;
+	(void)buf;
+	(void)flags;
+	(void)to;
+	(void)segment_size;
+	return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::NotSupported } };
+#endif
+}
+
+ReturnValue<txrx_size_t>
+recv_coalesced( handle_t handle, byte_range_mut buf, int flags, Sockaddr* from, int& segment_size ) noexcept
+{
+#if MART_NETLIB_PORT_LAYER_HAS_UDP_GSO
+	::iovec iov;
+	iov.iov_base = buf.char_ptr();
+	iov.iov_len  = buf.size();
+
+	::msghdr hdr{};
+	hdr.msg_iov    = &iov;
+	hdr.msg_iovlen = 1;
+	if( from != nullptr ) {
+		hdr.msg_name    = from->to_native_ptr();
+		hdr.msg_namelen = to_native_addr_len( from->size() );
+	}
+
+	union {
+		char      buffer[CMSG_SPACE( sizeof( int ) )];
+		::cmsghdr align;
+	} control;
+	hdr.msg_control    = control.buffer;
+	hdr.msg_controllen = sizeof( control.buffer );
+
+	const auto ret = narrow_cast<txrx_size_t>( ::recvmsg( to_native( handle ), &hdr, flags ) );
+	if( ret < 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+
+	if( from != nullptr ) { from->set_valid_data_range( hdr.msg_namelen ); }
+
+	segment_size = ret;
+	for( ::cmsghdr* cmsg = CMSG_FIRSTHDR( &hdr ); cmsg != nullptr; cmsg = CMSG_NXTHDR( &hdr, cmsg ) ) {
+		if( cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO ) {
+			std::memcpy( &segment_size, CMSG_DATA( cmsg ), sizeof( int ) );
+		}
+	}
+	return ReturnValue<txrx_size_t>{ ret };
+#else
+	// no coalescing on this platform: each call receives a single datagram
+	const auto res = from != nullptr ? port_layer::recvfrom( handle, buf, flags, *from ) : port_layer::recv( handle, buf, flags );
+	segment_size   = res.value_or( 0 );
+	return res;
+#endif
+}
+
+ReturnValue<txrx_size_t> send_zerocopy( handle_t handle, byte_range buf, int flags ) noexcept
+{
+#if MART_NETLIB_PORT_LAYER_HAS_ZEROCOPY
+	return port_layer::send( handle, buf, flags | MSG_ZEROCOPY );
+#else
+	(void)handle;
+	(void)buf;
+	(void)flags;
+	return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::NotSupported } };
+#endif
+}
+
+ReturnValue<int> read_zerocopy_completions( handle_t                  handle,
+											ZerocopyCompletion*       out,
+											std::size_t               count,
+											std::chrono::milliseconds timeout ) noexcept
+{
+#if MART_NETLIB_PORT_LAYER_HAS_ZEROCOPY
+	if( count == 0 ) { return ReturnValue<int>{ 0 }; }
+
+	// a non-empty error queue is signaled as POLLERR, which doesn't have to be requested explicitly
+	if( timeout.count() != 0 ) {
+		::pollfd pfd{};
+		pfd.fd          = to_native( handle );
+		pfd.events      = 0;
+		const int ready = ::poll( &pfd, 1, timeout.count() < 0 ? -1 : narrow_cast<int>( timeout.count() ) );
+		if( ready < 0 ) { return ReturnValue<int>{ get_last_socket_error() }; }
+	}
+
+	std::size_t cnt = 0;
+	while( cnt < count ) {
+		union {
+			char      buffer[CMSG_SPACE( sizeof( ::sock_extended_err ) + sizeof( ::sockaddr_in6 ) )];
+			::cmsghdr align;
+		} control;
+
+		::msghdr hdr{};
+		hdr.msg_control    = control.buffer;
+		hdr.msg_controllen = sizeof( control.buffer );
+
+		if( ::recvmsg( to_native( handle ), &hdr, MSG_ERRQUEUE | MSG_DONTWAIT ) < 0 ) {
+			const auto err = get_last_socket_error();
+			if( cnt == 0 && err.value() != ErrorCodeValues::WouldBlock && err.value() != ErrorCodeValues::TryAgain ) {
+				return ReturnValue<int>{ err };
+			}
+			break;
+		}
+
+		for( ::cmsghdr* cmsg = CMSG_FIRSTHDR( &hdr ); cmsg != nullptr; cmsg = CMSG_NXTHDR( &hdr, cmsg ) ) {
+			const bool is_recverr = ( cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR )
+									|| ( cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR );
+			if( !is_recverr ) { continue; }
+
+			::sock_extended_err err;
+			std::memcpy( &err, CMSG_DATA( cmsg ), sizeof( err ) );
+			if( err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY ) { continue; }
+
+			out[cnt].first  = err.ee_info;
+			out[cnt].last   = err.ee_data;
+			out[cnt].copied = ( err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED ) != 0;
+			++cnt;
+		}
+	}
+	return ReturnValue<int>{ narrow_cast<int>( cnt ) };
+#else
+	(void)handle;
+	(void)out;
+	(void)count;
+	(void)timeout;
+	return ReturnValue<int>{ ErrorCode{ ErrorCodeValues::NotSupported } };
+#endif
+}
+
+ReturnValue<txrx_size_t> send_file( handle_t handle, int file_fd, std::int64_t& offset, std::size_t count ) noexcept
+{
+	// a single call can't report more than txrx_size_t can hold
+	count = std::min<std::size_t>( count, static_cast<std::size_t>( std::numeric_limits<txrx_size_t>::max() ) );
+#if MART_NETLIB_PORT_LAYER_HAS_SPLICE
+	::off_t    off = static_cast<::off_t>( offset );
+	const auto ret = ::sendfile( to_native( handle ), file_fd, &off, count );
+	if( ret < 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+	offset = static_cast<std::int64_t>( off );
+	return ReturnValue<txrx_size_t>{ static_cast<txrx_size_t>( ret ) };
+#elif defined( MBA_UTILS_USE_WINSOCKS )
+	(void)handle;
+	(void)file_fd;
+	(void)offset;
+	(void)count;
+	return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::NotSupported } };
+#else
+	unsigned char buffer[16 * 1024];
+	const auto    rd = ::pread( file_fd, buffer, std::min( count, sizeof( buffer ) ), static_cast<::off_t>( offset ) );
+	if( rd < 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+	if( rd == 0 ) { return ReturnValue<txrx_size_t>{ 0 }; }
+
+	const auto ret = port_layer::send( handle, byte_range{ buffer, static_cast<std::size_t>( rd ) }, 0 );
+	if( ret.success() ) { offset += ret.value(); }
+	return ret;
+#endif
+}
+
+Splicer::Splicer() noexcept
+{
+	_pipe[0] = -1;
+	_pipe[1] = -1;
+#if MART_NETLIB_PORT_LAYER_HAS_SPLICE
+	if( ::pipe2( _pipe, O_CLOEXEC ) != 0 ) {
+		_pipe[0] = -1;
+		_pipe[1] = -1;
+		return;
+	}
+	// a larger pipe means fewer round trips through the pipe (the default is 64k, more may be denied)
+	::fcntl( _pipe[1], F_SETPIPE_SZ, 1024 * 1024 );
+	const int capacity = ::fcntl( _pipe[1], F_GETPIPE_SZ );
+	_capacity          = capacity > 0 ? static_cast<std::size_t>( capacity ) : 64 * 1024;
+#endif
+}
+
+Splicer::~Splicer()
+{
+#if MART_NETLIB_PORT_LAYER_HAS_SPLICE
+	if( is_valid() ) {
+		::close( _pipe[0] );
+		::close( _pipe[1] );
+	}
+#endif
+}
+
+ReturnValue<txrx_size_t> Splicer::transfer( int in_fd, int out_fd, std::size_t count ) noexcept
+{
+#if MART_NETLIB_PORT_LAYER_HAS_SPLICE
+	if( !is_valid() ) { return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } }; }
+	// the data in the pipe was meant for another destination
+	if( _pending != 0 && out_fd != _out_fd ) {
+		return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+	_out_fd = out_fd;
+
+	count = std::min<std::size_t>( count, static_cast<std::size_t>( std::numeric_limits<txrx_size_t>::max() ) );
+
+	// No SPLICE_F_NONBLOCK: it would also make blocking sockets non-blocking. The pipe never blocks anyway,
+	// as we only fill it, when it is empty (up to its capacity) and only drain what is in it.
+	const unsigned int flags = SPLICE_F_MOVE;
+
+	std::size_t total = 0;
+	while( total < count ) {
+		if( _pending == 0 ) {
+			// like recv: don't wait for more data, once we have something to report
+			if( total != 0 ) { break; }
+			const auto in = ::splice( in_fd, nullptr, _pipe[1], nullptr, std::min( count - total, _capacity ), flags );
+			if( in < 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+			if( in == 0 ) { break; } // end of file / connection closed
+			_pending = static_cast<std::size_t>( in );
+		}
+
+		const auto out = ::splice( _pipe[0], nullptr, out_fd, nullptr, std::min( count - total, _pending ), flags );
+		if( out < 0 ) {
+			if( total != 0 ) { break; }
+			return ReturnValue<txrx_size_t>{ get_last_socket_error() };
+		}
+		_pending -= static_cast<std::size_t>( out );
+		total += static_cast<std::size_t>( out );
+	}
+	return ReturnValue<txrx_size_t>{ static_cast<txrx_size_t>( total ) };
+#else
+	(void)in_fd;
+	(void)out_fd;
+	(void)count;
+	return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::NotSupported } };
+#endif
+}
+
+ErrorCode enable_rx_timestamps( handle_t handle, bool enable ) noexcept
+{
+#if MART_NETLIB_PORT_LAYER_HAS_RX_TIMESTAMPS
+	const int flags = enable ? ( SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+								 | SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE )
+							 : 0;
+	const bool timestamping_ok
+		= ::setsockopt( to_native( handle ), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof( flags ) ) == 0;
+
+	// if SO_TIMESTAMPING is available, SO_TIMESTAMPNS is only needed to switch it off (in case it was used before)
+	const int  ns_flag = enable && !timestamping_ok ? 1 : 0;
+	const bool ns_ok
+		= ::setsockopt( to_native( handle ), SOL_SOCKET, SO_TIMESTAMPNS, &ns_flag, sizeof( ns_flag ) ) == 0;
+
+	if( enable ? ( timestamping_ok || ns_ok ) : ns_ok ) { return ErrorCode{ ErrorCodeValues::NoError }; }
+	return get_last_socket_error();
+#else
+	(void)handle;
+	(void)enable;
+	return ErrorCode{ ErrorCodeValues::NotSupported };
+#endif
+}
+
+ReturnValue<txrx_size_t> recv_timestamped( handle_t                  handle,
+										   byte_range_mut            buf,
+										   int                       flags,
+										   Sockaddr*                 from,
+										   std::chrono::nanoseconds& timestamp,
+										   bool*                     truncated ) noexcept
+{
+	timestamp = std::chrono::nanoseconds{ 0 };
+	if( truncated != nullptr ) { *truncated = false; }
+#ifdef MBA_UTILS_USE_WINSOCKS
+	// winsock reports truncated datagrams as WSAEMSGSIZE (after filling the buffer)
+	auto res = from != nullptr ? port_layer::recvfrom( handle, buf, flags, *from )
+							   : port_layer::recv( handle, buf, flags );
+	if( !res.success() && res.error_code().raw_value() == WSAEMSGSIZE && truncated != nullptr ) {
+		*truncated = true;
+		return ReturnValue<txrx_size_t>{ narrow_cast<txrx_size_t>( buf.size() ) };
+	}
+	return res;
+#else
+	::iovec iov;
+	iov.iov_base = buf.char_ptr();
+	iov.iov_len  = buf.size();
+
+	::msghdr hdr{};
+	hdr.msg_iov    = &iov;
+	hdr.msg_iovlen = 1;
+	if( from != nullptr ) {
+		hdr.msg_name    = from->to_native_ptr();
+		hdr.msg_namelen = to_native_addr_len( from->size() );
+	}
+
+#if MART_NETLIB_PORT_LAYER_HAS_RX_TIMESTAMPS
+	RxTimestampControl control;
+	hdr.msg_control    = control.buffer;
+	hdr.msg_controllen = sizeof( control.buffer );
+#endif
+
+	const auto ret = narrow_cast<txrx_size_t>( ::recvmsg( to_native( handle ), &hdr, flags ) );
+	if( ret < 0 ) { return ReturnValue<txrx_size_t>{ get_last_socket_error() }; }
+
+	if( from != nullptr ) { from->set_valid_data_range( hdr.msg_namelen ); }
+	if( truncated != nullptr ) { *truncated = ( hdr.msg_flags & MSG_TRUNC ) != 0; }
+
+#if MART_NETLIB_PORT_LAYER_HAS_RX_TIMESTAMPS
+	timestamp = extract_rx_timestamp( hdr );
+#endif
+	return ReturnValue<txrx_size_t>{ ret };
+#endif
+}
+
 // implementation details for timeout related functions
 // Todo: move into general utilities
 namespace {
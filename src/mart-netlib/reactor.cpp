@@ -0,0 +1,353 @@
+#include <mart-netlib/reactor.hpp>
+
+/**
+ * reactor.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	epoll based implementation of mart::nw::Reactor
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/network_exceptions.hpp>
+
+#include "detail/error_message.hpp"
+
+/* Proprietary Library Includes */
+#include <im_str/im_str.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <functional>
+#include <limits>
+#include <string_view>
+
+/* Platform Includes */
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace nw {
+
+namespace {
+
+template<class... Elements>
+mba::im_zstr make_error_message_with_appended_last_errno( Elements&&... elements )
+{
+	return socks::detail::make_error_message_with_appended_last_errno( socks::port_layer::get_last_socket_error(),
+																	   std::forward<Elements>( elements )... );
+}
+
+// number of events retrieved per epoll_wait call
+constexpr int max_events_per_wait = 256;
+
+// the handle is stored in the lower, a per registration generation counter in the upper 32 bit of the epoll user data.
+// This allows us to detect events for a file descriptor that got closed and reused for a new registration
+// while the events were already pending
+constexpr std::uint64_t make_user_data( int fd, std::uint32_t generation ) noexcept
+{
+	return ( static_cast<std::uint64_t>( generation ) << 32 ) | static_cast<std::uint32_t>( fd );
+}
+
+constexpr int fd_from_user_data( std::uint64_t data ) noexcept
+{
+	return static_cast<int>( static_cast<std::uint32_t>( data ) );
+}
+
+constexpr std::uint32_t generation_from_user_data( std::uint64_t data ) noexcept
+{
+	return static_cast<std::uint32_t>( data >> 32 );
+}
+
+// the wakeup eventfd is registered with generation 0, which is never used for sockets
+constexpr std::uint32_t wakeup_generation = 0;
+
+std::uint32_t to_epoll_events( Interest interest, TriggerMode mode ) noexcept
+{
+	std::uint32_t events = EPOLLRDHUP;
+	if( has_interest( interest, Interest::Read ) ) { events |= EPOLLIN; }
+	if( has_interest( interest, Interest::Write ) ) { events |= EPOLLOUT; }
+	switch( mode ) {
+		case TriggerMode::Level: break;
+		case TriggerMode::Edge: events |= EPOLLET; break;
+		case TriggerMode::OneShot: events |= EPOLLONESHOT; break;
+	}
+	return events;
+}
+
+Events from_epoll_events( std::uint32_t events ) noexcept
+{
+	Events ret;
+	ret.readable = ( events & ( EPOLLIN | EPOLLPRI ) ) != 0;
+	ret.writable = ( events & EPOLLOUT ) != 0;
+	ret.error    = ( events & EPOLLERR ) != 0;
+	ret.hangup   = ( events & ( EPOLLHUP | EPOLLRDHUP ) ) != 0;
+	return ret;
+}
+
+// min heap ordered by deadline
+bool later_deadline( const std::pair<Reactor::clock::time_point, std::uint64_t>& l,
+					 const std::pair<Reactor::clock::time_point, std::uint64_t>& r ) noexcept
+{
+	return l.first > r.first;
+}
+
+} // namespace
+
+Reactor::Reactor()
+{
+	_epoll_fd = ::epoll_create1( EPOLL_CLOEXEC );
+	if( _epoll_fd < 0 ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno( "Could not create epoll instance." ) );
+	}
+
+	_wakeup_fd = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+	if( _wakeup_fd < 0 ) {
+		::close( _epoll_fd );
+		throw generic_nw_error( make_error_message_with_appended_last_errno( "Could not create eventfd for reactor." ) );
+	}
+
+	::epoll_event ev{};
+	ev.events   = EPOLLIN;
+	ev.data.u64 = make_user_data( _wakeup_fd, wakeup_generation );
+	if( ::epoll_ctl( _epoll_fd, EPOLL_CTL_ADD, _wakeup_fd, &ev ) != 0 ) {
+		::close( _wakeup_fd );
+		::close( _epoll_fd );
+		throw generic_nw_error( make_error_message_with_appended_last_errno( "Could not register eventfd with reactor." ) );
+	}
+}
+
+Reactor::~Reactor()
+{
+	::close( _wakeup_fd );
+	::close( _epoll_fd );
+}
+
+/* ###### socket registration ###### */
+
+void Reactor::add( handle_t handle, Interest interest, Callback cb, TriggerMode mode )
+{
+	const native_handle_t fd = socks::port_layer::to_native( handle );
+	if( _registrations.count( fd ) != 0 ) {
+		throw generic_nw_error( mba::concat( "Socket is already registered with this reactor" ) );
+	}
+
+	auto reg = std::make_unique<Registration>( Registration{ std::move( cb ), interest, mode, _next_generation++ } );
+	if( _next_generation == wakeup_generation ) { _next_generation++; }
+
+	::epoll_event ev{};
+	ev.events   = to_epoll_events( interest, mode );
+	ev.data.u64 = make_user_data( fd, reg->generation );
+	if( ::epoll_ctl( _epoll_fd, EPOLL_CTL_ADD, fd, &ev ) != 0 ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno( "Could not register socket with reactor." ) );
+	}
+	_registrations.emplace( fd, std::move( reg ) );
+}
+
+void Reactor::add( socks::RaiiSocket& socket, Interest interest, Callback cb, TriggerMode mode )
+{
+	socket.set_blocking( false );
+	add( socket.get_handle(), interest, std::move( cb ), mode );
+}
+
+void Reactor::add( socks::detail::HighLevelSocketBase& socket, Interest interest, Callback cb, TriggerMode mode )
+{
+	add( socket.as_raii_socket(), interest, std::move( cb ), mode );
+}
+
+void Reactor::add( ip::tcp::Acceptor& acceptor, Callback cb, TriggerMode mode )
+{
+	add( acceptor.getSocket(), Interest::Read, std::move( cb ), mode );
+}
+
+void Reactor::modify( handle_t handle, Interest interest )
+{
+	const native_handle_t fd = socks::port_layer::to_native( handle );
+
+	auto it = _registrations.find( fd );
+	if( it == _registrations.end() ) {
+		throw generic_nw_error( mba::concat( "Socket is not registered with this reactor" ) );
+	}
+	Registration& reg = *it->second;
+
+	::epoll_event ev{};
+	ev.events   = to_epoll_events( interest, reg.mode );
+	ev.data.u64 = make_user_data( fd, reg.generation );
+	if( ::epoll_ctl( _epoll_fd, EPOLL_CTL_MOD, fd, &ev ) != 0 ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno( "Could not modify reactor registration." ) );
+	}
+	reg.interest = interest;
+}
+
+void Reactor::remove( handle_t handle ) noexcept
+{
+	const native_handle_t fd = socks::port_layer::to_native( handle );
+
+	auto it = _registrations.find( fd );
+	if( it == _registrations.end() ) { return; }
+
+	// fails, if the socket was already closed, which is fine (closing removes the socket from the epoll set)
+	::epoll_ctl( _epoll_fd, EPOLL_CTL_DEL, fd, nullptr );
+
+	// the callback might currently be executing
+	_removed.push_back( std::move( it->second ) );
+	_registrations.erase( it );
+}
+
+bool Reactor::is_registered( handle_t handle ) const noexcept
+{
+	return _registrations.count( socks::port_layer::to_native( handle ) ) != 0;
+}
+
+/* ###### timers ###### */
+
+Reactor::TimerId Reactor::_add_timer( clock::time_point deadline, clock::duration period, TimerCallback cb )
+{
+	const std::uint64_t id = _next_timer_id++;
+	_timers.emplace( id, std::make_unique<Timer>( Timer{ deadline, period, std::move( cb ) } ) );
+	_timer_heap.emplace_back( deadline, id );
+	std::push_heap( _timer_heap.begin(), _timer_heap.end(), later_deadline );
+	return static_cast<TimerId>( id );
+}
+
+Reactor::TimerId Reactor::add_timer( clock::duration delay, TimerCallback cb )
+{
+	return _add_timer( clock::now() + delay, clock::duration::zero(), std::move( cb ) );
+}
+
+Reactor::TimerId Reactor::add_periodic_timer( clock::duration period, TimerCallback cb )
+{
+	if( period <= clock::duration::zero() ) {
+		throw generic_nw_error( mba::concat( "Period of a reactor timer has to be positive" ) );
+	}
+	return _add_timer( clock::now() + period, period, std::move( cb ) );
+}
+
+bool Reactor::cancel_timer( TimerId id ) noexcept
+{
+	// the entry in the heap is skipped, when it expires
+	return _timers.erase( static_cast<std::uint64_t>( id ) ) != 0;
+}
+
+std::size_t Reactor::_dispatch_timers()
+{
+	std::size_t cnt = 0;
+	const auto  now = clock::now();
+	while( !_timer_heap.empty() && _timer_heap.front().first <= now ) {
+		std::pop_heap( _timer_heap.begin(), _timer_heap.end(), later_deadline );
+		const auto [deadline, id] = _timer_heap.back();
+		_timer_heap.pop_back();
+
+		auto it = _timers.find( id );
+		// cancelled
+		if( it == _timers.end() || it->second == nullptr || it->second->deadline != deadline ) { continue; }
+
+		// take ownership for the duration of the call, so cancel_timer from inside the callback is safe
+		std::unique_ptr<Timer> timer = std::move( it->second );
+		if( timer->period == clock::duration::zero() ) { _timers.erase( it ); }
+
+		timer->cb();
+		cnt++;
+
+		if( timer->period != clock::duration::zero() ) {
+			// only reschedule, if it wasn't cancelled by the callback
+			auto slot = _timers.find( id );
+			if( slot != _timers.end() && slot->second == nullptr ) {
+				// don't try to catch up with missed periods
+				timer->deadline = std::max( deadline + timer->period, now );
+				_timer_heap.emplace_back( timer->deadline, id );
+				std::push_heap( _timer_heap.begin(), _timer_heap.end(), later_deadline );
+				slot->second = std::move( timer );
+			}
+		}
+	}
+	return cnt;
+}
+
+/* ###### event loop ###### */
+
+int Reactor::_timeout_ms( std::chrono::milliseconds max_wait ) const noexcept
+{
+	using namespace std::chrono;
+
+	// negative: wait indefinitely
+	if( _timer_heap.empty() ) { return max_wait.count() < 0 ? -1 : static_cast<int>( max_wait.count() ); }
+
+	const auto until_timer = _timer_heap.front().first - clock::now();
+	if( until_timer <= clock::duration::zero() ) { return 0; }
+
+	// round up, so we don't wake up just before the timer expires
+	auto ms = duration_cast<milliseconds>( until_timer );
+	if( ms < until_timer ) { ms += milliseconds( 1 ); }
+	if( max_wait.count() >= 0 ) { ms = std::min( ms, max_wait ); }
+	return static_cast<int>( std::min<milliseconds::rep>( ms.count(), std::numeric_limits<int>::max() ) );
+}
+
+std::size_t Reactor::run_once( std::chrono::milliseconds max_wait )
+{
+	std::array<::epoll_event, max_events_per_wait> events;
+
+	const int n = ::epoll_wait( _epoll_fd, events.data(), max_events_per_wait, _timeout_ms( max_wait ) );
+	if( n < 0 && errno != EINTR ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno( "Waiting for reactor events failed." ) );
+	}
+
+	std::size_t cnt = 0;
+	for( int i = 0; i < n; ++i ) {
+		const std::uint64_t data = events[i].data.u64;
+		const int           fd   = fd_from_user_data( data );
+
+		if( generation_from_user_data( data ) == wakeup_generation ) {
+			std::uint64_t value = 0;
+			[[maybe_unused]] const auto r = ::read( _wakeup_fd, &value, sizeof( value ) );
+			continue;
+		}
+
+		auto it = _registrations.find( fd );
+		// removed (and maybe replaced by a new registration for the same fd) by a previous callback
+		if( it == _registrations.end() || it->second->generation != generation_from_user_data( data ) ) { continue; }
+
+		Registration& reg = *it->second;
+		reg.cb( from_epoll_events( events[i].events ) );
+		cnt++;
+	}
+	_removed.clear();
+
+	cnt += _dispatch_timers();
+	return cnt;
+}
+
+void Reactor::run()
+{
+	while( !_stop_requested.load( std::memory_order_acquire ) ) {
+		run_once( std::chrono::milliseconds( -1 ) );
+	}
+	_stop_requested.store( false, std::memory_order_release );
+}
+
+void Reactor::stop() noexcept
+{
+	_stop_requested.store( true, std::memory_order_release );
+	_wakeup();
+}
+
+void Reactor::_wakeup() noexcept
+{
+	const std::uint64_t         one = 1;
+	[[maybe_unused]] const auto r   = ::write( _wakeup_fd, &one, sizeof( one ) );
+}
+
+} // namespace nw
+} // namespace mart
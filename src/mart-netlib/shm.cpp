@@ -0,0 +1,483 @@
+#include <mart-netlib/shm.hpp>
+
+/**
+ * shm.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Implementation of mart::nw::shm::Channel
+ *
+ * Layout of the shared memory: Header, followed by the ring buffer. Messages are stored as a 4 byte size followed
+ * by the payload, padded to a multiple of 8 bytes. A message is never split - if it doesn't fit into the space
+ * before the end of the ring, that space is filled with a wrap marker and the message starts at the beginning.
+ * read_pos / write_pos are ever increasing byte counters (the offset in the ring is pos % capacity).
+ *
+ * Waiting: the sleeping side announces itself in a flag and waits on a futex word, that is incremented by
+ * the other side after each update of its position. Because the futex word is read before the last check
+ * for progress, an update between that check and the futex call makes the futex call return immediately.
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/network_exceptions.hpp>
+#include <mart-netlib/RaiiSocket.hpp>
+#include <mart-netlib/port_layer.hpp>
+
+#include "detail/error_message.hpp"
+
+/* Proprietary Library Includes */
+#include <im_str/im_str.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+/* Platform Includes */
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::shm {
+
+namespace _detail_shm_ {
+
+inline constexpr std::uint32_t magic   = 0x4D534843; // "MSHC"
+inline constexpr std::uint32_t version = 1;
+
+struct Header {
+	std::atomic<std::uint32_t> magic{ 0 }; // written last during initialization
+	std::uint32_t              version  = 0;
+	std::uint64_t              capacity = 0;
+
+	// every group is written by a single side (and the waiting flags only rarely)
+	alignas( 64 ) std::atomic<std::uint64_t> write_pos{ 0 };
+	std::atomic<std::uint32_t> write_seq{ 0 }; // futex word for the receiver
+
+	alignas( 64 ) std::atomic<std::uint64_t> read_pos{ 0 };
+	std::atomic<std::uint32_t> read_seq{ 0 }; // futex word for the sender
+
+	alignas( 64 ) std::atomic<std::uint32_t> receiver_waiting{ 0 };
+	alignas( 64 ) std::atomic<std::uint32_t> sender_waiting{ 0 };
+};
+
+static_assert( std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory requires lock free atomics" );
+static_assert( sizeof( std::atomic<std::uint32_t> ) == sizeof( std::uint32_t ), "futex words have to be 32 bit" );
+
+} // namespace _detail_shm_
+
+namespace {
+
+using _detail_shm_::Header;
+
+constexpr std::uint32_t wrap_marker   = 0xFFFF'FFFF;
+constexpr std::size_t   record_header = sizeof( std::uint32_t );
+constexpr std::size_t   data_offset   = ( sizeof( Header ) + 63 ) / 64 * 64;
+constexpr std::size_t   min_capacity  = 4096;
+
+// how long open() waits for a channel, whose creator has not yet finished the initialization
+constexpr std::chrono::milliseconds init_timeout{ 1000 };
+
+constexpr std::uint64_t record_size( std::size_t payload ) noexcept
+{
+	return ( record_header + payload + 7 ) / 8 * 8;
+}
+
+using socks::detail::make_error_message_with_appended_last_errno;
+
+template<class... Elements>
+[[noreturn]] void throw_with_last_errno( Elements&&... elements )
+{
+	throw generic_nw_error( make_error_message_with_appended_last_errno(
+		socks::port_layer::get_last_socket_error(), std::forward<Elements>( elements )... ) );
+}
+
+void futex_wait( std::atomic<std::uint32_t>& word,
+				 std::uint32_t               expected,
+				 std::chrono::nanoseconds    timeout ) noexcept
+{
+	using namespace std::chrono;
+	::timespec ts{};
+	ts.tv_sec  = static_cast<::time_t>( duration_cast<seconds>( timeout ).count() );
+	ts.tv_nsec = static_cast<long>( ( timeout % seconds( 1 ) ).count() );
+	// not FUTEX_PRIVATE_FLAG, as the word is shared between processes
+	(void)::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( &word ), FUTEX_WAIT, expected, &ts, nullptr, 0 );
+}
+
+void futex_wake( std::atomic<std::uint32_t>& word ) noexcept
+{
+	(void)::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( &word ), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 );
+}
+
+// increments seq and wakes the other side, if it announced that it is sleeping
+void notify( std::atomic<std::uint32_t>& seq, std::atomic<std::uint32_t>& waiting ) noexcept
+{
+	seq.fetch_add( 1, std::memory_order_release );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	if( waiting.load( std::memory_order_relaxed ) != 0 ) { futex_wake( seq ); }
+}
+
+inline void cpu_relax() noexcept
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+	__builtin_ia32_pause();
+#elif defined( __aarch64__ )
+	asm volatile( "yield" );
+#endif
+}
+
+/*
+ * Waits until ready() returns true or the deadline passed (returns false in that case).
+ * Spins until spin_until, before going to sleep on the futex.
+ */
+template<class Ready>
+bool wait_until( Ready&&                               ready,
+				 std::atomic<std::uint32_t>&           seq,
+				 std::atomic<std::uint32_t>&           waiting,
+				 std::chrono::steady_clock::time_point spin_until,
+				 std::chrono::steady_clock::time_point deadline ) noexcept
+{
+	using clock = std::chrono::steady_clock;
+
+	if( ready() ) { return true; }
+	while( clock::now() < spin_until ) {
+		for( int i = 0; i < 64; ++i ) {
+			if( ready() ) { return true; }
+			cpu_relax();
+		}
+	}
+
+	while( true ) {
+		const std::uint32_t current = seq.load( std::memory_order_acquire );
+
+		waiting.store( 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( ready() ) {
+			waiting.store( 0, std::memory_order_relaxed );
+			return true;
+		}
+
+		const auto now = clock::now();
+		if( now >= deadline ) {
+			waiting.store( 0, std::memory_order_relaxed );
+			return false;
+		}
+		futex_wait( seq, current, deadline - now );
+		waiting.store( 0, std::memory_order_relaxed );
+		if( ready() ) { return true; }
+	}
+}
+
+std::chrono::steady_clock::time_point deadline_after( std::chrono::steady_clock::time_point now,
+													  std::chrono::nanoseconds              timeout ) noexcept
+{
+	// prevent overflows for "infinite" timeouts
+	const auto max_timeout = std::chrono::steady_clock::time_point::max() - now;
+	return timeout >= max_timeout ? std::chrono::steady_clock::time_point::max() : now + timeout;
+}
+
+std::size_t round_up_capacity( std::size_t capacity ) noexcept
+{
+	std::size_t c = min_capacity;
+	while( c < capacity ) {
+		c *= 2;
+	}
+	return c;
+}
+
+} // namespace
+
+/* ###### creation ###### */
+
+Channel Channel::create( std::string_view name, std::size_t capacity )
+{
+	const std::string name_str( name );
+
+	const int fd = ::shm_open( name_str.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600 );
+	if( fd < 0 ) { throw_with_last_errno( "Could not create shared memory channel ", name, ". " ); }
+	try {
+		return _map( fd, round_up_capacity( capacity ) );
+	} catch( ... ) {
+		::shm_unlink( name_str.c_str() );
+		throw;
+	}
+}
+
+Channel Channel::open( std::string_view name )
+{
+	const std::string name_str( name );
+
+	const int fd = ::shm_open( name_str.c_str(), O_RDWR | O_CLOEXEC, 0 );
+	if( fd < 0 ) { throw_with_last_errno( "Could not open shared memory channel ", name, ". " ); }
+	return _map( fd, 0 );
+}
+
+bool Channel::unlink( std::string_view name ) noexcept
+{
+	try {
+		return ::shm_unlink( std::string( name ).c_str() ) == 0;
+	} catch( ... ) {
+		return false;
+	}
+}
+
+Channel Channel::create_anonymous( std::size_t capacity )
+{
+	const int fd = ::memfd_create( "mart-netlib-shm-channel", MFD_CLOEXEC );
+	if( fd < 0 ) { throw_with_last_errno( "Could not create anonymous shared memory channel. " ); }
+	return _map( fd, round_up_capacity( capacity ) );
+}
+
+Channel Channel::from_fd( int fd )
+{
+	return _map( fd, 0 );
+}
+
+Channel Channel::_map( int fd, std::size_t capacity )
+{
+	Channel channel;
+	channel._fd = fd; // from now on, the channel closes the fd on errors
+
+	const bool initialize    = capacity != 0;
+	const auto init_deadline = std::chrono::steady_clock::now() + init_timeout;
+	if( initialize ) {
+		if( ::ftruncate( fd, static_cast<::off_t>( data_offset + capacity ) ) != 0 ) {
+			throw_with_last_errno( "Could not size shared memory channel. " );
+		}
+	} else {
+		// create() makes the name visible before it sizes the memory and publishes the magic number
+		struct ::stat st {};
+		while( true ) {
+			if( ::fstat( fd, &st ) != 0 ) { throw_with_last_errno( "Could not query shared memory channel. " ); }
+			if( st.st_size != 0 || std::chrono::steady_clock::now() >= init_deadline ) { break; }
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+		}
+		if( st.st_size < static_cast<::off_t>( data_offset + min_capacity ) ) {
+			throw generic_nw_error( "Shared memory is too small to be a channel." );
+		}
+		capacity = static_cast<std::size_t>( st.st_size ) - data_offset;
+	}
+
+	const std::size_t size    = data_offset + capacity;
+	void* const       mapping = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	if( mapping == MAP_FAILED ) { throw_with_last_errno( "Could not map shared memory channel. " ); }
+
+	channel._mapping      = mapping;
+	channel._mapping_size = size;
+
+	if( initialize ) {
+		auto* header     = new( mapping ) Header{};
+		header->version  = _detail_shm_::version;
+		header->capacity = capacity;
+		header->magic.store( _detail_shm_::magic, std::memory_order_release );
+	}
+
+	auto* header = std::launder( reinterpret_cast<Header*>( mapping ) );
+	while( header->magic.load( std::memory_order_acquire ) == 0
+		   && std::chrono::steady_clock::now() < init_deadline ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+	if( header->magic.load( std::memory_order_acquire ) != _detail_shm_::magic
+		|| header->version != _detail_shm_::version || header->capacity != capacity
+		|| ( capacity & ( capacity - 1 ) ) != 0 ) {
+		throw generic_nw_error( "Shared memory doesn't contain a (compatible) channel." );
+	}
+
+	channel._header           = header;
+	channel._data             = static_cast<mart::ByteType*>( mapping ) + data_offset;
+	channel._capacity         = capacity;
+	channel._cached_read_pos  = header->read_pos.load( std::memory_order_acquire );
+	channel._cached_write_pos = header->write_pos.load( std::memory_order_acquire );
+	return channel;
+}
+
+Channel::Channel( Channel&& other ) noexcept
+	: _fd( std::exchange( other._fd, -1 ) )
+	, _mapping( std::exchange( other._mapping, nullptr ) )
+	, _mapping_size( std::exchange( other._mapping_size, 0 ) )
+	, _header( std::exchange( other._header, nullptr ) )
+	, _data( std::exchange( other._data, nullptr ) )
+	, _capacity( std::exchange( other._capacity, 0 ) )
+	, _cached_read_pos( other._cached_read_pos )
+	, _cached_write_pos( other._cached_write_pos )
+	, _peeked_end( std::exchange( other._peeked_end, 0 ) )
+	, _tx_timeout( other._tx_timeout )
+	, _rx_timeout( other._rx_timeout )
+	, _busy_poll( other._busy_poll )
+{
+}
+
+Channel& Channel::operator=( Channel&& other ) noexcept
+{
+	if( this != &other ) {
+		_close();
+		_fd               = std::exchange( other._fd, -1 );
+		_mapping          = std::exchange( other._mapping, nullptr );
+		_mapping_size     = std::exchange( other._mapping_size, 0 );
+		_header           = std::exchange( other._header, nullptr );
+		_data             = std::exchange( other._data, nullptr );
+		_capacity         = std::exchange( other._capacity, 0 );
+		_cached_read_pos  = other._cached_read_pos;
+		_cached_write_pos = other._cached_write_pos;
+		_peeked_end       = std::exchange( other._peeked_end, 0 );
+		_tx_timeout       = other._tx_timeout;
+		_rx_timeout       = other._rx_timeout;
+		_busy_poll        = other._busy_poll;
+	}
+	return *this;
+}
+
+Channel::~Channel()
+{
+	_close();
+}
+
+void Channel::_close() noexcept
+{
+	if( _mapping ) { ::munmap( _mapping, _mapping_size ); }
+	if( _fd >= 0 ) { ::close( _fd ); }
+	_fd       = -1;
+	_mapping  = nullptr;
+	_header   = nullptr;
+	_data     = nullptr;
+	_capacity = 0;
+}
+
+std::size_t Channel::max_message_size() const noexcept
+{
+	// a message has to fit in front of or behind the current position, whatever that is
+	return _capacity == 0 ? 0 : _capacity / 2 - record_header;
+}
+
+/* ###### sending side ###### */
+
+bool Channel::try_send( mart::ConstMemoryView data ) noexcept
+{
+	if( !_header || data.size() > max_message_size() ) { return false; }
+
+	const std::uint64_t rec    = record_size( data.size() );
+	std::uint64_t       w      = _header->write_pos.load( std::memory_order_relaxed ); // only written by us
+	const std::uint64_t offset = w & ( _capacity - 1 );
+	const std::uint64_t to_end = _capacity - offset;
+	const std::uint64_t needed = rec <= to_end ? rec : to_end + rec;
+
+	if( _capacity - ( w - _cached_read_pos ) < needed ) {
+		_cached_read_pos = _header->read_pos.load( std::memory_order_acquire );
+		if( _capacity - ( w - _cached_read_pos ) < needed ) { return false; }
+	}
+
+	if( rec > to_end ) {
+		std::memcpy( _data + offset, &wrap_marker, sizeof( wrap_marker ) );
+		w += to_end;
+	}
+	mart::ByteType* const  dst  = _data + ( w & ( _capacity - 1 ) );
+	const auto             size = static_cast<std::uint32_t>( data.size() );
+	std::memcpy( dst, &size, sizeof( size ) );
+	if( data.size() > 0 ) { std::memcpy( dst + record_header, data.data(), data.size() ); }
+
+	_header->write_pos.store( w + rec, std::memory_order_release );
+	notify( _header->write_seq, _header->receiver_waiting );
+	return true;
+}
+
+void Channel::send( mart::ConstMemoryView data )
+{
+	if( !_header ) { throw generic_nw_error( "Tried to send via an invalid shared memory channel." ); }
+	if( data.size() > max_message_size() ) {
+		throw generic_nw_error( mba::concat( "Message of ",
+											 std::to_string( data.size() ),
+											 " bytes exceeds the maximum message size of the shared memory channel (",
+											 std::to_string( max_message_size() ),
+											 " bytes)." ) );
+	}
+
+	const auto now      = std::chrono::steady_clock::now();
+	const auto deadline = deadline_after( now, _tx_timeout );
+	const bool sent     = wait_until(
+        [&] { return try_send( data ); }, _header->read_seq, _header->sender_waiting, now, deadline );
+	if( !sent ) { throw generic_nw_error( "Timeout while waiting for space in the shared memory channel." ); }
+}
+
+/* ###### receiving side ###### */
+
+mart::ConstMemoryView Channel::try_peek() noexcept
+{
+	if( !_header ) { return {}; }
+
+	std::uint64_t r = _header->read_pos.load( std::memory_order_relaxed ); // only written by us
+	if( r == _cached_write_pos ) {
+		_cached_write_pos = _header->write_pos.load( std::memory_order_acquire );
+		if( r == _cached_write_pos ) { return {}; }
+	}
+
+	std::uint64_t offset = r & ( _capacity - 1 );
+	std::uint32_t size   = 0;
+	std::memcpy( &size, _data + offset, sizeof( size ) );
+	if( size == wrap_marker ) {
+		// the sender publishes the marker together with the message that follows it
+		r += _capacity - offset;
+		offset = 0;
+		std::memcpy( &size, _data, sizeof( size ) );
+	}
+
+	_peeked_end = r + record_size( size );
+	return mart::ConstMemoryView( _data + offset + record_header, size );
+}
+
+void Channel::pop() noexcept
+{
+	if( _peeked_end == 0 ) { return; }
+	_header->read_pos.store( std::exchange( _peeked_end, 0 ), std::memory_order_release );
+	notify( _header->read_seq, _header->sender_waiting );
+}
+
+mart::MemoryView Channel::try_recv( mart::MemoryView buffer ) noexcept
+{
+	const auto msg = try_peek();
+	if( !msg.isValid() ) { return {}; }
+
+	const std::size_t n = std::min( msg.size(), buffer.size() );
+	if( n > 0 ) { std::memcpy( buffer.data(), msg.data(), n ); }
+	pop();
+	return buffer.subview( 0, n );
+}
+
+mart::MemoryView Channel::recv( mart::MemoryView buffer )
+{
+	if( !_header ) { throw generic_nw_error( "Tried to receive via an invalid shared memory channel." ); }
+
+	mart::MemoryView ret{};
+
+	const auto now        = std::chrono::steady_clock::now();
+	const auto spin_until = deadline_after( now, std::min<std::chrono::nanoseconds>( _busy_poll, _rx_timeout ) );
+	const auto deadline   = deadline_after( now, _rx_timeout );
+	(void)wait_until(
+		[&] {
+			ret = try_recv( buffer );
+			return ret.isValid();
+		},
+		_header->write_seq,
+		_header->receiver_waiting,
+		spin_until,
+		deadline );
+	return ret;
+}
+
+} // namespace mart::nw::shm
@@ -0,0 +1,95 @@
+#include <mart-netlib/tcp.hpp>
+
+/**
+ * tcp.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Implementation of the non-inline parts of mart::nw::ip::tcp::Socket
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/network_exceptions.hpp>
+
+#include "detail/error_message.hpp"
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::tcp {
+
+void _detail_tcp_::throw_error( socks::ErrorCode error, std::string_view what, std::string_view detail )
+{
+	throw nw::generic_nw_error( socks::detail::make_error_message_with_appended_last_errno( error, what, detail ) );
+}
+
+std::uint64_t Socket::send_file( int fd, std::uint64_t offset, std::uint64_t length )
+{
+	using mart::nw::socks::ErrorCodeValues;
+
+	// the file offset is signed in the kernel interface
+	if( offset > static_cast<std::uint64_t>( std::numeric_limits<std::int64_t>::max() ) ) {
+		_detail_tcp_::throw_error( socks::ErrorCode{ ErrorCodeValues::InvalidArgument },
+								   "File offset for send_file is out of range." );
+	}
+	auto file_offset = static_cast<std::int64_t>( offset );
+
+	std::uint64_t total = 0;
+	while( total < length ) {
+		const auto chunk = static_cast<std::size_t>(
+			std::min<std::uint64_t>( length - total, std::numeric_limits<nw::socks::txrx_size_t>::max() ) );
+
+		const auto res = _socket.send_file( fd, file_offset, chunk );
+		if( !res.success() ) {
+			const auto error = res.error_code().value();
+			// non-blocking socket with a full send buffer: report what was sent so far
+			if( error == ErrorCodeValues::WouldBlock || error == ErrorCodeValues::TryAgain ) { break; }
+			_detail_tcp_::throw_error( res.error_code(), "Failed to send file. Details:  " );
+		}
+		if( res.value() == 0 ) { break; } // end of file
+		total += static_cast<std::uint64_t>( res.value() );
+	}
+	return total;
+}
+
+std::uint64_t Socket::send_file( const std::string& path, std::uint64_t offset, std::uint64_t length )
+{
+#ifdef _WIN32
+	(void)path;
+	(void)offset;
+	(void)length;
+	throw nw::generic_nw_error( "tcp::Socket::send_file is not supported on windows" );
+#else
+	const int fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+	if( fd < 0 ) {
+		const int error = errno;
+		throw nw::generic_nw_error( mba::concat( "Could not open file ", path, ": ", std::strerror( error ) ) );
+	}
+	try {
+		const auto ret = send_file( fd, offset, length );
+		::close( fd );
+		return ret;
+	} catch( ... ) {
+		::close( fd );
+		throw;
+	}
+#endif
+}
+
+} // namespace mart::nw::ip::tcp
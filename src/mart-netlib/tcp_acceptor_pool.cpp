@@ -0,0 +1,168 @@
+#include <mart-netlib/tcp_acceptor_pool.hpp>
+
+/**
+ * tcp_acceptor_pool.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Implementation of mart::nw::ip::tcp::AcceptorPool
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/network_exceptions.hpp>
+
+#include "detail/thread_affinity.hpp"
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <cerrno>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::tcp {
+
+namespace {
+
+using nw::detail::pin_to_cpu;
+
+} // namespace
+
+struct AcceptorPool::Worker {
+	std::size_t                index = 0;
+	Acceptor                   acceptor;
+	std::thread                thread;
+	std::atomic<std::uint64_t> accepted{ 0 };
+	std::atomic<std::uint64_t> resource_errors{ 0 };
+	std::atomic<int>           error{ 0 }; // raw value of the error that stopped the worker
+};
+
+AcceptorPool::AcceptorPool( const Config& config, Handler handler )
+	: _handler( std::move( handler ) )
+	, _config( config )
+	, _local( config.local )
+{
+	const std::size_t count
+		= config.worker_count != 0 ? config.worker_count : std::max( std::thread::hardware_concurrency(), 1u );
+
+	// all sockets listen before the first worker starts, so the kernel can distribute connections right away
+	for( std::size_t i = 0; i < count; ++i ) {
+		auto worker   = std::make_unique<Worker>();
+		worker->index = i;
+
+		const auto res = worker->acceptor.getSocket().setsockopt(
+			socks::SocketOptionLevel::Socket, socks::SocketOption::so_reuseport, 1 );
+		if( !res.success() ) {
+			_detail_tcp_::throw_error( res, "Could not set SO_REUSEPORT on tcp acceptor." );
+		}
+		worker->acceptor.bind( _local );
+		worker->acceptor.listen( config.backlog );
+
+		// with port 0, the first acceptor determines the port for all others
+		if( i == 0 ) { _local = worker->acceptor.getLocalEndpoint(); }
+		_workers.push_back( std::move( worker ) );
+	}
+
+	const unsigned cpus = std::max( std::thread::hardware_concurrency(), 1u );
+	try {
+		for( auto& worker : _workers ) {
+			worker->thread = std::thread( [this, w = worker.get()] { run( *w ); } );
+			if( config.pin_threads ) { pin_to_cpu( worker->thread, static_cast<unsigned>( worker->index % cpus ) ); }
+		}
+	} catch( ... ) {
+		// the destructor won't run - joinable threads would call std::terminate
+		stop();
+		throw;
+	}
+}
+
+AcceptorPool::~AcceptorPool()
+{
+	stop();
+}
+
+void AcceptorPool::stop() noexcept
+{
+	_stop.store( true, std::memory_order_relaxed );
+	for( auto& worker : _workers ) {
+		if( worker->thread.joinable() ) { worker->thread.join(); }
+	}
+}
+
+std::uint64_t AcceptorPool::accepted( std::size_t worker ) const noexcept
+{
+	return worker < _workers.size() ? _workers[worker]->accepted.load( std::memory_order_relaxed ) : 0;
+}
+
+std::uint64_t AcceptorPool::accepted() const noexcept
+{
+	std::uint64_t sum = 0;
+	for( const auto& worker : _workers ) {
+		sum += worker->accepted.load( std::memory_order_relaxed );
+	}
+	return sum;
+}
+
+std::uint64_t AcceptorPool::resource_errors( std::size_t worker ) const noexcept
+{
+	return worker < _workers.size() ? _workers[worker]->resource_errors.load( std::memory_order_relaxed ) : 0;
+}
+
+std::uint64_t AcceptorPool::resource_errors() const noexcept
+{
+	std::uint64_t sum = 0;
+	for( const auto& worker : _workers ) {
+		sum += worker->resource_errors.load( std::memory_order_relaxed );
+	}
+	return sum;
+}
+
+socks::ErrorCode AcceptorPool::error( std::size_t worker ) const noexcept
+{
+	if( worker >= _workers.size() ) { return socks::ErrorCode{ socks::ErrorCodeValues::InvalidArgument }; }
+	return socks::ErrorCode{ static_cast<socks::ErrorCodeValues>( _workers[worker]->error.load() ) };
+}
+
+std::size_t AcceptorPool::failed_workers() const noexcept
+{
+	return static_cast<std::size_t>( std::count_if(
+		_workers.begin(), _workers.end(), []( const auto& worker ) { return worker->error.load() != 0; } ) );
+}
+
+void AcceptorPool::run( Worker& worker ) noexcept
+{
+	using socks::ErrorCodeValues;
+
+	while( !_stop.load( std::memory_order_relaxed ) ) {
+		// the timeout is only set on the first call (Acceptor caches it)
+		socks::ErrorCode error{};
+		auto             connection = worker.acceptor.accept( _config.stop_latency, _config.socket_mode, error );
+		if( !connection.is_valid() ) {
+			const int raw = error.raw_value();
+			if( error.value() == ErrorCodeValues::WouldBlock || error.value() == ErrorCodeValues::TryAgain
+				|| error.value() == ErrorCodeValues::Timeout || raw == EINTR || raw == ECONNABORTED ) {
+				continue;
+			}
+			if( raw == EMFILE || raw == ENFILE || raw == ENOBUFS || raw == ENOMEM ) {
+				// accept would fail again right away - give the handlers time to release resources
+				worker.resource_errors.fetch_add( 1, std::memory_order_relaxed );
+				std::this_thread::sleep_for( _config.stop_latency );
+				continue;
+			}
+			// the listening socket is broken - nothing left to do for this worker (reported by error())
+			worker.error.store( raw );
+			return;
+		}
+
+		worker.accepted.fetch_add( 1, std::memory_order_relaxed );
+		_handler( worker.index, std::move( connection ) );
+	}
+}
+
+} // namespace mart::nw::ip::tcp
@@ -0,0 +1,162 @@
+#include <mart-netlib/tcp_framing.hpp>
+
+/**
+ * tcp_framing.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Implementation of mart::nw::ip::tcp::FramedReader / FramedWriter
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/basic_types.hpp>
+#include <mart-netlib/network_exceptions.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::tcp {
+
+namespace {
+
+std::uint32_t read_frame_size( const mart::ByteType* header ) noexcept
+{
+	std::uint32_t net_rep = 0;
+	std::memcpy( &net_rep, header, sizeof( net_rep ) );
+	return mart::nw::to_host_order( mart::nw::uint32_net_t( net_rep ) );
+}
+
+void write_frame_header( mart::ByteType* header, std::size_t frame_size ) noexcept
+{
+	const auto net_rep = mart::nw::to_net_order( static_cast<std::uint32_t>( frame_size ) );
+	std::memcpy( header, &net_rep, sizeof( net_rep ) );
+}
+
+} // namespace
+
+/* ###### FramedReader ###### */
+
+FramedReader::FramedReader( Socket& socket, std::size_t buffer_size, std::size_t max_frame_size )
+	: _socket( &socket )
+	, _buffer( std::max( buffer_size, frame_header_size ) )
+	, _max_frame_size( max_frame_size )
+{
+}
+
+std::optional<mart::ConstMemoryView> FramedReader::_next_frame()
+{
+	if( buffered_bytes() < frame_header_size ) { return std::nullopt; }
+
+	const std::size_t frame_size = read_frame_size( _buffer.data() + _begin );
+	if( frame_size > _max_frame_size ) {
+		throw generic_nw_error( mba::concat( "Received tcp frame of ",
+											 std::to_string( frame_size ),
+											 " bytes, which exceeds the maximum frame size of ",
+											 std::to_string( _max_frame_size ),
+											 " bytes." ) );
+	}
+	if( buffered_bytes() < frame_header_size + frame_size ) { return std::nullopt; }
+
+	const mart::ConstMemoryView frame( _buffer.data() + _begin + frame_header_size, frame_size );
+	_begin += frame_header_size + frame_size;
+	return frame;
+}
+
+void FramedReader::_make_room_for( std::size_t frame_size )
+{
+	// only called, if there is no complete frame left, so this copies at most the start of a single frame
+	if( _begin != 0 ) {
+		std::memmove( _buffer.data(), _buffer.data() + _begin, buffered_bytes() );
+		_end -= _begin;
+		_begin = 0;
+	}
+	if( _buffer.size() < frame_size ) { _buffer.resize( frame_size ); }
+}
+
+std::optional<mart::ConstMemoryView> FramedReader::try_read_buffered()
+{
+	return _next_frame();
+}
+
+std::optional<mart::ConstMemoryView> FramedReader::read()
+{
+	if( auto frame = _next_frame() ) { return frame; }
+
+	while( true ) {
+		std::size_t needed = frame_header_size;
+		if( buffered_bytes() >= frame_header_size ) { needed += read_frame_size( _buffer.data() + _begin ); }
+		_make_room_for( needed );
+
+		const auto rx = _socket->recv( mart::MemoryView( _buffer.data() + _end, _buffer.size() - _end ) );
+		if( !rx.isValid() ) { return std::nullopt; }
+		if( rx.empty() ) {
+			_closed = true;
+			if( buffered_bytes() != 0 ) {
+				throw generic_nw_error( "Tcp connection was closed by the peer in the middle of a frame." );
+			}
+			return std::nullopt;
+		}
+		_end += rx.size();
+
+		if( auto frame = _next_frame() ) { return frame; }
+	}
+}
+
+/* ###### FramedWriter ###### */
+
+FramedWriter::FramedWriter( Socket& socket, std::size_t flush_threshold )
+	: _socket( &socket )
+	, _flush_threshold( flush_threshold )
+{
+	_buffer.reserve( flush_threshold + frame_header_size );
+}
+
+void FramedWriter::write( mart::ConstMemoryView payload )
+{
+	if( payload.size() > std::numeric_limits<std::uint32_t>::max() ) {
+		throw generic_nw_error( mba::concat(
+			"Payload of ", std::to_string( payload.size() ), " bytes is too large for a tcp frame." ) );
+	}
+
+	if( payload.size() > _flush_threshold ) {
+		// don't copy large payloads - send them directly behind the already buffered frames
+		mart::ByteType header[frame_header_size];
+		write_frame_header( header, payload.size() );
+
+		const mart::ConstMemoryView parts[]
+			= { mart::view_elements( _buffer ).asBytes(), mart::view_bytes( header ), payload };
+		_socket->send( mart::ArrayView<const mart::ConstMemoryView>( parts ) );
+		_buffer.clear();
+		return;
+	}
+
+	const std::size_t offset = _buffer.size();
+	_buffer.resize( offset + frame_header_size + payload.size() );
+	write_frame_header( _buffer.data() + offset, payload.size() );
+	if( !payload.empty() ) {
+		std::memcpy( _buffer.data() + offset + frame_header_size, payload.data(), payload.size() );
+	}
+
+	if( _buffer.size() > _flush_threshold ) { flush(); }
+}
+
+void FramedWriter::flush()
+{
+	if( _buffer.empty() ) { return; }
+	_socket->send( mart::view_elements( _buffer ).asBytes() );
+	_buffer.clear();
+}
+
+} // namespace mart::nw::ip::tcp
@@ -206,4 +206,76 @@
 
 namespace mart::nw::socks::detail {
 template class DgramSocket<mart::nw::ip::udp::endpoint>;
-}
\ No newline at end of file
+}
+
+namespace mart::nw::ip::udp {
+
+using socks::ErrorCode;
+using socks::ErrorCodeValues;
+using socks::SocketOption;
+using socks::SocketOptionLevel;
+using socks::detail::make_error_message_with_appended_last_errno;
+
+namespace {
+ErrorCode change_multicast_membership( Socket& socket, SocketOption option, address_v4 group, address_v4 local_if )
+{
+	if( !is_multicast( group ) ) { return ErrorCode{ ErrorCodeValues::InvalidArgument }; }
+	const socks::MulticastRequest request{ group.inNetOrder(), local_if.inNetOrder() };
+	return socket.as_raii_socket().setsockopt( SocketOptionLevel::Ip, option, request );
+}
+} // namespace
+
+ErrorCode try_join_multicast_group( Socket& socket, address_v4 group, address_v4 local_interface ) noexcept
+{
+	return change_multicast_membership( socket, SocketOption::ip_add_membership, group, local_interface );
+}
+
+void join_multicast_group( Socket& socket, address_v4 group, address_v4 local_interface )
+{
+	const auto result = try_join_multicast_group( socket, group, local_interface );
+	if( !result.success() ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno( result,
+																			 "Could not join multicast group ",
+																			 group.asString(),
+																			 " on interface ",
+																			 local_interface.asString() ) );
+	}
+}
+
+ErrorCode try_leave_multicast_group( Socket& socket, address_v4 group, address_v4 local_interface ) noexcept
+{
+	return change_multicast_membership( socket, SocketOption::ip_drop_membership, group, local_interface );
+}
+
+void leave_multicast_group( Socket& socket, address_v4 group, address_v4 local_interface )
+{
+	const auto result = try_leave_multicast_group( socket, group, local_interface );
+	if( !result.success() ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno( result,
+																			 "Could not leave multicast group ",
+																			 group.asString(),
+																			 " on interface ",
+																			 local_interface.asString() ) );
+	}
+}
+
+bool try_set_multicast_ttl( Socket& socket, int ttl ) noexcept
+{
+	return socket.as_raii_socket().setsockopt( SocketOptionLevel::Ip, SocketOption::ip_multicast_ttl, ttl ).success();
+}
+
+bool try_set_multicast_loopback( Socket& socket, bool enable ) noexcept
+{
+	const int value = enable ? 1 : 0;
+	return socket.as_raii_socket()
+		.setsockopt( SocketOptionLevel::Ip, SocketOption::ip_multicast_loop, value )
+		.success();
+}
+
+bool try_set_multicast_interface( Socket& socket, address_v4 local_interface ) noexcept
+{
+	const auto addr = local_interface.inNetOrder();
+	return socket.as_raii_socket().setsockopt( SocketOptionLevel::Ip, SocketOption::ip_multicast_if, addr ).success();
+}
+
+} // namespace mart::nw::ip::udp
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include <mart-netlib/udp_capture.hpp>
+
+/**
+ * udp_capture.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Implementation of mart::nw::ip::udp::CaptureWriter / CaptureReader
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/network_exceptions.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+namespace {
+
+constexpr char          file_magic[8] = { 'M', 'A', 'R', 'T', 'U', 'D', 'P', 'C' };
+constexpr std::uint32_t file_version  = 1;
+
+template<class T>
+void store_le( mart::ByteType* dst, T value ) noexcept
+{
+	for( std::size_t i = 0; i < sizeof( T ); ++i ) {
+		dst[i] = static_cast<mart::ByteType>( value >> ( 8 * i ) );
+	}
+}
+
+template<class T>
+T load_le( const mart::ByteType* src ) noexcept
+{
+	T value = 0;
+	for( std::size_t i = 0; i < sizeof( T ); ++i ) {
+		value |= static_cast<T>( static_cast<T>( static_cast<std::uint8_t>( src[i] ) ) << ( 8 * i ) );
+	}
+	return value;
+}
+
+[[noreturn]] void throw_file_error( std::string_view what, const std::string& path )
+{
+	const int error = errno;
+	throw generic_nw_error( mba::concat( what, " capture file ", path, ": ", std::strerror( error ) ) );
+}
+
+} // namespace
+
+/* ###### CaptureWriter ###### */
+
+CaptureWriter::CaptureWriter( const std::string& path, std::size_t buffer_size )
+	: _file( std::fopen( path.c_str(), "wb" ) )
+	, _path( path )
+	, _buffer( std::max( buffer_size, capture_record_header_size + capture_max_payload_size ) )
+{
+	if( !_file ) { throw_file_error( "Could not create", _path ); }
+
+	// the file is written through our own buffer
+	std::setvbuf( _file.get(), nullptr, _IONBF, 0 );
+
+	std::memcpy( _buffer.data(), file_magic, sizeof( file_magic ) );
+	store_le<std::uint32_t>( _buffer.data() + 8, file_version );
+	store_le<std::uint32_t>( _buffer.data() + 12, 0 );
+	_used = capture_file_header_size;
+}
+
+CaptureWriter::~CaptureWriter()
+{
+	if( !_file ) { return; } // moved from
+	try {
+		flush();
+	} catch( ... ) {
+	}
+}
+
+void CaptureWriter::write( std::chrono::system_clock::time_point rx_time,
+						   const endpoint&                       source,
+						   mart::ConstMemoryView                 data )
+{
+	if( data.size() > capture_max_payload_size ) {
+		throw generic_nw_error( mba::concat( "Datagram of ",
+											 std::to_string( data.size() ),
+											 " bytes is too large for capture file ",
+											 _path ) );
+	}
+
+	const std::size_t record_size = capture_record_header_size + data.size();
+	if( _buffer.size() - _used < record_size ) { flush(); }
+
+	const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( rx_time.time_since_epoch() ).count();
+
+	mart::ByteType* const dst = _buffer.data() + _used;
+	store_le<std::uint64_t>( dst, static_cast<std::uint64_t>( ns ) );
+	store_le<std::uint32_t>( dst + 8, source.address.inHostOrder() );
+	store_le<std::uint16_t>( dst + 12, source.port.inHostOrder() );
+	store_le<std::uint16_t>( dst + 14, static_cast<std::uint16_t>( data.size() ) );
+	if( !data.empty() ) { std::memcpy( dst + capture_record_header_size, data.data(), data.size() ); }
+
+	_used += record_size;
+	++_record_count;
+}
+
+void CaptureWriter::flush()
+{
+	if( _used == 0 ) { return; }
+	const std::size_t written = std::fwrite( _buffer.data(), 1, _used, _file.get() );
+	if( written != _used ) {
+		// keep only the part that wasn't written, so a later flush doesn't write the prefix a second time
+		std::memmove( _buffer.data(), _buffer.data() + written, _used - written );
+		_used -= written;
+		throw_file_error( "Failed to write to", _path );
+	}
+	_used = 0;
+}
+
+/* ###### CaptureReader ###### */
+
+CaptureReader::CaptureReader( const std::string& path, std::size_t buffer_size )
+	: _file( std::fopen( path.c_str(), "rb" ) )
+	, _path( path )
+	, _buffer( std::max( buffer_size, capture_record_header_size + capture_max_payload_size ) )
+{
+	if( !_file ) { throw_file_error( "Could not open", _path ); }
+	std::setvbuf( _file.get(), nullptr, _IONBF, 0 );
+
+	if( !_fill( capture_file_header_size )
+		|| std::memcmp( _buffer.data(), file_magic, sizeof( file_magic ) ) != 0 ) {
+		throw generic_nw_error( mba::concat( path, " is not a udp capture file" ) );
+	}
+	const auto version = load_le<std::uint32_t>( _buffer.data() + 8 );
+	if( version != file_version ) {
+		throw generic_nw_error(
+			mba::concat( "Unsupported version ", std::to_string( version ), " of udp capture file ", path ) );
+	}
+	_begin = capture_file_header_size;
+}
+
+bool CaptureReader::_fill( std::size_t size )
+{
+	while( _end - _begin < size ) {
+		if( _eof ) { return false; }
+
+		// move the start of the incomplete record to the front
+		if( _begin != 0 ) {
+			std::memmove( _buffer.data(), _buffer.data() + _begin, _end - _begin );
+			_end -= _begin;
+			_begin = 0;
+		}
+
+		const std::size_t cnt = std::fread( _buffer.data() + _end, 1, _buffer.size() - _end, _file.get() );
+		if( cnt == 0 ) {
+			if( std::ferror( _file.get() ) ) { throw_file_error( "Failed to read from", _path ); }
+			_eof = true;
+		}
+		_end += cnt;
+	}
+	return true;
+}
+
+std::optional<CaptureRecord> CaptureReader::read()
+{
+	if( !_fill( capture_record_header_size ) ) {
+		if( _end != _begin ) {
+			throw generic_nw_error( mba::concat( "Udp capture file ", _path, " ends within a record header" ) );
+		}
+		return std::nullopt;
+	}
+
+	const mart::ByteType* src  = _buffer.data() + _begin;
+	const auto            ns   = load_le<std::uint64_t>( src );
+	const auto            addr = load_le<std::uint32_t>( src + 8 );
+	const auto            port = load_le<std::uint16_t>( src + 12 );
+	const std::size_t     size = load_le<std::uint16_t>( src + 14 );
+
+	if( !_fill( capture_record_header_size + size ) ) {
+		throw generic_nw_error( mba::concat( "Udp capture file ", _path, " ends within a record" ) );
+	}
+	src = _buffer.data() + _begin; // _fill may have moved the data
+
+	CaptureRecord record{
+		std::chrono::system_clock::time_point( std::chrono::duration_cast<std::chrono::system_clock::duration>(
+			std::chrono::nanoseconds( static_cast<std::int64_t>( ns ) ) ) ),
+		endpoint( addr, port ),
+		mart::ConstMemoryView( src + capture_record_header_size, size ) };
+
+	_begin += capture_record_header_size + size;
+	return record;
+}
+
+} // namespace mart::nw::ip::udp
@@ -0,0 +1,184 @@
+#include <mart-netlib/udp_sharded_server.hpp>
+
+/**
+ * udp_sharded_server.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Implementation of mart::nw::ip::udp::ShardedServer
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include <mart-netlib/network_exceptions.hpp>
+
+#include "detail/error_message.hpp"
+#include "detail/thread_affinity.hpp"
+
+/* Proprietary Library Includes */
+#include <im_str/im_str.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <string_view>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+namespace {
+
+using nw::detail::pin_to_cpu;
+using socks::detail::make_error_message_with_appended_last_errno;
+
+void set_option( Socket& socket, socks::SocketOption option, int value, std::string_view name )
+{
+	const auto res = socket.as_raii_socket().setsockopt( socks::SocketOptionLevel::Socket, option, value );
+	if( !res.success() ) {
+		throw generic_nw_error(
+			make_error_message_with_appended_last_errno( res, "Could not set ", name, " on sharded udp socket." ) );
+	}
+}
+
+} // namespace
+
+struct ShardedServer::Shard {
+	std::size_t                index = 0;
+	Socket                     socket;
+	std::thread                thread;
+	std::atomic<std::uint64_t> received{ 0 };
+	std::atomic<int>           error{ 0 }; // raw value of the error that stopped the worker
+};
+
+ShardedServer::ShardedServer( const Config& config, Handler handler )
+	: _handler( std::move( handler ) )
+	, _config( config )
+	, _local( config.local )
+{
+	const std::size_t count
+		= config.shard_count != 0 ? config.shard_count : std::max( std::thread::hardware_concurrency(), 1u );
+
+	_config.batch_size = std::clamp<std::size_t>( config.batch_size, 1, Socket::max_recv_batch_size );
+
+	// bind all sockets before starting the first worker, so the kernel can distribute datagrams right away
+	for( std::size_t i = 0; i < count; ++i ) {
+		auto shard   = std::make_unique<Shard>();
+		shard->index = i;
+
+		set_option( shard->socket, socks::SocketOption::so_reuseport, 1, "SO_REUSEPORT" );
+		if( config.rx_buffer_size > 0 ) {
+			set_option( shard->socket, socks::SocketOption::so_rcvbuf, config.rx_buffer_size, "SO_RCVBUF" );
+		}
+		if( config.busy_poll.count() > 0 ) {
+			const auto us = static_cast<int>( config.busy_poll.count() );
+			set_option( shard->socket, socks::SocketOption::so_busy_poll, us, "SO_BUSY_POLL" );
+		}
+		shard->socket.set_rx_timeout( config.stop_latency );
+		shard->socket.bind( _local );
+
+		if( i == 0 && _local.port.inHostOrder() == 0 ) {
+			socks::port_layer::SockaddrIn addr{};
+			const auto                    res = shard->socket.as_raii_socket().getsockname( addr );
+			if( !res.success() ) {
+				throw generic_nw_error(
+					make_error_message_with_appended_last_errno( res, "Could not get port of sharded udp socket." ) );
+			}
+			_local = endpoint( addr );
+		}
+		_shards.push_back( std::move( shard ) );
+	}
+
+	const unsigned cpus = std::max( std::thread::hardware_concurrency(), 1u );
+	try {
+		for( auto& shard : _shards ) {
+			shard->thread = std::thread( [this, s = shard.get()] { run( *s ); } );
+			if( config.pin_threads ) { pin_to_cpu( shard->thread, static_cast<unsigned>( shard->index % cpus ) ); }
+		}
+	} catch( ... ) {
+		// the destructor won't run - joinable threads would call std::terminate
+		stop();
+		throw;
+	}
+}
+
+ShardedServer::~ShardedServer()
+{
+	stop();
+}
+
+void ShardedServer::stop() noexcept
+{
+	_stop.store( true, std::memory_order_relaxed );
+	for( auto& shard : _shards ) {
+		if( shard->thread.joinable() ) { shard->thread.join(); }
+	}
+}
+
+std::uint64_t ShardedServer::received( std::size_t shard ) const noexcept
+{
+	return shard < _shards.size() ? _shards[shard]->received.load( std::memory_order_relaxed ) : 0;
+}
+
+std::uint64_t ShardedServer::received() const noexcept
+{
+	std::uint64_t sum = 0;
+	for( const auto& shard : _shards ) {
+		sum += shard->received.load( std::memory_order_relaxed );
+	}
+	return sum;
+}
+
+socks::ErrorCode ShardedServer::error( std::size_t shard ) const noexcept
+{
+	if( shard >= _shards.size() ) { return socks::ErrorCode{ socks::ErrorCodeValues::InvalidArgument }; }
+	return socks::ErrorCode{ static_cast<socks::ErrorCodeValues>( _shards[shard]->error.load() ) };
+}
+
+std::size_t ShardedServer::failed_shards() const noexcept
+{
+	return static_cast<std::size_t>( std::count_if(
+		_shards.begin(), _shards.end(), []( const auto& shard ) { return shard->error.load() != 0; } ) );
+}
+
+void ShardedServer::run( Shard& shard ) noexcept
+{
+	using socks::ErrorCodeValues;
+
+	const std::size_t batch_size = _config.batch_size;
+
+	std::vector<mart::ByteType>         storage( batch_size * _config.max_datagram_size );
+	std::vector<mart::MemoryView>       buffers;
+	std::vector<Socket::RecvfromResult> results( batch_size );
+	for( std::size_t i = 0; i < batch_size; ++i ) {
+		buffers.emplace_back( storage.data() + i * _config.max_datagram_size, _config.max_datagram_size );
+	}
+
+	while( !_stop.load( std::memory_order_relaxed ) ) {
+		const auto res = shard.socket.try_recv_batch( buffers, results );
+		if( !res.success() ) {
+			const auto error = res.error_code().value();
+			if( error == ErrorCodeValues::WouldBlock || error == ErrorCodeValues::TryAgain
+				|| error == ErrorCodeValues::Timeout || error == ErrorCodeValues::WsaeConnReset
+				|| res.error_code().raw_value() == EINTR ) {
+				continue;
+			}
+			// the socket is broken - nothing left to do for this worker (reported by error())
+			shard.error.store( res.error_code().raw_value() );
+			return;
+		}
+		for( std::size_t i = 0; i < res.value(); ++i ) {
+			_handler( shard.index, shard.socket, results[i] );
+		}
+		shard.received.fetch_add( res.value(), std::memory_order_relaxed );
+	}
+}
+
+} // namespace mart::nw::ip::udp
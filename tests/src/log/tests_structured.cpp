@@ -0,0 +1,125 @@
+#include <mart-common/logging/Logger.h>
+#include <mart-common/logging/structured.h>
+
+#include <im_str/im_str.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+struct CaptureSink : mart::log::ILogSink {
+	std::string text;
+
+	mba::im_zstr getName() const override { return mba::im_zstr( "CaptureSink" ); }
+
+private:
+	void _do_writeToLogImpl( std::string_view msg ) override { text.append( msg.data(), msg.size() ); }
+	void _do_flush() override {}
+};
+
+template<class T>
+std::string encode( mart::log::Format fmt, const T& value )
+{
+	std::string             out;
+	mart::log::ValueWriter w( out, fmt );
+	mart::log::encode_kv_value( w, value );
+	return out;
+}
+} // namespace
+
+TEST_CASE( "structured_log_encodes_values", "[log][structured]" )
+{
+	using mart::log::Format;
+	using namespace std::chrono_literals;
+
+	CHECK( encode( Format::Json, true ) == "true" );
+	CHECK( encode( Format::Json, -42 ) == "-42" );
+	CHECK( encode( Format::Json, std::uint8_t{ 7 } ) == "7" );
+	CHECK( encode( Format::Json, 12us ) == "\"12us\"" );
+	CHECK( encode( Format::Logfmt, 12us ) == "12us" );
+	CHECK( encode( Format::Json, nullptr ) == "null" );
+	CHECK( encode( Format::Json, mart::log::Level::Debug ) == "\"DEBUG\"" );
+
+	CHECK( encode( Format::Json, std::string_view( "a\"b\\c\n" ) ) == R"("a\"b\\c\n")" );
+	CHECK( encode( Format::Json, std::string_view( "\x01" ) ) == R"("\u0001")" );
+
+	CHECK( encode( Format::Logfmt, std::string_view( "plain" ) ) == "plain" );
+	CHECK( encode( Format::Logfmt, std::string_view( "two words" ) ) == "\"two words\"" );
+	CHECK( encode( Format::Logfmt, std::string_view( "" ) ) == "\"\"" );
+
+	CHECK( encode( Format::Json, std::chrono::system_clock::time_point{} ) == "\"1970-01-01T00:00:00.000000Z\"" );
+}
+
+TEST_CASE( "structured_log_writes_json_and_logfmt_lines", "[log][structured]" )
+{
+	using mart::log::kv;
+
+	auto             sink = std::make_shared<CaptureSink>();
+	mart::log::Logger log( "net", sink, mart::log::Level::Status );
+
+	log.setFormat( mart::log::Format::Json );
+	log.info( "connected", kv( "port", 8080 ), kv( "peer", "local host" ) );
+	CHECK( sink->text.front() == '{' );
+	CHECK( sink->text.find( R"("level":"STATUS")" ) != std::string::npos );
+	CHECK( sink->text.find( R"("module":"[net]")" ) != std::string::npos );
+	CHECK( sink->text.find( R"("msg":"connected","port":8080,"peer":"local host"})" ) != std::string::npos );
+	CHECK( sink->text.back() == '\n' );
+
+	sink->text.clear();
+	log.setFormat( mart::log::Format::Logfmt );
+	log.status( "connected", kv( "port", 8080 ), kv( "peer", "local host" ) );
+	CHECK( sink->text.rfind( "level=STATUS t_ms=", 0 ) == 0 );
+	CHECK( sink->text.find( R"(msg=connected port=8080 peer="local host")" ) != std::string::npos );
+
+	// legacy interface: formatted message becomes the msg field
+	sink->text.clear();
+	log.status_msg( "value ", 5 );
+	CHECK( sink->text.find( R"(msg="value 5")" ) != std::string::npos );
+
+	// filtered by log level
+	sink->text.clear();
+	log.debug( "hidden", kv( "x", 1 ) );
+	CHECK( sink->text.empty() );
+
+	// text mode keeps the classic prefix and appends the fields
+	log.setFormat( mart::log::Format::Text );
+	log.error( "failed", kv( "code", 3 ) );
+	CHECK( sink->text.rfind( "ERROR ", 0 ) == 0 );
+	CHECK( sink->text.find( "[net]: failed code=3\n" ) != std::string::npos );
+}
+
+TEST_CASE( "structured_log_wall_clock_timestamps", "[log][structured]" )
+{
+	auto              sink = std::make_shared<CaptureSink>();
+	mart::log::Logger log( "net", sink, mart::log::Level::Status );
+	log.setTimestampFormat( mart::log::TimestampFormat::Iso8601 );
+
+	log.status_msg( "hello" );
+	// "STATUS - 2020-04-01T13:37:00.123456Z - [net]: hello"
+	REQUIRE( sink->text.size() > 36 );
+	CHECK( sink->text.substr( 0, 9 ) == "STATUS - " );
+	CHECK( sink->text[19] == 'T' );
+	CHECK( sink->text[35] == 'Z' );
+	CHECK( sink->text.substr( 36 ) == " - [net]: hello\n" );
+
+	sink->text.clear();
+	log.setFormat( mart::log::Format::Json );
+	log.status( "hello" );
+	CHECK( sink->text.find( R"("ts":")" ) != std::string::npos );
+}
+
+TEST_CASE( "structured_log_trace_prefix_keeps_the_thread_id_format", "[log][structured]" )
+{
+	auto              sink = std::make_shared<CaptureSink>();
+	mart::log::Logger log( "net", sink, mart::log::Level::TRACE );
+
+	std::ostringstream id;
+	id << std::this_thread::get_id();
+
+	log.status_msg( "hello" );
+	CHECK( sink->text.find( "[ThreadID: " + id.str() + "]: " ) != std::string::npos );
+}
@@ -0,0 +1,32 @@
+#include <mart-common/logging/timestamp_formatter.h>
+
+#include <catch2/catch.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+TEST_CASE( "timestamp_relative_ms_is_left_aligned", "[log][timestamp]" )
+{
+	char buffer[mart::log::timestamp::buffer_size];
+	CHECK( mart::log::timestamp::relative_ms( buffer, std::chrono::milliseconds( 12 ) ) == "12     ms" );
+	CHECK( mart::log::timestamp::relative_ms( buffer, std::chrono::milliseconds( -3 ) ) == "-3     ms" );
+	CHECK( mart::log::timestamp::relative_ms( buffer, std::chrono::milliseconds( 123456789 ) ) == "123456789ms" );
+}
+
+TEST_CASE( "timestamp_wall_clock_formats", "[log][timestamp]" )
+{
+	using namespace std::chrono;
+	char buffer[mart::log::timestamp::buffer_size];
+
+	const auto tp = system_clock::time_point( seconds( 1585748220 ) + microseconds( 1234 ) );
+	CHECK( mart::log::timestamp::iso8601( buffer, tp ) == "2020-04-01T13:37:00.001234Z" );
+	// second call hits the cache
+	CHECK( mart::log::timestamp::iso8601( buffer, tp + microseconds( 5 ) ) == "2020-04-01T13:37:00.001239Z" );
+	CHECK( mart::log::timestamp::iso8601( buffer, tp + seconds( 1 ) ) == "2020-04-01T13:37:01.001234Z" );
+
+	// must match the put_time based format, that was used before
+	const auto         t = system_clock::to_time_t( tp );
+	std::ostringstream ref;
+	ref << std::put_time( std::gmtime( &t ), "(%Z) %F_%T-" ) << "001234us";
+	CHECK( mart::log::timestamp::legacy( buffer, tp ) == ref.str() );
+}
@@ -0,0 +1,25 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+// path of a file in the system's temp directory
+inline std::string temp_file( const char* name )
+{
+	return ( std::filesystem::temp_directory_path() / name ).string();
+}
+
+// deterministic, non periodic test data - different seeds give different data
+inline std::vector<std::uint8_t> make_payload( std::size_t size, int seed )
+{
+	std::vector<std::uint8_t> ret( size );
+	for( std::size_t i = 0; i < size; ++i ) {
+		ret[i] = static_cast<std::uint8_t>( seed + i * 11 + i / 256 );
+	}
+	return ret;
+}
+
+} // namespace
@@ -0,0 +1,113 @@
+#include <mart-netlib/byte_order.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using mart::nw::ByteSwapKernel;
+
+// restores the default kernel at the end of a test
+struct KernelGuard {
+	~KernelGuard() { mart::nw::set_byte_swap_kernel( mart::nw::best_byte_swap_kernel() ); }
+};
+
+template<class T>
+std::vector<T> make_values( std::size_t cnt )
+{
+	std::vector<T> ret( cnt );
+	std::uint64_t  v = 0x0102030405060708u;
+	for( auto& e : ret ) {
+		e = static_cast<T>( v );
+		v = v * 6364136223846793005u + 1442695040888963407u;
+	}
+	return ret;
+}
+
+template<class T>
+bool check_bswap_all_sizes_and_offsets()
+{
+	const auto input = make_values<T>( 300 );
+	bool       ok    = true;
+	// the vector kernels process 16 / 32 / 64 bytes at a time - cover all remainders and misaligned starts
+	for( std::size_t offset = 0; offset < 3; ++offset ) {
+		for( std::size_t cnt = 0; cnt + offset <= input.size(); cnt += ( cnt < 70 ? 1 : 37 ) ) {
+			std::vector<T> out( cnt + 2, T( 0x55 ) );
+			mart::nw::bswap( mart::ArrayView<const T>( input.data() + offset, cnt ),
+							 mart::ArrayView<T>( out.data() + 1, cnt ) );
+			ok = ok && out.front() == T( 0x55 ) && out.back() == T( 0x55 );
+			for( std::size_t i = 0; i < cnt; ++i ) {
+				ok = ok && out[i + 1] == mart::nw::bswap( input[i + offset] );
+			}
+
+			// in place
+			std::vector<T> data( input.begin() + offset, input.begin() + offset + cnt );
+			mart::nw::bswap( mart::ArrayView<const T>( data ), mart::ArrayView<T>( data ) );
+			for( std::size_t i = 0; i < cnt; ++i ) {
+				ok = ok && data[i] == mart::nw::bswap( input[i + offset] );
+			}
+		}
+	}
+	return ok;
+}
+
+} // namespace
+
+TEST_CASE( "byte_order_bswap_arrays_with_all_kernels", "[net][byte_order]" )
+{
+	KernelGuard guard;
+	CHECK( mart::nw::byte_swap_kernel() == mart::nw::best_byte_swap_kernel() );
+
+	for( const auto kernel : { ByteSwapKernel::Scalar, ByteSwapKernel::Ssse3, ByteSwapKernel::Avx2 } ) {
+		if( !mart::nw::set_byte_swap_kernel( kernel ) ) {
+			CHECK( kernel != ByteSwapKernel::Scalar );
+			continue;
+		}
+		CHECK( mart::nw::byte_swap_kernel() == kernel );
+		CHECK( check_bswap_all_sizes_and_offsets<std::uint16_t>() );
+		CHECK( check_bswap_all_sizes_and_offsets<std::uint32_t>() );
+		CHECK( check_bswap_all_sizes_and_offsets<std::uint64_t>() );
+	}
+}
+
+TEST_CASE( "byte_order_array_conversion_matches_scalar_conversion", "[net][byte_order]" )
+{
+	using namespace mart::nw;
+
+	const auto host16 = make_values<std::uint16_t>( 1000 );
+	const auto host32 = make_values<std::uint32_t>( 1000 );
+	const auto host64 = make_values<std::uint64_t>( 1000 );
+
+	std::vector<uint16_net_t> net16( host16.size() );
+	std::vector<uint32_net_t> net32( host32.size() );
+	std::vector<uint64_net_t> net64( host64.size() );
+	to_net_order( host16, net16 );
+	to_net_order( host32, net32 );
+	to_net_order( host64, net64 );
+
+	bool ok = true;
+	for( std::size_t i = 0; i < host16.size(); ++i ) {
+		ok = ok && net16[i] == to_net_order( host16[i] ) && net32[i] == to_net_order( host32[i] )
+			 && net64[i] == to_net_order( host64[i] );
+	}
+	CHECK( ok );
+
+	std::vector<std::uint16_t> back16( host16.size() );
+	std::vector<std::uint32_t> back32( host32.size() );
+	std::vector<std::uint64_t> back64( host64.size() );
+	to_host_order( net16, back16 );
+	to_host_order( net32, back32 );
+	to_host_order( net64, back64 );
+	CHECK( back16 == host16 );
+	CHECK( back32 == host32 );
+	CHECK( back64 == host64 );
+
+	// in place: e.g. samples that were copied out of a packet
+	to_net_order_in_place( back32 );
+	CHECK( std::memcmp( back32.data(), net32.data(), back32.size() * sizeof( std::uint32_t ) ) == 0 );
+	to_host_order_in_place( back32 );
+	CHECK( back32 == host32 );
+}
@@ -0,0 +1,230 @@
+#if defined( __linux__ ) && defined( __cpp_impl_coroutine )
+
+#include <mart-netlib/coro.hpp>
+
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+namespace coro = mart::nw::coro;
+namespace tcp  = mart::nw::ip::tcp;
+namespace udp  = mart::nw::ip::udp;
+
+coro::Task<> echo( tcp::Socket con )
+{
+	char buffer[64];
+	while( true ) {
+		auto data = co_await con.async_recv( mart::view_bytes_mutable( buffer ) );
+		if( data.empty() ) { co_return; }
+		co_await con.async_send( data );
+	}
+}
+
+coro::Task<> accept_n( coro::Scheduler& scheduler, tcp::Acceptor& acceptor, int n )
+{
+	for( int i = 0; i < n; ++i ) {
+		scheduler.spawn( echo( co_await acceptor.async_accept() ) );
+	}
+}
+
+coro::Task<> echo_client( tcp::endpoint server, int id, int& successful )
+{
+	tcp::Socket sock;
+	sock.connect( server );
+
+	const std::string msg = "Hello from client " + std::to_string( id );
+	co_await sock.async_send( mart::view_elements( msg ).asBytes() );
+
+	std::vector<char> buffer( msg.size() );
+	std::size_t       received = 0;
+	while( received < buffer.size() ) {
+		auto data = co_await sock.async_recv( mart::view_elements_mutable( buffer ).asBytes().subview( received ) );
+		if( data.empty() ) { co_return; }
+		received += data.size();
+	}
+	if( std::string_view( buffer.data(), buffer.size() ) == msg ) { successful++; }
+	// client closes first, so the server side doesn't end up in TIME_WAIT
+}
+
+coro::Task<int> answer()
+{
+	co_return 42;
+}
+
+coro::Task<int> add_answer( int v )
+{
+	co_return v + co_await answer();
+}
+
+} // namespace
+
+TEST_CASE( "coro_tcp_echo_with_many_connections", "[net][coro]" )
+{
+	const tcp::endpoint server{ "127.0.0.1:3477" };
+	constexpr int       n = 50;
+
+	coro::Scheduler scheduler;
+	tcp::Acceptor   acceptor( server, n );
+
+	int successful = 0;
+	scheduler.spawn( accept_n( scheduler, acceptor, n ) );
+	for( int i = 0; i < n; ++i ) {
+		scheduler.spawn( echo_client( server, i, successful ) );
+	}
+	scheduler.run();
+
+	CHECK( successful == n );
+	CHECK( scheduler.task_count() == 0 );
+}
+
+TEST_CASE( "coro_tcp_send_suspends_until_writable", "[net][coro]" )
+{
+	const tcp::endpoint server{ "127.0.0.1:3479" };
+
+	coro::Scheduler scheduler;
+	tcp::Acceptor   acceptor( server );
+
+	// much more than fits into the socket buffers
+	std::vector<unsigned char> tx_data( 8 * 1024 * 1024 );
+	for( std::size_t i = 0; i < tx_data.size(); ++i ) {
+		tx_data[i] = static_cast<unsigned char>( i * 7 );
+	}
+	std::vector<unsigned char> rx_data;
+
+	tcp::Socket client;
+	client.connect( server );
+
+	// NOTE: the lambdas have to outlive the coroutines, as they access the captures through the closure object
+	auto sender = [&]() -> coro::Task<> {
+		co_await client.async_send( mart::view_elements( tx_data ).asBytes() );
+		client.close();
+	};
+	auto receiver = [&]() -> coro::Task<> {
+		auto          con = co_await acceptor.async_accept();
+		unsigned char buffer[4096];
+		while( true ) {
+			auto data = co_await con.async_recv( mart::view_bytes_mutable( buffer ) );
+			if( data.empty() ) { co_return; }
+			rx_data.insert( rx_data.end(), data.begin(), data.end() );
+		}
+	};
+	scheduler.spawn( sender() );
+	scheduler.spawn( receiver() );
+	scheduler.run();
+
+	CHECK( rx_data == tx_data );
+}
+
+TEST_CASE( "coro_udp_recvfrom_and_sleep", "[net][coro]" )
+{
+	const udp::endpoint rx_ep{ "127.0.0.1:3478" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3480" };
+
+	udp::Socket rx;
+	rx.bind( rx_ep );
+	udp::Socket tx;
+	tx.bind( tx_ep );
+
+	coro::Scheduler scheduler;
+
+	int           value = 0;
+	udp::endpoint source{};
+	const auto    start       = std::chrono::steady_clock::now();
+	auto          received_at = start;
+
+	auto receiver = [&]() -> coro::Task<> {
+		auto res    = co_await rx.async_recvfrom( mart::view_bytes_mutable( value ) );
+		source      = res.remote_address;
+		received_at = std::chrono::steady_clock::now();
+	};
+	auto sender = [&]() -> coro::Task<> {
+		co_await scheduler.sleep_for( 20ms );
+		tx.sendto( mart::view_bytes( 1234 ), rx_ep );
+	};
+	scheduler.spawn( receiver() );
+	scheduler.spawn( sender() );
+	scheduler.run();
+
+	CHECK( value == 1234 );
+	CHECK( source == tx_ep );
+	CHECK( received_at - start >= 20ms );
+}
+
+TEST_CASE( "coro_second_waiter_on_the_same_socket_is_rejected", "[net][coro]" )
+{
+	const udp::endpoint rx_ep{ "127.0.0.1:3482" };
+
+	udp::Socket rx;
+	rx.bind( rx_ep );
+	udp::Socket tx;
+
+	coro::Scheduler scheduler;
+
+	int  received = 0;
+	auto receiver = [&]() -> coro::Task<> {
+		int value = 0;
+		co_await rx.async_recvfrom( mart::view_bytes_mutable( value ) );
+		received = value;
+	};
+	scheduler.spawn( receiver() );
+	scheduler.spawn( receiver() );
+	CHECK_THROWS_AS( scheduler.run(), mart::nw::generic_nw_error );
+	CHECK( scheduler.task_count() == 1 );
+
+	// the first receiver is still waiting
+	tx.sendto( mart::view_bytes( 7 ), rx_ep );
+	scheduler.run();
+	CHECK( received == 7 );
+	CHECK( scheduler.task_count() == 0 );
+}
+
+TEST_CASE( "coro_task_results_and_exceptions", "[net][coro]" )
+{
+	coro::Scheduler scheduler;
+
+	int  result     = 0;
+	auto get_result = [&]() -> coro::Task<> { result = co_await add_answer( 1 ); };
+	scheduler.spawn( get_result() );
+	scheduler.run();
+	CHECK( result == 43 );
+
+	auto fail = []() -> coro::Task<> {
+		co_await answer();
+		throw std::runtime_error( "Task failed" );
+	};
+	scheduler.spawn( fail() );
+	CHECK_THROWS_AS( scheduler.run(), std::runtime_error );
+	CHECK( scheduler.task_count() == 0 );
+
+	// unfinished tasks are destroyed together with the scheduler
+	udp::Socket idle;
+	idle.bind( udp::endpoint{ "127.0.0.1:3481" } );
+	auto pending = std::make_unique<coro::Scheduler>();
+
+	auto wait_forever = [&]() -> coro::Task<> {
+		int buffer = 0;
+		co_await idle.async_recvfrom( mart::view_bytes_mutable( buffer ) );
+	};
+	auto stop = [&]() -> coro::Task<> {
+		co_await pending->sleep_for( 1ms );
+		pending->stop();
+	};
+	pending->spawn( wait_forever() );
+	pending->spawn( stop() );
+	pending->run();
+	CHECK( pending->task_count() == 1 );
+	pending.reset();
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <mart-netlib/io_queue.hpp>
+
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+namespace pl = mart::nw::socks::port_layer;
+
+namespace {
+
+const pl::IoCompletion* find( const std::array<pl::IoCompletion, 4>& completions, int cnt, std::uint64_t user_data )
+{
+	auto it = std::find_if( completions.begin(), completions.begin() + cnt, [&]( const pl::IoCompletion& c ) {
+		return c.user_data == user_data;
+	} );
+	return it == completions.begin() + cnt ? nullptr : &*it;
+}
+
+// waits until cnt completions were retrieved
+int wait_for( pl::IoQueue& queue, std::array<pl::IoCompletion, 4>& completions, int cnt )
+{
+	int received = 0;
+	while( received < cnt ) {
+		auto ret = queue.wait_completions( completions.data() + received, completions.size() - received, 1 );
+		REQUIRE( ret.success() );
+		if( ret.value() == 0 ) { break; }
+		received += ret.value();
+	}
+	return received;
+}
+
+void check_udp_recv_and_send( pl::IoBackend backend, bool fixed )
+{
+	using namespace mart::nw::ip;
+	const udp::endpoint rx_ep{ "127.0.0.1:3465" };
+
+	udp::Socket rx;
+	rx.bind( rx_ep );
+	udp::Socket tx;
+	tx.connect( rx_ep );
+
+	pl::IoQueue queue( 8, backend );
+	if( backend == pl::IoBackend::Fallback ) { CHECK( queue.backend() == pl::IoBackend::Fallback ); }
+
+	std::array<unsigned char, 64> rx_buffer{};
+	std::array<unsigned char, 16> tx_buffer{};
+	std::fill( tx_buffer.begin(), tx_buffer.end(), static_cast<unsigned char>( 0x42 ) );
+
+	const mart::nw::byte_range_mut rx_range{ rx_buffer.data(), rx_buffer.size() };
+	const mart::nw::byte_range     tx_range{ tx_buffer.data(), tx_buffer.size() };
+
+	if( fixed ) {
+		const std::array<mart::nw::byte_range_mut, 2> buffers{
+			rx_range, mart::nw::byte_range_mut{ tx_buffer.data(), tx_buffer.size() } };
+		const std::array<pl::handle_t, 2> handles{ rx.get_raw_socket_handle(), tx.get_raw_socket_handle() };
+		REQUIRE( queue.register_buffers( buffers.data(), buffers.size() ).success() );
+		REQUIRE( queue.register_handles( handles.data(), handles.size() ).success() );
+
+		CHECK( queue.prepare_recv_fixed( rx.get_raw_socket_handle(), rx_range, 0, 1 ) );
+		CHECK( queue.prepare_send_fixed( tx.get_raw_socket_handle(), tx_range, 1, 2 ) );
+	} else {
+		CHECK( queue.prepare_recv( rx.get_raw_socket_handle(), rx_range, 0, 1 ) );
+		CHECK( queue.prepare_send( tx.get_raw_socket_handle(), tx_range, 0, 2 ) );
+	}
+	CHECK( queue.prepared_count() == 2 );
+
+	std::array<pl::IoCompletion, 4> completions{};
+	REQUIRE( wait_for( queue, completions, 2 ) == 2 );
+	CHECK( queue.in_flight_count() == 0 );
+
+	const auto* recv_c = find( completions, 2, 1 );
+	const auto* send_c = find( completions, 2, 2 );
+	REQUIRE( recv_c );
+	REQUIRE( send_c );
+	CHECK( recv_c->success() );
+	CHECK( send_c->success() );
+	CHECK( send_c->size == 16 );
+	CHECK( recv_c->size == 16 );
+	// only accept reports a handle
+	CHECK( send_c->handle == pl::handle_t::Invalid );
+	CHECK( recv_c->handle == pl::handle_t::Invalid );
+	CHECK( rx_buffer[0] == 0x42 );
+	CHECK( rx_buffer[15] == 0x42 );
+	CHECK( rx_buffer[16] == 0 );
+
+	if( fixed ) {
+		CHECK( queue.unregister_handles().success() );
+		CHECK( queue.unregister_buffers().success() );
+	}
+}
+
+} // namespace
+
+TEST_CASE( "io_queue_udp_recv_and_send", "[net][io_queue]" )
+{
+	check_udp_recv_and_send( pl::IoBackend::Fallback, false );
+	check_udp_recv_and_send( pl::IoBackend::Auto, false );
+	if( pl::IoQueue::io_uring_supported() ) {
+		pl::IoQueue queue;
+		CHECK( queue.backend() == pl::IoBackend::IoUring );
+		check_udp_recv_and_send( pl::IoBackend::IoUring, false );
+	}
+
+	// no silent fallback, if io_uring is requested explicitly
+	pl::IoQueue uring_only( 8, pl::IoBackend::IoUring );
+	CHECK( uring_only.is_valid() == pl::IoQueue::io_uring_supported() );
+	CHECK( pl::IoQueue( 8, pl::IoBackend::Fallback ).is_valid() );
+}
+
+TEST_CASE( "io_queue_registered_buffers_and_handles", "[net][io_queue]" )
+{
+	check_udp_recv_and_send( pl::IoBackend::Fallback, true );
+	check_udp_recv_and_send( pl::IoBackend::Auto, true );
+}
+
+TEST_CASE( "io_queue_tcp_accept", "[net][io_queue]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3466" };
+
+	for( auto backend : { pl::IoBackend::Fallback, pl::IoBackend::Auto } ) {
+		tcp::Acceptor acceptor( server_ep );
+		pl::IoQueue   queue( 4, backend );
+
+		CHECK( queue.prepare_accept( acceptor.getSocket().get_handle(), 7 ) );
+		REQUIRE( queue.submit().success() );
+
+		std::thread client( [&] {
+			auto s = tcp::connect( server_ep );
+			s.send( mart::view_bytes( 5 ) );
+		} );
+
+		std::array<pl::IoCompletion, 4> completions{};
+		REQUIRE( wait_for( queue, completions, 1 ) == 1 );
+		client.join();
+
+		CHECK( completions[0].user_data == 7 );
+		REQUIRE( completions[0].success() );
+		REQUIRE( completions[0].handle != pl::handle_t::Invalid );
+		CHECK( completions[0].size == 0 );
+#ifndef _WIN32
+		CHECK( ( ::fcntl( pl::to_native( completions[0].handle ), F_GETFD ) & FD_CLOEXEC ) != 0 );
+#endif
+
+		int  value = 0;
+		auto ret   = pl::recv( completions[0].handle, mart::nw::byte_range_from_pod( value ), 0 );
+		CHECK( ret.success() );
+		CHECK( value == 5 );
+		pl::close_socket( completions[0].handle );
+	}
+}
+
+TEST_CASE( "io_queue_full_submission_queue", "[net][io_queue]" )
+{
+	pl::IoQueue queue( 2, pl::IoBackend::Fallback );
+	int         dummy = 0;
+	CHECK( queue.prepare_recv( pl::handle_t::Invalid, mart::nw::byte_range_from_pod( dummy ), 0, 1 ) );
+	CHECK( queue.prepare_recv( pl::handle_t::Invalid, mart::nw::byte_range_from_pod( dummy ), 0, 2 ) );
+	CHECK( !queue.prepare_recv( pl::handle_t::Invalid, mart::nw::byte_range_from_pod( dummy ), 0, 3 ) );
+	CHECK( queue.prepared_count() == 2 );
+}
@@ -0,0 +1,73 @@
+#include <mart-netlib/packet_pool.hpp>
+
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+using Pool = mart::nw::BasicPacketPool<mart::nw::ip::udp::endpoint>;
+
+TEST_CASE( "packet_pool_allocate_and_release", "[net][packet_pool]" )
+{
+	Pool pool( 128, 2 );
+	CHECK( pool.slab_size() == 128 );
+	CHECK( pool.available() == 2 );
+
+	auto p1 = pool.try_allocate();
+	auto p2 = pool.try_allocate();
+	REQUIRE( p1 );
+	REQUIRE( p2 );
+	CHECK( p1.buffer().size() == 128 );
+	CHECK( p1.buffer().data() != p2.buffer().data() );
+	CHECK( !pool.try_allocate() );
+	CHECK( pool.available() == 0 );
+
+	p1.buffer()[0] = mart::ByteType{ 42 };
+	p1.assign( 1, mart::nw::ip::udp::endpoint{ "127.0.0.1:1234" }, {} );
+
+	auto copy = p1;
+	CHECK( copy.use_count() == 2 );
+	CHECK( copy.data().data() == p1.data().data() );
+	p1.reset();
+	CHECK( pool.available() == 0 );
+	CHECK( copy.data()[0] == mart::ByteType{ 42 } );
+	CHECK( copy.source() == mart::nw::ip::udp::endpoint{ "127.0.0.1:1234" } );
+
+	copy = std::move( p2 );
+	CHECK( pool.available() == 1 );
+	copy.reset();
+	CHECK( pool.available() == 2 );
+	CHECK( !p2 );
+}
+
+TEST_CASE( "packet_pool_concurrent_use", "[net][packet_pool]" )
+{
+	constexpr std::size_t slabs = 16;
+	Pool                  pool( 64, slabs );
+
+	std::atomic<bool>        failed{ false };
+	std::vector<std::thread> threads;
+	for( int t = 0; t < 4; ++t ) {
+		threads.emplace_back( [&, t] {
+			for( int i = 0; i < 20000; ++i ) {
+				auto p = pool.try_allocate();
+				if( !p ) { continue; }
+				const auto tag = static_cast<mart::ByteType>( t );
+				p.buffer()[0]  = tag;
+				auto copy      = p;
+				p.reset();
+				// nobody else must have gotten the same slab in the meantime
+				if( copy.buffer()[0] != tag ) { failed = true; }
+			}
+		} );
+	}
+	for( auto& th : threads ) {
+		th.join();
+	}
+	CHECK( !failed );
+	CHECK( pool.available() == slabs );
+}
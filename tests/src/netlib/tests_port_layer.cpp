@@ -2,7 +2,9 @@
 
 #include <catch2/catch.hpp>
 
+#include <climits>
 #include <iostream>
+#include <vector>
 
 namespace pl    = mart::nw::socks::port_layer;
 namespace socks = mart::nw::socks;
@@ -40,6 +42,26 @@ TEST_CASE( "net_port-layer_check_function_implementation_exists" )
 	listen( s2, 10 );
 }
 
+TEST_CASE( "net_port-layer_scatter_gather_rejects_too_many_buffers" )
+{
+#ifdef IOV_MAX
+	CHECK( pl::startup() );
+	const auto handle
+		= pl::socket( socks::Domain::Inet, socks::TransportType::Datagram ).value_or( pl::handle_t::Invalid );
+	REQUIRE( handle != pl::handle_t::Invalid );
+
+	// the kernel would reject it anyway, so no buffer array is allocated for it
+	std::vector<mart::nw::byte_range>     tx_bufs( IOV_MAX + 1, mart::nw::byte_range{ nullptr, 0 } );
+	std::vector<mart::nw::byte_range_mut> rx_bufs( IOV_MAX + 1, mart::nw::byte_range_mut{ nullptr, 0 } );
+	CHECK( pl::sendv( handle, tx_bufs.data(), tx_bufs.size(), 0 ).error_code().value()
+		   == socks::ErrorCodeValues::MessageSize );
+	CHECK( pl::recvv( handle, rx_bufs.data(), rx_bufs.size(), 0 ).error_code().value()
+		   == socks::ErrorCodeValues::MessageSize );
+
+	pl::close_socket( handle );
+#endif
+}
+
 TEST_CASE( "net_port-layer_getaddrinfo" )
 {
 	CHECK( pl::startup() );
@@ -0,0 +1,158 @@
+#ifdef __linux__
+
+#include <mart-netlib/reactor.hpp>
+
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "reactor_dispatches_udp_readability", "[net][reactor]" )
+{
+	using namespace mart::nw::ip;
+	mart::nw::Reactor reactor;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3460" };
+	udp::Socket         rx;
+	rx.bind( rx_ep );
+
+	int received = 0;
+	reactor.add( rx, mart::nw::Interest::Read, [&]( mart::nw::Events ev ) {
+		CHECK( ev.readable );
+		int buffer = 0;
+		while( rx.try_recv( mart::view_bytes_mutable( buffer ) ).isValid() ) {
+			received += buffer;
+		}
+	} );
+	CHECK( reactor.is_registered( rx.get_raw_socket_handle() ) );
+	CHECK( !rx.is_blocking() );
+
+	// nothing to do
+	CHECK( reactor.run_once( 0ms ) == 0 );
+
+	udp::Socket tx;
+	tx.sendto( mart::view_bytes( 1 ), rx_ep );
+	tx.sendto( mart::view_bytes( 2 ), rx_ep );
+	CHECK( reactor.run_once( 1000ms ) == 1 );
+	CHECK( received == 3 );
+
+	reactor.remove( rx );
+	CHECK( reactor.registration_count() == 0 );
+	tx.sendto( mart::view_bytes( 1 ), rx_ep );
+	CHECK( reactor.run_once( 10ms ) == 0 );
+}
+
+TEST_CASE( "reactor_serves_tcp_acceptor_and_connections_edge_triggered", "[net][reactor]" )
+{
+	using namespace mart::nw::ip;
+	mart::nw::Reactor reactor;
+
+	const tcp::endpoint server_ep{ "127.0.0.1:3461" };
+	tcp::Acceptor       acceptor( server_ep );
+
+	std::vector<std::unique_ptr<tcp::Socket>> connections;
+	std::string                               received;
+
+	reactor.add(
+		acceptor,
+		[&]( mart::nw::Events ) {
+			// edge triggered: accept everything that is pending
+			// NOTE: if nothing is pending, try_accept returns an unconnected socket
+			for( auto s = acceptor.try_accept(); s.get_remote_endpoint().valid(); s = acceptor.try_accept() ) {
+				connections.push_back( std::make_unique<tcp::Socket>( std::move( s ) ) );
+				tcp::Socket& con = *connections.back();
+				reactor.add(
+					con,
+					mart::nw::Interest::Read,
+					[&]( mart::nw::Events ev ) {
+						char buffer[4];
+						for( auto data = con.recv( mart::view_bytes_mutable( buffer ) ); data.isValid() && data.size() != 0;
+							 data      = con.recv( mart::view_bytes_mutable( buffer ) ) ) {
+							received.append( data.asConstCharPtr(), data.size() );
+						}
+						if( ev.hangup ) { reactor.remove( con ); }
+					},
+					mart::nw::TriggerMode::Edge );
+			}
+		},
+		mart::nw::TriggerMode::Edge );
+
+	std::thread client( [&] {
+		auto s = tcp::connect( server_ep );
+		s.send( mart::view_elements( std::string_view( "Hello reactor" ) ).asBytes() );
+	} );
+	client.join();
+
+	const auto deadline = std::chrono::steady_clock::now() + 2s;
+	while( received.size() < 13 && std::chrono::steady_clock::now() < deadline ) {
+		reactor.run_once( 100ms );
+	}
+	CHECK( connections.size() == 1 );
+	CHECK( received == "Hello reactor" );
+}
+
+TEST_CASE( "reactor_oneshot_needs_rearming", "[net][reactor]" )
+{
+	using namespace mart::nw::ip;
+	mart::nw::Reactor reactor;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3462" };
+	udp::Socket         rx;
+	rx.bind( rx_ep );
+
+	int calls = 0;
+	reactor.add(
+		rx, mart::nw::Interest::Read, [&]( mart::nw::Events ) { calls++; }, mart::nw::TriggerMode::OneShot );
+
+	udp::Socket tx;
+	tx.sendto( mart::view_bytes( 1 ), rx_ep );
+	CHECK( reactor.run_once( 1000ms ) == 1 );
+	// data is still pending, but the registration is disarmed
+	CHECK( reactor.run_once( 10ms ) == 0 );
+	reactor.modify( rx, mart::nw::Interest::Read );
+	CHECK( reactor.run_once( 1000ms ) == 1 );
+	CHECK( calls == 2 );
+}
+
+TEST_CASE( "reactor_timers", "[net][reactor]" )
+{
+	mart::nw::Reactor reactor;
+
+	int  one_shot   = 0;
+	int  periodic   = 0;
+	auto cancelled  = reactor.add_timer( 1ms, [&] { FAIL( "Cancelled timer was executed" ); } );
+	auto periodic_t = reactor.add_periodic_timer( 5ms, [&] { periodic++; } );
+	reactor.add_timer( 10ms, [&] { one_shot++; } );
+	CHECK( reactor.cancel_timer( cancelled ) );
+	CHECK( !reactor.cancel_timer( cancelled ) );
+
+	reactor.add_timer( 50ms, [&] {
+		CHECK( reactor.cancel_timer( periodic_t ) );
+		reactor.stop();
+	} );
+	reactor.run();
+
+	CHECK( one_shot == 1 );
+	CHECK( periodic >= 3 );
+	CHECK( periodic <= 10 );
+}
+
+TEST_CASE( "reactor_stop_from_other_thread", "[net][reactor]" )
+{
+	mart::nw::Reactor reactor;
+
+	std::thread th( [&] {
+		std::this_thread::sleep_for( 20ms );
+		reactor.stop();
+	} );
+	// would block forever without stop
+	reactor.run();
+	th.join();
+}
+
+#endif
@@ -0,0 +1,301 @@
+#include <mart-netlib/tcp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "./test_data.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+namespace pl = mart::nw::socks::port_layer;
+
+void write_file( const std::string& path, const std::vector<std::uint8_t>& data )
+{
+	std::ofstream file( path, std::ios::binary );
+	file.write( reinterpret_cast<const char*>( data.data() ), static_cast<std::streamsize>( data.size() ) );
+}
+
+// receives until the peer closes the connection
+std::vector<std::uint8_t> recv_all( mart::nw::ip::tcp::Socket& sock )
+{
+	std::vector<std::uint8_t> ret;
+	std::vector<std::uint8_t> buffer( 64 * 1024 );
+	while( true ) {
+		const auto data = sock.recv( mart::view_elements_mutable( buffer ) );
+		if( data.empty() ) { break; }
+		ret.insert( ret.end(), data.begin(), data.end() );
+	}
+	return ret;
+}
+
+int native_fd( const mart::nw::ip::tcp::Socket& sock )
+{
+	return static_cast<int>( pl::to_native( sock.get_raw_socket_handle() ) );
+}
+
+} // namespace
+
+TEST_CASE( "tcp_send_file_transmits_file_ranges", "[net][tcp][sendfile]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3491" };
+
+	const auto path    = temp_file( "mart_netlib_test_send_file.bin" );
+	const auto content = make_payload( 3 * 1024 * 1024 + 17, 5 );
+	write_file( path, content );
+
+	tcp::Acceptor acceptor( server_ep );
+	tcp::Socket   client;
+	client.connect( server_ep );
+	tcp::Socket server = acceptor.accept();
+
+	std::vector<std::uint8_t> received;
+	std::thread               receiver( [&] { received = recv_all( server ); } );
+
+	// whole file, a range in the middle and a range that extends beyond the end of the file
+	CHECK( client.send_file( path ) == content.size() );
+	CHECK( client.send_file( path, 1000, 5000 ) == 5000u );
+	CHECK( client.send_file( path, content.size() - 10, 100 ) == 10u );
+	CHECK( client.send_file( path, content.size() + 10 ) == 0u );
+	CHECK_THROWS_AS( client.send_file( temp_file( "mart_netlib_test_send_file_missing.bin" ) ),
+					 mart::nw::generic_nw_error );
+	CHECK_THROWS_AS( client.send_file( path, std::numeric_limits<std::uint64_t>::max() - 1 ),
+					 mart::nw::generic_nw_error );
+	client.close();
+	receiver.join();
+
+	std::vector<std::uint8_t> expected = content;
+	expected.insert( expected.end(), content.begin() + 1000, content.begin() + 6000 );
+	expected.insert( expected.end(), content.end() - 10, content.end() );
+	CHECK( received.size() == expected.size() );
+	CHECK( received == expected );
+
+	std::remove( path.c_str() );
+}
+
+TEST_CASE( "tcp_send_file_continues_partial_sends_of_non_blocking_sockets", "[net][tcp][sendfile]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3491" };
+
+	const auto path    = temp_file( "mart_netlib_test_send_file_nonblocking.bin" );
+	const auto content = make_payload( 16 * 1024 * 1024, 9 );
+	write_file( path, content );
+
+	tcp::Acceptor acceptor( server_ep );
+	tcp::Socket   client;
+	client.connect( server_ep );
+	tcp::Socket server = acceptor.accept();
+
+	// nobody receives yet, so the send buffer fills up long before the end of the file
+	client.set_blocking( false );
+	std::uint64_t offset = client.send_file( path );
+	CHECK( offset < content.size() );
+
+	std::vector<std::uint8_t> received;
+	std::thread               receiver( [&] { received = recv_all( server ); } );
+
+	while( offset < content.size() ) {
+		offset += client.send_file( path, offset );
+		if( offset < content.size() ) { std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ); }
+	}
+	CHECK( offset == content.size() );
+	client.close();
+	receiver.join();
+
+	CHECK( received.size() == content.size() );
+	CHECK( received == content );
+
+	std::remove( path.c_str() );
+}
+
+TEST_CASE( "port_layer_splicer_forwards_socket_to_file_and_socket", "[net][tcp][sendfile]" )
+{
+#if defined( __linux__ )
+	using namespace mart::nw::ip;
+	const tcp::endpoint in_ep{ "127.0.0.1:3491" };
+	const tcp::endpoint out_ep{ "127.0.0.1:3492" };
+
+	const auto content = make_payload( 2 * 1024 * 1024 + 3, 1 );
+
+	pl::Splicer splicer;
+	REQUIRE( splicer.is_valid() );
+
+	tcp::Acceptor in_acceptor( in_ep );
+	tcp::Acceptor out_acceptor( out_ep );
+	tcp::Socket   source;
+	source.connect( in_ep );
+	tcp::Socket in = in_acceptor.accept();
+	tcp::Socket out;
+	out.connect( out_ep );
+	tcp::Socket sink = out_acceptor.accept();
+
+	std::thread sender( [&] {
+		source.send( mart::view_elements( content ) );
+		source.close();
+	} );
+	std::vector<std::uint8_t> forwarded;
+	std::thread               receiver( [&] { forwarded = recv_all( sink ); } );
+
+	// socket -> socket: the first half
+	std::size_t total = 0;
+	while( total < content.size() / 2 ) {
+		const auto res = splicer.transfer( native_fd( in ), native_fd( out ), content.size() / 2 - total );
+		REQUIRE( res.success() );
+		REQUIRE( res.value() > 0 );
+		total += static_cast<std::size_t>( res.value() );
+	}
+	CHECK( splicer.pending() == 0 );
+	out.close();
+	receiver.join();
+
+	// socket -> file: the rest, until the sender closes the connection
+	const auto path = temp_file( "mart_netlib_test_splice.bin" );
+	const int  fd   = ::open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+	REQUIRE( fd >= 0 );
+	while( true ) {
+		const auto res = splicer.transfer( native_fd( in ), fd, 1024 * 1024 );
+		REQUIRE( res.success() );
+		if( res.value() == 0 && splicer.pending() == 0 ) { break; }
+		total += static_cast<std::size_t>( res.value() );
+	}
+	::close( fd );
+	sender.join();
+
+	CHECK( total == content.size() );
+	CHECK( forwarded.size() == content.size() / 2 );
+	CHECK( std::equal( forwarded.begin(), forwarded.end(), content.begin() ) );
+
+	std::vector<std::uint8_t> file_content( std::filesystem::file_size( path ) );
+	std::ifstream( path, std::ios::binary )
+		.read( reinterpret_cast<char*>( file_content.data() ), static_cast<std::streamsize>( file_content.size() ) );
+	CHECK( file_content.size() == content.size() - content.size() / 2 );
+	CHECK( std::equal( file_content.begin(), file_content.end(), content.begin() + content.size() / 2 ) );
+
+	std::remove( path.c_str() );
+#else
+	pl::Splicer splicer;
+	CHECK( !splicer.is_valid() );
+	CHECK( splicer.transfer( 0, 1, 1 ).error_code().value() == mart::nw::socks::ErrorCodeValues::NotSupported );
+#endif
+}
+
+TEST_CASE( "port_layer_splicer_forwards_requests_without_waiting_for_more_data", "[net][tcp][sendfile]" )
+{
+#if defined( __linux__ )
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+	const tcp::endpoint in_ep{ "127.0.0.1:3494" };
+	const tcp::endpoint out_ep{ "127.0.0.1:3495" };
+
+	pl::Splicer splicer;
+	REQUIRE( splicer.is_valid() );
+
+	tcp::Acceptor in_acceptor( in_ep );
+	tcp::Acceptor out_acceptor( out_ep );
+	tcp::Socket   source;
+	source.connect( in_ep );
+	tcp::Socket in = in_acceptor.accept();
+	tcp::Socket out;
+	out.connect( out_ep );
+	tcp::Socket sink = out_acceptor.accept();
+
+	// a proxy that waited for count bytes would only return after this timeout
+	in.set_rx_timeout( 2s );
+
+	// request / response: the source sends less than count and waits for an answer, before it sends again
+	std::array<std::uint8_t, 16> buffer{};
+	for( std::uint8_t i = 0; i < 3; ++i ) {
+		const std::array<std::uint8_t, 4> request{ i, 1, 2, 3 };
+		source.send( mart::view_elements( request ) );
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto res   = splicer.transfer( native_fd( in ), native_fd( out ), 64 * 1024 );
+		CHECK( std::chrono::steady_clock::now() - start < 1s );
+		REQUIRE( res.success() );
+		CHECK( static_cast<std::size_t>( res.value() ) == request.size() );
+		CHECK( splicer.pending() == 0 );
+
+		const auto received = sink.recv( mart::view_elements_mutable( buffer ) );
+		REQUIRE( received.size() == request.size() );
+		CHECK( std::equal( received.begin(), received.end(), request.begin() ) );
+	}
+
+	// clients close first, so the server side doesn't end up in TIME_WAIT
+	source.close();
+	out.close();
+#else
+	pl::Splicer splicer;
+	CHECK( !splicer.is_valid() );
+#endif
+}
+
+TEST_CASE( "port_layer_splicer_keeps_pending_data_for_its_destination", "[net][tcp][sendfile]" )
+{
+#if defined( __linux__ )
+	using namespace mart::nw::ip;
+	using mart::nw::socks::ErrorCodeValues;
+	const tcp::endpoint server_ep{ "127.0.0.1:3493" };
+
+	const auto path    = temp_file( "mart_netlib_test_splice_pending.bin" );
+	const auto content = make_payload( 16 * 1024 * 1024, 3 );
+	write_file( path, content );
+	const int file_fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+	REQUIRE( file_fd >= 0 );
+
+	tcp::Acceptor acceptor( server_ep );
+	tcp::Socket   client;
+	client.connect( server_ep );
+	tcp::Socket server = acceptor.accept();
+
+	// nobody receives, so the send buffer fills up and the splicer is left with data in its pipe
+	client.set_blocking( false );
+	pl::Splicer splicer;
+	REQUIRE( splicer.is_valid() );
+	std::size_t total = 0;
+	while( true ) {
+		const auto res = splicer.transfer( file_fd, native_fd( client ), 12345 );
+		if( !res.success() ) {
+			CHECK( ( res.error_code().value() == ErrorCodeValues::WouldBlock
+					 || res.error_code().value() == ErrorCodeValues::TryAgain ) );
+			break;
+		}
+		REQUIRE( res.value() > 0 );
+		total += static_cast<std::size_t>( res.value() );
+		REQUIRE( total < content.size() );
+	}
+	REQUIRE( splicer.pending() != 0 );
+
+	// the pending data must not end up at another destination
+	const auto path_other = temp_file( "mart_netlib_test_splice_other.bin" );
+	const int  other_fd   = ::open( path_other.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+	REQUIRE( other_fd >= 0 );
+	const auto pending = splicer.pending();
+	CHECK( splicer.transfer( file_fd, other_fd, 100 ).error_code().value() == ErrorCodeValues::InvalidArgument );
+	CHECK( splicer.pending() == pending );
+	CHECK( std::filesystem::file_size( path_other ) == 0u );
+
+	::close( other_fd );
+	::close( file_fd );
+	std::remove( path_other.c_str() );
+	std::remove( path.c_str() );
+#else
+	pl::Splicer splicer;
+	CHECK( !splicer.is_valid() );
+	CHECK( splicer.transfer( 0, 1, 1 ).error_code().value() == mart::nw::socks::ErrorCodeValues::NotSupported );
+#endif
+}
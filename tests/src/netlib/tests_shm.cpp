@@ -0,0 +1,215 @@
+#ifdef __linux__
+
+#include <mart-netlib/shm.hpp>
+
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string unique_name( const char* tag )
+{
+	return "/mart-netlib-test-" + std::string( tag ) + "-" + std::to_string( ::getpid() );
+}
+
+} // namespace
+
+TEST_CASE( "shm_channel_create_and_open_by_name", "[net][shm]" )
+{
+	using mart::nw::shm::Channel;
+	const auto name = unique_name( "open" );
+	Channel::unlink( name );
+
+	Channel tx = Channel::create( name, 5000 );
+	CHECK( tx.is_valid() );
+	CHECK( tx.capacity() == 8192 );
+	CHECK( tx.max_message_size() == 8192 / 2 - 4 );
+	CHECK_THROWS_AS( Channel::create( name, 4096 ), mart::nw::generic_nw_error );
+
+	Channel rx = Channel::open( name );
+	CHECK( Channel::unlink( name ) );
+	CHECK_THROWS_AS( Channel::open( name ), mart::nw::generic_nw_error );
+	CHECK( rx.capacity() == tx.capacity() );
+
+	int buffer = 0;
+	CHECK( !rx.try_recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+
+	CHECK( tx.try_send( mart::view_bytes( 42 ) ) );
+	tx.send( mart::view_bytes( 43 ) );
+
+	CHECK( rx.try_recv( mart::view_bytes_mutable( buffer ) ).size() == sizeof( buffer ) );
+	CHECK( buffer == 42 );
+	CHECK( rx.recv( mart::view_bytes_mutable( buffer ) ).size() == sizeof( buffer ) );
+	CHECK( buffer == 43 );
+	CHECK( !rx.try_recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+
+	// empty messages are valid messages
+	CHECK( tx.try_send( mart::ConstMemoryView( nullptr, 0 ) ) );
+	const auto empty = rx.try_recv( mart::view_bytes_mutable( buffer ) );
+	CHECK( empty.isValid() );
+	CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "shm_channel_open_while_it_is_being_created", "[net][shm]" )
+{
+	using mart::nw::shm::Channel;
+	const auto name = unique_name( "race" );
+
+	bool ok = true;
+	for( int i = 0; i < 100; ++i ) {
+		Channel::unlink( name );
+		Channel     tx;
+		std::thread creator( [&] { tx = Channel::create( name, 1 << 20 ); } );
+
+		// as soon as the name exists, open must succeed - even if the creator hasn't initialized the channel yet
+		int fd = -1;
+		while( ( fd = ::shm_open( name.c_str(), O_RDONLY, 0 ) ) < 0 ) {}
+		::close( fd );
+		try {
+			Channel rx = Channel::open( name );
+			ok         = ok && rx.capacity() == ( 1u << 20 );
+		} catch( const mart::nw::generic_nw_error& ) {
+			ok = false;
+		}
+		creator.join();
+	}
+	Channel::unlink( name );
+	CHECK( ok );
+
+	// a creator that never finishes the initialization
+	const int fd = ::shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+	REQUIRE( fd >= 0 );
+	const auto start = std::chrono::steady_clock::now();
+	CHECK_THROWS_AS( Channel::open( name ), mart::nw::generic_nw_error );
+	CHECK( std::chrono::steady_clock::now() - start >= 500ms );
+	::close( fd );
+	Channel::unlink( name );
+}
+
+TEST_CASE( "shm_channel_wraps_around_and_fills_up", "[net][shm]" )
+{
+	using mart::nw::shm::Channel;
+
+	Channel tx = Channel::create_anonymous( 4096 );
+	Channel rx = Channel::from_fd( ::dup( tx.native_handle() ) );
+
+	// odd sizes, so records (and the wrap marker) end up everywhere in the ring
+	std::vector<std::uint8_t> msg( 1000 );
+	std::vector<std::uint8_t> buffer( 2048 );
+	for( int i = 0; i < 200; ++i ) {
+		msg.resize( static_cast<std::size_t>( 1 + ( i * 37 ) % 1500 ) );
+		for( std::size_t k = 0; k < msg.size(); ++k ) {
+			msg[k] = static_cast<std::uint8_t>( i + k );
+		}
+		REQUIRE( tx.try_send( mart::view_elements( msg ).asBytes() ) );
+
+		const auto res = rx.try_recv( mart::view_elements_mutable( buffer ).asBytes() );
+		REQUIRE( res.size() == msg.size() );
+		CHECK( std::equal( msg.begin(), msg.end(), buffer.begin() ) );
+	}
+
+	// full ring
+	msg.resize( 1000 );
+	int sent = 0;
+	while( tx.try_send( mart::view_elements( msg ).asBytes() ) ) {
+		++sent;
+	}
+	CHECK( sent >= 3 );
+	CHECK( sent <= 4 );
+
+	tx.set_tx_timeout( 1ms );
+	CHECK_THROWS_AS( tx.send( mart::view_elements( msg ).asBytes() ), mart::nw::generic_nw_error );
+
+	// too large
+	msg.resize( tx.max_message_size() + 1 );
+	CHECK( !tx.try_send( mart::view_elements( msg ).asBytes() ) );
+
+	// messages that don't fit into the buffer are truncated
+	char small[10];
+	CHECK( rx.try_recv( mart::view_bytes_mutable( small ) ).size() == sizeof( small ) );
+
+	// after making room, sending works again
+	CHECK( tx.try_send( mart::view_bytes( small ) ) );
+}
+
+TEST_CASE( "shm_channel_peek_and_pop", "[net][shm]" )
+{
+	using mart::nw::shm::Channel;
+
+	Channel tx = Channel::create_anonymous( 4096 );
+	Channel rx = Channel::from_fd( ::dup( tx.native_handle() ) );
+
+	CHECK( !rx.try_peek().isValid() );
+	rx.pop(); // no-op
+
+	tx.send( mart::view_bytes( 1 ) );
+	tx.send( mart::view_bytes( 2 ) );
+
+	auto msg = rx.try_peek();
+	REQUIRE( msg.size() == sizeof( int ) );
+	CHECK( *reinterpret_cast<const int*>( msg.data() ) == 1 );
+	// peeking again returns the same message
+	CHECK( rx.try_peek().data() == msg.data() );
+	rx.pop();
+
+	msg = rx.try_peek();
+	REQUIRE( msg.size() == sizeof( int ) );
+	CHECK( *reinterpret_cast<const int*>( msg.data() ) == 2 );
+	rx.pop();
+	CHECK( !rx.try_peek().isValid() );
+}
+
+TEST_CASE( "shm_channel_blocking_recv_across_threads", "[net][shm]" )
+{
+	using mart::nw::shm::Channel;
+
+	Channel tx = Channel::create_anonymous( 4096 );
+	Channel rx = Channel::from_fd( ::dup( tx.native_handle() ) );
+
+	int buffer = 0;
+	rx.set_rx_timeout( 10ms );
+	const auto start = std::chrono::steady_clock::now();
+	CHECK( !rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( std::chrono::steady_clock::now() - start >= 10ms );
+
+	// more messages than fit into the ring at once - the sender has to wait for the receiver
+	constexpr int n = 10000;
+	rx.set_rx_timeout( 5s );
+	tx.set_tx_timeout( 5s );
+
+	std::thread sender( [&] {
+		for( int i = 0; i < n; ++i ) {
+			tx.send( mart::view_bytes( i ) );
+		}
+	} );
+
+	int expected = 0;
+	for( ; expected < n; ++expected ) {
+		if( !rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() || buffer != expected ) { break; }
+	}
+	sender.join();
+	CHECK( expected == n );
+
+	rx.set_busy_poll( 100us );
+	std::thread late_sender( [&] {
+		std::this_thread::sleep_for( 5ms );
+		tx.send( mart::view_bytes( 7 ) );
+	} );
+	CHECK( rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( buffer == 7 );
+	late_sender.join();
+}
+
+#endif
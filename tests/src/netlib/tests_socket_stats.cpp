@@ -0,0 +1,117 @@
+#include <mart-netlib/socket_stats.hpp>
+
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "socket_stats_latency_histogram", "[net][stats]" )
+{
+	using mart::nw::socks::LatencyHistogram;
+
+	CHECK( LatencyHistogram::bucket_index( 0 ) == 0 );
+	CHECK( LatencyHistogram::bucket_index( 1 ) == 0 );
+	CHECK( LatencyHistogram::bucket_index( 2 ) == 1 );
+	CHECK( LatencyHistogram::bucket_index( 3 ) == 1 );
+	CHECK( LatencyHistogram::bucket_index( 1024 ) == 10 );
+	CHECK( LatencyHistogram::bucket_index( ~0ull ) == LatencyHistogram::bucket_count - 1 );
+
+	LatencyHistogram h;
+	CHECK( h.percentile( 0.5 ) == 0ns );
+	for( int i = 0; i < 99; ++i ) {
+		h.record( 100ns );
+	}
+	h.record( 10us );
+	CHECK( h.count() == 100 );
+	CHECK( h.bucket( 6 ) == 99 );
+	CHECK( h.percentile( 0.5 ) == 127ns );
+	CHECK( h.percentile( 1.0 ) == 16383ns );
+}
+
+TEST_CASE( "socket_stats_counters_and_registry", "[net][stats]" )
+{
+	using namespace mart::nw::socks;
+
+	const auto registered = SocketStatsRegistry::instance().size();
+	{
+		SocketStats stats;
+		CHECK( SocketStatsRegistry::instance().size() == registered + 1 );
+
+		stats.record_tx( ErrorCode::Ok(), 100, 100, 1, 1us );
+		stats.record_tx( ErrorCode::Ok(), 100, 60, 1, 1us );
+		stats.record_rx( ErrorCode::Ok(), 50, 2, 1us );
+		stats.record_rx( ErrorCode{ ErrorCodeValues::WouldBlock }, 0, 0, 1us );
+		stats.record_tx( ErrorCode{ ErrorCodeValues::InvalidArgument }, 10, 0, 1, 1us );
+		stats.record_tx( ErrorCode{ ErrorCodeValues::InvalidArgument }, 10, 0, 1, 1us );
+
+		CHECK( stats.bytes_sent() == 160 );
+		CHECK( stats.msgs_sent() == 2 );
+		CHECK( stats.partial_sends() == 1 );
+		CHECK( stats.bytes_received() == 50 );
+		CHECK( stats.msgs_received() == 2 );
+		CHECK( stats.would_block() == 1 );
+		CHECK( stats.errors() == 2 );
+		REQUIRE( stats.error_counts().size() == 1 );
+		CHECK( stats.error_counts()[0].code == static_cast<int>( ErrorCodeValues::InvalidArgument ) );
+		CHECK( stats.error_counts()[0].count == 2 );
+		CHECK( stats.syscall_durations().count() == 6 );
+
+		std::ostringstream out;
+		SocketStatsRegistry::instance().dump( out );
+		CHECK( out.str().find( "partial_sends 1" ) != std::string::npos );
+	}
+	CHECK( SocketStatsRegistry::instance().size() == registered );
+}
+
+TEST_CASE( "socket_stats_are_collected_by_sockets", "[net][stats]" )
+{
+#ifndef MART_NETLIB_ENABLE_SOCKET_STATS
+	SUCCEED( "Socket stats are disabled (MART_NETLIB_ENABLE_SOCKET_STATS)" );
+#else
+	using namespace mart::nw::ip;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3486" };
+	udp::Socket         rx;
+	rx.bind( rx_ep );
+	udp::Socket tx;
+
+	REQUIRE( rx.stats() != nullptr );
+	const auto& rx_stats = *rx.stats();
+	const auto& tx_stats = *tx.stats();
+
+	tx.sendto( mart::view_bytes( 1 ), rx_ep );
+	tx.sendto( mart::view_bytes( 2 ), rx_ep );
+	CHECK( tx_stats.msgs_sent() == 2 );
+	CHECK( tx_stats.bytes_sent() == 2 * sizeof( int ) );
+
+	int buffer = 0;
+	CHECK( rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( rx.try_recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	rx.set_blocking( false );
+	CHECK( !rx.try_recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+
+	CHECK( rx_stats.msgs_received() == 2 );
+	CHECK( rx_stats.bytes_received() == 2 * sizeof( int ) );
+	CHECK( rx_stats.would_block() == 1 );
+	CHECK( rx_stats.syscall_durations().count() == 3 );
+
+	// a spin-then-block receive is recorded once - not once per poll
+	rx.set_blocking( true );
+	rx.set_rx_timeout( std::chrono::milliseconds( 5 ) );
+	rx.set_spin_then_block( std::chrono::microseconds( 200 ) );
+	CHECK( !rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( rx.spin_then_block_stats().timeouts == 1 );
+	CHECK( rx_stats.would_block() == 2 );
+	CHECK( rx_stats.syscall_durations().count() == 4 );
+
+	// stats move with the socket
+	udp::Socket moved = std::move( rx );
+	CHECK( moved.stats() == &rx_stats );
+	moved.close();
+	CHECK( rx_stats.handle() == mart::nw::socks::port_layer::handle_t::Invalid );
+#endif
+}
@@ -0,0 +1,154 @@
+#include <mart-netlib/spin_then_block.hpp>
+
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "spin_then_block_adapts_budget_to_inter_arrival_times", "[net][spin]" )
+{
+	using namespace mart::nw::socks;
+
+	struct FakeResult {
+		ReturnValue<txrx_size_t> result;
+	};
+
+	std::chrono::microseconds gap = 2ms;
+	int                       spin_calls = 0;
+	// with a gap, data only "arrives" in the blocking call, otherwise it is always available
+	auto recv_once = [&]( int flags ) {
+		if( flags != 0 ) {
+			++spin_calls;
+			if( gap == 0us ) { return FakeResult{ ReturnValue<txrx_size_t>( 1 ) }; }
+			return FakeResult{ ReturnValue<txrx_size_t>( ErrorCodeValues::WouldBlock ) };
+		}
+		std::this_thread::sleep_for( gap );
+		return FakeResult{ ReturnValue<txrx_size_t>( 1 ) };
+	};
+
+	SpinThenBlock spin;
+	CHECK( !spin.enabled() );
+	spin.recv( port_layer::handle_t::Invalid, recv_once );
+	CHECK( spin_calls == 0 );
+	CHECK( spin.stats().served_blocking == 0 ); // not tracked, while disabled
+
+	spin.set_max_spin( 100us );
+	CHECK( spin.stats().spin_budget == 100us );
+	for( int i = 0; i < 3; ++i ) {
+		spin.recv( port_layer::handle_t::Invalid, recv_once );
+	}
+	CHECK( spin_calls > 0 );
+	CHECK( spin.stats().served_blocking == 3 );
+	CHECK( spin.stats().served_spinning == 0 );
+	CHECK( spin.stats().mean_gap >= 2ms );
+	// messages are further apart than max_spin -> don't spin at all
+	CHECK( spin.stats().spin_budget == 0ns );
+
+	spin_calls = 0;
+	gap        = 0us;
+	for( int i = 0; i < 100; ++i ) {
+		spin.recv( port_layer::handle_t::Invalid, recv_once );
+	}
+	// only once the average gap dropped below max_spin
+	CHECK( spin_calls > 0 );
+	CHECK( spin.stats().served_spinning == static_cast<std::uint64_t>( spin_calls ) );
+	CHECK( spin.stats().served_blocking + spin.stats().served_spinning == 103 );
+	CHECK( spin.stats().mean_gap < 100us );
+	CHECK( spin.stats().spin_budget > 0ns );
+	CHECK( spin.stats().spin_budget <= 100us );
+}
+
+TEST_CASE( "spin_then_block_backs_off_after_timeouts", "[net][spin]" )
+{
+	using namespace mart::nw::socks;
+
+	struct FakeResult {
+		ReturnValue<txrx_size_t> result;
+	};
+	auto nothing = []( int ) { return FakeResult{ ReturnValue<txrx_size_t>( ErrorCodeValues::WouldBlock ) }; };
+
+	SpinThenBlock spin;
+	spin.set_max_spin( 80us );
+	spin.recv( port_layer::handle_t::Invalid, nothing );
+	CHECK( spin.stats().timeouts == 1 );
+	CHECK( spin.stats().spin_budget == 40us );
+	spin.recv( port_layer::handle_t::Invalid, nothing );
+	CHECK( spin.stats().spin_budget == 20us );
+}
+
+TEST_CASE( "udp_socket_spin_then_block_receive", "[net][udp][spin]" )
+{
+	using namespace mart::nw::ip;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3487" };
+	udp::Socket         rx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 10ms );
+	udp::Socket tx;
+
+	CHECK( !rx.wait_readable( 1ms ) );
+	rx.set_spin_then_block( 50us );
+
+	tx.sendto( mart::view_bytes( 1 ), rx_ep );
+	tx.sendto( mart::view_bytes( 2 ), rx_ep );
+	CHECK( rx.wait_readable( -1us ) );
+
+	int buffer = 0;
+	CHECK( rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( buffer == 1 );
+	CHECK( rx.recvfrom( mart::view_bytes_mutable( buffer ) ).data.isValid() );
+	CHECK( buffer == 2 );
+	CHECK( rx.spin_then_block_stats().served_spinning == 2 );
+
+	// spins, then blocks until the rx timeout
+	CHECK( !rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( rx.spin_then_block_stats().timeouts == 1 );
+
+	std::thread sender( [&] {
+		std::this_thread::sleep_for( 2ms );
+		tx.sendto( mart::view_bytes( 3 ), rx_ep );
+	} );
+	rx.set_rx_timeout( 1s );
+	CHECK( rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( buffer == 3 );
+	sender.join();
+
+	const auto& stats = rx.spin_then_block_stats();
+	CHECK( stats.served_spinning + stats.served_blocking == 3 );
+	CHECK( stats.spin_budget <= 50us );
+
+	// a non-blocking socket doesn't spin at all
+	rx.set_spin_then_block( 1s );
+	rx.set_blocking( false );
+	const auto start = std::chrono::steady_clock::now();
+	CHECK( !rx.recv( mart::view_bytes_mutable( buffer ) ).isValid() );
+	CHECK( std::chrono::steady_clock::now() - start < 500ms );
+	CHECK( stats.timeouts == 1 );
+}
+
+TEST_CASE( "tcp_socket_spin_then_block_receive", "[net][tcp][spin]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3488" };
+
+	tcp::Acceptor acceptor( server_ep );
+	tcp::Socket   client;
+	client.connect( server_ep );
+	tcp::Socket server = acceptor.accept();
+	server.set_spin_then_block( 50us );
+
+	client.send( mart::view_bytes( 42 ) );
+	int buffer = 0;
+	CHECK( server.recv( mart::view_bytes_mutable( buffer ) ).size() == sizeof( buffer ) );
+	CHECK( buffer == 42 );
+	CHECK( server.spin_then_block_stats().served_spinning == 1 );
+
+	// orderly shutdown is reported as an empty (successful) receive
+	client.close();
+	CHECK( server.recv( mart::view_bytes_mutable( buffer ) ).size() == 0 );
+	CHECK( server.spin_then_block_stats().timeouts == 0 );
+}
@@ -4,8 +4,11 @@
 
 #include <catch2/catch.hpp>
 
+#include <array>
 #include <future>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 
 namespace mart::nw::ip::tcp {
@@ -76,4 +79,225 @@ TEST_CASE( "tcp_simple_exchange", "[net]" )
 	CHECK( rec.size_inBytes() == sizeof( int ) );
 	CHECK( data_orig == data_rec );
 
-}
\ No newline at end of file
+}
+
+TEST_CASE( "tcp_zerocopy_send", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3468" };
+	tcp::Acceptor       acceptor( server_ep );
+
+	constexpr std::size_t      chunk_size = 256 * 1024;
+	constexpr std::size_t      chunks     = 4;
+	std::vector<unsigned char> data( chunk_size * chunks );
+	for( std::size_t i = 0; i < data.size(); ++i ) {
+		data[i] = static_cast<unsigned char>( i * 7 );
+	}
+
+	auto received_future = std::async( std::launch::async, [&] {
+		auto                       con = acceptor.accept( std::chrono::milliseconds( 2000 ) );
+		std::vector<unsigned char> received( data.size() );
+		std::size_t                total = 0;
+		while( total < received.size() ) {
+			auto rec = con.recv( mart::MemoryView( received.data() + total, received.size() - total ) );
+			if( !rec.isValid() || rec.size() == 0 ) { break; }
+			total += rec.size();
+		}
+		received.resize( total );
+		return received;
+	} );
+
+	auto client = tcp::connect( server_ep );
+	// only fails on platforms without MSG_ZEROCOPY - send_zerocopy has to work either way
+	[[maybe_unused]] const bool zerocopy = client.try_enable_zerocopy();
+
+	tcp::Socket::ZerocopyId last{};
+	for( std::size_t i = 0; i < chunks; ++i ) {
+		last = client.send_zerocopy( mart::ConstMemoryView( data.data() + i * chunk_size, chunk_size ) );
+	}
+	CHECK( client.wait_zerocopy_completion( last, std::chrono::milliseconds( 2000 ) ) );
+	CHECK( client.zerocopy_completed( last ) );
+	CHECK( client.zerocopy_pending() == 0 );
+
+	client.close();
+	CHECK( received_future.get() == data );
+}
+
+TEST_CASE( "tcp_scatter_gather", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3470" };
+	tcp::Acceptor       acceptor( server_ep );
+
+	const std::uint32_t        header = 0x01020304;
+	std::vector<unsigned char> payload( 4 * 1024 * 1024 ); // large enough to (usually) cause partial writes
+	for( std::size_t i = 0; i < payload.size(); ++i ) {
+		payload[i] = static_cast<unsigned char>( i * 13 );
+	}
+
+	auto received_future = std::async( std::launch::async, [&] {
+		auto                       con = acceptor.accept( std::chrono::milliseconds( 2000 ) );
+		std::uint32_t              rx_header{};
+		std::vector<unsigned char> rx_payload( payload.size() + 1 );
+
+		const std::array<mart::MemoryView, 2> views{ mart::view_bytes_mutable( rx_header ),
+													 mart::MemoryView( rx_payload.data(), rx_payload.size() ) };
+		// the first read has to start with the header
+		auto rec = con.recv( views );
+		REQUIRE( rec.has_value() );
+		REQUIRE( *rec >= sizeof( rx_header ) );
+		std::size_t total = *rec - sizeof( rx_header );
+		while( total < rx_payload.size() ) {
+			auto data = con.recv( mart::MemoryView( rx_payload.data() + total, rx_payload.size() - total ) );
+			if( !data.isValid() || data.size() == 0 ) { break; }
+			total += data.size();
+		}
+		rx_payload.resize( total );
+		return std::make_pair( rx_header, rx_payload );
+	} );
+
+	auto client = tcp::connect( server_ep );
+
+	const std::array<mart::ConstMemoryView, 2> views{ mart::view_bytes( header ),
+													  mart::ConstMemoryView( payload.data(), payload.size() ) };
+	client.send( views );
+	client.close();
+
+	const auto received = received_future.get();
+	CHECK( received.first == header );
+	CHECK( received.second == payload );
+}
+
+TEST_CASE( "consume_front_across_buffer_boundaries", "[net]" )
+{
+	std::array<unsigned char, 3> b1{};
+	std::array<unsigned char, 4> b2{};
+	std::array<unsigned char, 5> b3{};
+
+	std::array<mart::ConstMemoryView, 3> views{ mart::ConstMemoryView( b1.data(), b1.size() ),
+												mart::ConstMemoryView( b2.data(), b2.size() ),
+												mart::ConstMemoryView( b3.data(), b3.size() ) };
+
+	auto rest = mart::nw::socks::consume_front( mart::ArrayView<mart::ConstMemoryView>( views ), 5 );
+	REQUIRE( rest.size() == 2 );
+	CHECK( rest[0].data() == b2.data() + 2 );
+	CHECK( rest[0].size() == 2 );
+	CHECK( rest[1].size() == 5 );
+
+	rest = mart::nw::socks::consume_front( rest, 2 );
+	REQUIRE( rest.size() == 1 );
+	CHECK( rest[0].data() == b3.data() );
+
+	CHECK( mart::nw::socks::consume_front( rest, 5 ).empty() );
+}
+
+TEST_CASE( "tcp_kernel_rx_timestamps", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+	const tcp::endpoint server_ep{ "127.0.0.1:3476" };
+	tcp::Acceptor       acceptor( server_ep );
+
+	auto server_future
+		= std::async( std::launch::async, [&] { return acceptor.accept( std::chrono::milliseconds( 2000 ) ); } );
+	auto client = tcp::connect( server_ep );
+	auto server = server_future.get();
+
+	if( !server.try_enable_rx_timestamps() ) { return; } // not supported on this platform
+	// the kernel switches timestamping on asynchronously - packets arriving right after this may not get one
+	std::this_thread::sleep_for( 50ms );
+
+	const auto before = std::chrono::system_clock::now();
+	client.send( mart::view_bytes( 5 ) );
+	std::this_thread::sleep_for( 20ms );
+
+	int        value = 0;
+	const auto res   = server.recv_timestamped( mart::view_bytes_mutable( value ) );
+	CHECK( res.data.size() == sizeof( int ) );
+	CHECK( value == 5 );
+	CHECK( res.rx_timestamp >= before );
+	CHECK( res.rx_timestamp <= std::chrono::system_clock::now() - 15ms );
+
+	// close the client side first, such that the server port doesn't end up in TIME_WAIT
+	client.close();
+}
+
+TEST_CASE( "tcp_acceptor_accept_all", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3482" };
+	tcp::Acceptor       acceptor( server_ep );
+
+	// nothing pending
+	CHECK( !acceptor.try_accept().is_valid() );
+
+	constexpr std::size_t    n = 5;
+	std::vector<tcp::Socket> clients;
+	for( std::size_t i = 0; i < n; ++i ) {
+		clients.push_back( tcp::connect( server_ep ) );
+	}
+
+	std::vector<tcp::Socket> connections;
+	// connections may need a moment to show up in the backlog
+	for( int i = 0; i < 100 && connections.size() < n; ++i ) {
+		acceptor.accept_all( connections, tcp::Acceptor::SocketMode::NonBlocking );
+		if( connections.size() < n ) { std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) ); }
+	}
+	REQUIRE( connections.size() == n );
+	const auto res = acceptor.accept_all( connections );
+	CHECK( res.accepted == 0 );
+	CHECK( res.drained() );
+
+	// a timeout that was changed through the raw socket doesn't hide behind the cached one
+	CHECK( !acceptor.accept( std::chrono::milliseconds( 20 ) ).is_valid() );
+	acceptor.getSocket().set_rx_timeout( std::chrono::seconds( 5 ) );
+	const auto start = std::chrono::steady_clock::now();
+	CHECK( !acceptor.accept( std::chrono::milliseconds( 20 ) ).is_valid() );
+	CHECK( std::chrono::steady_clock::now() - start < std::chrono::seconds( 2 ) );
+
+	for( std::size_t i = 0; i < n; ++i ) {
+		CHECK( connections[i].is_valid() );
+		CHECK( !connections[i].is_blocking() );
+		CHECK( connections[i].get_local_endpoint() == server_ep );
+		CHECK( connections[i].get_remote_endpoint() == clients[i].get_local_endpoint() );
+	}
+
+	clients[0].send( mart::view_bytes( 42 ) );
+	int value = 0;
+	for( int i = 0; i < 100 && value == 0; ++i ) {
+		if( !connections[0].recv( mart::view_bytes_mutable( value ) ).isValid() ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+		}
+	}
+	CHECK( value == 42 );
+
+	// client closes first, so the server side doesn't end up in TIME_WAIT
+	clients.clear();
+}
+
+TEST_CASE( "tcp_acceptor_resolves_port_0", "[net]" )
+{
+	using namespace mart::nw::ip;
+	tcp::Acceptor acceptor( tcp::endpoint{ "127.0.0.1:0" } );
+	const auto    server_ep = acceptor.getLocalEndpoint();
+	REQUIRE( server_ep.port.inHostOrder() != 0 );
+
+	auto client = tcp::connect( server_ep );
+	auto con    = acceptor.accept( std::chrono::milliseconds( 1000 ) );
+	REQUIRE( con.is_valid() );
+	CHECK( con.is_blocking() );
+	CHECK( con.get_local_endpoint() == server_ep );
+	CHECK( con.get_remote_endpoint() == client.get_local_endpoint() );
+}
+
+TEST_CASE( "tcp_moved_from_socket_is_invalid", "[net]" )
+{
+	using namespace mart::nw::ip;
+	tcp::Socket s1;
+	REQUIRE( s1.is_valid() );
+	const auto handle = s1.get_raw_socket_handle();
+
+	tcp::Socket s2( std::move( s1 ) );
+	CHECK( !s1.is_valid() );
+	CHECK( s2.get_raw_socket_handle() == handle );
+}
@@ -0,0 +1,112 @@
+#include <mart-netlib/tcp_acceptor_pool.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined( __linux__ )
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+TEST_CASE( "tcp_acceptor_pool_accepts_on_all_workers", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	tcp::AcceptorPool::Config config;
+	config.local        = tcp::endpoint{ "127.0.0.1:0" };
+	config.worker_count = 4;
+	config.socket_mode  = tcp::Acceptor::SocketMode::NonBlocking;
+	config.stop_latency = 10ms;
+
+	std::mutex               mutex;
+	std::vector<tcp::Socket> connections;
+	std::atomic<int>         invalid{ 0 };
+
+	tcp::AcceptorPool pool( config, [&]( std::size_t worker, tcp::Socket connection ) {
+		if( worker >= 4 || !connection.is_valid() || connection.is_blocking() ) { invalid++; }
+		std::lock_guard<std::mutex> lock( mutex );
+		connections.push_back( std::move( connection ) );
+	} );
+	REQUIRE( pool.worker_count() == 4 );
+	REQUIRE( pool.local_endpoint().port.inHostOrder() != 0 );
+
+	constexpr std::size_t    n = 32;
+	std::vector<tcp::Socket> clients;
+	for( std::size_t i = 0; i < n; ++i ) {
+		clients.push_back( tcp::connect( pool.local_endpoint() ) );
+	}
+	for( int i = 0; i < 200 && pool.accepted() < n; ++i ) {
+		std::this_thread::sleep_for( 10ms );
+	}
+	CHECK( pool.accepted() == n );
+	CHECK( invalid == 0 );
+
+	// client closes first, so the server side doesn't end up in TIME_WAIT
+	clients.clear();
+	pool.stop();
+
+	std::lock_guard<std::mutex> lock( mutex );
+	CHECK( connections.size() == n );
+
+	// the kernel distributes by source port, so with 32 connections, more than one worker should have been used
+	std::size_t used_workers = 0;
+	for( std::size_t i = 0; i < pool.worker_count(); ++i ) {
+		used_workers += pool.accepted( i ) != 0 ? 1 : 0;
+	}
+	CHECK( used_workers > 1 );
+}
+
+#if defined( __linux__ )
+TEST_CASE( "tcp_acceptor_pool_backs_off_if_the_process_runs_out_of_file_descriptors", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	tcp::AcceptorPool::Config config;
+	config.local        = tcp::endpoint{ "127.0.0.1:0" };
+	config.worker_count = 1;
+	config.stop_latency = 10ms;
+
+	std::atomic<int> handled{ 0 };
+	tcp::AcceptorPool pool( config, [&]( std::size_t, tcp::Socket ) { handled++; } );
+	CHECK( pool.error( 0 ).value() == mart::nw::socks::ErrorCodeValues::NoError );
+	CHECK( pool.error( 1 ).value() == mart::nw::socks::ErrorCodeValues::InvalidArgument );
+
+	tcp::Socket client;
+
+	// only the descriptors that are currently open are allowed -> accept fails with EMFILE
+	const int lowest_free = ::dup( 0 );
+	REQUIRE( lowest_free >= 0 );
+	::close( lowest_free );
+	::rlimit old_limit{};
+	REQUIRE( ::getrlimit( RLIMIT_NOFILE, &old_limit ) == 0 );
+	::rlimit limit = old_limit;
+	limit.rlim_cur = static_cast<::rlim_t>( lowest_free );
+	REQUIRE( ::setrlimit( RLIMIT_NOFILE, &limit ) == 0 );
+
+	client.connect( pool.local_endpoint() );
+	for( int i = 0; i < 200 && pool.resource_errors() < 2; ++i ) {
+		std::this_thread::sleep_for( 10ms );
+	}
+	::setrlimit( RLIMIT_NOFILE, &old_limit );
+
+	CHECK( pool.resource_errors() >= 2 );
+	CHECK( pool.resource_errors( 0 ) == pool.resource_errors() );
+	CHECK( pool.failed_workers() == 0 );
+
+	// the connection stayed in the backlog
+	for( int i = 0; i < 200 && pool.accepted() < 1; ++i ) {
+		std::this_thread::sleep_for( 10ms );
+	}
+	CHECK( pool.accepted() == 1 );
+	CHECK( pool.failed_workers() == 0 );
+	pool.stop();
+	CHECK( handled == 1 );
+}
+#endif
@@ -0,0 +1,113 @@
+#include <mart-netlib/tcp_framing.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "./test_data.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE( "tcp_framing_exchanges_small_and_large_frames", "[net][tcp]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3483" };
+
+	tcp::Acceptor acceptor( server_ep );
+	tcp::Socket   client;
+	client.connect( server_ep );
+	tcp::Socket server = acceptor.accept();
+
+	// sizes around the buffer / threshold sizes, including empty frames and frames larger than the read buffer
+	const std::vector<std::size_t> sizes = { 0, 1, 10, 100, 1000, 0, 4000, 4096, 10000, 3, 100000, 7, 0, 50 };
+
+	std::thread sender( [&] {
+		tcp::FramedWriter writer( client, 1024 );
+		for( int round = 0; round < 10; ++round ) {
+			for( std::size_t i = 0; i < sizes.size(); ++i ) {
+				writer.write( mart::view_elements( make_payload( sizes[i], round + static_cast<int>( i ) ) ) );
+			}
+		}
+		writer.flush();
+		CHECK( writer.buffered_bytes() == 0 );
+		client.close();
+	} );
+
+	tcp::FramedReader reader( server, 4096 );
+	bool              all_correct = true;
+	for( int round = 0; round < 10; ++round ) {
+		for( std::size_t i = 0; i < sizes.size(); ++i ) {
+			const auto frame = reader.read();
+			REQUIRE( frame.has_value() );
+
+			const auto expected = make_payload( sizes[i], round + static_cast<int>( i ) );
+			all_correct         = all_correct && frame->size() == expected.size()
+						  && std::equal( frame->begin(), frame->end(), expected.begin() );
+		}
+	}
+	CHECK( all_correct );
+
+	sender.join();
+	CHECK( !reader.read().has_value() );
+	CHECK( reader.is_closed() );
+}
+
+TEST_CASE( "tcp_framing_reader_handles_partial_and_invalid_frames", "[net][tcp]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+	const tcp::endpoint server_ep{ "127.0.0.1:3484" };
+
+	tcp::Acceptor acceptor( server_ep );
+	tcp::Socket   client;
+	client.connect( server_ep );
+	tcp::Socket server = acceptor.accept();
+	server.set_rx_timeout( 10ms );
+
+	tcp::FramedReader reader( server, 64, 1000 );
+	CHECK( !reader.read().has_value() );
+	CHECK( !reader.is_closed() );
+
+	// a frame, followed by the first half of another one
+	const std::uint8_t data[] = { 0, 0, 0, 2, 'a', 'b', 0, 0, 0, 3, 'c' };
+	client.send( mart::view_bytes( data ) );
+
+	auto frame = reader.read();
+	REQUIRE( frame.has_value() );
+	CHECK( frame->size() == 2 );
+	CHECK( !reader.try_read_buffered().has_value() );
+	CHECK( !reader.read().has_value() ); // times out, but keeps the partial frame
+	CHECK( reader.buffered_bytes() == 5 );
+
+	const std::uint8_t rest[] = { 'd', 'e' };
+	client.send( mart::view_bytes( rest ) );
+	frame = reader.read();
+	REQUIRE( frame.has_value() );
+	CHECK( frame->size() == 3 );
+	CHECK( static_cast<char>( ( *frame )[2] ) == 'e' );
+
+	// too large
+	const std::uint8_t huge[] = { 0, 1, 0, 0 };
+	client.send( mart::view_bytes( huge ) );
+	CHECK_THROWS_AS( reader.read(), mart::nw::generic_nw_error );
+	client.close();
+}
+
+TEST_CASE( "tcp_framing_reader_throws_on_close_within_frame", "[net][tcp]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint server_ep{ "127.0.0.1:3485" };
+
+	tcp::Acceptor acceptor( server_ep );
+	tcp::Socket   client;
+	client.connect( server_ep );
+	tcp::Socket server = acceptor.accept();
+
+	const std::uint8_t data[] = { 0, 0, 0, 10, 'a' };
+	client.send( mart::view_bytes( data ) );
+	client.close();
+
+	tcp::FramedReader reader( server );
+	CHECK_THROWS_AS( reader.read(), mart::nw::generic_nw_error );
+	CHECK( reader.is_closed() );
+}
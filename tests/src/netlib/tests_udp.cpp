@@ -1,9 +1,18 @@
+#include <mart-netlib/network_exceptions.hpp>
 #include <mart-netlib/udp.hpp>
 
 #include <mart-common/PrintWrappers.h>
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
 TEST_CASE( "udp_socket_simple_member_check1", "[net]" )
 {
 	using namespace mart::nw::ip;
@@ -99,3 +108,289 @@ TEST_CASE( "invalid_endpoint_strings_fail" )
 	CHECK_THROWS( udp::endpoint{"127.0.0.1:66999"} );
 	CHECK_THROWS( udp::endpoint{"1.333.0.1:669"} );
 }
+
+TEST_CASE( "udp_socket_batch_send_and_receive", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3447" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3448" };
+
+	udp::Socket rx;
+	udp::Socket tx;
+	rx.bind( rx_ep );
+	tx.bind( tx_ep );
+	rx.set_rx_timeout( 100ms );
+
+	const std::array<int, 3>                    values{ 1, 2, 3 };
+	const std::array<mart::ConstMemoryView, 3> data{
+		mart::view_bytes( values[0] ), mart::view_bytes( values[1] ), mart::view_bytes( values[2] ) };
+	const std::array<udp::endpoint, 3> eps{ rx_ep, rx_ep, rx_ep };
+
+	// number of endpoints has to match the number of messages
+	CHECK( !tx.try_send_batch( data, mart::ArrayView<const udp::endpoint>( eps.data(), 2 ) ).success() );
+
+	CHECK_NOTHROW( tx.send_batch( data, eps ) );
+
+	std::array<int, 4>              rx_values{};
+	std::array<mart::MemoryView, 4> buffers{ mart::view_bytes_mutable( rx_values[0] ),
+											 mart::view_bytes_mutable( rx_values[1] ),
+											 mart::view_bytes_mutable( rx_values[2] ),
+											 mart::view_bytes_mutable( rx_values[3] ) };
+	std::array<udp::Socket::RecvfromResult, 4> results{};
+
+	std::size_t received = 0;
+	while( received < 3 ) {
+		const auto cnt = rx.recv_batch( mart::ArrayView<const mart::MemoryView>( buffers ).subview( received ),
+										mart::ArrayView<udp::Socket::RecvfromResult>( results ).subview( received ) );
+		REQUIRE( cnt != 0 );
+		received += cnt;
+	}
+	CHECK( received == 3 );
+	for( std::size_t i = 0; i < 3; ++i ) {
+		CHECK( results[i].data.size() == sizeof( int ) );
+		CHECK( results[i].remote_address == tx_ep );
+		CHECK( rx_values[i] == values[i] );
+	}
+
+	// nothing left
+	CHECK( rx.recv_batch( buffers, results ) == 0 );
+}
+
+TEST_CASE( "udp_socket_segmented_send_and_coalesced_receive", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3449" };
+
+	udp::Socket rx;
+	udp::Socket tx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 100ms );
+	// both are optional - if not supported, the data is just sent / received as individual datagrams
+	[[maybe_unused]] const bool gro = rx.try_enable_gro();
+	[[maybe_unused]] const bool gso = tx.supports_segmentation_offload();
+
+	constexpr std::size_t segment_size = 1000;
+
+	std::vector<mart::ByteType> tx_data( 10 * segment_size + 500 );
+	for( std::size_t i = 0; i < tx_data.size(); ++i ) {
+		tx_data[i] = static_cast<mart::ByteType>( i % 251 );
+	}
+
+	CHECK( !tx.try_send_segmented( mart::ConstMemoryView( tx_data.data(), tx_data.size() ), 0, rx_ep ).success() );
+	CHECK_NOTHROW( tx.send_segmented( mart::ConstMemoryView( tx_data.data(), tx_data.size() ), segment_size, rx_ep ) );
+
+	std::vector<mart::ByteType> rx_buffer( 64 * 1024 );
+	std::vector<mart::ByteType> rx_data;
+	std::size_t                 datagrams = 0;
+	while( rx_data.size() < tx_data.size() ) {
+		const auto res = rx.recv_coalesced( mart::MemoryView( rx_buffer.data(), rx_buffer.size() ) );
+		REQUIRE( res.data.size() != 0 );
+		CHECK( res.segment_size == std::min( segment_size, res.data.size() ) );
+		for( std::size_t i = 0; i < res.segment_count(); ++i ) {
+			const auto segment = res.segment( i );
+			CHECK( segment.size() <= segment_size );
+			rx_data.insert( rx_data.end(), segment.begin(), segment.end() );
+			datagrams++;
+		}
+	}
+	CHECK( datagrams == 11 );
+	CHECK( rx_data == tx_data );
+}
+
+#if defined( __linux__ )
+TEST_CASE( "udp_socket_segmented_send_reports_pending_errors", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	// nobody listens on that port -> the first datagram results in an icmp port unreachable
+	const udp::endpoint closed_ep{ "127.0.0.1:3451" };
+
+	udp::Socket tx;
+	tx.connect( closed_ep );
+	CHECK( tx.try_send( mart::view_bytes( 42 ) ) );
+	std::this_thread::sleep_for( 10ms );
+
+	const std::vector<mart::ByteType> tx_data( 4000 );
+	const auto res = tx.try_send_segmented( mart::ConstMemoryView( tx_data.data(), tx_data.size() ), 1000 );
+	REQUIRE( !res.success() );
+	CHECK( res.error_code().raw_value() == ECONNREFUSED );
+}
+#endif
+
+TEST_CASE( "udp_socket_scatter_gather", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3469" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3471" };
+
+	udp::Socket rx;
+	udp::Socket tx;
+	rx.bind( rx_ep );
+	tx.bind( tx_ep );
+	rx.set_rx_timeout( 100ms );
+
+	const std::uint32_t                 header = 0xa1b2c3d4;
+	const std::array<mart::ByteType, 5> payload{ 1, 2, 3, 4, 5 };
+
+	const std::array<mart::ConstMemoryView, 2> tx_views{ mart::view_bytes( header ),
+														 mart::ConstMemoryView( payload.data(), payload.size() ) };
+	CHECK( tx.try_sendto( tx_views, rx_ep ) );
+	CHECK_NOTHROW( tx.sendto( tx_views, rx_ep ) );
+
+	std::uint32_t                         rx_header = 0;
+	std::array<mart::ByteType, 16>        rx_payload{};
+	const std::array<mart::MemoryView, 2> rx_views{ mart::view_bytes_mutable( rx_header ),
+													mart::MemoryView( rx_payload.data(), rx_payload.size() ) };
+
+	const auto res = rx.recvfrom( rx_views );
+	CHECK( res.size == sizeof( header ) + payload.size() );
+	CHECK( res.remote_address == tx_ep );
+	CHECK( rx_header == header );
+	CHECK( std::equal( payload.begin(), payload.end(), rx_payload.begin() ) );
+
+	rx_header = 0;
+	CHECK( rx.recv( rx_views ) == sizeof( header ) + payload.size() );
+	CHECK( rx_header == header );
+
+	// nothing left
+	CHECK( rx.recvfrom( rx_views ).size == 0 );
+	CHECK( rx.recv( rx_views ) == 0 );
+}
+
+TEST_CASE( "udp_socket_recv_pooled", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3472" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3473" };
+
+	udp::Socket rx;
+	udp::Socket tx;
+	rx.bind( rx_ep );
+	tx.bind( tx_ep );
+	rx.set_rx_timeout( 100ms );
+
+	udp::Socket::PacketPool pool( 64, 2 );
+	for( int i = 0; i < 3; ++i ) {
+		tx.sendto( mart::view_bytes( i ), rx_ep );
+	}
+
+	const auto before = std::chrono::system_clock::now();
+	auto       p1     = rx.recv_pooled( pool );
+	auto       p2     = rx.try_recv_pooled( pool );
+	REQUIRE( p1 );
+	REQUIRE( p2 );
+	CHECK( p1.size() == sizeof( int ) );
+	CHECK( p1.source() == tx_ep );
+	CHECK( p1.rx_time() >= before );
+
+	// pool is exhausted - the datagram has to stay in the socket
+	mart::nw::socks::ErrorCode error{};
+	CHECK( !rx.try_recv_pooled( pool, &error ) );
+	CHECK( error.value() == mart::nw::socks::ErrorCodeValues::NoBufferSpace );
+	CHECK_THROWS_AS( rx.recv_pooled( pool ), mart::nw::generic_nw_error );
+
+	// handing the packet to another thread doesn't copy the data
+	const auto* data = p1.data().data();
+	auto        fut  = std::async( std::launch::async, [p = std::move( p1 )]() mutable {
+		const auto packet = std::move( p ); // released before the result becomes ready
+		int        value  = -1;
+		std::memcpy( &value, packet.data().data(), sizeof( value ) );
+		return std::make_pair( packet.data().data(), value );
+	} );
+	const auto res = fut.get();
+	CHECK( res.first == data );
+	CHECK( res.second == 0 );
+	CHECK( pool.available() == 1 );
+
+	auto p3 = rx.recv_pooled( pool );
+	REQUIRE( p3 );
+	int value = -1;
+	std::memcpy( &value, p3.data().data(), sizeof( value ) );
+	CHECK( value == 2 );
+
+	p2.reset();
+	p3.reset();
+	CHECK( pool.available() == 2 );
+	// nothing left
+	CHECK( !rx.recv_pooled( pool ) );
+	CHECK( !rx.try_recv_pooled( pool, &error ) );
+	CHECK( error.value() != mart::nw::socks::ErrorCodeValues::NoBufferSpace );
+	CHECK( pool.available() == 2 );
+
+	// datagrams larger than a slab are reported instead of being cut off silently
+	const std::array<mart::ByteType, 100> large{};
+	tx.sendto( mart::view_elements( large ), rx_ep );
+	tx.sendto( mart::view_elements( large ), rx_ep );
+	CHECK( !rx.try_recv_pooled( pool, &error ) );
+	CHECK( error.value() == mart::nw::socks::ErrorCodeValues::MessageSize );
+	CHECK_THROWS_AS( rx.recv_pooled( pool ), mart::nw::generic_nw_error );
+	CHECK( pool.available() == 2 );
+}
+
+TEST_CASE( "udp_socket_kernel_rx_timestamps", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3474" };
+
+	udp::Socket rx;
+	udp::Socket tx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 100ms );
+	CHECK( !rx.rx_timestamps_enabled() );
+
+	std::array<mart::ByteType, 16> buffer{};
+	const auto                     before = std::chrono::system_clock::now();
+
+	tx.sendto( mart::view_bytes( 1 ), rx_ep );
+	// without timestamps enabled, none is reported
+	CHECK( rx.recvfrom( buffer ).rx_timestamp == std::chrono::system_clock::time_point{} );
+
+	if( !rx.try_enable_rx_timestamps() ) { return; } // not supported on this platform
+	CHECK( rx.rx_timestamps_enabled() );
+	// the kernel switches timestamping on asynchronously - packets arriving right after this may not get one
+	std::this_thread::sleep_for( 50ms );
+
+	tx.sendto( mart::view_bytes( 2 ), rx_ep );
+	std::this_thread::sleep_for( 20ms );
+	const auto res   = rx.recvfrom( buffer );
+	const auto after = std::chrono::system_clock::now();
+	CHECK( res.data.size() == sizeof( int ) );
+	CHECK( res.rx_timestamp >= before );
+	// the datagram was timestamped on arrival, not when it was read
+	CHECK( res.rx_timestamp <= after - 15ms );
+
+	tx.sendto( mart::view_bytes( 3 ), rx_ep );
+	udp::Socket::PacketPool pool( 64, 1 );
+	std::this_thread::sleep_for( 20ms );
+	const auto packet = rx.recv_pooled( pool );
+	REQUIRE( packet );
+	CHECK( packet.rx_time() <= std::chrono::system_clock::now() - 15ms );
+
+	// recv_batch reports the arrival time of each datagram
+	tx.sendto( mart::view_bytes( 5 ), rx_ep );
+	std::this_thread::sleep_for( 10ms );
+	tx.sendto( mart::view_bytes( 6 ), rx_ep );
+	std::this_thread::sleep_for( 10ms );
+	std::array<mart::ByteType, 32>             batch_storage{};
+	const auto                                 batch_view = mart::view_elements_mutable( batch_storage );
+	const std::array<mart::MemoryView, 2>      batch_buffers{ batch_view.subview( 0, 16 ), batch_view.subview( 16 ) };
+	std::array<udp::Socket::RecvfromResult, 2> batch_results{};
+	REQUIRE( rx.recv_batch( batch_buffers, batch_results ) == 2 );
+	CHECK( batch_results[0].rx_timestamp >= before );
+	CHECK( batch_results[1].rx_timestamp - batch_results[0].rx_timestamp >= 8ms );
+
+	CHECK( rx.try_enable_rx_timestamps( false ) );
+	tx.sendto( mart::view_bytes( 4 ), rx_ep );
+	CHECK( rx.try_recvfrom( buffer ).rx_timestamp == std::chrono::system_clock::time_point{} );
+}
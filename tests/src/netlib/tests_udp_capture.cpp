@@ -0,0 +1,77 @@
+#include <mart-netlib/udp_capture.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "./test_data.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+TEST_CASE( "udp_capture_records_survive_write_and_read", "[net][udp][capture]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const auto path = temp_file( "mart_netlib_test_capture_roundtrip.bin" );
+	const auto t0   = std::chrono::system_clock::time_point( 1'600'000'000'123'456'789ns );
+
+	// sizes around the (minimal) buffer size, such that records straddle the buffer boundaries
+	const std::vector<std::size_t> sizes = { 0, 1, 100, 65535, 3, 60000, 1500, 0, 65535, 17 };
+	{
+		udp::CaptureWriter writer( path, 1 );
+		for( std::size_t i = 0; i < sizes.size(); ++i ) {
+			const auto payload = make_payload( sizes[i], static_cast<int>( i ) );
+			writer.write( t0 + i * 1ms,
+						  udp::endpoint( "10.0.0.1", static_cast<std::uint16_t>( 1000 + i ) ),
+						  mart::view_elements( payload ) );
+		}
+		CHECK( writer.record_count() == sizes.size() );
+		CHECK_THROWS_AS( writer.write( t0, udp::endpoint{}, mart::view_elements( make_payload( 70000, 0 ) ) ),
+						 mart::nw::generic_nw_error );
+	}
+
+	udp::CaptureReader reader( path, 1 );
+	bool               all_correct = true;
+	for( std::size_t i = 0; i < sizes.size(); ++i ) {
+		const auto record = reader.read();
+		REQUIRE( record.has_value() );
+
+		const auto expected = make_payload( sizes[i], static_cast<int>( i ) );
+		all_correct         = all_correct && record->rx_time == t0 + i * 1ms
+					  && record->source == udp::endpoint( "10.0.0.1", static_cast<std::uint16_t>( 1000 + i ) )
+					  && record->data.size() == expected.size()
+					  && std::equal( record->data.begin(), record->data.end(), expected.begin() );
+	}
+	CHECK( all_correct );
+	CHECK( !reader.read().has_value() );
+
+	std::remove( path.c_str() );
+}
+
+TEST_CASE( "udp_capture_reader_rejects_invalid_files", "[net][udp][capture]" )
+{
+	using namespace mart::nw::ip;
+
+	const auto path = temp_file( "mart_netlib_test_capture_invalid.bin" );
+	CHECK_THROWS_AS( udp::CaptureReader( temp_file( "mart_netlib_test_capture_missing.bin" ) ),
+					 mart::nw::generic_nw_error );
+
+	{
+		std::ofstream file( path, std::ios::binary );
+		file << "definitely not a capture file";
+	}
+	CHECK_THROWS_AS( udp::CaptureReader( path ), mart::nw::generic_nw_error );
+
+	// truncated in the middle of the payload
+	{
+		udp::CaptureWriter writer( path );
+		writer.write( std::chrono::system_clock::now(), udp::endpoint( "127.0.0.1:1234" ), mart::view_bytes( 42 ) );
+	}
+	std::filesystem::resize_file( path, std::filesystem::file_size( path ) - 1 );
+	udp::CaptureReader reader( path );
+	CHECK_THROWS_AS( reader.read(), mart::nw::generic_nw_error );
+
+	std::remove( path.c_str() );
+}
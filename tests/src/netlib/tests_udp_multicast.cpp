@@ -0,0 +1,109 @@
+#include <mart-netlib/network_exceptions.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+TEST_CASE( "ip_multicast_group_helpers", "[net][ip][multicast]" )
+{
+	using namespace mart::nw::ip;
+
+	CHECK( is_multicast( address_v4( "224.0.0.1" ) ) );
+	CHECK( is_multicast( address_v4( "239.255.255.255" ) ) );
+	CHECK( !is_multicast( address_v4( "223.255.255.255" ) ) );
+	CHECK( !is_multicast( address_v4( "240.0.0.0" ) ) );
+	CHECK( !is_multicast( address_local_host ) );
+
+	CHECK( is_link_local_multicast( multicast_all_hosts ) );
+	CHECK( !is_link_local_multicast( address_v4( "224.0.1.1" ) ) );
+	CHECK( is_admin_scoped_multicast( address_v4( "239.1.2.3" ) ) );
+	CHECK( !is_admin_scoped_multicast( address_v4( "238.1.2.3" ) ) );
+
+	CHECK( try_parse_multicast_group( "239.255.77.1" ) == address_v4( "239.255.77.1" ) );
+	CHECK( !try_parse_multicast_group( "127.0.0.1" ).has_value() );
+	CHECK( !try_parse_multicast_group( "239.255.77" ).has_value() );
+}
+
+TEST_CASE( "udp_multicast_single_send_reaches_all_local_subscribers", "[net][udp][multicast]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+	using mart::nw::socks::SocketOption;
+	using mart::nw::socks::SocketOptionLevel;
+
+	const address_v4    group( "239.255.77.1" );
+	const udp::endpoint group_ep( group, port_nr( std::uint16_t{ 3493 } ) );
+
+	// everything stays on the loopback interface
+	constexpr std::size_t                   subscriber_cnt = 3;
+	std::array<udp::Socket, subscriber_cnt> subscribers;
+	for( auto& s : subscribers ) {
+		s.as_raii_socket().setsockopt( SocketOptionLevel::Socket, SocketOption::so_reuseaddr, 1 );
+		s.bind( udp::endpoint( address_any, group_ep.port ) );
+		udp::join_multicast_group( s, group, address_local_host );
+		s.set_rx_timeout( 100ms );
+	}
+	CHECK( udp::try_join_multicast_group( subscribers[0], address_local_host ).value()
+		   == mart::nw::socks::ErrorCodeValues::InvalidArgument );
+	CHECK_THROWS_AS( udp::join_multicast_group( subscribers[0], address_v4( "10.0.0.1" ) ),
+					 mart::nw::generic_nw_error );
+
+	udp::Socket sender;
+	REQUIRE( udp::try_set_multicast_interface( sender, address_local_host ) );
+	CHECK( udp::try_set_multicast_ttl( sender, 1 ) );
+	CHECK( udp::try_set_multicast_loopback( sender, true ) );
+
+	constexpr std::size_t msg_cnt = 20;
+	for( std::size_t i = 0; i < msg_cnt; ++i ) {
+		const auto value = static_cast<std::uint32_t>( i );
+		sender.sendto( mart::view_bytes( value ), group_ep );
+	}
+
+	const auto recv_all = [&]( udp::Socket& s ) {
+		constexpr std::size_t batch_size = udp::Socket::max_recv_batch_size;
+
+		std::vector<std::uint32_t>                             values;
+		std::array<std::array<mart::ByteType, 64>, batch_size> storage{};
+		std::array<mart::MemoryView, batch_size>               buffers;
+		std::array<udp::Socket::RecvfromResult, batch_size>    results;
+		for( std::size_t i = 0; i < buffers.size(); ++i ) {
+			buffers[i] = mart::view_elements_mutable( storage[i] );
+		}
+		while( const std::size_t cnt = s.recv_batch( buffers, results ) ) {
+			for( std::size_t i = 0; i < cnt; ++i ) {
+				std::uint32_t value = 0;
+				if( results[i].data.size() == sizeof( value ) ) {
+					std::memcpy( &value, results[i].data.data(), sizeof( value ) );
+					values.push_back( value );
+				}
+			}
+		}
+		return values;
+	};
+
+	for( auto& s : subscribers ) {
+		const auto values = recv_all( s );
+		REQUIRE( values.size() == msg_cnt );
+		for( std::size_t i = 0; i < msg_cnt; ++i ) {
+			CHECK( values[i] == i );
+		}
+	}
+
+	// once nobody on this host is a member anymore, the datagrams aren't delivered at all
+	// (on linux, sockets bound to address_any get the datagrams of all groups joined by any local socket)
+	for( auto& s : subscribers ) {
+		udp::leave_multicast_group( s, group, address_local_host );
+	}
+	CHECK( udp::try_leave_multicast_group( subscribers[0], group, address_local_host ).raw_value() != 0 );
+	sender.sendto( mart::view_bytes( std::uint32_t{ 42 } ), group_ep );
+
+	for( auto& s : subscribers ) {
+		CHECK( recv_all( s ).empty() );
+	}
+}
@@ -0,0 +1,69 @@
+#include <mart-netlib/udp_sharded_server.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST_CASE( "udp_sharded_server_dispatches_to_all_shards", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	udp::ShardedServer::Config config;
+	config.local        = udp::endpoint{ "127.0.0.1:0" };
+	config.shard_count  = 4;
+	config.stop_latency = 10ms;
+
+	std::atomic<int> handled{ 0 };
+	std::atomic<int> invalid{ 0 };
+
+	udp::ShardedServer server( config, [&]( std::size_t shard, udp::Socket& socket, const auto& datagram ) {
+		if( shard >= 4 || datagram.data.size() != sizeof( int ) ) { invalid++; }
+		handled++;
+		// echo
+		socket.sendto( datagram.data, datagram.remote_address );
+	} );
+	REQUIRE( server.shard_count() == 4 );
+	REQUIRE( server.local_endpoint().port.inHostOrder() != 0 );
+
+	// the kernel distributes by source address, so we need several senders
+	constexpr int            senders = 16;
+	constexpr int            msgs    = 10;
+	std::vector<udp::Socket> clients( senders );
+	for( auto& c : clients ) {
+		c.bind( udp::endpoint{ "127.0.0.1:0" } );
+		c.set_rx_timeout( 1000ms );
+	}
+	int echoed = 0;
+	for( int i = 0; i < msgs; ++i ) {
+		for( auto& c : clients ) {
+			c.sendto( mart::view_bytes( i ), server.local_endpoint() );
+			int        value = -1;
+			const auto res   = c.recvfrom( mart::view_bytes_mutable( value ) );
+			if( res.data.size() == sizeof( int ) && value == i ) { echoed++; }
+		}
+	}
+	CHECK( echoed == senders * msgs );
+	CHECK( handled == senders * msgs );
+	CHECK( invalid == 0 );
+
+	// the counters are updated after the handler returned
+	server.stop();
+	CHECK( server.received() == static_cast<std::uint64_t>( senders * msgs ) );
+
+	std::size_t used_shards = 0;
+	for( std::size_t i = 0; i < server.shard_count(); ++i ) {
+		used_shards += server.received( i ) != 0 ? 1 : 0;
+	}
+	CHECK( used_shards > 1 );
+	CHECK( server.failed_shards() == 0 );
+	CHECK( server.error( 0 ).success() );
+	CHECK( !server.error( server.shard_count() ).success() );
+
+	// stop is idempotent
+	server.stop();
+}
@@ -0,0 +1,106 @@
+#include <mart-netlib/wire_format.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace {
+
+namespace wire = mart::nw::wire;
+
+enum class Mode : std::uint8_t { Idle = 1, Active = 7 };
+
+struct StatusMsg {
+	static constexpr std::size_t                              size = 24;
+	static constexpr wire::Field<std::uint32_t, 0>            seq{};
+	static constexpr wire::Field<std::uint16_t, 4>            heart_rate{};
+	static constexpr wire::Field<std::int16_t, 6, wire::le>   temperature{};
+	static constexpr wire::Field<Mode, 8>                     mode{};
+	static constexpr wire::Field<double, 12>                  position{};
+	static constexpr wire::Field<std::uint32_t, 20, wire::le> checksum{};
+};
+static_assert( wire::is_valid_layout<StatusMsg>( StatusMsg::seq,
+												 StatusMsg::heart_rate,
+												 StatusMsg::temperature,
+												 StatusMsg::mode,
+												 StatusMsg::position,
+												 StatusMsg::checksum ) );
+
+struct BrokenMsg {
+	static constexpr std::size_t                   size = 6;
+	static constexpr wire::Field<std::uint32_t, 0> a{};
+	static constexpr wire::Field<std::uint16_t, 2> overlaps_a{};
+	static constexpr wire::Field<std::uint16_t, 5> exceeds_size{};
+};
+static_assert( wire::is_valid_layout<BrokenMsg>( BrokenMsg::a ) );
+static_assert( !wire::is_valid_layout<BrokenMsg>( BrokenMsg::a, BrokenMsg::overlaps_a ) );
+static_assert( !wire::is_valid_layout<BrokenMsg>( BrokenMsg::exceeds_size ) );
+
+} // namespace
+
+TEST_CASE( "wire_format_writer_encodes_fields_in_their_byte_order", "[net][wire_format]" )
+{
+	std::array<mart::ByteType, 32> buffer{};
+
+	wire::Writer<StatusMsg> writer( mart::view_elements_mutable( buffer ) );
+	writer.clear()
+		.set( StatusMsg::seq, 0x01020304 )
+		.set( StatusMsg::heart_rate, 0xA0B0 )
+		.set( StatusMsg::temperature, -2 )
+		.set( StatusMsg::mode, Mode::Active )
+		.set( StatusMsg::position, 1.5 )
+		.set( StatusMsg::checksum, 0x11223344 );
+
+	CHECK( writer.bytes().size() == StatusMsg::size );
+
+	// big endian by default, little endian where requested
+	CHECK( buffer[0] == 0x01 );
+	CHECK( buffer[3] == 0x04 );
+	CHECK( buffer[4] == 0xA0 );
+	CHECK( buffer[5] == 0xB0 );
+	CHECK( buffer[6] == 0xFE );
+	CHECK( buffer[7] == 0xFF );
+	CHECK( buffer[8] == 7 );
+	CHECK( buffer[12] == 0x3F ); // 1.5 = 0x3FF8000000000000
+	CHECK( buffer[13] == 0xF8 );
+	CHECK( buffer[20] == 0x44 );
+	CHECK( buffer[23] == 0x11 );
+
+	// the same values come back in host order
+	const wire::View<StatusMsg> view( mart::view_elements( buffer ) );
+	CHECK( view.get( StatusMsg::seq ) == 0x01020304u );
+	CHECK( view.get( StatusMsg::heart_rate ) == 0xA0B0u );
+	CHECK( view.get( StatusMsg::temperature ) == -2 );
+	CHECK( view.get( StatusMsg::mode ) == Mode::Active );
+	CHECK( view.get( StatusMsg::position ) == 1.5 );
+	CHECK( view.get( StatusMsg::checksum ) == 0x11223344u );
+	CHECK( writer.get( StatusMsg::seq ) == 0x01020304u );
+	CHECK( view.trailing().size() == buffer.size() - StatusMsg::size );
+}
+
+TEST_CASE( "wire_format_views_are_bounds_checked_once", "[net][wire_format]" )
+{
+	std::array<mart::ByteType, StatusMsg::size + 3> buffer{};
+	buffer[0] = 0xFF;
+
+	// views are unaligned
+	const auto data = mart::view_elements( buffer ).subview( 1 );
+	REQUIRE( data.size() == StatusMsg::size + 2 );
+
+	const auto view = wire::View<StatusMsg>::try_from( data );
+	REQUIRE( view.has_value() );
+	CHECK( view->bytes().data() == data.data() );
+	CHECK( view->trailing().size() == 2 );
+
+	CHECK( !wire::View<StatusMsg>::try_from( data.subview( 0, StatusMsg::size - 1 ) ).has_value() );
+	CHECK( !wire::Writer<StatusMsg>::try_from( mart::view_elements_mutable( buffer ).subview( 0, 10 ) ).has_value() );
+	CHECK_THROWS_AS( wire::View<StatusMsg>( data.subview( 0, 10 ) ), mart::nw::generic_nw_error );
+	CHECK_THROWS_AS( wire::Writer<StatusMsg>( mart::MemoryView{} ), mart::nw::generic_nw_error );
+
+	auto writer = wire::Writer<StatusMsg>::try_from( mart::view_elements_mutable( buffer ).subview( 3 ) );
+	REQUIRE( writer.has_value() );
+	writer->set( StatusMsg::seq, 42 );
+	CHECK( view->get( StatusMsg::heart_rate ) == 42u ); // view starts two bytes earlier
+	CHECK( buffer[0] == 0xFF );
+}
@@ -0,0 +1,124 @@
+#include <mart-common/HexDump.h>
+
+#include <mart-common/PrintWrappers.h>
+#include <mart-common/logging/default_formatter.h>
+
+#include <catch2/catch.hpp>
+
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Previous, ostream based implementations that serve as reference for the output format
+void reference_print_one_line( std::ostream& out, mart::ConstMemoryView mem, size_t fillto = 0 )
+{
+	out << '[';
+	for( mart::ByteType b : mem ) {
+		out << ' ' << std::setw( 2 ) << static_cast<int>( b );
+	}
+	if( fillto > mem.size() ) { out << std::string( ( fillto - mem.size() ) * 3, ' ' ); }
+	out << " ]";
+}
+
+void reference_log_format( std::ostream& out, mart::ConstMemoryView mem )
+{
+	constexpr std::size_t ElementsPerLine = 20;
+
+	mart::log::ostream_flag_saver _( out );
+	out << std::right << std::hex << std::setfill( '0' );
+
+	if( mem.size() <= ElementsPerLine ) {
+		reference_print_one_line( out, mem );
+	} else {
+		while( !mem.empty() ) {
+			out << "\n\t";
+			auto parts = mem.split( std::min( ElementsPerLine, mem.size() ) );
+			reference_print_one_line( out, parts.first, ElementsPerLine );
+			mem = parts.second;
+		}
+		out << '\n';
+	}
+}
+
+void reference_sformat( std::ostream& out, mart::ConstMemoryView range, std::size_t chunk_size, std::size_t row_size )
+{
+	mart::os_flag_guard g( out );
+
+	out << '[' << ' ';
+	for( std::size_t i = 0; i < range.size(); ++i ) {
+		out << std::hex << std::setw( 2 ) << std::setfill( '0' ) << (int)range[i] << ' ';
+		if( ( i + 1 ) % row_size == 0 ) {
+			out << "\n  ";
+		} else {
+			if( ( i + 1 ) % chunk_size == 0 ) { out << "  "; }
+		}
+	}
+	out << ']';
+}
+
+std::vector<mart::ByteType> make_data( std::size_t size )
+{
+	std::vector<mart::ByteType> data( size );
+	for( std::size_t i = 0; i < size; ++i ) {
+		data[i] = static_cast<mart::ByteType>( i * 13 );
+	}
+	return data;
+}
+
+} // namespace
+
+TEST_CASE( "HexDump_encode", "[HexDump]" )
+{
+	const std::array<mart::ByteType, 4> data{ mart::ByteType{ 0x00 }, mart::ByteType{ 0x0a }, mart::ByteType{ 0x7f }, mart::ByteType{ 0xff } };
+
+	char buffer[8];
+	auto end = mart::hex::encode( buffer, mart::ConstMemoryView( data ) );
+	CHECK( std::string_view( buffer, end - buffer ) == "000a7fff" );
+	end = mart::hex::encode( buffer, mart::ConstMemoryView( data ), true );
+	CHECK( std::string_view( buffer, end - buffer ) == "000A7FFF" );
+}
+
+TEST_CASE( "HexDump_log_format_is_identical_to_stream_based_version", "[HexDump]" )
+{
+	for( std::size_t size : { 0, 1, 19, 20, 21, 40, 99, 1500 } ) {
+		const auto data = make_data( size );
+		const auto mem  = mart::ConstMemoryView( data.data(), data.size() );
+
+		for( auto flags : { std::ios::fmtflags{}, std::ios::uppercase, std::ios::left, std::ios::showbase } ) {
+			std::ostringstream ref;
+			std::ostringstream actual;
+			ref.flags( ref.flags() | flags );
+			actual.flags( actual.flags() | flags );
+			ref << std::setw( 3 );
+			actual << std::setw( 3 );
+
+			reference_log_format( ref, mem );
+			mart::log::defaultFormatForLog( actual, mem );
+			CHECK( actual.str() == ref.str() );
+			CHECK( actual.flags() == ref.flags() );
+		}
+	}
+}
+
+TEST_CASE( "HexDump_sformat_is_identical_to_stream_based_version", "[HexDump]" )
+{
+	for( std::size_t size : { 0, 1, 8, 9, 32, 33, 1500 } ) {
+		const auto data = make_data( size );
+		const auto mem  = mart::ConstMemoryView( data.data(), data.size() );
+
+		for( auto flags : { std::ios::fmtflags{}, std::ios::uppercase, std::ios::left, std::ios::showbase } ) {
+			std::ostringstream ref;
+			std::ostringstream actual;
+			ref.flags( ref.flags() | flags );
+			actual.flags( actual.flags() | flags );
+
+			reference_sformat( ref, mem, 8, 32 );
+			actual << mart::sformat( mem );
+			CHECK( actual.str() == ref.str() );
+			CHECK( actual.fill() == ref.fill() );
+		}
+	}
+}